@@ -33,6 +33,7 @@
 #include "galois/Galois.h"
 #include <boost/iterator/counting_iterator.hpp>
 #include <boost/mpl/has_xxx.hpp>
+#include <algorithm>
 #include <climits> // CHAR_BIT
 #include <vector>
 #include <assert.h>
@@ -40,16 +41,148 @@
 namespace galois {
 /**
  * Concurrent dynamically allocated bitset
+ *
+ * Words are grouped into lines of 8 words (one cache line). A summary word
+ * holds one bit per line that is set whenever a bit in the line may be set,
+ * so iteration, counting and bulk operations touch only lines that may hold
+ * set bits. Clearing single bits leaves the summary bit set; it is cleared
+ * by reset() and recomputed after the words were modified through
+ * get_vec().
  **/
 class DynamicBitSet {
 protected:
   galois::PODResizeableArray<galois::CopyableAtomic<uint64_t>> bitvec;
   size_t num_bits;
   static constexpr uint32_t bits_uint64 = sizeof(uint64_t) * CHAR_BIT;
+  static constexpr uint32_t words_line  = 8;
+  //! bit i of summary[s] covers words [(64 * s + i) * 8, (64 * s + i + 1) * 8)
+  mutable galois::PODResizeableArray<galois::CopyableAtomic<uint64_t>> summary;
+  mutable bool summary_valid;
+
+  static size_t summary_size(size_t words) {
+    return (words + words_line * bits_uint64 - 1) / (words_line * bits_uint64);
+  }
+
+  //! Number of lines, i.e., groups of words_line words
+  size_t num_lines() const {
+    return (bitvec.size() + words_line - 1) / words_line;
+  }
+
+  //! Marks the line of a word as possibly non-zero
+  void mark_line(size_t word) {
+    if (!summary_valid)
+      return;
+    size_t line  = word / words_line;
+    uint64_t bit = uint64_t{1} << (line % bits_uint64);
+    auto& sum    = summary[line / bits_uint64];
+    if (!(sum.load(std::memory_order_relaxed) & bit))
+      sum.fetch_or(bit, std::memory_order_relaxed);
+  }
+
+  //! Recomputes the summary if the words were written through get_vec()
+  void ensure_summary() const {
+    if (summary_valid)
+      return;
+    summary.resize(summary_size(bitvec.size()));
+    std::fill(summary.begin(), summary.end(), 0);
+    galois::do_all(galois::iterate(size_t{0}, num_lines()),
+                   [&](size_t line) {
+                     size_t w  = line * words_line;
+                     size_t we = std::min(w + words_line, bitvec.size());
+                     uint64_t any = 0;
+                     for (; w < we; ++w)
+                       any |= bitvec[w];
+                     if (any)
+                       summary[line / bits_uint64].fetch_or(
+                           uint64_t{1} << (line % bits_uint64),
+                           std::memory_order_relaxed);
+                   },
+                   galois::no_stats());
+    summary_valid = true;
+  }
+
+  /**
+   * Calls fn(w) for every word w in the lines marked in the given summary
+   * bits of summary word s.
+   */
+  template <typename F>
+  void for_each_word(size_t s, uint64_t lines, F& fn) const {
+    for (; lines; lines &= lines - 1) {
+      size_t w  = (s * bits_uint64 + __builtin_ctzll(lines)) * words_line;
+      size_t we = std::min(w + words_line, bitvec.size());
+      for (; w < we; ++w)
+        fn(w);
+    }
+  }
+
+  /**
+   * Calls fn(w) for every word w in the lines [lineBegin, lineEnd) that are
+   * marked in mask(s), which combines summary words of this and other
+   * bitsets.
+   */
+  template <typename M, typename F>
+  void for_each_word_in(size_t lineBegin, size_t lineEnd, M& mask,
+                        F& fn) const {
+    for (size_t s = lineBegin / bits_uint64; s * bits_uint64 < lineEnd; ++s) {
+      size_t first   = s * bits_uint64;
+      uint64_t lines = mask(s);
+      if (lineBegin > first)
+        lines &= ~uint64_t{0} << (lineBegin - first);
+      if (lineEnd < first + bits_uint64)
+        lines &= ~(~uint64_t{0} << (lineEnd - first));
+      for_each_word(s, lines, fn);
+    }
+  }
+
+  /**
+   * Calls fn(w) in parallel for every word w in the lines marked by
+   * mask(s). Each thread takes an equal range of lines, so dense bitsets
+   * are balanced while empty lines are still skipped.
+   */
+  template <typename M, typename F>
+  void do_all_words(M mask, F fn) const {
+    galois::on_each([&](unsigned tid, unsigned nthreads) {
+      size_t start;
+      size_t end;
+      std::tie(start, end) =
+          galois::block_range(size_t{0}, num_lines(), tid, nthreads);
+      for_each_word_in(start, end, mask, fn);
+    });
+  }
+
+  //! Returns the summary word s of this bitset
+  auto own_summary() const {
+    return [this](size_t s) {
+      return summary[s].load(std::memory_order_relaxed);
+    };
+  }
+
+  //! Calls fn(index) for every set bit in the lines [lineBegin, lineEnd)
+  template <typename F>
+  void for_each_set_in(size_t lineBegin, size_t lineEnd, F& fn) const {
+    auto visit = [&](size_t w) {
+      for (uint64_t bits = bitvec[w].load(std::memory_order_relaxed); bits;
+           bits &= bits - 1)
+        fn(w * bits_uint64 + __builtin_ctzll(bits));
+    };
+    auto mask = own_summary();
+    for_each_word_in(lineBegin, lineEnd, mask, visit);
+  }
+
+  //! Number of set bits in the lines [lineBegin, lineEnd)
+  uint64_t count_in(size_t lineBegin, size_t lineEnd) const {
+    uint64_t n = 0;
+    auto pop   = [&](size_t w) {
+      n += __builtin_popcountll(bitvec[w].load(std::memory_order_relaxed));
+    };
+    auto mask = own_summary();
+    for_each_word_in(lineBegin, lineEnd, mask, pop);
+    return n;
+  }
 
 public:
   //! Constructor which initializes to an empty bitset.
-  DynamicBitSet() : num_bits(0) {}
+  DynamicBitSet() : num_bits(0), summary_valid(true) {}
 
   /**
    * Returns the underlying bitset representation to the user
@@ -62,12 +195,16 @@ public:
   }
 
   /**
-   * Returns the underlying bitset representation to the user
+   * Returns the underlying bitset representation to the user. The summary
+   * of non-empty lines is recomputed on the next operation that needs it.
    *
    * @returns reference to vector of copyable atomics that represents the
    * bitset
    */
-  auto& get_vec() { return bitvec; }
+  auto& get_vec() {
+    summary_valid = false;
+    return bitvec;
+  }
 
   /**
    * Resizes the bitset.
@@ -78,6 +215,8 @@ public:
     assert(bits_uint64 == 64); // compatibility with other devices
     num_bits = n;
     bitvec.resize((n + bits_uint64 - 1) / bits_uint64);
+    summary.resize(summary_size(bitvec.size()));
+    summary_valid = false;
     reset();
   }
 
@@ -89,6 +228,7 @@ public:
   void reserve(uint64_t n) {
     assert(bits_uint64 == 64); // compatibility with other devices
     bitvec.reserve((n + bits_uint64 - 1) / bits_uint64);
+    summary.reserve(summary_size((n + bits_uint64 - 1) / bits_uint64));
   }
 
   /**
@@ -104,9 +244,22 @@ public:
   //size_t alloc_size() const { return bitvec.size() * sizeof(uint64_t); }
 
   /**
-   * Unset every bit in the bitset.
+   * Unset every bit in the bitset. Only lines that may hold set bits are
+   * cleared.
    */
-  void reset() { std::fill(bitvec.begin(), bitvec.end(), 0); }
+  void reset() {
+    if (summary_valid) {
+      auto clear = [&](size_t w) { bitvec[w] = 0; };
+      for (size_t s = 0; s < summary.size(); ++s) {
+        for_each_word(s, summary[s], clear);
+        summary[s] = 0;
+      }
+    } else {
+      std::fill(bitvec.begin(), bitvec.end(), 0);
+      std::fill(summary.begin(), summary.end(), 0);
+      summary_valid = true;
+    }
+  }
 
   /**
    * Unset a range of bits given an inclusive range
@@ -211,9 +364,52 @@ public:
             !bitvec[bit_index].compare_exchange_weak(
               old_val, old_val | bit_offset, std::memory_order_relaxed))
       ;
+    if (!(old_val & bit_offset))
+      mark_line(bit_index);
     return (old_val & bit_offset);
   }
 
+  /**
+   * Set an inclusive range of bits. Whole words are written with one store
+   * and the words at either end with one atomic or, so concurrent set calls
+   * on the same words are safe.
+   *
+   * @param begin first bit in range to set
+   * @param end last bit in range to set
+   */
+  void set_range(size_t begin, size_t end) {
+    assert(begin <= end);
+    assert(end < num_bits);
+    size_t first = begin / bits_uint64;
+    size_t last  = end / bits_uint64;
+    for (size_t w = first; w <= last; ++w) {
+      uint64_t mask = ~uint64_t{0};
+      if (w == first)
+        mask &= ~uint64_t{0} << (begin % bits_uint64);
+      if (w == last)
+        mask &= ~uint64_t{0} >> (bits_uint64 - 1 - end % bits_uint64);
+      if (mask == ~uint64_t{0})
+        bitvec[w].store(mask, std::memory_order_relaxed);
+      else
+        bitvec[w].fetch_or(mask, std::memory_order_relaxed);
+    }
+
+    if (!summary_valid)
+      return;
+    size_t firstLine = first / words_line;
+    size_t lastLine  = last / words_line;
+    for (size_t s = firstLine / bits_uint64; s <= lastLine / bits_uint64;
+         ++s) {
+      uint64_t mask = ~uint64_t{0};
+      if (s == firstLine / bits_uint64)
+        mask &= ~uint64_t{0} << (firstLine % bits_uint64);
+      if (s == lastLine / bits_uint64)
+        mask &= ~uint64_t{0} >> (bits_uint64 - 1 - lastLine % bits_uint64);
+      if ((summary[s].load(std::memory_order_relaxed) & mask) != mask)
+        summary[s].fetch_or(mask, std::memory_order_relaxed);
+    }
+  }
+
   /**
    * Reset a bit in the bitset.
    *
@@ -235,12 +431,21 @@ public:
   }
 
   // assumes bit_vector is not updated (set) in parallel
+
+  /**
+   * Does an IN-PLACE bitwise or of this bitset and another bitset
+   *
+   * @param other Other bitset to do bitwise or with
+   */
   void bitwise_or(const DynamicBitSet& other) {
     assert(size() == other.size());
+    ensure_summary();
+    other.ensure_summary();
     auto& other_bitvec = other.get_vec();
-    galois::do_all(galois::iterate(size_t{0}, bitvec.size()),
-                   [&](size_t i) { bitvec[i] |= other_bitvec[i]; },
-                   galois::no_stats());
+    do_all_words([&](size_t s) { return other.summary[s].load(); },
+                 [&](size_t i) { bitvec[i] |= other_bitvec[i]; });
+    for (size_t s = 0; s < summary.size(); ++s)
+      summary[s] |= other.summary[s];
   }
 
   // assumes bit_vector is not updated (set) in parallel
@@ -252,10 +457,14 @@ public:
    */
   void bitwise_and(const DynamicBitSet& other) {
     assert(size() == other.size());
+    ensure_summary();
+    other.ensure_summary();
     auto& other_bitvec = other.get_vec();
-    galois::do_all(galois::iterate(size_t{0}, bitvec.size()),
-                   [&](size_t i) { bitvec[i] &= other_bitvec[i]; },
-                   galois::no_stats());
+    // lines empty in other are cleared outright
+    do_all_words([&](size_t s) { return summary[s].load(); },
+                 [&](size_t i) { bitvec[i] &= other_bitvec[i]; });
+    for (size_t s = 0; s < summary.size(); ++s)
+      summary[s] &= other.summary[s];
   }
 
   /**
@@ -268,14 +477,36 @@ public:
   void bitwise_and(const DynamicBitSet& other1, const DynamicBitSet& other2) {
     assert(size() == other1.size());
     assert(size() == other2.size());
+    other1.ensure_summary();
+    other2.ensure_summary();
     auto& other_bitvec1 = other1.get_vec();
     auto& other_bitvec2 = other2.get_vec();
 
-    galois::do_all(galois::iterate(size_t{0}, bitvec.size()),
-                   [&](size_t i) {
-                     bitvec[i] = other_bitvec1[i] & other_bitvec2[i];
-                   },
-                   galois::no_stats());
+    // this may alias other1 or other2
+    ensure_summary();
+    do_all_words(
+        [&](size_t s) {
+          return summary[s] | (other1.summary[s] & other2.summary[s]);
+        },
+        [&](size_t i) { bitvec[i] = other_bitvec1[i] & other_bitvec2[i]; });
+    for (size_t s = 0; s < summary.size(); ++s)
+      summary[s] = other1.summary[s] & other2.summary[s];
+  }
+
+  /**
+   * Does an IN-PLACE bitwise and of this bitset and the complement of
+   * another bitset, i.e., clears the bits that are set in other
+   *
+   * @param other Bitset whose set bits are cleared in this bitset
+   */
+  void bitwise_andnot(const DynamicBitSet& other) {
+    assert(size() == other.size());
+    ensure_summary();
+    other.ensure_summary();
+    auto& other_bitvec = other.get_vec();
+    do_all_words(
+        [&](size_t s) { return summary[s] & other.summary[s]; },
+        [&](size_t i) { bitvec[i] &= ~other_bitvec[i]; });
   }
 
   /**
@@ -285,10 +516,13 @@ public:
    */
   void bitwise_xor(const DynamicBitSet& other) {
     assert(size() == other.size());
+    ensure_summary();
+    other.ensure_summary();
     auto& other_bitvec = other.get_vec();
-    galois::do_all(galois::iterate(size_t{0}, bitvec.size()),
-                   [&](size_t i) { bitvec[i] ^= other_bitvec[i]; },
-                   galois::no_stats());
+    do_all_words([&](size_t s) { return other.summary[s].load(); },
+                 [&](size_t i) { bitvec[i] ^= other_bitvec[i]; });
+    for (size_t s = 0; s < summary.size(); ++s)
+      summary[s] |= other.summary[s];
   }
 
   /**
@@ -301,67 +535,97 @@ public:
   void bitwise_xor(const DynamicBitSet& other1, const DynamicBitSet& other2) {
     assert(size() == other1.size());
     assert(size() == other2.size());
+    other1.ensure_summary();
+    other2.ensure_summary();
     auto& other_bitvec1 = other1.get_vec();
     auto& other_bitvec2 = other2.get_vec();
 
-    galois::do_all(galois::iterate(size_t{0}, bitvec.size()),
-                   [&](size_t i) {
-                     bitvec[i] = other_bitvec1[i] ^ other_bitvec2[i];
-                   },
-                   galois::no_stats());
+    // this may alias other1 or other2
+    ensure_summary();
+    do_all_words(
+        [&](size_t s) {
+          return summary[s] | other1.summary[s] | other2.summary[s];
+        },
+        [&](size_t i) { bitvec[i] = other_bitvec1[i] ^ other_bitvec2[i]; });
+    for (size_t s = 0; s < summary.size(); ++s)
+      summary[s] = other1.summary[s] | other2.summary[s];
   }
 
-
   /**
    * Count how many bits are set in the bitset
    *
    * @returns number of set bits in the bitset
    */
   uint64_t count() const {
+    ensure_summary();
     galois::GAccumulator<uint64_t> ret;
-    galois::do_all(galois::iterate(bitvec.begin(), bitvec.end()),
-                   [&](uint64_t n) {
-  #ifdef __GNUC__
-                     ret += __builtin_popcountll(n);
-  #else
-                     n = n - ((n >> 1) & 0x5555555555555555UL);
-                     n = (n & 0x3333333333333333UL) +
-                         ((n >> 2) & 0x3333333333333333UL);
-                     ret += (((n + (n >> 4)) & 0xF0F0F0F0F0F0F0FUL) *
-                             0x101010101010101UL) >>
-                            56;
-  #endif
-                   },
-                   galois::no_stats());
+    galois::on_each([&](unsigned tid, unsigned nthreads) {
+      size_t start;
+      size_t end;
+      std::tie(start, end) =
+          galois::block_range(size_t{0}, num_lines(), tid, nthreads);
+      ret += count_in(start, end);
+    });
     return ret.reduce();
   }
 
   /**
-   * Returns a vector containing the set bits in this bitset in order
-   * from left to right.
+   * Calls fn(index) for every set bit in increasing order. The cost is
+   * proportional to the number of lines holding set bits.
+   * Do NOT call in a parallel region if the words were modified through
+   * get_vec().
+   *
+   * @param fn function to call on the index of each set bit
+   */
+  template <typename F>
+  void for_each_set(F fn) const {
+    ensure_summary();
+    for_each_set_in(0, num_lines(), fn);
+  }
+
+  /**
+   * Calls fn(index) for every set bit in parallel. Each line, i.e., 512
+   * bits, is one iteration of a do_all that takes the passed loop arguments.
+   * Do NOT call in a parallel region.
+   *
+   * @param fn function to call on the index of each set bit
+   * @param args optional arguments to the do_all
+   */
+  template <typename F, typename... Args>
+  void do_all_set(F fn, const Args&... args) const {
+    ensure_summary();
+    galois::do_all(galois::iterate(size_t{0}, num_lines()),
+                   [&](size_t line) {
+                     if (summary[line / bits_uint64].load(
+                             std::memory_order_relaxed) &
+                         (uint64_t{1} << (line % bits_uint64)))
+                       for_each_set_in(line, line + 1, fn);
+                   },
+                   args...);
+  }
+
+  /**
+   * Writes the set bits in this bitset in order from left to right into
+   * offsets. offsets is resized only if some bit is set.
    * Do NOT call in a parallel region as it uses galois::on_each.
    *
-   * @returns vector with offsets into set bits
+   * @param offsets output: resizable array of indices of set bits
+   * @returns number of set bits
    */
-  // TODO uint32_t is somewhat dangerous; change in the future
-  std::vector<uint32_t> getOffsets() const {
+  template <typename VecTy>
+  size_t getOffsets(VecTy& offsets) const {
+    ensure_summary();
     uint32_t activeThreads = galois::getActiveThreads();
-    std::vector<unsigned int> tPrefixBitCounts(activeThreads);
+    std::vector<size_t> tPrefixBitCounts(activeThreads);
 
     // count how many bits are set on each thread
-    galois::on_each(
-      [&] (unsigned tid, unsigned nthreads) {
-        size_t start;
-        size_t end;
-        std::tie(start, end) = galois::block_range((size_t)0, this->size(), tid,
-                                                   nthreads);
-
-        unsigned int count = 0;
-        for (unsigned int i = start; i < end; ++i) {
-          if (this->test(i)) ++count;
-        }
+    galois::on_each([&](unsigned tid, unsigned nthreads) {
+      size_t start;
+      size_t end;
+      std::tie(start, end) =
+          galois::block_range((size_t)0, num_lines(), tid, nthreads);
 
-        tPrefixBitCounts[tid] = count;
+      tPrefixBitCounts[tid] = count_in(start, end);
     });
 
     // calculate prefix sum of bits per thread
@@ -370,37 +634,38 @@ public:
     }
 
     // total num of set bits
-    uint64_t bitsetCount = tPrefixBitCounts[activeThreads - 1];
-    std::vector<uint32_t> offsets;
+    size_t bitsetCount = tPrefixBitCounts[activeThreads - 1];
 
     // calculate the indices of the set bits and save them to the offset
     // vector
     if (bitsetCount > 0) {
       offsets.resize(bitsetCount);
-      galois::on_each(
-        [&] (unsigned tid, unsigned nthreads) {
-          size_t start;
-          size_t end;
-          std::tie(start, end) = galois::block_range((size_t)0, this->size(), tid,
-                                                     nthreads);
-          unsigned int count = 0;
-          unsigned int tPrefixBitCount;
-          if (tid == 0) {
-            tPrefixBitCount = 0;
-          } else {
-            tPrefixBitCount = tPrefixBitCounts[tid - 1];
-          }
-
-          for (unsigned int i = start; i < end; ++i) {
-            if (this->test(i)) {
-              offsets[tPrefixBitCount + count] = i;
-              ++count;
-            }
-          }
-        }
-      );
+      galois::on_each([&](unsigned tid, unsigned nthreads) {
+        size_t start;
+        size_t end;
+        std::tie(start, end) =
+            galois::block_range((size_t)0, num_lines(), tid, nthreads);
+
+        size_t next = (tid == 0) ? 0 : tPrefixBitCounts[tid - 1];
+        auto emit   = [&](size_t i) { offsets[next++] = i; };
+        for_each_set_in(start, end, emit);
+      });
     }
 
+    return bitsetCount;
+  }
+
+  /**
+   * Returns a vector containing the set bits in this bitset in order
+   * from left to right.
+   * Do NOT call in a parallel region as it uses galois::on_each.
+   *
+   * @returns vector with offsets into set bits
+   */
+  // TODO uint32_t is somewhat dangerous; change in the future
+  std::vector<uint32_t> getOffsets() const {
+    std::vector<uint32_t> offsets;
+    getOffsets(offsets);
     return offsets;
   }
 
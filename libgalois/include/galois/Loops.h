@@ -103,6 +103,14 @@ static inline void preAlloc(int num) {
   }
 }
 
+/**
+ * Returns hugepages that are currently unused back to the OS. Call it between
+ * loops, not while a loop is running.
+ *
+ * @returns number of pages released
+ */
+static inline size_t releasePages() { return runtime::pagePoolRelease(); }
+
 /**
  * Reports number of hugepages allocated by the Galois system so far. The value
  * is printing using the statistics infrastructure.
@@ -113,6 +121,18 @@ static inline void reportPageAlloc(const char* label) {
   runtime::reportPageAlloc(label);
 }
 
+/**
+ * Reports the bytes held in slabs by the fixed-size allocators, the bytes
+ * of live objects in them and how many objects were freed by the thread
+ * that allocated them versus another thread. The values are printed using
+ * the statistics infrastructure.
+ *
+ * @param label Label to associated with report at this program point
+ */
+static inline void reportSlabAlloc(const char* label) {
+  runtime::reportSlabAlloc(label);
+}
+
 /**
  * Galois ordered set iterator for stable source algorithms.
  *
@@ -0,0 +1,106 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_PROPAGATIONBLOCKING_H
+#define GALOIS_PROPAGATIONBLOCKING_H
+
+#include "galois/Galois.h"
+#include "galois/gstl.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace galois {
+
+/**
+ * Propagation blocking for push-style scatter loops.
+ *
+ * Instead of updating the data of a destination node directly, and
+ * atomically, an operator pushes (destination, value) pairs. Each thread
+ * appends them to its own bin for the range of rangeSize nodes that holds
+ * the destination, so pushing is sequential writes only. apply then hands
+ * every range to one owner thread, which applies all updates to the range,
+ * from every thread's bin, in sequence: the updated data of a range stays in
+ * cache and needs no atomics. Ranges are owned in contiguous blocks, thread
+ * 0 owning the lowest nodes, like the NUMA-blocked graph allocation.
+ *
+ * push may be called concurrently from any parallel loop; apply must not run
+ * concurrently with push.
+ *
+ * @tparam T type of the update values
+ */
+template <typename T>
+class PropagationBlocking {
+  struct Update {
+    uint32_t dst;
+    T value;
+  };
+  using Bin = gstl::Vector<Update>;
+
+  size_t rangeSize;
+  size_t numRanges;
+  //! per thread, one bin per range
+  substrate::PerThreadStorage<std::vector<Bin>> bins;
+
+public:
+  /**
+   * @param numNodes destinations are in [0, numNodes)
+   * @param rangeSize nodes per bin; choose it so that the data updated for
+   * that many nodes fits in cache
+   */
+  PropagationBlocking(size_t numNodes, size_t _rangeSize)
+      : rangeSize(std::max<size_t>(_rangeSize, 1)),
+        numRanges((numNodes + rangeSize - 1) / rangeSize) {
+    for (unsigned t = 0; t < bins.size(); ++t)
+      bins.getRemote(t)->resize(numRanges);
+  }
+
+  //! Records an update of dst by the calling thread
+  void push(uint32_t dst, const T& value) {
+    (*bins.getLocal())[dst / rangeSize].push_back(Update{dst, value});
+  }
+
+  /**
+   * Calls fn(dst, value) for every update pushed since the last apply, then
+   * empties the bins. All updates of a range are passed to fn by one thread,
+   * in order of the pushing thread and, per thread, of push.
+   */
+  template <typename F>
+  void apply(const F& fn) {
+    unsigned threads = bins.size();
+    galois::on_each(
+        [&](unsigned tid, unsigned total) {
+          auto ranges = galois::block_range(size_t{0}, numRanges, tid, total);
+          for (size_t r = ranges.first; r < ranges.second; ++r) {
+            for (unsigned t = 0; t < threads; ++t) {
+              Bin& bin = (*bins.getRemote(t))[r];
+              for (const Update& u : bin)
+                fn(u.dst, u.value);
+              bin.clear();
+            }
+          }
+        },
+        galois::no_stats());
+  }
+};
+
+} // namespace galois
+
+#endif
@@ -23,6 +23,7 @@
 #include "galois/gtuple.h"
 #include "galois/worklists/WorkList.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <tuple>
 
@@ -367,6 +368,30 @@ struct chunk_size :
   chunk_size(unsigned cs = SZ) : trait_has_value(regulate(cs)) {}
 };
 
+/**
+ * Lets a work-stealing {@link do_all()} choose chunk sizes at run time
+ * instead of using a fixed chunk_size. Each thread measures the cost of its
+ * iterations and sizes its chunks to take about targetNs nanoseconds; it
+ * shrinks them while its range is being stolen from and never takes more
+ * than half of its remaining range, so the tail of a loop is split finely.
+ * Chunk sizes stay within [minSize, maxSize] and are reported as loop
+ * statistics. Implies galois::steal().
+ */
+struct adaptive_chunk_size_tag {};
+struct adaptive_chunk_size : public adaptive_chunk_size_tag {
+  unsigned minSize;
+  unsigned maxSize;
+  unsigned targetNs;
+
+  adaptive_chunk_size(unsigned minSz = chunk_size_tag::MIN,
+                      unsigned maxSz = chunk_size_tag::MAX,
+                      unsigned target = 10000)
+      : minSize(std::max(minSz, unsigned(chunk_size_tag::MIN))),
+        maxSize(std::max(std::max(minSz, unsigned(chunk_size_tag::MIN)),
+                         maxSz)),
+        targetNs(target) {}
+};
+
 typedef worklists::PerSocketChunkFIFO<chunk_size<>::value> defaultWL;
 
 namespace internal {
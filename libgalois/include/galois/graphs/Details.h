@@ -297,6 +297,9 @@ public:
   void outOfLineAcquire(size_t n, MethodFlag mflag) {
     galois::runtime::acquire(&outOfLineLocks[n], mflag);
   }
+  bool outOfLineTryAcquire(size_t n, MethodFlag mflag) {
+    return galois::runtime::tryAcquire(&outOfLineLocks[n], mflag);
+  }
   void outOfLineAllocateLocal(size_t numNodes) {
     outOfLineLocks.allocateLocal(numNodes);
   }
@@ -325,6 +328,7 @@ public:
     static const size_t value = 0;
   };
   void outOfLineAcquire(size_t n, MethodFlag mflag) {}
+  bool outOfLineTryAcquire(size_t n, MethodFlag mflag) { return true; }
   void outOfLineAllocateLocal(size_t numNodes) {}
   void outOfLineAllocateInterleaved(size_t numNodes) {}
   void outOfLineAllocateBlocked(size_t) {}
@@ -0,0 +1,271 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_GRAPHS_GATHER_REDUCE_H
+#define GALOIS_GRAPHS_GATHER_REDUCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace galois {
+namespace graphs {
+
+//! Default distance, in edges, that graph edge maps prefetch ahead
+constexpr static const size_t DEFAULT_PREFETCH_DISTANCE = 64;
+
+//! Prefetches the cache line holding p for reading
+inline void prefetchRead(const void* p) { __builtin_prefetch(p, 0, 3); }
+
+namespace internal {
+
+//! Scalar gather reductions; specialized below for vector units
+template <typename T>
+struct Gather {
+  static T sum(const T* values, const uint32_t* idx, size_t count) {
+    T s = T();
+    for (size_t i = 0; i < count; ++i)
+      s += values[idx[i]];
+    return s;
+  }
+
+  static T dot(const T* weights, const T* values, const uint32_t* idx,
+               size_t count) {
+    T s = T();
+    for (size_t i = 0; i < count; ++i)
+      s += weights[i] * values[idx[i]];
+    return s;
+  }
+};
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+
+inline float horizontalSum(__m256 v) {
+  __m128 s =
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+inline double horizontalSum(__m256d v) {
+  __m128d s =
+      _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  s = _mm_add_sd(s, _mm_unpackhi_pd(s, s));
+  return _mm_cvtsd_f64(s);
+}
+
+#endif
+
+#if defined(__AVX512F__)
+
+// The AVX-512 intrinsics below all take an explicit source for the unused
+// lanes: the unmasked forms, and _mm512_reduce_add_*, start from
+// _mm512_undefined_* and trip -Wmaybe-uninitialized inside the GCC headers.
+
+inline __m512 gather(const float* values, __m512i vi) {
+  return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, vi, values, 4);
+}
+
+inline __m512d gather(const double* values, __m256i vi) {
+  return _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, vi, values, 8);
+}
+
+inline double horizontalSum(__m512d v) {
+  __m256d zero = _mm256_setzero_pd();
+  __m256d lo   = _mm512_mask_extractf64x4_pd(zero, 0xF, v, 0);
+  __m256d hi   = _mm512_mask_extractf64x4_pd(zero, 0xF, v, 1);
+  return horizontalSum(_mm256_add_pd(lo, hi));
+}
+
+inline float horizontalSum(__m512 v) {
+  __m256d zero = _mm256_setzero_pd();
+  __m256d lo = _mm512_mask_extractf64x4_pd(zero, 0xF, _mm512_castps_pd(v), 0);
+  __m256d hi = _mm512_mask_extractf64x4_pd(zero, 0xF, _mm512_castps_pd(v), 1);
+  return horizontalSum(
+      _mm256_add_ps(_mm256_castpd_ps(lo), _mm256_castpd_ps(hi)));
+}
+
+template <>
+struct Gather<float> {
+  static float sum(const float* values, const uint32_t* idx, size_t count) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i   = 0;
+    for (; i + 16 <= count; i += 16) {
+      __m512i vi = _mm512_loadu_si512(idx + i);
+      acc        = _mm512_add_ps(acc, gather(values, vi));
+    }
+    float s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += values[idx[i]];
+    return s;
+  }
+
+  static float dot(const float* weights, const float* values,
+                   const uint32_t* idx, size_t count) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i   = 0;
+    for (; i + 16 <= count; i += 16) {
+      __m512i vi = _mm512_loadu_si512(idx + i);
+      __m512 w   = _mm512_loadu_ps(weights + i);
+      acc        = _mm512_fmadd_ps(w, gather(values, vi), acc);
+    }
+    float s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += weights[i] * values[idx[i]];
+    return s;
+  }
+};
+
+template <>
+struct Gather<double> {
+  static double sum(const double* values, const uint32_t* idx, size_t count) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i    = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256i vi =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      acc = _mm512_add_pd(acc, gather(values, vi));
+    }
+    double s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += values[idx[i]];
+    return s;
+  }
+
+  static double dot(const double* weights, const double* values,
+                    const uint32_t* idx, size_t count) {
+    __m512d acc = _mm512_setzero_pd();
+    size_t i    = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256i vi =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      __m512d w = _mm512_loadu_pd(weights + i);
+      acc       = _mm512_fmadd_pd(w, gather(values, vi), acc);
+    }
+    double s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += weights[i] * values[idx[i]];
+    return s;
+  }
+};
+
+#elif defined(__AVX2__)
+
+template <>
+struct Gather<float> {
+  static float sum(const float* values, const uint32_t* idx, size_t count) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i   = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256i vi =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      acc = _mm256_add_ps(acc, _mm256_i32gather_ps(values, vi, 4));
+    }
+    float s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += values[idx[i]];
+    return s;
+  }
+
+  static float dot(const float* weights, const float* values,
+                   const uint32_t* idx, size_t count) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i   = 0;
+    for (; i + 8 <= count; i += 8) {
+      __m256i vi =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      __m256 w   = _mm256_loadu_ps(weights + i);
+      __m256 v   = _mm256_i32gather_ps(values, vi, 4);
+      acc        = _mm256_add_ps(acc, _mm256_mul_ps(w, v));
+    }
+    float s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += weights[i] * values[idx[i]];
+    return s;
+  }
+};
+
+template <>
+struct Gather<double> {
+  static double sum(const double* values, const uint32_t* idx, size_t count) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i    = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i));
+      acc        = _mm256_add_pd(acc, _mm256_i32gather_pd(values, vi, 8));
+    }
+    double s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += values[idx[i]];
+    return s;
+  }
+
+  static double dot(const double* weights, const double* values,
+                    const uint32_t* idx, size_t count) {
+    __m256d acc = _mm256_setzero_pd();
+    size_t i    = 0;
+    for (; i + 4 <= count; i += 4) {
+      __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i));
+      __m256d w  = _mm256_loadu_pd(weights + i);
+      __m256d v  = _mm256_i32gather_pd(values, vi, 8);
+      acc        = _mm256_add_pd(acc, _mm256_mul_pd(w, v));
+    }
+    double s = horizontalSum(acc);
+    for (; i < count; ++i)
+      s += weights[i] * values[idx[i]];
+    return s;
+  }
+};
+
+#endif
+
+} // namespace internal
+
+/**
+ * Returns the sum of values[idx[i]] for i in [0, count).
+ *
+ * For float and double this uses AVX-512 or AVX2 gathers when the build
+ * targets them, which treat indices as signed 32-bit integers; all indices
+ * must therefore be below 2^31. The summation order, and hence rounding,
+ * differs from a sequential loop.
+ */
+template <typename T>
+T gather_sum(const T* values, const uint32_t* idx, size_t count) {
+  return internal::Gather<T>::sum(values, idx, count);
+}
+
+/**
+ * Returns the sum of weights[i] * values[idx[i]] for i in [0, count), i.e.,
+ * one row of a sparse matrix-vector product. Same restrictions as
+ * gather_sum.
+ */
+template <typename T>
+T gather_dot(const T* weights, const T* values, const uint32_t* idx,
+             size_t count) {
+  return internal::Gather<T>::dot(weights, values, idx, count);
+}
+
+} // namespace graphs
+} // namespace galois
+
+#endif
@@ -24,6 +24,7 @@
 #include "LC_InlineEdge_Graph.h"
 #include "LC_Linear_Graph.h"
 #include "LC_Morph_Graph.h"
+#include "LC_Dynamic_CSR_Graph.h"
 #include "LC_InOut_Graph.h"
 #include "LC_Adaptor_Graph.h"
 #include "Util.h"
@@ -80,6 +80,22 @@ public:
     return derived().get_data(N);
   }
 
+  /**
+   * Status-returning variant of the acquire done by getData: returns false
+   * instead of signalling a conflict (see galois::runtime::tryAcquire).
+   */
+  template <bool _A1 = HasNoLockable>
+  bool tryAcquireNode(GraphNode N, MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<!_A1>::type* = 0) {
+    return this->outOfLineTryAcquire(getId(N), mflag);
+  }
+
+  template <bool _A1 = HasNoLockable>
+  bool tryAcquireNode(GraphNode, MethodFlag = MethodFlag::WRITE,
+                      typename std::enable_if<_A1>::type* = 0) {
+    return true;
+  }
+
   edge_data_reference getEdgeData(edge_iterator ni,
                                   MethodFlag mflag = MethodFlag::UNPROTECTED) {
     // galois::runtime::checkWrite(mflag, false);
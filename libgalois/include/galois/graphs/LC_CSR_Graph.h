@@ -23,8 +23,10 @@
 #include "galois/Galois.h"
 #include "galois/graphs/Details.h"
 #include "galois/graphs/FileGraph.h"
+#include "galois/graphs/GatherReduce.h"
 #include "galois/graphs/GraphHelpers.h"
 
+#include <limits>
 #include <type_traits>
 
 /*
@@ -220,6 +222,35 @@ protected:
     edgeData.set(*nn, {});
   }
 
+  //! Walks the out-edges of N in batches of at most Batch destinations,
+  //! prefetching ahead of the batch; see edge_map
+  template <size_t Batch, typename F, typename P>
+  void edgeMapImpl(GraphNode N, F& fn, size_t prefetchDistance,
+                   MethodFlag mflag, const P& prefetchNode) {
+    static_assert(Batch > 0, "empty batches");
+    uint64_t ii          = *edge_begin(N, mflag);
+    uint64_t ee          = *raw_end(N);
+    const uint32_t* dsts = edgeDst.data();
+    while (ii < ee) {
+      uint64_t next = std::min<uint64_t>(ii + Batch, ee);
+      if (prefetchDistance) {
+        // edgeDst twice as far ahead, so reading the destinations to prefetch
+        // their data rarely misses; this runs into the following nodes'
+        // edges, which a loop over nodes visits next
+        uint64_t end =
+            std::min<uint64_t>(next + 2 * prefetchDistance, numEdges);
+        for (uint64_t k = ii + 2 * prefetchDistance; k < end;
+             k += 64 / sizeof(uint32_t))
+          prefetchRead(dsts + k);
+        end = std::min<uint64_t>(next + prefetchDistance, numEdges);
+        for (uint64_t k = ii + prefetchDistance; k < end; ++k)
+          prefetchNode(dsts[k]);
+      }
+      fn(dsts + ii, size_t(next - ii));
+      ii = next;
+    }
+  }
+
   size_t getId(GraphNode N) { return N; }
 
   GraphNode getNode(size_t n) { return n; }
@@ -399,6 +430,45 @@ public:
     return NI.getData();
   }
 
+  /**
+   * Status-returning variant of the acquire done by getData: returns false
+   * instead of signalling a conflict (see galois::runtime::tryAcquire).
+   */
+  template <bool _A1 = HasNoLockable, bool _A2 = HasOutOfLineLockable>
+  bool tryAcquireNode(GraphNode N, MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<!_A1 && !_A2>::type* = 0) {
+    return galois::runtime::tryAcquire(&nodeData[N], mflag);
+  }
+
+  template <bool _A1 = HasOutOfLineLockable, bool _A2 = HasNoLockable>
+  bool tryAcquireNode(GraphNode N, MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<_A1 && !_A2>::type* = 0) {
+    return this->outOfLineTryAcquire(getId(N), mflag);
+  }
+
+  template <bool _A1 = HasOutOfLineLockable, bool _A2 = HasNoLockable>
+  bool tryAcquireNode(GraphNode, MethodFlag = MethodFlag::WRITE,
+                      typename std::enable_if<_A2>::type* = 0) {
+    return true;
+  }
+
+  /**
+   * Status-returning variant of the acquire done by edge_begin: acquires N
+   * and its out-neighbors, stopping at the first conflict.
+   */
+  bool tryAcquireNeighborhood(GraphNode N,
+                              MethodFlag mflag = MethodFlag::WRITE) {
+    if (!tryAcquireNode(N, mflag))
+      return false;
+    if (!HasNoLockable && galois::runtime::shouldLock(mflag)) {
+      for (edge_iterator ii = raw_begin(N), ee = raw_end(N); ii != ee; ++ii) {
+        if (!tryAcquireNode(edgeDst[*ii], mflag))
+          return false;
+      }
+    }
+    return true;
+  }
+
   edge_data_reference getEdgeData(edge_iterator ni,
                                   MethodFlag mflag = MethodFlag::UNPROTECTED) {
     // galois::runtime::checkWrite(mflag, false);
@@ -467,6 +537,75 @@ public:
     return edges(N, mflag);
   }
 
+  /**
+   * Calls fn(dsts, count) on the destinations of the out-edges of N, in
+   * order, as consecutive batches of at most Batch node ids read directly
+   * from the edge array, so that the operator can vectorize over them (e.g.,
+   * with gather_sum). Acquires like edge_begin. While a batch is processed,
+   * the edge array 2 * prefetchDistance edges ahead and the node data of the
+   * destinations prefetchDistance edges ahead are prefetched; 0 disables
+   * prefetching.
+   */
+  template <size_t Batch = 64, typename F>
+  void edge_map(GraphNode N, F&& fn,
+                size_t prefetchDistance = DEFAULT_PREFETCH_DISTANCE,
+                MethodFlag mflag        = MethodFlag::WRITE) {
+    auto prefetchNode = [&](GraphNode dst) { prefetchRead(&nodeData[dst]); };
+    edgeMapImpl<Batch>(N, fn, prefetchDistance, mflag, prefetchNode);
+  }
+
+  /**
+   * Returns the sum of values[dst] over the out-edges of N, where values is
+   * a dense array indexed by node (e.g., a LargeArray of per-node
+   * contributions in a pull loop). Uses vector gathers where available (see
+   * galois::graphs::gather_sum) and prefetches values rather than node data.
+   */
+  template <typename T>
+  T gather_sum(GraphNode N, const T* values,
+               size_t prefetchDistance = DEFAULT_PREFETCH_DISTANCE,
+               MethodFlag mflag        = MethodFlag::WRITE) {
+    T sum              = T();
+    bool vector        = numNodes <= std::numeric_limits<int32_t>::max();
+    auto prefetchValue = [&](GraphNode dst) { prefetchRead(values + dst); };
+    auto reduce        = [&](const uint32_t* dsts, size_t count) {
+      if (vector) {
+        sum += galois::graphs::gather_sum(values, dsts, count);
+      } else {
+        for (size_t i = 0; i < count; ++i)
+          sum += values[dsts[i]];
+      }
+    };
+    edgeMapImpl<64>(N, reduce, prefetchDistance, mflag, prefetchValue);
+    return sum;
+  }
+
+  /**
+   * Returns the sum of getEdgeData(e) * values[getEdgeDst(e)] over the
+   * out-edges of N: one row of a sparse matrix-vector product with the graph
+   * as the matrix. Requires edge data of the same type as values.
+   */
+  template <typename T>
+  T gather_dot(GraphNode N, const T* values,
+               size_t prefetchDistance = DEFAULT_PREFETCH_DISTANCE,
+               MethodFlag mflag        = MethodFlag::WRITE) {
+    static_assert(std::is_same<T, EdgeTy>::value,
+                  "edge data and values must have the same type");
+    T sum              = T();
+    bool vector        = numNodes <= std::numeric_limits<int32_t>::max();
+    auto prefetchValue = [&](GraphNode dst) { prefetchRead(values + dst); };
+    auto reduce        = [&](const uint32_t* dsts, size_t count) {
+      const T* weights = edgeData.data() + (dsts - edgeDst.data());
+      if (vector) {
+        sum += galois::graphs::gather_dot(weights, values, dsts, count);
+      } else {
+        for (size_t i = 0; i < count; ++i)
+          sum += weights[i] * values[dsts[i]];
+      }
+    };
+    edgeMapImpl<64>(N, reduce, prefetchDistance, mflag, prefetchValue);
+    return sum;
+  }
+
   /**
    * Sorts outgoing edges of a node. Comparison function is over EdgeTy.
    */
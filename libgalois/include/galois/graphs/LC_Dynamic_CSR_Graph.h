@@ -0,0 +1,660 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file LC_Dynamic_CSR_Graph.h
+ *
+ * Contains the LC_Dynamic_CSR_Graph class.
+ */
+
+#ifndef GALOIS_GRAPH_LC_DYNAMIC_CSR_GRAPH_H
+#define GALOIS_GRAPH_LC_DYNAMIC_CSR_GRAPH_H
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/ParallelSTL.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/Details.h"
+#include "galois/graphs/FileGraph.h"
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <vector>
+
+namespace galois {
+namespace graphs {
+
+/**
+ * Batch-dynamic graph: a CSR graph whose edges can be inserted and deleted
+ * in batches.
+ *
+ * The graph is an immutable CSR base with the out-edges of each node sorted
+ * by destination, plus a delta CSR of inserted edges and a tombstone per
+ * deleted base edge. insertEdge and deleteEdge only append to a per-thread
+ * buffer, so they may be called from parallel loops. commit sorts the
+ * buffered batch and folds it into the delta and tombstones in parallel.
+ * Once the delta and tombstones outgrow a fraction of the base (see
+ * setCompactThreshold), commit merges everything into a new base.
+ *
+ * The node set is fixed. edges(n) visits the live base edges of n followed
+ * by its inserted edges, and getEdgeDst/getEdgeData work as for
+ * LC_CSR_Graph, so operators written against LC_CSR_Graph run unchanged.
+ * Edge iterators stay valid until the next commit or compact. The graph has
+ * no abstract locks; use it with galois::no_conflicts() or do_all.
+ *
+ * Updates have set semantics. A deleteEdge(src, dst) removes every src->dst
+ * edge. An insertEdge(src, dst) of an edge that already exists replaces its
+ * data and collapses duplicate edges from the input file. Within one batch,
+ * an insert of an edge wins over a delete of it. When one batch inserts the
+ * same edge several times, it is unspecified which data is kept.
+ *
+ * @tparam NodeTy data on nodes
+ * @tparam EdgeTy data on out edges
+ */
+template <typename NodeTy, typename EdgeTy, bool UseNumaAlloc = false,
+          typename FileEdgeTy = EdgeTy>
+class LC_Dynamic_CSR_Graph
+    : private boost::noncopyable,
+      private internal::LocalIteratorFeature<UseNumaAlloc> {
+public:
+  template <typename _node_data>
+  struct with_node_data {
+    typedef LC_Dynamic_CSR_Graph<_node_data, EdgeTy, UseNumaAlloc, FileEdgeTy>
+        type;
+  };
+
+  template <typename _edge_data>
+  struct with_edge_data {
+    typedef LC_Dynamic_CSR_Graph<NodeTy, _edge_data, UseNumaAlloc, FileEdgeTy>
+        type;
+  };
+
+  template <typename _file_edge_data>
+  struct with_file_edge_data {
+    typedef LC_Dynamic_CSR_Graph<NodeTy, EdgeTy, UseNumaAlloc,
+                                 _file_edge_data>
+        type;
+  };
+
+  //! The graph never has abstract locks
+  template <bool _has_no_lockable>
+  struct with_no_lockable {
+    typedef LC_Dynamic_CSR_Graph type;
+  };
+
+  //! If true, use NUMA-aware graph allocation
+  template <bool _use_numa_alloc>
+  struct with_numa_alloc {
+    typedef LC_Dynamic_CSR_Graph<NodeTy, EdgeTy, _use_numa_alloc, FileEdgeTy>
+        type;
+  };
+
+  typedef read_default_graph_tag read_tag;
+
+protected:
+  typedef LargeArray<EdgeTy> EdgeData;
+  typedef LargeArray<uint32_t> EdgeDst;
+  typedef LargeArray<uint64_t> EdgeIndData;
+  typedef LargeArray<uint8_t> EdgeFlags;
+  typedef internal::NodeInfoBaseTypes<NodeTy, false> NodeInfoTypes;
+  typedef internal::NodeInfoBase<NodeTy, false> NodeInfo;
+  typedef LargeArray<NodeInfo> NodeData;
+
+public:
+  typedef uint32_t GraphNode;
+  typedef EdgeTy edge_data_type;
+  typedef FileEdgeTy file_edge_data_type;
+  typedef NodeTy node_data_type;
+  typedef typename EdgeData::value_type edge_value_type;
+  typedef typename EdgeData::reference edge_data_reference;
+  typedef typename NodeInfoTypes::reference node_data_reference;
+  using iterator = boost::counting_iterator<typename EdgeDst::value_type>;
+  typedef iterator const_iterator;
+  typedef iterator local_iterator;
+  typedef iterator const_local_iterator;
+
+  /**
+   * Iterates over the edges of one node: the base edges that are not
+   * tombstoned, then the delta edges. Dereferences to an edge id; ids below
+   * the number of base edges index the base, the rest index the delta.
+   */
+  class edge_iterator
+      : public boost::iterator_facade<edge_iterator, uint64_t,
+                                      boost::forward_traversal_tag, uint64_t> {
+    friend class boost::iterator_core_access;
+    friend class LC_Dynamic_CSR_Graph;
+
+    const uint8_t* removed; //!< tombstones; null if there are none
+    uint64_t at;
+    uint64_t baseEnd;
+    uint64_t deltaBegin;
+
+    edge_iterator(const uint8_t* r, uint64_t b, uint64_t be, uint64_t db)
+        : removed(r), at(b), baseEnd(be), deltaBegin(db) {
+      skip();
+    }
+
+    void skip() {
+      if (removed)
+        while (at < baseEnd && removed[at])
+          ++at;
+      if (at == baseEnd)
+        at = deltaBegin;
+    }
+
+    void increment() {
+      ++at;
+      skip();
+    }
+    bool equal(const edge_iterator& other) const { return at == other.at; }
+    uint64_t dereference() const { return at; }
+
+  public:
+    edge_iterator() : removed(nullptr), at(0), baseEnd(0), deltaBegin(0) {}
+  };
+
+protected:
+  //! One buffered update
+  struct Update {
+    GraphNode src;
+    GraphNode dst;
+    bool insert;
+    edge_value_type data;
+  };
+
+  NodeData nodeData;
+
+  EdgeIndData baseIndex;
+  EdgeDst baseDst;
+  EdgeData baseData;
+  EdgeFlags removed;
+
+  EdgeIndData deltaIndex;
+  EdgeDst deltaDst;
+  EdgeData deltaData;
+
+  uint64_t numNodes       = 0;
+  uint64_t numBaseEdges   = 0;
+  uint64_t numRemoved     = 0;
+  uint64_t numDeltaEdges  = 0;
+  double compactThreshold = 0.1;
+
+  substrate::PerThreadStorage<std::vector<Update>> buffers;
+
+  typedef internal::EdgeSortIterator<GraphNode, uint64_t, EdgeDst, EdgeData>
+      edge_sort_iterator;
+
+  template <typename A>
+  static void allocate(A& array, size_t n) {
+    if (UseNumaAlloc)
+      array.allocateBlocked(n);
+    else
+      array.allocateInterleaved(n);
+  }
+
+  uint64_t baseBegin(GraphNode N) const { return N == 0 ? 0 : baseIndex[N - 1]; }
+  uint64_t baseEnd(GraphNode N) const { return baseIndex[N]; }
+  uint64_t deltaBegin(GraphNode N) const {
+    return N == 0 ? 0 : deltaIndex[N - 1];
+  }
+  uint64_t deltaEnd(GraphNode N) const { return deltaIndex[N]; }
+
+  //! First base edge of N with destination not below dst
+  uint64_t lowerBoundBase(GraphNode N, GraphNode dst) const {
+    const uint32_t* beg = &baseDst[0] + baseBegin(N);
+    const uint32_t* end = &baseDst[0] + baseEnd(N);
+    return std::lower_bound(beg, end, dst) - &baseDst[0];
+  }
+
+  /**
+   * Walks the delta edges of N merged in destination order with the updates
+   * [u, ue) of N and calls emit(dst, data) for every edge of the new delta.
+   * An inserted edge goes to the delta only if the base has no copy of it,
+   * live or not. With ApplyToBase, updates of edges in the base set their
+   * tombstones and data.
+   *
+   * @returns change in the number of tombstones
+   */
+  template <bool ApplyToBase, typename EmitTy>
+  int64_t mergeUpdates(GraphNode N, const Update* u, const Update* ue,
+                       EmitTy emit) {
+    int64_t tombstones = 0;
+    uint64_t d = deltaBegin(N), de = deltaEnd(N);
+    uint64_t be = baseEnd(N);
+    while (u != ue) {
+      GraphNode x = u->dst;
+      // deletes sort before inserts, so the last update of an edge wins
+      while (u + 1 != ue && (u + 1)->dst == x)
+        ++u;
+      const Update& last = *u++;
+
+      for (; d != de && deltaDst[d] < x; ++d)
+        emit(deltaDst[d], deltaData[d]);
+      if (d != de && deltaDst[d] == x)
+        ++d; // replaced or deleted
+
+      uint64_t b = lowerBoundBase(N, x);
+      if (b != be && baseDst[b] == x) {
+        if (!ApplyToBase)
+          continue;
+        bool keepFirst = last.insert;
+        for (; b != be && baseDst[b] == x; ++b) {
+          if (keepFirst) {
+            keepFirst = false;
+            baseData.set(b, last.data);
+            if (removed[b]) {
+              removed[b] = 0;
+              --tombstones;
+            }
+          } else if (!removed[b]) {
+            removed[b] = 1;
+            ++tombstones;
+          }
+        }
+      } else if (last.insert) {
+        emit(x, last.data);
+      }
+    }
+    for (; d != de; ++d)
+      emit(deltaDst[d], deltaData[d]);
+    return tombstones;
+  }
+
+  template <bool _A1 = EdgeData::has_value,
+            bool _A2 = LargeArray<FileEdgeTy>::has_value>
+  void constructEdgeValue(FileGraph& graph,
+                          typename FileGraph::edge_iterator nn,
+                          typename std::enable_if<!_A1 || _A2>::type* = 0) {
+    typedef LargeArray<FileEdgeTy> FED;
+    if (EdgeData::has_value)
+      baseData.set(*nn, graph.getEdgeData<typename FED::value_type>(nn));
+  }
+
+  template <bool _A1 = EdgeData::has_value,
+            bool _A2 = LargeArray<FileEdgeTy>::has_value>
+  void constructEdgeValue(FileGraph&, typename FileGraph::edge_iterator nn,
+                          typename std::enable_if<_A1 && !_A2>::type* = 0) {
+    baseData.set(*nn, {});
+  }
+
+  void resetDelta() {
+    deltaIndex.destroy();
+    deltaIndex.deallocate();
+    allocate(deltaIndex, numNodes);
+    galois::do_all(galois::iterate(UINT64_C(0), numNodes),
+                   [&](uint64_t n) { deltaIndex[n] = 0; }, galois::no_stats(),
+                   galois::loopname("DYNAMIC_GRAPH_RESET_DELTA"));
+    deltaDst.destroy();
+    deltaDst.deallocate();
+    deltaData.destroy();
+    deltaData.deallocate();
+    numDeltaEdges = 0;
+  }
+
+public:
+  LC_Dynamic_CSR_Graph() = default;
+
+  size_t size() const { return numNodes; }
+  size_t sizeEdges() const { return numBaseEdges - numRemoved + numDeltaEdges; }
+
+  iterator begin() const { return iterator(0); }
+  iterator end() const { return iterator(numNodes); }
+
+  const_local_iterator local_begin() const {
+    return const_local_iterator(this->localBegin(numNodes));
+  }
+
+  const_local_iterator local_end() const {
+    return const_local_iterator(this->localEnd(numNodes));
+  }
+
+  local_iterator local_begin() {
+    return local_iterator(this->localBegin(numNodes));
+  }
+
+  local_iterator local_end() {
+    return local_iterator(this->localEnd(numNodes));
+  }
+
+  node_data_reference getData(GraphNode N,
+                              MethodFlag = MethodFlag::UNPROTECTED) {
+    return nodeData[N].getData();
+  }
+
+  edge_data_reference getEdgeData(edge_iterator ni,
+                                  MethodFlag = MethodFlag::UNPROTECTED) {
+    uint64_t e = *ni;
+    return e < numBaseEdges ? baseData[e] : deltaData[e - numBaseEdges];
+  }
+
+  GraphNode getEdgeDst(edge_iterator ni) {
+    uint64_t e = *ni;
+    return e < numBaseEdges ? baseDst[e] : deltaDst[e - numBaseEdges];
+  }
+
+  edge_iterator edge_begin(GraphNode N, MethodFlag = MethodFlag::UNPROTECTED) {
+    return edge_iterator(numRemoved ? removed.data() : nullptr, baseBegin(N),
+                         baseEnd(N), numBaseEdges + deltaBegin(N));
+  }
+
+  edge_iterator edge_end(GraphNode N, MethodFlag = MethodFlag::UNPROTECTED) {
+    uint64_t e = numBaseEdges + deltaEnd(N);
+    return edge_iterator(nullptr, e, e, e);
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  edges(GraphNode N, MethodFlag mflag = MethodFlag::UNPROTECTED) {
+    return internal::make_no_deref_range(edge_begin(N, mflag),
+                                         edge_end(N, mflag));
+  }
+
+  runtime::iterable<NoDerefIterator<edge_iterator>>
+  out_edges(GraphNode N, MethodFlag mflag = MethodFlag::UNPROTECTED) {
+    return edges(N, mflag);
+  }
+
+  edge_iterator findEdge(GraphNode N1, GraphNode N2) {
+    edge_iterator ii = edge_begin(N1), ee = edge_end(N1);
+    for (; ii != ee; ++ii)
+      if (getEdgeDst(ii) == N2)
+        break;
+    return ii;
+  }
+
+  /**
+   * Buffers the insertion of edge src->dst. Safe to call from parallel
+   * loops; takes effect at the next commit.
+   */
+  void insertEdge(GraphNode src, GraphNode dst,
+                  const edge_value_type& data = edge_value_type()) {
+    buffers.getLocal()->push_back(Update{src, dst, true, data});
+  }
+
+  /**
+   * Buffers the deletion of all edges src->dst. Safe to call from parallel
+   * loops; takes effect at the next commit.
+   */
+  void deleteEdge(GraphNode src, GraphNode dst) {
+    buffers.getLocal()->push_back(Update{src, dst, false, edge_value_type()});
+  }
+
+  //! Number of buffered updates; call outside of parallel loops
+  size_t pendingUpdates() const {
+    size_t total = 0;
+    for (unsigned i = 0; i < buffers.size(); ++i)
+      total += buffers.getRemote(i)->size();
+    return total;
+  }
+
+  /**
+   * Sets how large the delta and tombstones may grow, as a fraction of the
+   * number of base edges, before commit compacts the graph.
+   */
+  void setCompactThreshold(double fraction) { compactThreshold = fraction; }
+
+  /**
+   * Applies all buffered updates. Must not run concurrently with other uses
+   * of the graph.
+   */
+  void commit() {
+    galois::StatTimer timer("TIMER_GRAPH_COMMIT");
+    timer.start();
+
+    std::vector<size_t> starts(buffers.size() + 1, 0);
+    for (unsigned i = 0; i < buffers.size(); ++i)
+      starts[i + 1] = starts[i] + buffers.getRemote(i)->size();
+    size_t total = starts.back();
+    if (total == 0) {
+      timer.stop();
+      return;
+    }
+
+    LargeArray<Update> batch;
+    batch.allocateInterleaved(total);
+    galois::on_each([&](unsigned tid, unsigned numThreads) {
+      for (unsigned i = tid; i < buffers.size(); i += numThreads) {
+        std::vector<Update>& buffer = *buffers.getRemote(i);
+        std::copy(buffer.begin(), buffer.end(), &batch[starts[i]]);
+        std::vector<Update>().swap(buffer);
+      }
+    });
+    galois::ParallelSTL::sort(
+        batch.data(), batch.data() + total,
+        [](const Update& a, const Update& b) {
+          if (a.src != b.src)
+            return a.src < b.src;
+          if (a.dst != b.dst)
+            return a.dst < b.dst;
+          return a.insert < b.insert;
+        });
+
+    // updates of node n are [updateIndex[n], updateIndex[n + 1])
+    EdgeIndData updateIndex;
+    updateIndex.allocateInterleaved(numNodes + 1);
+    galois::do_all(galois::iterate(UINT64_C(0), numNodes + 1),
+                   [&](uint64_t n) {
+                     updateIndex[n] =
+                         std::lower_bound(batch.data(), batch.data() + total,
+                                          n,
+                                          [](const Update& u, uint64_t n) {
+                                            return u.src < n;
+                                          }) -
+                         batch.data();
+                   },
+                   galois::no_stats(),
+                   galois::loopname("DYNAMIC_GRAPH_UPDATE_INDEX"));
+
+    EdgeIndData newIndex;
+    allocate(newIndex, numNodes);
+    galois::GAccumulator<int64_t> tombstones;
+    galois::do_all(
+        galois::iterate(UINT64_C(0), numNodes),
+        [&](uint64_t n) {
+          uint64_t count = 0;
+          tombstones += mergeUpdates<true>(
+              n, &batch[0] + updateIndex[n], &batch[0] + updateIndex[n + 1],
+              [&](GraphNode, const edge_value_type&) { ++count; });
+          newIndex[n] = count;
+        },
+        galois::steal(), galois::no_stats(),
+        galois::loopname("DYNAMIC_GRAPH_COUNT_DELTA"));
+
+    for (uint64_t n = 1; n < numNodes; ++n)
+      newIndex[n] += newIndex[n - 1];
+    uint64_t newDeltaEdges = numNodes ? newIndex[numNodes - 1] : 0;
+
+    EdgeDst newDst;
+    EdgeData newData;
+    allocate(newDst, newDeltaEdges);
+    allocate(newData, newDeltaEdges);
+    galois::do_all(
+        galois::iterate(UINT64_C(0), numNodes),
+        [&](uint64_t n) {
+          uint64_t pos = n == 0 ? 0 : newIndex[n - 1];
+          mergeUpdates<false>(n, &batch[0] + updateIndex[n],
+                              &batch[0] + updateIndex[n + 1],
+                              [&](GraphNode dst, const edge_value_type& data) {
+                                newDst[pos] = dst;
+                                newData.set(pos, data);
+                                ++pos;
+                              });
+        },
+        galois::steal(), galois::no_stats(),
+        galois::loopname("DYNAMIC_GRAPH_FILL_DELTA"));
+
+    swap(deltaIndex, newIndex);
+    swap(deltaDst, newDst);
+    swap(deltaData, newData);
+    numDeltaEdges = newDeltaEdges;
+    numRemoved += tombstones.reduce();
+
+    timer.stop();
+
+    if (numDeltaEdges + numRemoved > compactThreshold * numBaseEdges)
+      compact();
+  }
+
+  /**
+   * Merges the delta into the base and drops tombstoned edges. Buffered
+   * updates are not applied; call commit for that.
+   */
+  void compact() {
+    galois::StatTimer timer("TIMER_GRAPH_COMPACT");
+    timer.start();
+
+    EdgeIndData newIndex;
+    allocate(newIndex, numNodes);
+    galois::do_all(galois::iterate(UINT64_C(0), numNodes),
+                   [&](uint64_t n) {
+                     uint64_t count = deltaEnd(n) - deltaBegin(n);
+                     for (uint64_t b = baseBegin(n), be = baseEnd(n); b != be;
+                          ++b)
+                       count += !removed[b];
+                     newIndex[n] = count;
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("DYNAMIC_GRAPH_COUNT_BASE"));
+
+    for (uint64_t n = 1; n < numNodes; ++n)
+      newIndex[n] += newIndex[n - 1];
+    uint64_t newBaseEdges = numNodes ? newIndex[numNodes - 1] : 0;
+
+    EdgeDst newDst;
+    EdgeData newData;
+    EdgeFlags newRemoved;
+    allocate(newDst, newBaseEdges);
+    allocate(newData, newBaseEdges);
+    allocate(newRemoved, newBaseEdges);
+    galois::do_all(
+        galois::iterate(UINT64_C(0), numNodes),
+        [&](uint64_t n) {
+          uint64_t pos = n == 0 ? 0 : newIndex[n - 1];
+          uint64_t b = baseBegin(n), be = baseEnd(n);
+          uint64_t d = deltaBegin(n), de = deltaEnd(n);
+          // base and delta are sorted by destination and share none
+          while (b != be || d != de) {
+            if (b != be && removed[b]) {
+              ++b;
+            } else if (d == de || (b != be && baseDst[b] < deltaDst[d])) {
+              newDst[pos] = baseDst[b];
+              newData.set(pos, baseData[b]);
+              newRemoved[pos++] = 0;
+              ++b;
+            } else {
+              newDst[pos] = deltaDst[d];
+              newData.set(pos, deltaData[d]);
+              newRemoved[pos++] = 0;
+              ++d;
+            }
+          }
+        },
+        galois::steal(), galois::no_stats(),
+        galois::loopname("DYNAMIC_GRAPH_MERGE"));
+
+    swap(baseIndex, newIndex);
+    swap(baseDst, newDst);
+    swap(baseData, newData);
+    swap(removed, newRemoved);
+    numBaseEdges = newBaseEdges;
+    numRemoved   = 0;
+    resetDelta();
+
+    timer.stop();
+  }
+
+  void allocateFrom(FileGraph& graph) {
+    allocateFrom(graph.size(), graph.sizeEdges());
+  }
+
+  void allocateFrom(uint32_t nNodes, uint64_t nEdges) {
+    numNodes      = nNodes;
+    numBaseEdges  = nEdges;
+    numRemoved    = 0;
+    numDeltaEdges = 0;
+    allocate(nodeData, numNodes);
+    allocate(baseIndex, numNodes);
+    allocate(baseDst, numBaseEdges);
+    allocate(baseData, numBaseEdges);
+    allocate(removed, numBaseEdges);
+    allocate(deltaIndex, numNodes);
+  }
+
+  void constructNodes() {
+    galois::do_all(galois::iterate(UINT64_C(0), numNodes),
+                   [&](uint64_t n) {
+                     nodeData.constructAt(n);
+                     deltaIndex[n] = 0;
+                   },
+                   galois::no_stats(), galois::loopname("CONSTRUCT_NODES"));
+  }
+
+  /**
+   * Sets base edge e. Edges of a node must be constructed in increasing
+   * order of destination.
+   */
+  void constructEdge(uint64_t e, uint32_t dst,
+                     const edge_value_type& val = edge_value_type()) {
+    baseData.set(e, val);
+    baseDst[e]  = dst;
+    removed[e]  = 0;
+  }
+
+  void fixEndEdge(uint32_t n, uint64_t e) { baseIndex[n] = e; }
+
+  void constructFrom(FileGraph& graph, unsigned tid, unsigned total) {
+    auto r = graph
+                 .divideByNode(NodeData::size_of::value +
+                                   2 * EdgeIndData::size_of::value,
+                               EdgeDst::size_of::value +
+                                   EdgeData::size_of::value +
+                                   EdgeFlags::size_of::value,
+                               tid, total)
+                 .first;
+
+    this->setLocalRange(*r.first, *r.second);
+
+    for (FileGraph::iterator ii = r.first, ei = r.second; ii != ei; ++ii) {
+      nodeData.constructAt(*ii);
+      baseIndex[*ii]  = *graph.edge_end(*ii);
+      deltaIndex[*ii] = 0;
+
+      for (FileGraph::edge_iterator nn = graph.edge_begin(*ii),
+                                    en = graph.edge_end(*ii);
+           nn != en; ++nn) {
+        constructEdgeValue(graph, nn);
+        baseDst[*nn] = graph.getEdgeDst(nn);
+        removed[*nn] = 0;
+      }
+
+      // Bound the sort by the file graph: baseBegin(*ii) reads the end of
+      // the previous node, which may belong to another thread
+      typedef EdgeSortValue<GraphNode, EdgeTy> EdgeSortVal;
+      std::sort(edge_sort_iterator(*graph.edge_begin(*ii), &baseDst, &baseData),
+                edge_sort_iterator(*graph.edge_end(*ii), &baseDst, &baseData),
+                [](const EdgeSortVal& e1, const EdgeSortVal& e2) {
+                  return e1.dst < e2.dst;
+                });
+    }
+  }
+};
+
+} // namespace graphs
+} // namespace galois
+
+#endif
@@ -248,6 +248,45 @@ public:
     return N->getData();
   }
 
+  /**
+   * Status-returning variant of the acquire done by getData: returns false
+   * instead of signalling a conflict (see galois::runtime::tryAcquire).
+   */
+  template <bool _A1 = HasNoLockable, bool _A2 = HasOutOfLineLockable>
+  bool tryAcquireNode(GraphNode N, MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<!_A1 && !_A2>::type* = 0) {
+    return galois::runtime::tryAcquire(N, mflag);
+  }
+
+  template <bool _A1 = HasOutOfLineLockable, bool _A2 = HasNoLockable>
+  bool tryAcquireNode(GraphNode N, MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<_A1 && !_A2>::type* = 0) {
+    return this->outOfLineTryAcquire(getId(N), mflag);
+  }
+
+  template <bool _A1 = HasOutOfLineLockable, bool _A2 = HasNoLockable>
+  bool tryAcquireNode(GraphNode, MethodFlag = MethodFlag::WRITE,
+                      typename std::enable_if<_A2>::type* = 0) {
+    return true;
+  }
+
+  /**
+   * Status-returning variant of the acquire done by edge_begin: acquires N
+   * and its out-neighbors, stopping at the first conflict.
+   */
+  bool tryAcquireNeighborhood(GraphNode N,
+                              MethodFlag mflag = MethodFlag::WRITE) {
+    if (!tryAcquireNode(N, mflag))
+      return false;
+    if (galois::runtime::shouldLock(mflag)) {
+      for (edge_iterator ii = N->edgeBegin(), ee = N->edgeEnd(); ii != ee; ++ii) {
+        if (!tryAcquireNode(getDst(ii), mflag))
+          return false;
+      }
+    }
+    return true;
+  }
+
   edge_data_reference
   getEdgeData(edge_iterator ni,
               MethodFlag mflag = MethodFlag::UNPROTECTED) const {
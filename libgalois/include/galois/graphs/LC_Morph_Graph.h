@@ -335,6 +335,47 @@ public:
     return N->getData();
   }
 
+  /**
+   * Status-returning variant of the acquire done by getData: returns false
+   * instead of signalling a conflict (see galois::runtime::tryAcquire).
+   */
+  template <bool _A1 = HasNoLockable, bool _A2 = HasOutOfLineLockable>
+  bool tryAcquireNode(const GraphNode& N,
+                      MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<!_A1 && !_A2>::type* = 0) {
+    return galois::runtime::tryAcquire(N, mflag);
+  }
+
+  template <bool _A1 = HasOutOfLineLockable, bool _A2 = HasNoLockable>
+  bool tryAcquireNode(const GraphNode& N,
+                      MethodFlag mflag = MethodFlag::WRITE,
+                      typename std::enable_if<_A1 && !_A2>::type* = 0) {
+    return this->outOfLineTryAcquire(getId(N), mflag);
+  }
+
+  template <bool _A1 = HasOutOfLineLockable, bool _A2 = HasNoLockable>
+  bool tryAcquireNode(const GraphNode&, MethodFlag = MethodFlag::WRITE,
+                      typename std::enable_if<_A2>::type* = 0) {
+    return true;
+  }
+
+  /**
+   * Status-returning variant of the acquire done by edge_begin: acquires N
+   * and its out-neighbors, stopping at the first conflict.
+   */
+  bool tryAcquireNeighborhood(const GraphNode& N,
+                              MethodFlag mflag = MethodFlag::WRITE) {
+    if (!tryAcquireNode(N, mflag))
+      return false;
+    if (galois::runtime::shouldLock(mflag)) {
+      for (edge_iterator ii = N->edgeBegin, ee = N->edgeEnd; ii != ee; ++ii) {
+        if (!tryAcquireNode(ii->dst, mflag))
+          return false;
+      }
+    }
+    return true;
+  }
+
   /**
    * Get edge data of an edge given an iterator to the edge.
    */
@@ -495,6 +495,17 @@ private:///////////////////////////////////////////////////////////////////////
     template <bool _A1 = HasNoLockable>
     void acquire(MethodFlag mflag, typename std::enable_if<_A1>::type* = 0) {}
 
+    template <bool _A1 = HasNoLockable>
+    bool tryAcquire(MethodFlag mflag,
+                    typename std::enable_if<!_A1>::type* = 0) {
+      return galois::runtime::tryAcquire(this, mflag);
+    }
+
+    template <bool _A1 = HasNoLockable>
+    bool tryAcquire(MethodFlag mflag, typename std::enable_if<_A1>::type* = 0) {
+      return true;
+    }
+
   public:
     template <typename... Args>
     gNode(Args&&... args)
@@ -750,6 +761,36 @@ public://///////////////////////////////////////////////////////////////////////
     return n->getData();
   }
 
+  /**
+   * Status-returning variant of the acquire done by getData: returns false
+   * instead of signalling a conflict (see galois::runtime::tryAcquire).
+   */
+  bool tryAcquireNode(const GraphNode& n,
+                      galois::MethodFlag mflag = MethodFlag::WRITE) {
+    assert(n);
+    return n->tryAcquire(mflag);
+  }
+
+  /**
+   * Status-returning variant of the acquire done by edge_begin: acquires n
+   * and its active out-neighbors, stopping at the first conflict.
+   */
+  bool tryAcquireNeighborhood(const GraphNode& n,
+                              galois::MethodFlag mflag = MethodFlag::WRITE) {
+    assert(n);
+    if (!n->tryAcquire(mflag))
+      return false;
+    if (galois::runtime::shouldLock(mflag)) {
+      for (typename gNode::iterator ii = n->begin(), ee = n->end(); ii != ee;
+           ++ii) {
+        if (ii->first()->active && !ii->isInEdge() &&
+            !ii->first()->tryAcquire(mflag))
+          return false;
+      }
+    }
+    return true;
+  }
+
   //! Checks if a node is in the graph
   //! @returns true if a node has is in the graph
   bool containsNode(const GraphNode& n,
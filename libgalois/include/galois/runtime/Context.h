@@ -112,9 +112,12 @@ class SimpleRuntimeContext : public LockManagerBase {
   //! The locks we hold
   Lockable* locks;
   bool customAcquire;
+  //! Set when a status-returning acquire failed in this iteration
+  bool conflicted;
 
 protected:
   friend void doAcquire(Lockable*, galois::MethodFlag);
+  friend bool doTryAcquire(Lockable*, galois::MethodFlag);
 
   static SimpleRuntimeContext* getOwner(Lockable* lockable) {
     LockManagerBase* owner = LockManagerBase::getOwner(lockable);
@@ -129,14 +132,21 @@ protected:
     locks          = lockable;
   }
 
+  using LockManagerBase::tryAcquire;
+
   void acquire(Lockable* lockable, galois::MethodFlag m);
+  bool tryAcquire(Lockable* lockable, galois::MethodFlag m);
   void release(Lockable* lockable);
 
 public:
-  SimpleRuntimeContext(bool child = false) : locks(0), customAcquire(child) {}
+  SimpleRuntimeContext(bool child = false)
+      : locks(0), customAcquire(child), conflicted(false) {}
   virtual ~SimpleRuntimeContext() {}
 
-  void startIteration() { assert(!locks); }
+  void startIteration() { assert(!locks && !conflicted); }
+
+  //! True if a status-returning acquire failed since the iteration started
+  bool isConflicted() const { return conflicted; }
 
   unsigned cancelIteration();
   unsigned commitIteration();
@@ -188,6 +198,33 @@ inline void acquire(Lockable* lockable, galois::MethodFlag m) {
     doAcquire(lockable, m);
 }
 
+//! Locking function that reports a conflict instead of signalling it.
+inline bool doTryAcquire(Lockable* lockable, galois::MethodFlag m) {
+  SimpleRuntimeContext* ctx = getThreadContext();
+  return !ctx || ctx->tryAcquire(lockable, m);
+}
+
+/**
+ * Status-returning variant of acquire. On a conflict it neither throws nor
+ * jumps: it marks the iteration as conflicted and returns false. The
+ * operator must then return without further side effects, and the executor
+ * aborts and retries the iteration once it returns (early-exit protocol):
+ *
+ * @code
+ * if (!galois::runtime::tryAcquire(&lockable, galois::MethodFlag::WRITE))
+ *   return;
+ * @endcode
+ *
+ * acquire() and the graph accessors built on it (getData, edge_begin) still
+ * signal conflicts by throwing or jumping: their callers cannot see a failed
+ * acquire and would go on to use data they do not own. Operators opt in by
+ * acquiring through tryAcquire, as delaunayrefinement, preflowpush,
+ * independentset and boruvka-merge do.
+ */
+inline bool tryAcquire(Lockable* lockable, galois::MethodFlag m) {
+  return !shouldLock(m) || doTryAcquire(lockable, m);
+}
+
 struct AlwaysLockObj {
   void operator()(Lockable* lockable) const {
     doAcquire(lockable, galois::MethodFlag::WRITE);
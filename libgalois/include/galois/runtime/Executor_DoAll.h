@@ -26,6 +26,7 @@
 #include "galois/runtime/Executor_OnEach.h"
 #include "galois/runtime/OperatorReferenceTypes.h"
 #include "galois/runtime/Statistics.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/substrate/Barrier.h"
 #include "galois/substrate/PerThreadStorage.h"
 #include "galois/substrate/Termination.h"
@@ -33,6 +34,8 @@
 #include "galois/substrate/PaddedLock.h"
 #include "galois/substrate/CompilerSpecific.h"
 
+#include <chrono>
+
 namespace galois {
 namespace runtime {
 
@@ -51,6 +54,10 @@ class DoAllStealingExec {
   constexpr static const bool MORE_STATS =
       NEED_STATS && exists_by_supertype<more_stats_tag, ArgsTuple>::value;
   constexpr static const bool USE_TERM = false;
+  constexpr static const bool ADAPTIVE =
+      exists_by_supertype<adaptive_chunk_size_tag, ArgsTuple>::value;
+
+  typedef std::chrono::steady_clock clockTy;
 
   struct ThreadContext {
 
@@ -62,18 +69,32 @@ class DoAllStealingExec {
     Diff_ty m_size;
     size_t num_iter;
 
+    // Adaptive chunking; see adaptive_chunk_size
+    double nsPerIter;     // running estimate of iteration cost; 0 if unknown
+    Diff_ty stealLimit;   // bound on chunk size, lowered while being stolen from
+    unsigned timesStolen; // incremented by thieves under work_mutex
+    unsigned seenStolen;
+
     // Stats
+    size_t num_chunks;
+    size_t chunk_sum;
+    Diff_ty chunk_min;
+    Diff_ty chunk_max;
 
     ThreadContext()
         : work_mutex(),
           id(substrate::getThreadPool()
                  .getMaxThreads()), // TODO: fix this initialization problem,
                                     // see initThread
-          shared_beg(), shared_end(), m_size(0), num_iter(0) {}
+          shared_beg(), shared_end(), m_size(0), num_iter(0), nsPerIter(0),
+          stealLimit(chunk_size_tag::MAX), timesStolen(0), seenStolen(0),
+          num_chunks(0), chunk_sum(0), chunk_min(0), chunk_max(0) {}
 
     ThreadContext(unsigned id, Iter beg, Iter end)
         : work_mutex(), id(id), shared_beg(beg), shared_end(end),
-          m_size(std::distance(beg, end)), num_iter(0) {}
+          m_size(std::distance(beg, end)), num_iter(0), nsPerIter(0),
+          stealLimit(chunk_size_tag::MAX), timesStolen(0), seenStolen(0),
+          num_chunks(0), chunk_sum(0), chunk_min(0), chunk_max(0) {}
 
     bool doWork(F func, const unsigned chunk_size) {
       Iter beg(shared_beg);
@@ -96,6 +117,42 @@ class DoAllStealingExec {
       return didwork;
     }
 
+    bool doWorkAdaptive(F func, const adaptive_chunk_size& policy) {
+      Iter beg(shared_beg);
+      Iter end(shared_end);
+
+      bool didwork = false;
+
+      while (getWorkAdaptive(beg, end, policy)) {
+
+        didwork = true;
+
+        Diff_ty n  = 0;
+        auto start = clockTy::now();
+        for (; beg != end; ++beg, ++n) {
+          func(*beg);
+        }
+        double ns = std::chrono::duration<double, std::nano>(clockTy::now() -
+                                                             start)
+                        .count();
+
+        // smooth the estimate; loops with heavy-tailed iteration costs
+        // would otherwise swing between the bounds
+        double sample = ns / n;
+        nsPerIter = nsPerIter > 0 ? 0.75 * nsPerIter + 0.25 * sample : sample;
+
+        if (NEED_STATS) {
+          num_iter += n;
+          chunk_min = num_chunks ? std::min(chunk_min, n) : n;
+          chunk_max = std::max(chunk_max, n);
+          chunk_sum += n;
+          ++num_chunks;
+        }
+      }
+
+      return didwork;
+    }
+
     bool hasWorkWeak() const { return (m_size > 0); }
 
     bool hasWork() const {
@@ -115,33 +172,83 @@ class DoAllStealingExec {
     }
 
   private:
-    bool getWork(Iter& priv_beg, Iter& priv_end, const unsigned chunk_size) {
-      bool succ = false;
+    //! takes up to chunk_size iterations; work_mutex must be held
+    Diff_ty grabLocked(Iter& priv_beg, Iter& priv_end,
+                       const Diff_ty chunk_size) {
+      Diff_ty grabbed = 0;
+
+      if (hasWorkWeak()) {
+        Iter nbeg = shared_beg;
+        if (m_size <= chunk_size) {
+          nbeg    = shared_end;
+          grabbed = m_size;
+          m_size  = 0;
+
+        } else {
+          std::advance(nbeg, chunk_size);
+          grabbed = chunk_size;
+          m_size -= chunk_size;
+          assert(m_size > 0);
+        }
+
+        priv_beg   = shared_beg;
+        priv_end   = nbeg;
+        shared_beg = nbeg;
+      }
 
+      return grabbed;
+    }
+
+    bool getWork(Iter& priv_beg, Iter& priv_end, const unsigned chunk_size) {
       work_mutex.lock();
-      {
-        if (hasWorkWeak()) {
-          succ = true;
+      Diff_ty grabbed = grabLocked(priv_beg, priv_end, chunk_size);
+      work_mutex.unlock();
 
-          Iter nbeg = shared_beg;
-          if (m_size <= chunk_size) {
-            nbeg   = shared_end;
-            m_size = 0;
+      if (grabbed) {
+        timeline::record(timeline::Event::ChunkGrab, grabbed);
+      }
 
-          } else {
-            std::advance(nbeg, chunk_size);
-            m_size -= chunk_size;
-            assert(m_size > 0);
-          }
+      return grabbed > 0;
+    }
 
-          priv_beg   = shared_beg;
-          priv_end   = nbeg;
-          shared_beg = nbeg;
-        }
+    //! chunk size for the next grab; work_mutex must be held
+    Diff_ty adaptiveChunkSize(const adaptive_chunk_size& policy) {
+      if (timesStolen != seenStolen) {
+        // others ran out of work: hand out smaller pieces
+        seenStolen = timesStolen;
+        stealLimit = std::max(Diff_ty(policy.minSize), stealLimit / 2);
+      } else if (stealLimit < Diff_ty(policy.maxSize)) {
+        stealLimit = std::min(Diff_ty(policy.maxSize),
+                              stealLimit + stealLimit / 4 + 1);
+      }
+
+      // the first chunk measures the iteration cost
+      Diff_ty size = policy.minSize;
+      if (nsPerIter > 0) {
+        size = Diff_ty(policy.targetNs / nsPerIter);
+      }
+      size = std::min(size, stealLimit);
+      // guided: leave at least half of the local range for thieves
+      size = std::min(size, (m_size + 1) / 2);
+
+      return std::min(std::max(size, Diff_ty(policy.minSize)),
+                      Diff_ty(policy.maxSize));
+    }
+
+    bool getWorkAdaptive(Iter& priv_beg, Iter& priv_end,
+                         const adaptive_chunk_size& policy) {
+      work_mutex.lock();
+      Diff_ty grabbed = 0;
+      if (hasWorkWeak()) {
+        grabbed = grabLocked(priv_beg, priv_end, adaptiveChunkSize(policy));
       }
       work_mutex.unlock();
 
-      return succ;
+      if (grabbed) {
+        timeline::record(timeline::Event::ChunkGrab, grabbed);
+      }
+
+      return grabbed > 0;
     }
 
     void steal_from_end_impl(Iter& steal_beg, Iter& steal_end, const Diff_ty sz,
@@ -191,6 +298,8 @@ class DoAllStealingExec {
             steal_size = m_size;
           }
 
+          ++timesStolen;
+
           if (m_size <= steal_size) {
             steal_beg = shared_beg;
             steal_end = shared_end;
@@ -251,6 +360,7 @@ private:
       assert(std::distance(steal_beg, steal_end) == steal_size);
 
       poor.assignWork(steal_beg, steal_end, steal_size);
+      timeline::record(timeline::Event::Steal, rich.id);
     }
 
     return succ;
@@ -422,7 +532,9 @@ private:
   R range;
   F func;
   const char* loopname;
+  uint32_t timelineName;
   Diff_ty chunk_size;
+  adaptive_chunk_size policy;
   substrate::PerThreadStorage<ThreadContext> workers;
 
   substrate::TerminationDetection& term;
@@ -434,11 +546,23 @@ private:
   PerThreadTimer<MORE_STATS> stealTime;
   PerThreadTimer<MORE_STATS> termTime;
 
+  static adaptive_chunk_size getPolicy(const ArgsTuple& argsTuple,
+                                       std::true_type) {
+    return get_by_supertype<adaptive_chunk_size_tag>(argsTuple);
+  }
+
+  static adaptive_chunk_size getPolicy(const ArgsTuple&, std::false_type) {
+    return adaptive_chunk_size();
+  }
+
 public:
   DoAllStealingExec(const R& _range, F _func, const ArgsTuple& argsTuple)
       : range(_range), func(_func),
         loopname(galois::internal::getLoopName(argsTuple)),
+        timelineName(timeline::name(loopname)),
         chunk_size(get_by_supertype<chunk_size_tag>(argsTuple).value),
+        policy(getPolicy(argsTuple,
+                         std::integral_constant<bool, ADAPTIVE>())),
         term(substrate::getSystemTermination(activeThreads)),
         totalTime(loopname, "Total"), initTime(loopname, "Init"),
         execTime(loopname, "Execute"), stealTime(loopname, "Steal"),
@@ -478,6 +602,7 @@ public:
   void operator()(void) {
 
     ThreadContext& ctx = *workers.getLocal();
+    timeline::LoopSpan span(timelineName);
     totalTime.start();
 
     while (true) {
@@ -485,7 +610,8 @@ public:
 
       execTime.start();
 
-      if (ctx.doWork(func, chunk_size)) {
+      if (ADAPTIVE ? ctx.doWorkAdaptive(func, policy)
+                   : ctx.doWork(func, chunk_size)) {
         workHappened = true;
       }
 
@@ -525,6 +651,18 @@ public:
     if (NEED_STATS) {
       galois::runtime::reportStat_Tsum(loopname, "Iterations", ctx.num_iter);
     }
+
+    if (NEED_STATS && ADAPTIVE) {
+      galois::runtime::reportStat_Tsum(loopname, "Chunks", ctx.num_chunks);
+      if (ctx.num_chunks) {
+        galois::runtime::reportStat_Tmin(loopname, "MinChunkSize",
+                                         ctx.chunk_min);
+        galois::runtime::reportStat_Tmax(loopname, "MaxChunkSize",
+                                         ctx.chunk_max);
+        galois::runtime::reportStat_Tavg(loopname, "AvgChunkSize",
+                                         ctx.chunk_sum / ctx.num_chunks);
+      }
+    }
   }
 };
 
@@ -540,7 +678,8 @@ struct ChooseDoAllImpl {
 
     substrate::getThreadPool().run(activeThreads,
                                    [&exec](void) { exec.initThread(); },
-                                   std::ref(barrier), std::ref(exec));
+                                   timeline::TimedBarrier(barrier),
+                                   std::ref(exec));
   }
 };
 
@@ -550,6 +689,9 @@ struct ChooseDoAllImpl<false> {
   template <typename R, typename F, typename ArgsT>
   static void call(const R& range, F func, const ArgsT& argsTuple) {
 
+    const uint32_t timelineName =
+        timeline::name(galois::internal::getLoopName(argsTuple));
+
     runtime::on_each_gen(
         [&](const unsigned tid, const unsigned numT) {
           static constexpr bool NEED_STATS =
@@ -563,6 +705,7 @@ struct ChooseDoAllImpl<false> {
           PerThreadTimer<MORE_STATS> initTime(loopname, "Init");
           PerThreadTimer<MORE_STATS> execTime(loopname, "Work");
 
+          timeline::LoopSpan span(timelineName);
           totalTime.start();
           initTime.start();
 
@@ -615,7 +758,9 @@ void do_all_gen(const R& range, F&& func, const ArgsTuple& argsTuple) {
 
   timer.start();
 
-  constexpr bool STEAL = exists_by_supertype<steal_tag, ArgsT>::value;
+  constexpr bool STEAL =
+      exists_by_supertype<steal_tag, ArgsT>::value ||
+      exists_by_supertype<adaptive_chunk_size_tag, ArgsT>::value;
 
   OperatorReferenceType<decltype(std::forward<F>(func))> func_ref = func;
   internal::ChooseDoAllImpl<STEAL>::call(range, func_ref, argsT);
@@ -33,13 +33,17 @@
 #include "galois/runtime/LoopStatistics.h"
 #include "galois/runtime/OperatorReferenceTypes.h"
 #include "galois/runtime/Statistics.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/substrate/Termination.h"
 #include "galois/substrate/ThreadPool.h"
 #include "galois/runtime/UserContextAccess.h"
+#include "galois/substrate/EnvCheck.h"
 #include "galois/worklists/Chunk.h"
 #include "galois/worklists/Simple.h"
+#include "galois/worklists/WorkListHelpers.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -48,6 +52,171 @@ namespace galois {
 //! Internal Galois functionality - Use at your own risk.
 namespace runtime {
 
+/**
+ * Feedback controller for speculative loops.
+ *
+ * Every thread counts its commits and aborts and publishes them in windows
+ * of WINDOW attempts. After each round of work, thread 0 computes the commit
+ * ratio over the windows published since its last look and reacts:
+ *
+ * - below LOW_RATIO, it halves the number of threads allowed to run
+ *   speculatively and aborted iterations are retried by the thread that
+ *   aborted them instead of being passed on to other threads;
+ * - above HIGH_RATIO, it lets one more thread run.
+ *
+ * Throttled threads hand their private work to the threads still running,
+ * back off, and keep the loop alive until they are let back in. Thread 0
+ * never stops, and whenever it runs out of work it releases every thread, so
+ * throttling never strands work.
+ *
+ * Handing work over needs a release() on the worklist (see
+ * worklists::HasRelease). The chunked worklists built on ChunkMaster, the
+ * work-stealing worklists, OrderedByIntegerMetric without a barrier,
+ * LocalQueue with such a global queue and the locked FIFO, LIFO and
+ * OrderedList have one. With any other worklist threads are never
+ * throttled and only local retries are used.
+ *
+ * Setting GALOIS_ADAPTIVE_ABORTS=0 disables throttling and local retries.
+ */
+class ConflictManager {
+  static constexpr unsigned WINDOW     = 256;
+  static constexpr unsigned LOW_RATIO  = 500; // per mille
+  static constexpr unsigned HIGH_RATIO = 900; // per mille
+
+  struct Counts {
+    unsigned commits = 0;
+    unsigned aborts  = 0;
+  };
+
+  substrate::PerThreadStorage<Counts> counts;
+  std::atomic<uint64_t> commits;
+  std::atomic<uint64_t> aborts;
+  std::atomic<unsigned> limit;
+  std::atomic<bool> local;
+  unsigned maxThreads;
+  bool adaptive;
+  bool throttle;
+
+  // Only touched by thread 0
+  uint64_t seenCommits = 0;
+  uint64_t seenAborts  = 0;
+  unsigned minLimit;
+  unsigned minRatio    = 1000;
+  size_t windows       = 0;
+  size_t throttles     = 0;
+  size_t localWindows  = 0;
+
+  static bool enabledByEnv() {
+    static const bool enabled = [] {
+      int val = 1;
+      substrate::EnvCheck("GALOIS_ADAPTIVE_ABORTS", val);
+      return val != 0;
+    }();
+    return enabled;
+  }
+
+  void publish(Counts& c) {
+    if (c.commits + c.aborts < WINDOW)
+      return;
+    commits.fetch_add(c.commits, std::memory_order_relaxed);
+    aborts.fetch_add(c.aborts, std::memory_order_relaxed);
+    c.commits = c.aborts = 0;
+  }
+
+  void setLimit(unsigned l) {
+    limit.store(l, std::memory_order_relaxed);
+    minLimit = std::min(minLimit, l);
+    timeline::record(timeline::Event::SpeculativeThreads, l);
+  }
+
+public:
+  /**
+   * @param numThreads threads running the loop
+   * @param canThrottle true if throttled threads can hand their private
+   * work to other threads
+   */
+  ConflictManager(unsigned numThreads, bool canThrottle)
+      : commits(0), aborts(0), limit(numThreads), local(false),
+        maxThreads(numThreads), adaptive(enabledByEnv()),
+        throttle(canThrottle), minLimit(numThreads) {}
+
+  void commit() {
+    Counts& c = *counts.getLocal();
+    ++c.commits;
+    publish(c);
+  }
+
+  void abort() {
+    Counts& c = *counts.getLocal();
+    ++c.aborts;
+    publish(c);
+  }
+
+  //! True if thread tid may run speculative iterations now
+  bool mayRun(unsigned tid) const {
+    return tid < limit.load(std::memory_order_relaxed);
+  }
+
+  //! Number of threads allowed to run speculative iterations, at least one
+  unsigned running() const { return limit.load(std::memory_order_relaxed); }
+
+  //! True if aborted iterations should be retried by the aborting thread
+  bool localRetries() const { return local.load(std::memory_order_relaxed); }
+
+  /**
+   * Adjusts the throttle. Called by thread 0 after each round of work.
+   *
+   * @param idle true if thread 0 found no work in its last round
+   */
+  void update(bool idle) {
+    if (!adaptive)
+      return;
+    if (idle) {
+      if (limit.load(std::memory_order_relaxed) != maxThreads)
+        setLimit(maxThreads);
+      return;
+    }
+
+    uint64_t c  = commits.load(std::memory_order_relaxed);
+    uint64_t a  = aborts.load(std::memory_order_relaxed);
+    uint64_t dc = c - seenCommits;
+    uint64_t da = a - seenAborts;
+    if (dc + da < WINDOW)
+      return;
+    seenCommits = c;
+    seenAborts  = a;
+
+    unsigned ratio = dc * 1000 / (dc + da);
+    minRatio       = std::min(minRatio, ratio);
+    ++windows;
+    timeline::record(timeline::Event::CommitRatio, ratio);
+
+    unsigned cur = limit.load(std::memory_order_relaxed);
+    if (ratio < LOW_RATIO) {
+      if (throttle && cur > 1) {
+        setLimit(std::max(1U, cur / 2));
+        ++throttles;
+      }
+      local.store(true, std::memory_order_relaxed);
+      ++localWindows;
+    } else {
+      local.store(false, std::memory_order_relaxed);
+      if (ratio > HIGH_RATIO && cur < maxThreads)
+        setLimit(cur + 1);
+    }
+  }
+
+  void reportStats(const char* loopname) {
+    if (!adaptive)
+      return;
+    reportStat_Single(loopname, "CommitRatioWindows", windows);
+    reportStat_Single(loopname, "MinCommitRatio", minRatio);
+    reportStat_Single(loopname, "Throttles", throttles);
+    reportStat_Single(loopname, "MinSpeculativeThreads", minLimit);
+    reportStat_Single(loopname, "LocalRetryWindows", localWindows);
+  }
+};
+
 template <typename value_type>
 class AbortHandler {
   struct Item {
@@ -133,14 +302,27 @@ public:
     queues.getLocal()->push(item);
   }
 
-  void push(const Item& item) {
+  void push(const Item& item, bool local = false) {
     Item newitem = {item.val, item.retries + 1};
-    if (useBasicPolicy)
+    if (local)
+      eagerPolicy(newitem);
+    else if (useBasicPolicy)
       basicPolicy(newitem);
     else
       doublePolicy(newitem);
   }
 
+  //! Moves the retries queued on the calling thread to thread tid
+  void handOff(unsigned tid) {
+    AbortedList* src = queues.getLocal();
+    AbortedList* dst = queues.getRemote(tid);
+    if (src == dst)
+      return;
+    galois::optional<Item> p;
+    while ((p = src->pop()))
+      dst->push(*p);
+  }
+
   AbortedList* getQueue() { return queues.getLocal(); }
 };
 
@@ -164,6 +346,9 @@ public:
 protected:
   typedef typename WorkListTy::value_type value_type;
 
+  //! Most pauses a throttled thread spins for between checks
+  static constexpr unsigned MAX_BACKOFF = 1024;
+
   struct ThreadLocalBasics {
 
     UserContextAccess<value_type> facing;
@@ -186,12 +371,14 @@ protected:
   // members to give higher likelihood of reclaiming PerThreadStorage
 
   AbortHandler<value_type> aborted;
+  ConflictManager conflicts;
   substrate::TerminationDetection& term;
   substrate::Barrier& barrier;
 
   WorkListTy wl;
   FunctionTy origFunction;
   const char* loopname;
+  uint32_t timelineName;
   bool broke;
 
   PerThreadTimer<MORE_STATS> initTime;
@@ -211,8 +398,10 @@ protected:
     }
     if (needsPia)
       tld.facing.resetAlloc();
-    if (needsAborts)
+    if (needsAborts) {
       tld.ctx.commitIteration();
+      conflicts.commit();
+    }
     //++tld.stat_commits;
   }
 
@@ -222,7 +411,8 @@ protected:
     assert(needsAborts);
     tld.ctx.cancelIteration();
     tld.inc_conflicts();
-    aborted.push(item);
+    conflicts.abort();
+    pushAborted(item);
     // clear push buffer
     if (needsPush)
       tld.facing.resetPushBuffer();
@@ -231,13 +421,24 @@ protected:
       tld.facing.resetAlloc();
   }
 
-  inline void doProcess(value_type& val, ThreadLocalData& tld) {
+  void pushAborted(const value_type& val) { aborted.push(val); }
+
+  template <typename Item>
+  void pushAborted(const Item& item) {
+    aborted.push(item, conflicts.localRetries());
+  }
+
+  //! @returns false if the operator returned early after a failed tryAcquire
+  inline bool doProcess(value_type& val, ThreadLocalData& tld) {
     if (needsAborts)
       tld.ctx.startIteration();
 
     tld.inc_iterations();
     tld.function(val, tld.facing.data());
+    if (needsAborts && tld.ctx.isConflicted())
+      return false;
     commitIteration(tld);
+    return true;
   }
 
   bool runQueueSimple(ThreadLocalData& tld) {
@@ -258,7 +459,8 @@ protected:
     if (setjmp(execFrame) == 0) {
       while ((!limit || num < limit) && (p = lwl.pop())) {
         ++num;
-        doProcess(aborted.value(*p), tld);
+        if (!doProcess(aborted.value(*p), tld))
+          abortIteration(*p, tld);
       }
     } else {
       clearConflictLock();
@@ -268,7 +470,8 @@ protected:
     try {
       while ((!limit || num < limit) && (p = lwl.pop())) {
         ++num;
-        doProcess(aborted.value(*p), tld);
+        if (!doProcess(aborted.value(*p), tld))
+          abortIteration(*p, tld);
       }
     } catch (ConflictFlag const& flag) {
       clearConflictLock();
@@ -297,13 +500,30 @@ protected:
     return wl.empty();
   }
 
+  void releaseLocal(WorkListTy&, ...) {}
+
+  template <typename WL>
+  auto releaseLocal(WL& wl, int) -> decltype(wl.release(), void()) {
+    wl.release();
+  }
+
+  void reportChunkStats(WorkListTy&, ...) {}
+
+  template <typename WL>
+  auto reportChunkStats(WL& wl, int)
+      -> decltype(wl.reportChunkStats(loopname), void()) {
+    wl.reportChunkStats(loopname);
+  }
+
   template <bool couldAbort, bool isLeader>
   void go() {
 
+    timeline::LoopSpan span(timelineName);
     execTime.start();
 
     // Thread-local data goes on the local stack to be NUMA friendly
     ThreadLocalData tld(origFunction, loopname);
+    const unsigned tid = substrate::ThreadPool::getTID();
     if (needsBreak)
       tld.facing.setBreakFlag(&broke);
     if (couldAbort)
@@ -312,12 +532,24 @@ protected:
       tld.facing.setFastPushBack(std::bind(&ForEachExecutor::fastPushBack, this,
                                            std::placeholders::_1));
 
+    unsigned backoff = 1;
     while (true) {
       do {
         bool didWork = false;
 
         // Run some iterations
-        if (couldAbort || needsBreak) {
+        if (couldAbort && !conflicts.mayRun(tid)) {
+          // Throttled: hand private work to a running thread, back off and
+          // keep the loop alive until thread 0 lets us back in
+          releaseLocal(wl, 0);
+          aborted.handOff(tid % conflicts.running());
+          for (unsigned i = 0; i < backoff; ++i)
+            substrate::asmPause();
+          if (backoff < MAX_BACKOFF)
+            backoff *= 2;
+          didWork = true;
+        } else if (couldAbort || needsBreak) {
+          backoff             = 1;
           constexpr int __NUM = (needsBreak || isLeader) ? 64 : 0;
           bool b              = runQueue<__NUM>(tld, wl);
           didWork             = b || didWork;
@@ -325,6 +557,8 @@ protected:
           if (couldAbort) {
             b       = handleAborts(tld);
             didWork = b || didWork;
+            if (tid == 0)
+              conflicts.update(!didWork);
           }
         } else { // No try/catch
           bool b  = runQueueSimple(tld);
@@ -347,7 +581,13 @@ protected:
       }
 
       term.initializeThread();
-      barrier.wait();
+      timeline::TimedBarrier(barrier).wait();
+    }
+
+    if (needStats) {
+      reportChunkStats(wl, 0);
+      if (couldAbort && tid == 0)
+        conflicts.reportStats(loopname);
     }
 
     if (couldAbort)
@@ -359,10 +599,11 @@ protected:
 
   template <typename... WArgsTy>
   ForEachExecutor(T2, FunctionTy f, const ArgsTy& args, WArgsTy... wargs)
-      : term(substrate::getSystemTermination(activeThreads)),
+      : conflicts(activeThreads, worklists::HasRelease<WorkListTy>::value),
+        term(substrate::getSystemTermination(activeThreads)),
         barrier(getBarrier(activeThreads)), wl(std::forward<WArgsTy>(wargs)...),
         origFunction(f), loopname(galois::internal::getLoopName(args)),
-        broke(false), initTime(loopname, "Init"),
+        timelineName(timeline::name(loopname)), broke(false), initTime(loopname, "Init"),
         execTime(loopname, "Execute") {}
 
   template <typename WArgsTy, int... Is>
@@ -521,7 +762,8 @@ void for_each_impl(const RangeTy& range, FunctionTy&& fn,
   W.init(range);
   substrate::getThreadPool().run(activeThreads,
                                  [&W, &range]() { W.initThread(range); },
-                                 std::ref(barrier), std::ref(W));
+                                 timeline::TimedBarrier(barrier),
+                                 std::ref(W));
   //  for_each_impl_<WorkListTy, value_type>(range, fn, args);
 }
 
@@ -25,6 +25,7 @@
 #include "galois/Timer.h"
 #include "galois/runtime/OperatorReferenceTypes.h"
 #include "galois/runtime/Statistics.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/Threads.h"
 #include "galois/gIO.h"
 #include "galois/substrate/ThreadPool.h"
@@ -58,12 +59,22 @@ inline void on_each_impl(FunctionTy&& fn, const ArgsTy& argsTuple) {
 
   OperatorReferenceType<decltype(std::forward<FunctionTy>(fn))> fn_ref = fn;
 
+  // do_all without stealing runs on top of an anonymous on_each and records
+  // its own loop name, so only named on_each loops are recorded
+  const uint32_t timelineName = NEEDS_STATS ? timeline::name(loopname) : 0;
+
   auto runFun = [&] {
+    if (NEEDS_STATS) {
+      timeline::record(timeline::Event::LoopBegin, timelineName);
+    }
     execTime.start();
 
     fn_ref(substrate::ThreadPool::getTID(), numT);
 
     execTime.stop();
+    if (NEEDS_STATS) {
+      timeline::record(timeline::Event::LoopEnd, timelineName);
+    }
   };
 
   timer.start();
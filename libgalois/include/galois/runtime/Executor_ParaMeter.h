@@ -321,11 +321,13 @@ private:
         int flag = 0;
         if ((flag = setjmp(execFrame)) == 0) {
           m_func(it->item, it->facing.data());
+          it->doabort = it->ctx.isConflicted();
 
         } else {
 #else
         try {
           m_func(it->item, it->facing.data());
+          it->doabort = it->ctx.isConflicted();
 
         } catch (const ConflictFlag& flag) {
 #endif
@@ -22,6 +22,7 @@
 
 #include "galois/runtime/Statistics.h"
 #include "galois/runtime/PagePool.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/substrate/Init.h"
 
 #include <string>
@@ -41,10 +42,12 @@ public:
   explicit SharedMemRuntime(void) : Base(), m_pa(), m_sm() {
     internal::setPagePoolState(&m_pa);
     internal::setSysStatManager(&m_sm);
+    timeline::start();
   }
 
   ~SharedMemRuntime(void) {
     m_sm.print();
+    timeline::finish();
     internal::setSysStatManager(nullptr);
     internal::setPagePoolState(nullptr);
   }
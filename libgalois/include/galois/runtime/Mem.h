@@ -36,6 +36,8 @@
 #include <list>
 #include <cstddef>
 #include <cstdio>
+#include <atomic>
+#include <vector>
 
 namespace galois {
 namespace runtime {
@@ -518,6 +520,197 @@ public:
   inline void deallocate(void* ptr) { pagePoolFree(ptr); }
 };
 
+//! Allocation counters of a SlabHeap, summed over threads
+struct SlabStats {
+  size_t slabBytes;   //!< bytes of slabs carved from pages
+  size_t liveBytes;   //!< bytes of objects allocated and not yet freed
+  size_t localFrees;  //!< objects freed by the thread that allocated them
+  size_t remoteFrees; //!< objects freed by another thread
+
+  SlabStats() : slabBytes(0), liveBytes(0), localFrees(0), remoteFrees(0) {}
+
+  SlabStats& operator+=(const SlabStats& o) {
+    slabBytes += o.slabBytes;
+    liveBytes += o.liveBytes;
+    localFrees += o.localFrees;
+    remoteFrees += o.remoteFrees;
+    return *this;
+  }
+};
+
+/**
+ * Fixed-size heap of per-thread slabs that returns objects to the thread
+ * that allocated them.
+ *
+ * Each thread carves slabs from pages of SourceHeap, i.e., pages of its own
+ * PagePool that it faulted in, so they are local to its NUMA node. Slabs are
+ * aligned to their size and start with a pointer to the owning thread's
+ * state. An object freed by its owner goes on the owner's free list; an
+ * object freed by another thread is pushed on a lock-free queue of the
+ * owner, which the owner takes over whole when its free list runs dry.
+ * Objects thus never migrate between threads and a long run of a morph
+ * algorithm keeps its nodes on the node of the thread that made them.
+ *
+ * Objects too large for a slab (more than half a page) come from per-thread
+ * free lists over bump-allocated pages instead, as all fixed-size objects
+ * did before slabs; they are not counted in the slab statistics.
+ */
+template <class SourceHeap>
+class SlabHeap : private boost::noncopyable {
+  struct FreeNode {
+    FreeNode* next;
+  };
+
+  struct Local;
+
+  struct SlabHeader {
+    union {
+      Local* owner;
+      double dummy; // for alignment
+    };
+  };
+
+  struct Local {
+    FreeNode* freeList;                // owner only
+    std::atomic<FreeNode*> remoteFree; // pushed by other threads
+    char* bump;                        // next object in current slab
+    char* slabEnd;                     // end of current slab
+    char* pageCur;                     // next slab in current page
+    char* pageEnd;                     // end of current page
+    std::vector<void*> pages;          // pages taken from SourceHeap
+    size_t slabs, allocs, frees, remoteFreesSent;
+
+    Local()
+        : freeList(0), remoteFree(0), bump(0), slabEnd(0), pageCur(0),
+          pageEnd(0), slabs(0), allocs(0), frees(0), remoteFreesSent(0) {}
+  };
+
+  //! Slabs are powers of two of at least MIN_SLAB_SIZE bytes that hold at
+  //! least MIN_OBJECTS_PER_SLAB objects unless that exceeds half a page
+  enum { MIN_SLAB_SIZE = 64 * 1024, MIN_OBJECTS_PER_SLAB = 8 };
+
+  typedef ThreadPrivateHeap<FreeListHeap<BumpHeap<SourceHeap>>> LargeHeap;
+
+  SourceHeap source;
+  substrate::PerThreadStorage<Local> locals;
+  const size_t objSize;
+  //! 0 if objects do not fit in a slab
+  const size_t slabSize;
+  std::unique_ptr<LargeHeap> large;
+
+  static size_t roundSize(size_t size) {
+    size = std::max(size, sizeof(FreeNode));
+    return (size + sizeof(double) - 1) & ~(sizeof(double) - 1);
+  }
+
+  static size_t computeSlabSize(size_t size) {
+    size_t s = MIN_SLAB_SIZE;
+    while (s < sizeof(SlabHeader) + MIN_OBJECTS_PER_SLAB * size)
+      s *= 2;
+    // Pages need not be aligned to slabs, so only half of a page is sure
+    // to hold an aligned slab
+    if (s > SourceHeap::AllocSize / 2)
+      s = SourceHeap::AllocSize / 2;
+    if (s < sizeof(SlabHeader) + size)
+      return 0;
+    return s;
+  }
+
+  static SlabHeader* slabOf(void* ptr, size_t slabSize) {
+    return reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(ptr) &
+                                         ~(uintptr_t)(slabSize - 1));
+  }
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  void refill(Local& l) {
+    if (l.pageCur + slabSize > l.pageEnd) {
+      char* page = (char*)source.allocate(SourceHeap::AllocSize);
+      l.pages.push_back(page);
+      l.pageCur = (char*)slabOf(page + slabSize - 1, slabSize);
+      l.pageEnd = page + SourceHeap::AllocSize;
+      assert(l.pageCur + slabSize <= l.pageEnd);
+    }
+    SlabHeader* slab = reinterpret_cast<SlabHeader*>(l.pageCur);
+    slab->owner      = &l;
+    l.bump           = l.pageCur + sizeof(SlabHeader);
+    l.slabEnd        = l.pageCur + slabSize;
+    l.pageCur += slabSize;
+    ++l.slabs;
+  }
+
+public:
+  enum { AllocSize = 0 };
+
+  explicit SlabHeap(size_t size)
+      : objSize(roundSize(size)), slabSize(computeSlabSize(objSize)) {
+    if (!slabSize)
+      large.reset(new LargeHeap());
+  }
+
+  ~SlabHeap() {
+    for (unsigned i = 0; i < locals.size(); ++i)
+      for (void* page : locals.getRemote(i)->pages)
+        source.deallocate(page);
+  }
+
+  inline void* allocate(size_t size) {
+    assert(roundSize(size) <= objSize);
+    if (large)
+      return large->allocate(objSize);
+    Local& l = *locals.getLocal();
+    ++l.allocs;
+    if (!l.freeList && l.remoteFree.load(std::memory_order_relaxed))
+      l.freeList = l.remoteFree.exchange(0, std::memory_order_acquire);
+    if (l.freeList) {
+      FreeNode* n = l.freeList;
+      l.freeList  = n->next;
+      return n;
+    }
+    if (l.bump + objSize > l.slabEnd)
+      refill(l);
+    void* ptr = l.bump;
+    l.bump += objSize;
+    return ptr;
+  }
+
+  inline void deallocate(void* ptr) {
+    if (!ptr)
+      return;
+    if (large) {
+      large->deallocate(ptr);
+      return;
+    }
+    Local& me    = *locals.getLocal();
+    Local* owner = slabOf(ptr, slabSize)->owner;
+    FreeNode* n  = reinterpret_cast<FreeNode*>(ptr);
+    if (owner == &me) {
+      ++me.frees;
+      n->next     = me.freeList;
+      me.freeList = n;
+      return;
+    }
+    ++me.remoteFreesSent;
+    FreeNode* h = owner->remoteFree.load(std::memory_order_relaxed);
+    do {
+      n->next = h;
+    } while (!owner->remoteFree.compare_exchange_weak(
+        h, n, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  //! Counters of thread tid; racy while other threads use the heap
+  SlabStats stats(unsigned tid) {
+    Local& l = *locals.getRemote(tid);
+    SlabStats s;
+    s.slabBytes   = l.slabs * slabSize;
+    s.localFrees  = l.frees;
+    s.remoteFrees = l.remoteFreesSent;
+    // Objects allocated by one thread may be freed by another, so only the
+    // sum over all threads is meaningful
+    s.liveBytes = (l.allocs - l.frees - l.remoteFreesSent) * objSize;
+    return s;
+  }
+};
+
 template <typename Derived>
 class StaticSingleInstance : private boost::noncopyable {
 
@@ -594,6 +787,8 @@ public:
 
   static SizedHeap* getHeapForSize(const size_t) { return &alloc; }
 
+  static SlabStats getSlabStats() { return SlabStats(); }
+
 private:
   static SizedHeap alloc;
 };
@@ -604,11 +799,14 @@ class SizedHeapFactory : public StaticSingleInstance<SizedHeapFactory> {
 
 public:
   //! [FixedSizeAllocator example]
-  typedef ThreadPrivateHeap<FreeListHeap<BumpHeap<SystemHeap>>> SizedHeap;
+  typedef SlabHeap<SystemHeap> SizedHeap;
   //! [FixedSizeAllocator example]
 
   static SizedHeap* getHeapForSize(const size_t);
 
+  //! Sums the counters of all heaps
+  static SlabStats getSlabStats();
+
 private:
   typedef std::map<size_t, SizedHeap*> HeapMap;
   static thread_local HeapMap* localHeaps;
@@ -27,13 +27,17 @@
 #include "galois/substrate/PageAlloc.h"
 #include "galois/substrate/ThreadPool.h"
 
-#include <unordered_map>
+#include <atomic>
 #include <vector>
 #include <mutex>
+#include <memory>
 #include <numeric>
 #include <deque>
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
 
 namespace galois {
 namespace runtime {
@@ -44,6 +48,15 @@ void* pagePoolAlloc();
 void pagePoolFree(void*);
 void pagePoolPreAlloc(unsigned);
 
+/**
+ * Returns batches of pages that are entirely free back to the OS. Must not
+ * run concurrently with pagePoolAlloc or pagePoolFree, e.g., call it between
+ * parallel loops.
+ *
+ * @returns number of pages released
+ */
+size_t pagePoolRelease();
+
 // Size of returned pages
 size_t pagePoolSize();
 
@@ -62,29 +75,160 @@ struct FreeNode {
 typedef galois::substrate::PtrLock<FreeNode> HeadPtr;
 typedef galois::substrate::CacheLineStorage<HeadPtr> HeadPtrStorage;
 
-// Tracks pages allocated
+/**
+ * Tracks pages allocated.
+ *
+ * Free pages are kept on one stack per socket. An empty stack is refilled
+ * with a batch of pages mapped and faulted in by the requesting thread, so
+ * the batch lands on that thread's NUMA node. The owning batch of a page is
+ * found from its address through a two-level radix table, which is written
+ * only when batches are mapped or released and read without locks.
+ */
 template <typename _UNUSED = void>
 class PageAllocState {
+  //! Pages obtained from the OS with a single mapping
+  struct Batch {
+    char* base;
+    unsigned pages;
+    unsigned socket;
+    unsigned tid;       // thread whose page count includes the batch
+    unsigned freePages; // scratch space for release()
+  };
+
+  struct Socket {
+    HeadPtr head;
+    //! Serializes refills so that threads of a socket map one batch at a time
+    galois::substrate::SimpleLock lock;
+    std::vector<Batch*> batches;
+  };
+
+  typedef galois::substrate::CacheLineStorage<Socket> SocketStorage;
+
+  //! Destroys and frees the socket array, whose storage is cache line
+  //! aligned, which plain operator new[] does not honor before C++17
+  struct SocketsDeleter {
+    unsigned num;
+    void operator()(SocketStorage* p) const {
+      for (unsigned i = 0; i < num; ++i)
+        p[i].~SocketStorage();
+      free(p);
+    }
+  };
+
+  typedef std::atomic<Batch*> Slot;
+
+  static const unsigned PAGE_BITS = 21;
+  static const unsigned LEAF_BITS = 13;
+  static const unsigned ROOT_BITS = 48 - PAGE_BITS - LEAF_BITS;
+  static const unsigned BATCH_PAGES = 8;
+
   std::deque<std::atomic<int>> counts;
-  std::vector<HeadPtrStorage> pool;
-  std::unordered_map<void*, int> ownerMap;
-  galois::substrate::SimpleLock mapLock;
+  std::unique_ptr<SocketStorage[], SocketsDeleter> sockets;
+  unsigned numSockets;
+  std::unique_ptr<std::atomic<Slot*>[]> root;
 
-  void* allocFromOS() {
-    void* ptr = galois::substrate::allocPages(1, true);
-    assert(ptr);
+  Slot& slot(void* ptr) {
+    uintptr_t key = reinterpret_cast<uintptr_t>(ptr) >> PAGE_BITS;
+    assert(key < (uintptr_t(1) << (ROOT_BITS + LEAF_BITS)));
+    std::atomic<Slot*>& r = root[key >> LEAF_BITS];
+    Slot* leaf            = r.load(std::memory_order_acquire);
+    if (!leaf) {
+      Slot* fresh = new Slot[1 << LEAF_BITS]();
+      if (r.compare_exchange_strong(leaf, fresh, std::memory_order_acq_rel))
+        leaf = fresh;
+      else
+        delete[] fresh;
+    }
+    return leaf[key & ((1 << LEAF_BITS) - 1)];
+  }
+
+  // A batch need not be aligned to pagePoolSize(), but the start of each of
+  // its pages falls in a distinct aligned page-sized window, so the window
+  // identifies the batch.
+  Batch* owner(void* ptr) {
+    Batch* b = slot(ptr).load(std::memory_order_acquire);
+    assert(b && "pagePoolFree of a page not from the page pool");
+    return b;
+  }
+
+  char* page(Batch* b, unsigned i) {
+    return b->base + (size_t(i) << PAGE_BITS);
+  }
+
+  //! Maps a batch; called with the socket lock held
+  Batch* allocFromOS(Socket& s, unsigned socket, unsigned num) {
     auto tid = galois::substrate::ThreadPool::getTID();
-    counts[tid] += 1;
-    std::lock_guard<galois::substrate::SimpleLock> lg(mapLock);
-    ownerMap[ptr] = tid;
-    return ptr;
+    Batch* b = new Batch{
+        static_cast<char*>(galois::substrate::allocPages(num, true)), num,
+        socket, tid, 0};
+    assert(b->base);
+    for (unsigned i = 0; i < num; ++i)
+      slot(page(b, i)).store(b, std::memory_order_release);
+    s.batches.push_back(b);
+    counts[tid] += num;
+    return b;
+  }
+
+  //! Pushes pages [first, b->pages) of a batch with a single lock acquire
+  void pushBatch(Socket& s, Batch* b, unsigned first) {
+    if (first == b->pages)
+      return;
+    FreeNode* h = reinterpret_cast<FreeNode*>(page(b, first));
+    FreeNode* t = h;
+    for (unsigned i = first + 1; i < b->pages; ++i) {
+      t->next = reinterpret_cast<FreeNode*>(page(b, i));
+      t       = t->next;
+    }
+    s.head.lock();
+    t->next = s.head.getValue();
+    s.head.unlock_and_set(h);
+  }
+
+  static void* pop(HeadPtr& hp) {
+    if (!hp.getValue())
+      return nullptr;
+    hp.lock();
+    FreeNode* h = hp.getValue();
+    if (h) {
+      hp.unlock_and_set(h->next);
+      return h;
+    }
+    hp.unlock();
+    return nullptr;
+  }
+
+  Socket& mySocket(unsigned& socket) {
+    socket = galois::substrate::ThreadPool::getSocket();
+    assert(socket < numSockets);
+    return sockets[socket].data;
   }
 
 public:
-  PageAllocState() {
+  PageAllocState()
+      : numSockets(galois::substrate::getThreadPool().getMaxSockets()),
+        root(new std::atomic<Slot*>[1 << ROOT_BITS]()) {
+    GALOIS_ASSERT(galois::substrate::allocSize() == (size_t(1) << PAGE_BITS));
     auto num = galois::substrate::getThreadPool().getMaxThreads();
     counts.resize(num);
-    pool.resize(num);
+    void* mem = nullptr;
+    if (posix_memalign(&mem, alignof(SocketStorage),
+                       numSockets * sizeof(SocketStorage)))
+      throw std::bad_alloc();
+    SocketStorage* p = static_cast<SocketStorage*>(mem);
+    for (unsigned i = 0; i < numSockets; ++i)
+      new (p + i) SocketStorage();
+    sockets = std::unique_ptr<SocketStorage[], SocketsDeleter>(
+        p, SocketsDeleter{numSockets});
+  }
+
+  // Pages still handed out may be referenced by objects that outlive the
+  // runtime, so mappings are left for the OS to reclaim at exit.
+  ~PageAllocState() {
+    for (unsigned i = 0; i < numSockets; ++i)
+      for (Batch* b : sockets[i].data.batches)
+        delete b;
+    for (unsigned i = 0; i < (1u << ROOT_BITS); ++i)
+      delete[] root[i].load(std::memory_order_relaxed);
   }
 
   int count(int tid) const { return counts[tid]; }
@@ -94,34 +238,78 @@ public:
   }
 
   void* pageAlloc() {
-    auto tid    = galois::substrate::ThreadPool::getTID();
-    HeadPtr& hp = pool[tid].data;
-    if (hp.getValue()) {
-      hp.lock();
-      FreeNode* h = hp.getValue();
-      if (h) {
-        hp.unlock_and_set(h->next);
-        return h;
-      }
-      hp.unlock();
-    }
-    return allocFromOS();
+    unsigned socket;
+    Socket& s = mySocket(socket);
+    if (void* ptr = pop(s.head))
+      return ptr;
+    std::lock_guard<galois::substrate::SimpleLock> lg(s.lock);
+    // another thread of this socket may have refilled the stack meanwhile
+    if (void* ptr = pop(s.head))
+      return ptr;
+    Batch* b = allocFromOS(s, socket, BATCH_PAGES);
+    pushBatch(s, b, 1);
+    return b->base;
   }
 
   void pageFree(void* ptr) {
     assert(ptr);
-    mapLock.lock();
-    assert(ownerMap.count(ptr));
-    int i = ownerMap[ptr];
-    mapLock.unlock();
-    HeadPtr& hp = pool[i].data;
+    HeadPtr& hp = sockets[owner(ptr)->socket].data.head;
     hp.lock();
     FreeNode* nh = reinterpret_cast<FreeNode*>(ptr);
     nh->next     = hp.getValue();
     hp.unlock_and_set(nh);
   }
 
-  void pagePreAlloc() { pageFree(allocFromOS()); }
+  void pagePreAlloc(unsigned num) {
+    if (!num)
+      return;
+    unsigned socket;
+    Socket& s = mySocket(socket);
+    std::lock_guard<galois::substrate::SimpleLock> lg(s.lock);
+    pushBatch(s, allocFromOS(s, socket, num), 0);
+  }
+
+  size_t release() {
+    size_t released = 0;
+    for (unsigned i = 0; i < numSockets; ++i) {
+      Socket& s = sockets[i].data;
+      std::lock_guard<galois::substrate::SimpleLock> lg(s.lock);
+      s.head.lock();
+      FreeNode* h = s.head.getValue();
+
+      for (FreeNode* n = h; n; n = n->next)
+        owner(n)->freePages += 1;
+
+      FreeNode* keep = nullptr;
+      for (FreeNode* n = h; n;) {
+        FreeNode* next = n->next;
+        Batch* b       = owner(n);
+        if (b->freePages != b->pages) {
+          n->next = keep;
+          keep    = n;
+        }
+        n = next;
+      }
+      s.head.unlock_and_set(keep);
+
+      auto live = s.batches.begin();
+      for (Batch* b : s.batches) {
+        if (b->freePages == b->pages) {
+          for (unsigned p = 0; p < b->pages; ++p)
+            slot(page(b, p)).store(nullptr, std::memory_order_relaxed);
+          galois::substrate::freePages(b->base, b->pages);
+          counts[b->tid] -= b->pages;
+          released += b->pages;
+          delete b;
+        } else {
+          b->freePages = 0;
+          *live++      = b;
+        }
+      }
+      s.batches.erase(live, s.batches.end());
+    }
+    return released;
+  }
 };
 
 //! Initialize PagePool, used by runtime::init();
@@ -0,0 +1,274 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef _GALOIS_RUNTIME_SEGMENTEDEXECUTOR_H_
+#define _GALOIS_RUNTIME_SEGMENTEDEXECUTOR_H_
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/gstl.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+namespace galois {
+namespace runtime {
+
+/**
+ * Cache-blocked ("segmented CSR") execution of dense pull loops.
+ *
+ * A pull loop reduces, for every node, some value over its neighbors. When
+ * the neighbor values do not fit in cache, nearly every edge misses. This
+ * executor splits the edges by neighbor id into segments of segmentSize
+ * nodes, so that the values read while processing one segment stay in cache.
+ * The segments are processed one after the other, each by all threads, and
+ * produce partial results for the nodes with edges into them. The partials
+ * are then merged block by block of nodes, which keeps the merge in cache as
+ * well.
+ *
+ * The edge structure is copied from graph.edges(n) at construction; for a
+ * pull algorithm pass the transposed graph, as the pull apps do. Rebuild the
+ * executor if the edges change.
+ */
+template <typename Graph>
+class SegmentedPullExecutor {
+  using GNode = typename Graph::GraphNode;
+
+  //! Nodes per block of the merge
+  constexpr static const size_t MERGE_BLOCK = 1024;
+
+  size_t numNodes;
+  size_t segmentSize;
+  //! segment s owns the partial results [segmentBegin[s], segmentBegin[s+1])
+  std::vector<size_t> segmentBegin;
+  //! node of each partial result, increasing within a segment
+  LargeArray<uint32_t> nodes;
+  //! start of the neighbors of each partial result; one more entry
+  LargeArray<uint64_t> offsets;
+  //! neighbors, ordered by segment
+  LargeArray<uint32_t> srcs;
+  //! merge block b reduces the runs [blockRuns[b], blockRuns[b+1])
+  std::vector<uint64_t> blockRuns;
+  //! partial results [runBegin[r], runEnd[r]) of one segment for the nodes
+  //! of one merge block
+  LargeArray<uint64_t> runBegin;
+  LargeArray<uint64_t> runEnd;
+  //! partial results of run, kept across calls
+  LargeArray<char> scratch;
+
+  template <typename Fn>
+  void forEachEdgeSegment(Graph& graph, size_t n, const Fn& fn) {
+    for (auto e : graph.edges(n, galois::MethodFlag::UNPROTECTED)) {
+      uint32_t src = graph.getEdgeDst(e);
+      fn(src, src / segmentSize);
+    }
+  }
+
+  //! Calls fn(begin, end) for the partial results of each segment with nodes
+  //! in merge block b
+  template <typename Fn>
+  void forEachMergeRun(size_t b, const Fn& fn) {
+    size_t lo = b * MERGE_BLOCK;
+    size_t hi = std::min(lo + MERGE_BLOCK, numNodes);
+    const uint32_t* base = nodes.data();
+    for (size_t s = 0; s + 1 < segmentBegin.size(); ++s) {
+      const uint32_t* last  = base + segmentBegin[s + 1];
+      const uint32_t* first = std::lower_bound(base + segmentBegin[s], last, lo);
+      const uint32_t* end   = std::lower_bound(first, last, hi);
+      if (first != end)
+        fn(first - base, end - base);
+    }
+  }
+
+public:
+  /**
+   * @param segmentSize nodes per segment; choose it so that the values read
+   * for that many nodes fit in the targeted cache level
+   */
+  SegmentedPullExecutor(Graph& graph, size_t _segmentSize)
+      : numNodes(graph.size()),
+        segmentSize(std::max<size_t>(_segmentSize, 1)) {
+    size_t numSegments  = (numNodes + segmentSize - 1) / segmentSize;
+    unsigned threads    = galois::getActiveThreads();
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    // Thread tid handles the tid-th block of nodes in both passes, so each
+    // segment lists its nodes in increasing order. The counts per thread and
+    // segment become the thread's write positions in between.
+    std::vector<std::vector<uint64_t>> nodeCount(
+        threads, std::vector<uint64_t>(numSegments));
+    std::vector<std::vector<uint64_t>> edgeCount(
+        threads, std::vector<uint64_t>(numSegments));
+
+    galois::on_each([&](unsigned tid, unsigned total) {
+      auto range = galois::block_range(size_t{0}, numNodes, tid, total);
+      std::vector<uint32_t> last(numSegments, none);
+      for (size_t n = range.first; n < range.second; ++n) {
+        forEachEdgeSegment(graph, n, [&](uint32_t, size_t s) {
+          if (last[s] != n) {
+            last[s] = n;
+            ++nodeCount[tid][s];
+          }
+          ++edgeCount[tid][s];
+        });
+      }
+    });
+
+    uint64_t numPartials = 0;
+    uint64_t numEdges    = 0;
+    segmentBegin.resize(numSegments + 1);
+    for (size_t s = 0; s < numSegments; ++s) {
+      segmentBegin[s] = numPartials;
+      for (unsigned tid = 0; tid < threads; ++tid) {
+        std::swap(numPartials, nodeCount[tid][s]);
+        numPartials += nodeCount[tid][s];
+        std::swap(numEdges, edgeCount[tid][s]);
+        numEdges += edgeCount[tid][s];
+      }
+    }
+    segmentBegin[numSegments] = numPartials;
+
+    nodes.allocateInterleaved(numPartials);
+    offsets.allocateInterleaved(numPartials + 1);
+    srcs.allocateInterleaved(numEdges);
+    offsets[numPartials] = numEdges;
+
+    galois::on_each([&](unsigned tid, unsigned total) {
+      auto range = galois::block_range(size_t{0}, numNodes, tid, total);
+      std::vector<uint32_t> last(numSegments, none);
+      std::vector<uint64_t> pos(numSegments);
+      std::vector<size_t> touched;
+      for (size_t n = range.first; n < range.second; ++n) {
+        touched.clear();
+        forEachEdgeSegment(graph, n, [&](uint32_t, size_t s) {
+          if (last[s] != n) {
+            last[s] = n;
+            pos[s]  = 0;
+            touched.push_back(s);
+          }
+          ++pos[s];
+        });
+        for (size_t s : touched) {
+          uint64_t i      = nodeCount[tid][s]++;
+          uint64_t degree = pos[s];
+          nodes[i]        = n;
+          offsets[i]      = edgeCount[tid][s];
+          pos[s]          = edgeCount[tid][s];
+          edgeCount[tid][s] += degree;
+        }
+        forEachEdgeSegment(graph, n, [&](uint32_t src, size_t s) {
+          srcs[pos[s]++] = src;
+        });
+      }
+    });
+
+    // Find where each segment enters every merge block once, rather than
+    // searching the segments in every call to run
+    size_t numBlocks = (numNodes + MERGE_BLOCK - 1) / MERGE_BLOCK;
+    blockRuns.assign(numBlocks + 1, 0);
+    galois::do_all(
+        galois::iterate(size_t{0}, numBlocks),
+        [&](size_t b) {
+          forEachMergeRun(b, [&](uint64_t, uint64_t) { ++blockRuns[b + 1]; });
+        },
+        galois::steal(), galois::no_stats());
+    std::partial_sum(blockRuns.begin(), blockRuns.end(), blockRuns.begin());
+
+    runBegin.allocateInterleaved(blockRuns[numBlocks]);
+    runEnd.allocateInterleaved(blockRuns[numBlocks]);
+    galois::do_all(
+        galois::iterate(size_t{0}, numBlocks),
+        [&](size_t b) {
+          uint64_t r = blockRuns[b];
+          forEachMergeRun(b, [&](uint64_t begin, uint64_t end) {
+            runBegin[r] = begin;
+            runEnd[r]   = end;
+            ++r;
+          });
+        },
+        galois::steal(), galois::no_stats());
+  }
+
+  //! @returns number of segments
+  size_t size() const { return segmentBegin.size() - 1; }
+
+  //! @returns number of partial results per run, i.e., the sum over the
+  //! segments of the nodes with neighbors in them
+  size_t sizePartials() const { return nodes.size(); }
+
+  /**
+   * For every node n, calls apply(n, r) where r is the reduction with
+   * reduce, starting from identity, of read(m) over the neighbors m of n.
+   *
+   * reduce must be associative and commutative. All calls to read happen
+   * before the first call to apply, so apply may update what read reads.
+   * T is kept in raw scratch memory and must be trivially copyable.
+   */
+  template <typename T, typename ReadFn, typename ReduceFn, typename ApplyFn>
+  void run(const T& identity, const ReadFn& read, const ReduceFn& reduce,
+           const ApplyFn& apply) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "partial results must be trivially copyable");
+    if (scratch.size() < nodes.size() * sizeof(T)) {
+      scratch.deallocate();
+      scratch.allocateInterleaved(nodes.size() * sizeof(T));
+    }
+    T* partials = reinterpret_cast<T*>(scratch.data());
+
+    for (size_t s = 0; s + 1 < segmentBegin.size(); ++s) {
+      galois::do_all(
+          galois::iterate(segmentBegin[s], segmentBegin[s + 1]),
+          [&](size_t i) {
+            T acc = identity;
+            for (uint64_t e = offsets[i], ee = offsets[i + 1]; e < ee; ++e)
+              acc = reduce(acc, read(GNode(srcs[e])));
+            partials[i] = acc;
+          },
+          galois::steal(), galois::chunk_size<64>(), galois::no_stats());
+    }
+
+    galois::substrate::PerThreadStorage<std::vector<T>> blocks;
+    galois::do_all(
+        galois::iterate(size_t{0}, blockRuns.size() - 1),
+        [&](size_t b) {
+          size_t lo           = b * MERGE_BLOCK;
+          size_t hi           = std::min(lo + MERGE_BLOCK, numNodes);
+          std::vector<T>& acc = *blocks.getLocal();
+          acc.assign(hi - lo, identity);
+          for (uint64_t r = blockRuns[b]; r < blockRuns[b + 1]; ++r) {
+            for (uint64_t i = runBegin[r], ie = runEnd[r]; i < ie; ++i) {
+              size_t n = nodes[i] - lo;
+              acc[n]   = reduce(acc[n], partials[i]);
+            }
+          }
+          for (size_t n = lo; n < hi; ++n)
+            apply(GNode(n), acc[n - lo]);
+        },
+        galois::steal(), galois::no_stats());
+  }
+};
+
+} // namespace runtime
+} // namespace galois
+
+#endif
@@ -749,6 +749,8 @@ void reportRUsage(const std::string& id);
 void reportPageAlloc(const char* category);
 //! Reports NUMA memory stats for all NUMA nodes
 void reportNumaAlloc(const char* category);
+//! Reports fragmentation and locality of the fixed-size allocators
+void reportSlabAlloc(const char* category);
 
 } // end namespace runtime
 namespace _flexograph_profile {
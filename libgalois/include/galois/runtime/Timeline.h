@@ -0,0 +1,167 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file Timeline.h
+ *
+ * Per-thread event timeline of parallel loops.
+ *
+ * When the environment variable GALOIS_TIMELINE names an output file, every
+ * thread records loop begin/end, chunk grabs, steals, worklist pushes and
+ * pops, barrier waits and communication phases into its own ring buffer of
+ * GALOIS_TIMELINE_EVENTS entries (default 65536; the oldest events are
+ * overwritten). The buffers are written out when the runtime shuts down:
+ * files ending in ".json" are in Chrome trace format, which chrome://tracing
+ * and Perfetto open directly; any other name gets a compact binary file that
+ * timeline-to-json converts offline. In distributed runs host h > 0 writes
+ * to the given name with ".h" inserted before the extension.
+ *
+ * With the variable unset each event costs one predictable branch.
+ */
+#ifndef GALOIS_RUNTIME_TIMELINE_H
+#define GALOIS_RUNTIME_TIMELINE_H
+
+#include "galois/substrate/Barrier.h"
+
+#include <cstdint>
+#include <string>
+
+namespace galois {
+namespace runtime {
+namespace timeline {
+
+//! Kinds of recorded events
+enum class Event : uint8_t {
+  LoopBegin,          //!< thread starts executing a loop; arg is the loop name
+  LoopEnd,            //!< thread leaves a loop; arg is the loop name
+  BarrierBegin,       //!< thread enters a barrier
+  BarrierEnd,         //!< thread leaves a barrier
+  SyncBegin,          //!< communication phase starts; arg is the phase name
+  SyncEnd,            //!< communication phase ends; arg is the phase name
+  ChunkGrab,          //!< thread takes a chunk of a local range; arg is its size
+  Steal,              //!< thread takes work owned by another thread or socket;
+                      //!< arg is the victim
+  Push,               //!< chunk pushed to a worklist; arg is its size
+  Pop,                //!< chunk popped from a worklist; arg is its size
+  CommitRatio,        //!< commit ratio of a speculative loop; arg is in per mille
+  SpeculativeThreads  //!< threads allowed to run speculatively; arg is the count
+};
+
+//! One recorded event
+struct Record {
+  uint64_t time; //!< nanoseconds since the timeline was started
+  uint32_t arg;
+  Event event;
+};
+
+namespace internal {
+extern bool enabled;
+void record(Event event, uint32_t arg);
+uint32_t intern(const char* name);
+} // namespace internal
+
+//! True if events are being recorded
+inline bool isEnabled() { return internal::enabled; }
+
+//! Records an event on the calling thread if the timeline is enabled
+inline void record(Event event, uint32_t arg = 0) {
+  if (__builtin_expect(internal::enabled, false)) {
+    internal::record(event, arg);
+  }
+}
+
+/**
+ * Returns the id of a span name, e.g., a loop name, for LoopBegin/LoopEnd
+ * and SyncBegin/SyncEnd events. Interning takes a lock, so loops call it
+ * once per invocation from the master thread and hand the id to workers.
+ */
+inline uint32_t name(const char* name) {
+  return internal::enabled ? internal::intern(name) : 0;
+}
+
+inline uint32_t name(const std::string& str) { return name(str.c_str()); }
+
+/**
+ * Records matching begin and end events around a scope.
+ */
+class Span {
+  Event endEvent;
+  uint32_t arg;
+
+public:
+  Span(Event begin, Event end, uint32_t arg) : endEvent(end), arg(arg) {
+    record(begin, arg);
+  }
+  ~Span() { record(endEvent, arg); }
+};
+
+//! Loop executed by the calling thread
+struct LoopSpan : public Span {
+  explicit LoopSpan(uint32_t loop)
+      : Span(Event::LoopBegin, Event::LoopEnd, loop) {}
+};
+
+//! Communication phase executed by the calling thread
+struct SyncSpan : public Span {
+  explicit SyncSpan(uint32_t phase)
+      : Span(Event::SyncBegin, Event::SyncEnd, phase) {}
+};
+
+/**
+ * Waits at a barrier and records the wait. Usable wherever the thread pool
+ * expects a std::ref to a barrier.
+ */
+class TimedBarrier {
+  substrate::Barrier& barrier;
+
+public:
+  explicit TimedBarrier(substrate::Barrier& b) : barrier(b) {}
+
+  void operator()(void) { wait(); }
+
+  void wait() {
+    Span s(Event::BarrierBegin, Event::BarrierEnd, 0);
+    barrier.wait();
+  }
+};
+
+/**
+ * Reads GALOIS_TIMELINE and starts recording if it is set. Called by the
+ * runtime on startup.
+ */
+void start();
+
+/**
+ * Writes the recorded events to the file named by GALOIS_TIMELINE and stops
+ * recording. Called by the runtime on shutdown.
+ */
+void finish();
+
+/**
+ * Converts a binary timeline file to Chrome trace format.
+ *
+ * @returns false if the input could not be read
+ */
+bool convertToJSON(const std::string& binaryFile, const std::string& jsonFile);
+
+} // namespace timeline
+} // namespace runtime
+} // namespace galois
+
+#endif
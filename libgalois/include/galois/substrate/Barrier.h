@@ -23,8 +23,11 @@
 #include "galois/substrate/ThreadPool.h"
 #include "galois/gIO.h"
 
+#include <map>
 #include <memory>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace galois {
 namespace substrate {
@@ -47,7 +50,10 @@ public:
 };
 
 /**
- * Return a reference to system barrier
+ * Return a reference to system barrier. The first call for a thread count
+ * outside a parallel region chooses the barrier for that many threads,
+ * timing the candidates if no cached choice exists yet (see
+ * internal::BarrierSelector).
  */
 Barrier& getBarrier(unsigned activeThreads);
 
@@ -60,6 +66,24 @@ std::unique_ptr<Barrier> createMCSBarrier(unsigned);
 std::unique_ptr<Barrier> createTopoBarrier(unsigned);
 std::unique_ptr<Barrier> createCountingBarrier(unsigned);
 std::unique_ptr<Barrier> createDisseminationBarrier(unsigned);
+std::unique_ptr<Barrier> createHybridBarrier(unsigned);
+
+//! Names of the barriers createBarrier knows, e.g., "Topo" or "Hybrid"
+const std::vector<std::string>& getBarrierNames();
+
+/**
+ * Create a barrier by name (see getBarrierNames()). Returns null if the name
+ * is unknown or the barrier is not available on this system.
+ */
+std::unique_ptr<Barrier> createBarrier(const std::string& name, unsigned);
+
+/**
+ * Times numWaits consecutive waits of barrier b on numThreads threads of the
+ * thread pool, which must not be running.
+ *
+ * @returns average nanoseconds per wait
+ */
+double timeBarrier(Barrier& b, unsigned numThreads, unsigned numWaits);
 
 /**
  * Creates a new simple barrier. This barrier is not designed to be fast but
@@ -72,15 +96,55 @@ std::unique_ptr<Barrier> createSimpleBarrier(unsigned int);
 
 namespace internal {
 
+/**
+ * Picks the barrier used for each thread count. Unless GALOIS_BARRIER names
+ * a barrier, the first get for a thread count times every barrier on that
+ * many threads and keeps the fastest; gets from inside a parallel region,
+ * where the thread pool cannot be used for timing, get the topology barrier.
+ * Choices are cached in a profile per topology, by default
+ * $XDG_CACHE_HOME/galois/barriers-<topology> (or ~/.cache/galois), so each
+ * thread count is timed once per machine rather than once per run.
+ * GALOIS_BARRIER_PROFILE names a different file, or turns the cache off when
+ * set to the empty string. A profile is read only when it was written on a
+ * machine with the same topology. The profile is read at the first get, and
+ * a profile that cannot be read or written is skipped.
+ */
+class BarrierSelector {
+  struct Instance {
+    std::unique_ptr<Barrier> barrier;
+    unsigned numThreads;
+  };
+
+  //! Barriers handed out so far; they live as long as the selector
+  std::map<std::string, Instance> barriers;
+  //! Chosen barrier for each thread count
+  std::map<unsigned, std::string> choices;
+  std::string forced;
+  std::string profile;
+  bool useDefaultProfile;
+  bool loaded;
+
+  std::string topology() const;
+  std::string defaultProfile() const;
+  void loadProfile();
+  void saveProfile();
+  std::string calibrate(unsigned numThreads);
+  //! Chooses the barrier for numThreads threads, timing them if needed
+  void prepare(unsigned numThreads);
+
+public:
+  BarrierSelector();
+
+  //! Name of the barrier chosen for numThreads threads
+  const std::string& choose(unsigned numThreads);
+
+  //! Barrier chosen for numThreads threads, initialized for that many
+  Barrier& get(unsigned numThreads);
+};
+
 template <typename _UNUSED = void>
 struct BarrierInstance {
-  unsigned m_num_threads;
-  std::unique_ptr<Barrier> m_barrier;
-
-  BarrierInstance(void) {
-    m_num_threads = getThreadPool().getMaxThreads();
-    m_barrier     = createTopoBarrier(m_num_threads);
-  }
+  BarrierSelector m_selector;
 
   Barrier& get(unsigned numT) {
     GALOIS_ASSERT(numT > 0,
@@ -89,12 +153,7 @@ struct BarrierInstance {
     numT = std::min(numT, getThreadPool().getMaxUsableThreads());
     numT = std::max(numT, 1u);
 
-    if (numT != m_num_threads) {
-      m_num_threads = numT;
-      m_barrier->reinit(numT);
-    }
-
-    return *m_barrier;
+    return m_selector.get(numT);
   }
 };
 
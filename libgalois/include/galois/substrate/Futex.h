@@ -0,0 +1,44 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_SUBSTRATE_FUTEX_H
+#define GALOIS_SUBSTRATE_FUTEX_H
+
+#include <atomic>
+
+namespace galois {
+namespace substrate {
+
+/**
+ * Blocks the calling thread while word holds expected. May return
+ * spuriously, so callers recheck their condition in a loop. On systems
+ * without futexes this yields the processor instead.
+ */
+void futexWait(std::atomic<int>& word, int expected);
+
+//! Wakes up to num threads blocked in futexWait on word
+void futexWake(std::atomic<int>& word, int num);
+
+//! Wakes all threads blocked in futexWait on word
+void futexWakeAll(std::atomic<int>& word);
+
+} // end namespace substrate
+} // end namespace galois
+
+#endif
@@ -33,6 +33,7 @@ struct threadTopoInfo {
   unsigned cumulativeMaxSocket; // max socket id seen from [0, tid]
   unsigned osContext;           // OS ID to use for thread binding
   unsigned osNumaNode;          // OS ID for numa node
+  unsigned core;                // physical core; shared by SMT siblings
 };
 
 struct machineTopoInfo {
@@ -21,9 +21,10 @@
 #define GALOIS_SUBSTRATE_THREADPOOL_H
 
 #include "CacheLineStorage.h"
+#include "Futex.h"
 #include "HWTopo.h"
 
-#include <condition_variable>
+#include <chrono>
 #include <thread>
 #include <functional>
 #include <atomic>
@@ -65,36 +66,57 @@ protected:
 
   //! Per-thread mailboxes for notification
   struct per_signal {
-    std::condition_variable cv;
-    std::mutex m;
+    //! Release word for blocking waits: IDLE, RELEASED or PARKED
+    std::atomic<int> release;
     unsigned wbegin, wend;
     std::atomic<int> done;
     std::atomic<int> fastRelease;
     threadTopoInfo topo;
 
+    enum { IDLE = 0, RELEASED = 1, PARKED = 2 };
+
+    per_signal() : release(IDLE) {}
+
     void wakeup(bool fastmode) {
+      done = 0;
       if (fastmode) {
-        done        = 0;
         fastRelease = 1;
-      } else {
-        std::lock_guard<std::mutex> lg(m);
-        done = 0;
-        cv.notify_one();
-        // start.release();
+      } else if (release.exchange(RELEASED) == PARKED) {
+        futexWake(release, 1);
       }
     }
 
-    void wait(bool fastmode) {
+    /**
+     * Waits for the next wakeup. In fastmode this spins; otherwise it spins
+     * for up to spinUsec microseconds and then parks on a futex until woken.
+     */
+    void wait(bool fastmode, unsigned spinUsec) {
       if (fastmode) {
         while (!fastRelease.load(std::memory_order_relaxed)) {
           asmPause();
         }
         fastRelease = 0;
-      } else {
-        std::unique_lock<std::mutex> lg(m);
-        cv.wait(lg, [=] { return !done; });
-        // start.acquire();
+        return;
       }
+
+      if (spinUsec) {
+        auto until = std::chrono::steady_clock::now() +
+                     std::chrono::microseconds(spinUsec);
+        unsigned n = 0;
+        while (release.load(std::memory_order_acquire) != RELEASED) {
+          asmPause();
+          if (++n % 64 == 0 && std::chrono::steady_clock::now() > until)
+            break;
+        }
+      }
+
+      int expected = IDLE;
+      if (release.compare_exchange_strong(expected, PARKED)) {
+        while (release.load(std::memory_order_acquire) == PARKED) {
+          futexWait(release, PARKED);
+        }
+      }
+      release.store(IDLE, std::memory_order_relaxed);
     }
   };
 
@@ -105,6 +127,7 @@ protected:
   std::vector<std::thread> threads;
   unsigned reserved;
   unsigned masterFastmode;
+  std::atomic<unsigned> idleSpin;
   bool running;
   std::function<void(void)> work;
 
@@ -164,8 +187,27 @@ public:
   // experimental: leave busy wait
   void beKind();
 
+  /**
+   * Elastic mode: after a parallel region, idle workers spin for up to usec
+   * microseconds waiting for the next one before parking in the kernel, so
+   * back-to-back loops are cheap to start while idle workers give their
+   * cores back. Workers not used by a region (e.g., after lowering the
+   * number of active threads) stay parked. The default of 0, which
+   * GALOIS_IDLE_SPIN_US overrides, parks workers immediately. Takes effect
+   * from the next wait.
+   */
+  void setIdleSpin(unsigned usec) {
+    idleSpin.store(usec, std::memory_order_relaxed);
+  }
+  unsigned getIdleSpin() const {
+    return idleSpin.load(std::memory_order_relaxed);
+  }
+
   bool isRunning() const { return running; }
 
+  //! true between burnPower() and beKind()
+  bool isBurningPower() const { return masterFastmode; }
+
   //! return the number of non-reserved threads in the pool
   unsigned getMaxUsableThreads() const { return mi.maxThreads - reserved; }
   //! return the number of threads supported by the thread pool on the current
@@ -195,6 +237,7 @@ public:
   unsigned getNumaNode(unsigned tid) const {
     return signals[tid]->topo.numaNode;
   }
+  unsigned getCore(unsigned tid) const { return signals[tid]->topo.core; }
 
   static unsigned getTID() { return my_box.topo.tid; }
   static bool isLeader() { return my_box.topo.tid == my_box.topo.socketLeader; }
@@ -204,6 +247,7 @@ public:
     return my_box.topo.cumulativeMaxSocket;
   }
   static unsigned getNumaNode() { return my_box.topo.numaNode; }
+  static unsigned getCore() { return my_box.topo.core; }
 };
 
 namespace internal {
@@ -23,9 +23,13 @@
 #include "galois/FixedSizeRing.h"
 #include "galois/substrate/PaddedLock.h"
 #include "galois/runtime/Mem.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/runtime/Timeline.h"
 #include "galois/worklists/WorkListHelpers.h"
 #include "WLCompileCheck.h"
 
+#include <chrono>
+
 namespace galois {
 namespace runtime {
 extern unsigned activeThreads;
@@ -54,20 +58,25 @@ struct squeue<false, PS, TQ> {
 };
 
 //! Common functionality to all chunked worklists
+//!
+//! With Adaptive, chunks hold at most ChunkSize items, but each thread fills
+//! the chunks it pushes only up to a limit that follows the measured time to
+//! process a chunk (aiming at ADAPTIVE_TARGET_NS) and is halved whenever the
+//! thread finds no local chunk and has to steal or goes idle.
 template <typename T, template <typename, bool> class QT, bool Distributed,
-          bool IsStack, int ChunkSize, bool Concurrent>
+          bool IsStack, int ChunkSize, bool Concurrent, bool Adaptive = false>
 struct ChunkMaster : private boost::noncopyable {
   template <typename _T>
-  using retype =
-      ChunkMaster<_T, QT, Distributed, IsStack, ChunkSize, Concurrent>;
+  using retype = ChunkMaster<_T, QT, Distributed, IsStack, ChunkSize,
+                             Concurrent, Adaptive>;
 
   template <int _chunk_size>
-  using with_chunk_size =
-      ChunkMaster<T, QT, Distributed, IsStack, _chunk_size, Concurrent>;
+  using with_chunk_size = ChunkMaster<T, QT, Distributed, IsStack, _chunk_size,
+                                      Concurrent, Adaptive>;
 
   template <bool _Concurrent>
-  using rethread =
-      ChunkMaster<T, QT, Distributed, IsStack, ChunkSize, _Concurrent>;
+  using rethread = ChunkMaster<T, QT, Distributed, IsStack, ChunkSize,
+                               _Concurrent, Adaptive>;
 
 private:
   class Chunk : public FixedSizeRing<T, ChunkSize>,
@@ -75,10 +84,29 @@ private:
 
   runtime::FixedSizeAllocator<Chunk> alloc;
 
+  typedef std::chrono::steady_clock clockTy;
+  constexpr static const double ADAPTIVE_TARGET_NS = 10000;
+
   struct p {
     Chunk* cur;
     Chunk* next;
-    p() : cur(0), next(0) {}
+
+    // Adaptive chunking
+    unsigned limit;            // items per pushed chunk
+    clockTy::time_point start; // when the chunk being drained was popped
+    unsigned startSize;        // its size; 0 if none
+    double nsPerItem;          // running estimate; 0 if unknown
+
+    // Stats
+    size_t chunks;
+    size_t items;
+    unsigned minSize;
+    unsigned maxSize;
+
+    p()
+        : cur(0), next(0), limit(ChunkSize / 4 ? ChunkSize / 4 : 1),
+          startSize(0), nsPerItem(0), chunks(0), items(0), minSize(0),
+          maxSize(0) {}
   };
 
   typedef QT<Chunk, Concurrent> LevelItem;
@@ -98,43 +126,96 @@ private:
   }
 
   void pushChunk(Chunk* C) {
+    runtime::timeline::record(runtime::timeline::Event::Push, C->size());
     LevelItem& I = Q.get();
     I.push(C);
   }
 
+  void pushChunk(p& n, Chunk* C) {
+    if (Adaptive) {
+      unsigned sz = C->size();
+      n.minSize   = n.chunks ? std::min(n.minSize, sz) : sz;
+      n.maxSize   = std::max(n.maxSize, sz);
+      n.items += sz;
+      ++n.chunks;
+    }
+    pushChunk(C);
+  }
+
+  //! updates the fill limit of thread n after it popped r (null if none)
+  void adapt(p& n, Chunk* r, bool local) {
+    auto now = clockTy::now();
+    if (n.startSize) {
+      double sample =
+          std::chrono::duration<double, std::nano>(now - n.start).count() /
+          n.startSize;
+      n.nsPerItem =
+          n.nsPerItem > 0 ? 0.75 * n.nsPerItem + 0.25 * sample : sample;
+    }
+    n.start     = now;
+    n.startSize = r ? r->size() : 0;
+
+    unsigned target = n.limit;
+    if (n.nsPerItem > 0) {
+      double t = ADAPTIVE_TARGET_NS / n.nsPerItem;
+      target   = t >= ChunkSize ? ChunkSize : (t < 1 ? 1 : unsigned(t));
+    }
+
+    if (!r || !local) {
+      n.limit = std::max(1u, std::min(target, n.limit / 2));
+    } else {
+      n.limit = std::min(target, n.limit + n.limit / 4 + 1);
+    }
+  }
+
   Chunk* popChunkByID(unsigned int i) {
     LevelItem& I = Q.get(i);
     return I.pop();
   }
 
-  Chunk* popChunk() {
+  Chunk* popChunk(p& n) {
     int id   = Q.myEffectiveID();
     Chunk* r = popChunkByID(id);
-    if (r)
+    if (r) {
+      runtime::timeline::record(runtime::timeline::Event::Pop, r->size());
+      if (Adaptive)
+        adapt(n, r, true);
       return r;
+    }
 
     for (int i = id + 1; i < (int)Q.size(); ++i) {
       r = popChunkByID(i);
-      if (r)
+      if (r) {
+        runtime::timeline::record(runtime::timeline::Event::Steal, i);
+        if (Adaptive)
+          adapt(n, r, false);
         return r;
+      }
     }
 
     for (int i = 0; i < id; ++i) {
       r = popChunkByID(i);
-      if (r)
+      if (r) {
+        runtime::timeline::record(runtime::timeline::Event::Steal, i);
+        if (Adaptive)
+          adapt(n, r, false);
         return r;
+      }
     }
 
+    if (Adaptive)
+      adapt(n, 0, false);
     return 0;
   }
 
   template <typename... Args>
   T* emplacei(p& n, Args&&... args) {
     T* retval = 0;
-    if (n.next && (retval = n.next->emplace_back(std::forward<Args>(args)...)))
+    if (n.next && (!Adaptive || n.next->size() < n.limit) &&
+        (retval = n.next->emplace_back(std::forward<Args>(args)...)))
       return retval;
     if (n.next)
-      pushChunk(n.next);
+      pushChunk(n, n.next);
     n.next = mkChunk();
     retval = n.next->emplace_back(std::forward<Args>(args)...);
     assert(retval);
@@ -149,10 +230,40 @@ public:
   void flush() {
     p& n = data.get();
     if (n.next)
-      pushChunk(n.next);
+      pushChunk(n, n.next);
     n.next = 0;
   }
 
+  /**
+   * Hands the chunks the calling thread is filling and draining to the
+   * shared queues, so that other threads can take them.
+   */
+  void release() {
+    flush();
+    p& n = data.get();
+    if (n.cur && !n.cur->empty()) {
+      pushChunk(n.cur);
+      n.cur       = 0;
+      n.startSize = 0;
+    }
+  }
+
+  /**
+   * Reports the sizes of the chunks pushed by the calling thread as loop
+   * statistics. Only adaptive worklists report anything.
+   */
+  void reportChunkStats(const char* loopname) {
+    p& n = data.get();
+    if (!Adaptive)
+      return;
+    runtime::reportStat_Tsum(loopname, "Chunks", n.chunks);
+    if (n.chunks) {
+      runtime::reportStat_Tmin(loopname, "MinChunkSize", n.minSize);
+      runtime::reportStat_Tmax(loopname, "MaxChunkSize", n.maxSize);
+      runtime::reportStat_Tavg(loopname, "AvgChunkSize", n.items / n.chunks);
+    }
+  }
+
   /**
    * Construct an item on the worklist and return a pointer to its value.
    *
@@ -178,7 +289,7 @@ public:
         return &n.next->back();
       if (n.next)
         delChunk(n.next);
-      n.next = popChunk();
+      n.next = popChunk(n);
       if (n.next && !n.next->empty())
         return &n.next->back();
       return NULL;
@@ -187,7 +298,7 @@ public:
         return &n.cur->front();
       if (n.cur)
         delChunk(n.cur);
-      n.cur = popChunk();
+      n.cur = popChunk(n);
       if (!n.cur) {
         n.cur  = n.next;
         n.next = 0;
@@ -240,7 +351,7 @@ public:
         return retval;
       if (n.next)
         delChunk(n.next);
-      n.next = popChunk();
+      n.next = popChunk(n);
       if (n.next)
         return n.next->extract_back();
       return galois::optional<value_type>();
@@ -249,7 +360,7 @@ public:
         return retval;
       if (n.cur)
         delChunk(n.cur);
-      n.cur = popChunk();
+      n.cur = popChunk(n);
       if (!n.cur) {
         n.cur  = n.next;
         n.next = 0;
@@ -314,6 +425,19 @@ using PerSocketChunkBag = internal::ChunkMaster<T, ConExtLinkedQueue, true,
                                                 true, ChunkSize, Concurrent>;
 GALOIS_WLCOMPILECHECK(PerSocketChunkBag)
 
+/**
+ * Distributed chunked FIFO whose chunk sizes adapt to the measured cost of
+ * work items and to load imbalance; see internal::ChunkMaster. Loops using
+ * it report the chunk sizes chosen in their statistics.
+ *
+ * @tparam MaxChunkSize largest chunk size
+ */
+template <int MaxChunkSize = 256, typename T = int, bool Concurrent = true>
+using AdaptiveChunkFIFO =
+    internal::ChunkMaster<T, ConExtLinkedQueue, true, false, MaxChunkSize,
+                          Concurrent, true>;
+GALOIS_WLCOMPILECHECK(AdaptiveChunkFIFO)
+
 } // end namespace worklists
 } // end namespace galois
 
@@ -22,6 +22,7 @@
 
 #include <boost/mpl/if.hpp>
 #include "galois/worklists/Simple.h"
+#include "galois/worklists/WorkListHelpers.h"
 
 #include <type_traits>
 
@@ -104,6 +105,18 @@ public:
       return ret;
     return popGlobal();
   }
+
+  /**
+   * Moves the local work of the calling thread to the global queue. Only
+   * available if the global queue can release work itself.
+   */
+  template <bool Enable = HasRelease<Global>::value>
+  typename std::enable_if<Enable>::type release() {
+    lWLTy& l = *local.getLocal();
+    while (galois::optional<value_type> v = l.pop())
+      global.push(*v);
+    global.release();
+  }
 };
 GALOIS_WLCOMPILECHECK(LocalQueue)
 
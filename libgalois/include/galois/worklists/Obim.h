@@ -419,6 +419,18 @@ public:
     return slowPop(p);
   }
 
+  /**
+   * Releases the private work of the calling thread in every priority it
+   * knows of. Not available with a barrier, where a thread also holds back
+   * work of the priorities after the current one.
+   */
+  template <bool Enable = !UseBarrier && HasRelease<CTy>::value>
+  typename std::enable_if<Enable>::type release() {
+    ThreadData& p = *data.getLocal();
+    for (auto& entry : p.local)
+      entry.second->release();
+  }
+
   template <bool Barrier = UseBarrier>
   auto empty() -> typename std::enable_if<Barrier, bool>::type {
     galois::optional<value_type> item;
@@ -85,6 +85,9 @@ public:
     unlock();
     return v;
   }
+
+  //! All work is shared; there is nothing to release
+  void release() {}
 };
 GALOIS_WLCOMPILECHECK(OrderedList)
 } // namespace worklists
@@ -76,6 +76,9 @@ public:
     }
     return retval;
   }
+
+  //! All work is shared; there is nothing to release
+  void release() {}
 };
 
 template <typename T = int>
@@ -31,15 +31,18 @@
 #include "OrderedList.h"
 #include "OwnerComputes.h"
 #include "StableIterator.h"
+#include "WorkStealing.h"
 
 namespace galois {
 /**
  * Scheduling policies for Galois iterators. Unless you have very specific
  * scheduling requirement, {@link PerSocketChunkLIFO} or {@link
- * PerSocketChunkFIFO} is a reasonable scheduling policy. If you need
- * approximate priority scheduling, use {@link OrderedByIntegerMetric}. For
- * debugging, you may be interested in {@link FIFO} or {@link LIFO}, which try
- * to follow serial order exactly.
+ * PerSocketChunkFIFO} is a reasonable scheduling policy. When the work is
+ * unevenly spread over threads, {@link WorkStealingLIFO} lets idle threads
+ * take it from nearby threads first. If you need approximate priority
+ * scheduling, use {@link OrderedByIntegerMetric}. For debugging, you may be
+ * interested in {@link FIFO} or {@link LIFO}, which try to follow serial
+ * order exactly.
  *
  * The way to use a worklist is to pass it as a template parameter to
  * {@link for_each()}. For example,
@@ -26,6 +26,9 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 
+#include <type_traits>
+#include <utility>
+
 namespace galois {
 namespace worklists {
 
@@ -174,6 +177,18 @@ public:
   const_iterator end() const { return const_iterator(); }
 };
 
+/**
+ * True if worklist WL has a release() member, which hands the work the
+ * calling thread holds privately to the shared part of the worklist where
+ * other threads can pop it.
+ */
+template <typename WL, typename = void>
+struct HasRelease : std::false_type {};
+
+template <typename WL>
+struct HasRelease<WL, decltype(std::declval<WL&>().release(), void())>
+    : std::true_type {};
+
 template <typename T>
 struct DummyIndexer : public std::unary_function<const T&, unsigned> {
   unsigned operator()(const T& x) { return 0; }
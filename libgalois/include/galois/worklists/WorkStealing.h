@@ -0,0 +1,427 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef GALOIS_WORKLIST_WORKSTEALING_H
+#define GALOIS_WORKLIST_WORKSTEALING_H
+
+#include "galois/FixedSizeRing.h"
+#include "galois/Threads.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "galois/substrate/ThreadPool.h"
+#include "galois/runtime/Mem.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/runtime/Timeline.h"
+#include "WLCompileCheck.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace galois {
+namespace worklists {
+
+namespace internal {
+
+/**
+ * Chase-Lev work-stealing deque of pointers (Lê et al., PPoPP 2013).
+ *
+ * The owning thread pushes and takes at the bottom; any other thread steals
+ * from the top. The array grows when full. Arrays that were replaced may
+ * still be read by concurrent thieves, so they are only freed with the
+ * deque.
+ */
+template <typename T>
+class ChaseLevDeque : private boost::noncopyable {
+  struct Array {
+    size_t mask;
+    Array* retired; // array this one replaced
+    std::atomic<T*>* slots;
+
+    explicit Array(size_t size)
+        : mask(size - 1), retired(0), slots(new std::atomic<T*>[size]) {}
+    ~Array() { delete[] slots; }
+
+    size_t size() const { return mask + 1; }
+    T* get(ptrdiff_t i) const {
+      return slots[i & mask].load(std::memory_order_relaxed);
+    }
+    void put(ptrdiff_t i, T* x) {
+      slots[i & mask].store(x, std::memory_order_relaxed);
+    }
+  };
+
+  // top is written by thieves and bottom by the owner; keep them apart
+  std::atomic<ptrdiff_t> top;
+  char pad1[GALOIS_CACHE_LINE_SIZE - sizeof(std::atomic<ptrdiff_t>)];
+  std::atomic<ptrdiff_t> bottom;
+  std::atomic<Array*> array;
+  char pad2[GALOIS_CACHE_LINE_SIZE - sizeof(std::atomic<ptrdiff_t>) -
+            sizeof(std::atomic<Array*>)];
+
+  Array* grow(Array* a, ptrdiff_t b, ptrdiff_t t) {
+    Array* n   = new Array(a->size() * 2);
+    n->retired = a;
+    for (ptrdiff_t i = t; i < b; ++i)
+      n->put(i, a->get(i));
+    array.store(n, std::memory_order_release);
+    return n;
+  }
+
+public:
+  explicit ChaseLevDeque(size_t initial = 32)
+      : top(0), bottom(0), array(new Array(initial)) {}
+
+  ~ChaseLevDeque() {
+    Array* a = array.load(std::memory_order_relaxed);
+    while (a) {
+      Array* r = a->retired;
+      delete a;
+      a = r;
+    }
+  }
+
+  //! Approximate number of elements; exact for the owner when no steals race
+  ptrdiff_t size() const {
+    ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+    ptrdiff_t t = top.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  //! Owner only
+  void push(T* x) {
+    ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+    ptrdiff_t t = top.load(std::memory_order_acquire);
+    Array* a    = array.load(std::memory_order_relaxed);
+    if (b - t > ptrdiff_t(a->size()) - 1)
+      a = grow(a, b, t);
+    a->put(b, x);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  //! Owner only; returns the most recently pushed element or null
+  T* take() {
+    ptrdiff_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Array* a    = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ptrdiff_t t = top.load(std::memory_order_relaxed);
+    T* x        = 0;
+    if (t <= b) {
+      x = a->get(b);
+      if (t == b) {
+        // Last element: race against thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))
+          x = 0;
+        bottom.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return x;
+  }
+
+  //! Any thread; returns the oldest element or null if empty or if another
+  //! thread won the race for it
+  T* steal() {
+    ptrdiff_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    ptrdiff_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return 0;
+    Array* a = array.load(std::memory_order_acquire);
+    T* x     = a->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+      return 0;
+    return x;
+  }
+
+  /**
+   * Steals up to half of the elements of victim. The first one is returned
+   * and the rest are pushed onto this deque, whose owner must be the
+   * calling thread.
+   *
+   * Each element is claimed with its own steal(): claiming a whole range
+   * with a single CAS on top would race with the owner taking from the
+   * bottom without synchronization.
+   */
+  T* stealHalfAndTake(ChaseLevDeque& victim) {
+    ptrdiff_t n = (victim.size() + 1) / 2;
+    if (!n)
+      return 0;
+    T* first = victim.steal();
+    if (!first)
+      return 0;
+    for (ptrdiff_t i = 1; i < n; ++i) {
+      T* x = victim.steal();
+      if (!x)
+        break;
+      push(x);
+    }
+    return first;
+  }
+};
+
+/**
+ * Per-thread chunked worklists on Chase-Lev deques with locality-biased
+ * steals.
+ *
+ * Each thread fills a chunk and moves it to the bottom of its deque when it
+ * is full. LIFO threads drain their newest chunk; FIFO threads drain their
+ * oldest one by stealing from the top of their own deque. A thread out of
+ * chunks steals half of the deque of a victim, trying threads on the same
+ * physical core first, then threads on the same socket and then threads on
+ * other sockets; within a group it starts with the next thread id to spread
+ * thieves over victims. Loops report the steals at each distance in their
+ * statistics.
+ */
+template <bool IsLocallyLIFO, int ChunkSize, typename T>
+struct WorkStealingMaster : private boost::noncopyable {
+  template <typename _T>
+  using retype = WorkStealingMaster<IsLocallyLIFO, ChunkSize, _T>;
+
+  template <bool _concurrent>
+  using rethread = WorkStealingMaster<IsLocallyLIFO, ChunkSize, T>;
+
+  template <int _chunk_size>
+  using with_chunk_size = WorkStealingMaster<IsLocallyLIFO, _chunk_size, T>;
+
+private:
+  class Chunk : public galois::FixedSizeRing<T, ChunkSize> {};
+
+  enum Distance { CORE, SOCKET, REMOTE, NUM_DISTANCES };
+
+  struct Victim {
+    unsigned tid;
+    Distance distance;
+  };
+
+  struct p {
+    ChaseLevDeque<Chunk> deque;
+    Chunk* cur;  // chunk being drained
+    Chunk* next; // chunk being filled; same as cur when locally LIFO
+    std::vector<Victim> victims; // in the order to try them
+
+    // Stats
+    size_t steals[NUM_DISTANCES];
+    size_t failedSteals;
+
+    p() : cur(0), next(0), steals(), failedSteals(0) {}
+  };
+
+  runtime::FixedSizeAllocator<Chunk> alloc;
+  substrate::PerThreadStorage<p> data;
+
+  Chunk* mkChunk() {
+    Chunk* ptr = alloc.allocate(1);
+    alloc.construct(ptr);
+    return ptr;
+  }
+
+  void delChunk(Chunk* ptr) {
+    alloc.destroy(ptr);
+    alloc.deallocate(ptr, 1);
+  }
+
+  Chunk*& getPushChunk(p& n) { return IsLocallyLIFO ? n.cur : n.next; }
+
+  galois::optional<T> doPop(Chunk* c) {
+    if (IsLocallyLIFO)
+      return c->extract_back();
+    else
+      return c->extract_front();
+  }
+
+  void computeVictims() {
+    auto& tp     = substrate::getThreadPool();
+    unsigned num = galois::getActiveThreads();
+
+    for (unsigned tid = 0; tid < num; ++tid) {
+      std::vector<Victim>& v = data.getRemote(tid)->victims;
+      v.clear();
+      for (unsigned i = 1; i < num; ++i) {
+        unsigned eid = (tid + i) % num;
+        Distance d   = REMOTE;
+        if (tp.getSocket(eid) == tp.getSocket(tid))
+          d = tp.getCore(eid) == tp.getCore(tid) ? CORE : SOCKET;
+        v.push_back(Victim{eid, d});
+      }
+      std::stable_sort(v.begin(), v.end(),
+                       [](const Victim& a, const Victim& b) {
+                         return a.distance < b.distance;
+                       });
+    }
+  }
+
+  Chunk* popLocal(p& n) {
+    Chunk* c = 0;
+    if (IsLocallyLIFO) {
+      c = n.deque.take();
+    } else {
+      // Thieves may beat us to the oldest chunk; retry while there are more
+      while (!c && !n.deque.empty())
+        c = n.deque.steal();
+    }
+    if (c)
+      runtime::timeline::record(runtime::timeline::Event::Pop, c->size());
+    return c;
+  }
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  Chunk* steal(p& n) {
+    for (const Victim& v : n.victims) {
+      Chunk* c = n.deque.stealHalfAndTake(data.getRemote(v.tid)->deque);
+      if (c) {
+        runtime::timeline::record(runtime::timeline::Event::Steal, v.tid);
+        ++n.steals[v.distance];
+        return c;
+      }
+    }
+    ++n.failedSteals;
+    return 0;
+  }
+
+  void push_internal(p& n, const T& val) {
+    Chunk*& c = getPushChunk(n);
+    if (c && c->push_back(val))
+      return;
+    if (c) {
+      runtime::timeline::record(runtime::timeline::Event::Push, c->size());
+      n.deque.push(c);
+    }
+    c = mkChunk();
+    c->push_back(val);
+  }
+
+public:
+  typedef T value_type;
+
+  WorkStealingMaster() { computeVictims(); }
+
+  ~WorkStealingMaster() {
+    for (unsigned i = 0; i < data.size(); ++i) {
+      p& n = *data.getRemote(i);
+      if (n.cur)
+        delChunk(n.cur);
+      if (n.next && n.next != n.cur)
+        delChunk(n.next);
+      while (Chunk* c = n.deque.take())
+        delChunk(c);
+    }
+  }
+
+  void push(const value_type& val) { push_internal(*data.getLocal(), val); }
+
+  template <typename Iter>
+  void push(Iter b, Iter e) {
+    p& n = *data.getLocal();
+    while (b != e)
+      push_internal(n, *b++);
+  }
+
+  template <typename RangeTy>
+  void push_initial(const RangeTy& range) {
+    auto rp = range.local_pair();
+    push(rp.first, rp.second);
+  }
+
+  galois::optional<value_type> pop() {
+    p& n = *data.getLocal();
+    galois::optional<value_type> retval;
+    if (n.cur && (retval = doPop(n.cur)))
+      return retval;
+
+    Chunk* c = popLocal(n);
+    if (!c)
+      c = steal(n);
+    if (!c && !IsLocallyLIFO && n.next) {
+      // Last resort: drain the chunk we are filling
+      c      = n.next;
+      n.next = 0;
+    }
+    if (!c)
+      return retval;
+
+    if (n.cur)
+      delChunk(n.cur);
+    n.cur = c;
+    return doPop(n.cur);
+  }
+
+  /**
+   * Moves the chunks the calling thread is draining and filling to its
+   * deque, where other threads can steal them.
+   */
+  void release() {
+    p& n        = *data.getLocal();
+    auto giveUp = [&](Chunk* c) {
+      if (c->empty())
+        delChunk(c);
+      else
+        n.deque.push(c);
+    };
+    if (n.next && n.next != n.cur)
+      giveUp(n.next);
+    if (n.cur)
+      giveUp(n.cur);
+    n.next = n.cur = 0;
+  }
+
+  //! Reports the steals of the calling thread as loop statistics
+  void reportChunkStats(const char* loopname) {
+    p& n = *data.getLocal();
+    runtime::reportStat_Tsum(loopname, "StealsCore", n.steals[CORE]);
+    runtime::reportStat_Tsum(loopname, "StealsSocket", n.steals[SOCKET]);
+    runtime::reportStat_Tsum(loopname, "StealsRemote", n.steals[REMOTE]);
+    runtime::reportStat_Tsum(loopname, "FailedSteals", n.failedSteals);
+  }
+};
+
+} // namespace internal
+
+/**
+ * Work-stealing chunked LIFO. Every thread keeps its own deque of chunks
+ * and idle threads steal half of another thread's chunks, preferring
+ * threads that share a core or a socket; see internal::WorkStealingMaster.
+ *
+ * @tparam ChunkSize chunk size
+ */
+template <int ChunkSize = 64, typename T = int>
+using WorkStealingLIFO = internal::WorkStealingMaster<true, ChunkSize, T>;
+GALOIS_WLCOMPILECHECK(WorkStealingLIFO)
+
+/**
+ * Work-stealing chunked FIFO. Like {@link WorkStealingLIFO} but each thread
+ * processes its own chunks oldest first.
+ *
+ * @tparam ChunkSize chunk size
+ */
+template <int ChunkSize = 64, typename T = int>
+using WorkStealingFIFO = internal::WorkStealingMaster<false, ChunkSize, T>;
+GALOIS_WLCOMPILECHECK(WorkStealingFIFO)
+
+} // namespace worklists
+} // namespace galois
+#endif
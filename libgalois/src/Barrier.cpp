@@ -18,6 +18,19 @@
  */
 
 #include "galois/substrate/Barrier.h"
+#include "galois/substrate/EnvCheck.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
 
 // anchor vtable
 galois::substrate::Barrier::~Barrier() {}
@@ -39,3 +52,212 @@ galois::substrate::Barrier& galois::substrate::getBarrier(unsigned numT) {
   GALOIS_ASSERT(BI, "BarrierInstance not initialized");
   return BI->get(numT);
 }
+
+const std::vector<std::string>& galois::substrate::getBarrierNames() {
+  static const std::vector<std::string> names = {
+      "Topo", "Counting", "Dissemination", "MCS", "Hybrid", "Pthread"};
+  return names;
+}
+
+std::unique_ptr<galois::substrate::Barrier>
+galois::substrate::createBarrier(const std::string& name, unsigned numT) {
+  if (name == "Topo")
+    return createTopoBarrier(numT);
+  if (name == "Counting")
+    return createCountingBarrier(numT);
+  if (name == "Dissemination")
+    return createDisseminationBarrier(numT);
+  if (name == "MCS")
+    return createMCSBarrier(numT);
+  if (name == "Hybrid")
+    return createHybridBarrier(numT);
+  if (name == "Pthread")
+    return createPthreadBarrier(numT);
+  return nullptr;
+}
+
+double galois::substrate::timeBarrier(Barrier& b, unsigned numT,
+                                      unsigned numWaits) {
+  using clockTy = std::chrono::steady_clock;
+  auto& tp      = getThreadPool();
+  GALOIS_ASSERT(!tp.isRunning(), "can't time a barrier in a parallel region");
+
+  b.reinit(numT);
+  // Warm up: wake the threads and touch the barrier's memory
+  tp.run(numT, [&]() {
+    for (unsigned i = 0; i < 8; ++i)
+      b.wait();
+  });
+
+  auto begin = clockTy::now();
+  tp.run(numT, [&]() {
+    for (unsigned i = 0; i < numWaits; ++i)
+      b.wait();
+  });
+  auto end = clockTy::now();
+
+  return std::chrono::duration<double, std::nano>(end - begin).count() /
+         std::max(numWaits, 1U);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// BarrierSelector
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+//! Used when there is nothing to choose or no chance to calibrate
+const std::string defaultBarrier = "Topo";
+const unsigned calibrationWaits  = 512;
+} // namespace
+
+galois::substrate::internal::BarrierSelector::BarrierSelector()
+    : loaded(false) {
+  EnvCheck("GALOIS_BARRIER", forced);
+  if (!forced.empty() && !createBarrier(forced, 1)) {
+    gWarn("unknown barrier GALOIS_BARRIER=", forced, "; selecting by timing");
+    forced.clear();
+  }
+  useDefaultProfile = !EnvCheck("GALOIS_BARRIER_PROFILE", profile);
+}
+
+std::string galois::substrate::internal::BarrierSelector::topology() const {
+  auto& tp = getThreadPool();
+  std::ostringstream os;
+  os << tp.getMaxThreads() << " " << tp.getMaxCores() << " "
+     << tp.getMaxSockets() << " " << tp.getMaxNumaNodes();
+  return os.str();
+}
+
+std::string galois::substrate::internal::BarrierSelector::defaultProfile() const {
+  std::string dir;
+  if (!EnvCheck("XDG_CACHE_HOME", dir)) {
+    if (!EnvCheck("HOME", dir))
+      return "";
+    dir += "/.cache";
+  }
+  for (const char* sub : {"", "/galois"}) {
+    dir += sub;
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+      gDebug("cannot create ", dir, "; not caching barrier choices");
+      return "";
+    }
+  }
+
+  std::string name = topology();
+  std::replace(name.begin(), name.end(), ' ', '-');
+  return dir + "/barriers-" + name;
+}
+
+void galois::substrate::internal::BarrierSelector::loadProfile() {
+  loaded = true;
+  try {
+    if (useDefaultProfile)
+      profile = defaultProfile();
+    if (profile.empty())
+      return;
+    std::ifstream is(profile);
+    std::string line;
+    if (!is || !std::getline(is, line) || line != "topology " + topology())
+      return;
+    unsigned numT;
+    std::string name;
+    while (is >> numT >> name) {
+      if (createBarrier(name, 1))
+        choices[numT] = name;
+    }
+  } catch (const std::exception& e) {
+    gDebug("cannot read barrier profile ", profile, ": ", e.what());
+    profile.clear();
+  }
+}
+
+void galois::substrate::internal::BarrierSelector::saveProfile() {
+  if (profile.empty())
+    return;
+  // Write a private file and rename it, so that processes saving at the same
+  // time never leave a mixed profile behind
+  std::string tmp = profile + "." + std::to_string(getpid());
+  try {
+    {
+      std::ofstream os(tmp);
+      if (!os) {
+        gDebug("cannot write barrier profile ", profile);
+        return;
+      }
+      os << "topology " << topology() << "\n";
+      for (auto& kv : choices)
+        os << kv.first << " " << kv.second << "\n";
+    }
+    if (std::rename(tmp.c_str(), profile.c_str()) != 0) {
+      gDebug("cannot write barrier profile ", profile);
+      std::remove(tmp.c_str());
+    }
+  } catch (const std::exception& e) {
+    gDebug("cannot write barrier profile ", profile, ": ", e.what());
+    std::remove(tmp.c_str());
+    profile.clear();
+  }
+}
+
+std::string
+galois::substrate::internal::BarrierSelector::calibrate(unsigned numT) {
+  std::string best = defaultBarrier;
+  double bestTime  = std::numeric_limits<double>::max();
+  for (auto& name : getBarrierNames()) {
+    std::unique_ptr<Barrier> b = createBarrier(name, numT);
+    if (!b)
+      continue;
+    double t = timeBarrier(*b, numT, calibrationWaits);
+    gDebug("barrier ", name, " on ", numT, " threads: ", t, " ns");
+    if (t < bestTime) {
+      bestTime = t;
+      best     = name;
+    }
+  }
+  return best;
+}
+
+const std::string&
+galois::substrate::internal::BarrierSelector::choose(unsigned numT) {
+  if (!forced.empty())
+    return forced;
+  if (numT == 1)
+    return defaultBarrier;
+
+  auto ii = choices.find(numT);
+  if (ii != choices.end())
+    return ii->second;
+  return defaultBarrier;
+}
+
+void galois::substrate::internal::BarrierSelector::prepare(unsigned numT) {
+  if (!forced.empty() || numT == 1)
+    return;
+  if (!loaded)
+    loadProfile();
+  if (choices.count(numT))
+    return;
+
+  // Calibration needs an idle thread pool; try again next time
+  auto& tp = getThreadPool();
+  if (tp.isRunning() || tp.isBurningPower())
+    return;
+
+  choices[numT] = calibrate(numT);
+  saveProfile();
+}
+
+galois::substrate::Barrier&
+galois::substrate::internal::BarrierSelector::get(unsigned numT) {
+  prepare(numT);
+  const std::string& name = choose(numT);
+  Instance& inst          = barriers[name];
+  if (!inst.barrier) {
+    inst.barrier    = createBarrier(name, numT);
+    inst.numThreads = numT;
+  } else if (inst.numThreads != numT) {
+    inst.barrier->reinit(numT);
+    inst.numThreads = numT;
+  }
+  return *inst.barrier;
+}
@@ -0,0 +1,105 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/substrate/Barrier.h"
+#include "galois/substrate/CacheLineStorage.h"
+#include "galois/substrate/CompilerSpecific.h"
+#include "galois/substrate/Futex.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+/**
+ * Centralized barrier whose waiters spin for a bounded time and then sleep
+ * on a futex. The last thread to arrive bumps the generation and wakes the
+ * sleepers, if there are any. Cheap when threads arrive close together and
+ * does not burn cores when some of them are late.
+ */
+class HybridBarrier : public galois::substrate::Barrier {
+  static constexpr unsigned SPIN = 1 << 12;
+
+  galois::substrate::CacheLineStorage<std::atomic<unsigned>> count;
+  galois::substrate::CacheLineStorage<std::atomic<int>> generation;
+  galois::substrate::CacheLineStorage<std::atomic<int>> sleepers;
+  unsigned num;
+
+  void _reinit(unsigned val) {
+    num            = val;
+    count.get()    = val;
+    sleepers.get() = 0;
+  }
+
+public:
+  HybridBarrier(unsigned int activeT) {
+    generation.get() = 0;
+    _reinit(activeT);
+  }
+
+  virtual ~HybridBarrier() {}
+
+  // The counters are cache line aligned, which plain operator new does not
+  // honor before C++17
+  static void* operator new(size_t size) {
+    void* p = nullptr;
+    if (posix_memalign(&p, alignof(HybridBarrier), size))
+      throw std::bad_alloc();
+    return p;
+  }
+
+  static void operator delete(void* p) { free(p); }
+
+  virtual void reinit(unsigned val) { _reinit(val); }
+
+  virtual void wait() {
+    std::atomic<int>& gen = generation.get();
+    int mine              = gen.load(std::memory_order_acquire);
+
+    if (count.get().fetch_sub(1) == 1) {
+      count.get().store(num, std::memory_order_relaxed);
+      gen.fetch_add(1);
+      if (sleepers.get().load())
+        galois::substrate::futexWakeAll(gen);
+      return;
+    }
+
+    for (unsigned i = 0; i < SPIN; ++i) {
+      if (gen.load(std::memory_order_acquire) != mine)
+        return;
+      galois::substrate::asmPause();
+    }
+
+    ++sleepers.get();
+    while (gen.load() == mine) {
+      galois::substrate::futexWait(gen, mine);
+    }
+    --sleepers.get();
+  }
+
+  virtual const char* name() const { return "HybridBarrier"; }
+};
+
+} // namespace
+
+std::unique_ptr<galois::substrate::Barrier>
+galois::substrate::createHybridBarrier(unsigned activeThreads) {
+  return std::unique_ptr<Barrier>(new HybridBarrier(activeThreads));
+}
@@ -110,6 +110,21 @@ void galois::runtime::SimpleRuntimeContext::acquire(
   }
 }
 
+bool galois::runtime::SimpleRuntimeContext::tryAcquire(
+    galois::runtime::Lockable* lockable, galois::MethodFlag m) {
+  AcquireStatus i;
+  if (customAcquire) {
+    subAcquire(lockable, m);
+  } else if ((i = tryAcquire(lockable)) != AcquireStatus::FAIL) {
+    if (i == AcquireStatus::NEW_OWNER) {
+      addToNhood(lockable);
+    }
+  } else {
+    conflicted = true;
+  }
+  return !conflicted;
+}
+
 void galois::runtime::SimpleRuntimeContext::release(
     galois::runtime::Lockable* lockable) {
   assert(lockable);
@@ -122,6 +137,7 @@ void galois::runtime::SimpleRuntimeContext::release(
 
 unsigned galois::runtime::SimpleRuntimeContext::commitIteration() {
   unsigned numLocks = 0;
+  conflicted        = false;
   while (locks) {
     // ORDER MATTERS!
     Lockable* lockable = locks;
@@ -0,0 +1,63 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/substrate/Futex.h"
+
+#include <climits>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(std::atomic<int>) == sizeof(int),
+              "futex word must be a plain int");
+
+#ifdef __linux__
+
+static int* address(std::atomic<int>& word) {
+  return reinterpret_cast<int*>(&word);
+}
+
+void galois::substrate::futexWait(std::atomic<int>& word, int expected) {
+  syscall(SYS_futex, address(word), FUTEX_WAIT_PRIVATE, expected, nullptr,
+          nullptr, 0);
+}
+
+void galois::substrate::futexWake(std::atomic<int>& word, int num) {
+  syscall(SYS_futex, address(word), FUTEX_WAKE_PRIVATE, num, nullptr, nullptr,
+          0);
+}
+
+#else
+
+void galois::substrate::futexWait(std::atomic<int>& word, int expected) {
+  if (word.load(std::memory_order_relaxed) == expected)
+    std::this_thread::yield();
+}
+
+void galois::substrate::futexWake(std::atomic<int>&, int) {}
+
+#endif
+
+void galois::substrate::futexWakeAll(std::atomic<int>& word) {
+  futexWake(word, INT_MAX);
+}
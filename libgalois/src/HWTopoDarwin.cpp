@@ -76,12 +76,15 @@ galois::substrate::getHWTopo() {
   for (unsigned i = 0; i < mti.maxThreads; ++i) {
     unsigned socket = i / threadsPerSocket;
     unsigned leader = socket * threadsPerSocket;
+    // Darwin does not say which logical CPUs share a physical core, so each
+    // thread counts as its own core
     tti.push_back(threadTopoInfo{
         .socketLeader = leader,
         .socket       = socket,
         .numaNode     = socket,
         .osContext    = i,
         .osNumaNode   = socket,
+        .core         = i,
     });
   }
 
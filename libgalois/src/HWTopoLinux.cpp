@@ -271,9 +271,11 @@ galois::substrate::getHWTopo() {
   // compute renumberings
   std::set<unsigned> sockets;
   std::set<unsigned> numaNodes;
+  std::set<std::pair<unsigned, unsigned>> cores;
   for (auto& i : info) {
     sockets.insert(i.physid);
     numaNodes.insert(i.numaNode);
+    cores.insert(std::make_pair(i.physid, i.coreid));
   }
   unsigned mid = 0; // max socket id
   for (unsigned i = 0; i < info.size(); ++i) {
@@ -289,7 +291,10 @@ galois::substrate::getHWTopo() {
         threadTopoInfo{i, leader, repid,
                        (unsigned)std::distance(
                            numaNodes.begin(), numaNodes.find(info[i].numaNode)),
-                       mid, info[i].proc, info[i].numaNode});
+                       mid, info[i].proc, info[i].numaNode,
+                       (unsigned)std::distance(
+                           cores.begin(),
+                           cores.find(std::make_pair(pid, info[i].coreid)))});
   }
 
   return std::make_pair(retMTI, retTTI);
@@ -56,12 +56,23 @@ SizedHeapFactory::SizedHeap* SizedHeapFactory::getHeap(const size_t size) {
     std::lock_guard<galois::substrate::SimpleLock> ll(lock);
     auto& gentry = heaps[size];
     if (!gentry)
-      gentry = new SizedHeap();
+      gentry = new SizedHeap(size);
     lentry = gentry;
     return lentry;
   }
 }
 
+SlabStats SizedHeapFactory::getSlabStats() {
+  SizedHeapFactory* f = Base::getInstance();
+  unsigned num        = substrate::getThreadPool().getMaxThreads();
+  SlabStats s;
+  std::lock_guard<galois::substrate::SimpleLock> ll(f->lock);
+  for (auto entry : f->heaps)
+    for (unsigned tid = 0; tid < num; ++tid)
+      s += entry.second->stats(tid);
+  return s;
+}
+
 Pow_2_BlockHeap::Pow_2_BlockHeap(void) throw() : heapTable() {
   populateTable();
 }
@@ -41,10 +41,11 @@ int galois::runtime::numPagePoolAllocForThread(unsigned tid) {
 void* galois::runtime::pagePoolAlloc() { return PA->pageAlloc(); }
 
 void galois::runtime::pagePoolPreAlloc(unsigned num) {
-  while (num--)
-    PA->pagePreAlloc();
+  PA->pagePreAlloc(num);
 }
 
+size_t galois::runtime::pagePoolRelease() { return PA->release(); }
+
 void galois::runtime::pagePoolFree(void* ptr) { PA->pageFree(ptr); }
 
 size_t galois::runtime::pagePoolSize() { return substrate::allocSize(); }
@@ -19,6 +19,7 @@
 
 #include "galois/runtime/Statistics.h"
 #include "galois/runtime/Executor_OnEach.h"
+#include "galois/runtime/Mem.h"
 
 #include <iostream>
 #include <fstream>
@@ -135,6 +136,18 @@ void galois::runtime::reportPageAlloc(const char* category) {
       std::make_tuple());
 }
 
+void galois::runtime::reportSlabAlloc(const char* category) {
+  SlabStats s = SizedHeapFactory::getSlabStats();
+  reportStat_Single("SlabAlloc", std::string(category) + "SlabBytes",
+                    s.slabBytes);
+  reportStat_Single("SlabAlloc", std::string(category) + "LiveBytes",
+                    s.liveBytes);
+  reportStat_Single("SlabAlloc", std::string(category) + "LocalFrees",
+                    s.localFrees);
+  reportStat_Single("SlabAlloc", std::string(category) + "RemoteFrees",
+                    s.remoteFrees);
+}
+
 void galois::runtime::reportNumaAlloc(const char* category) {
   galois::gWarn("reportNumaAlloc NOT IMPLEMENTED YET. TBD");
   int nodes = substrate::getThreadPool().getMaxNumaNodes();
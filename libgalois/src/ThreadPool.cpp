@@ -39,8 +39,12 @@ using namespace galois::substrate;
 thread_local ThreadPool::per_signal ThreadPool::my_box;
 
 ThreadPool::ThreadPool()
-    : mi(getHWTopo().first), reserved(0), masterFastmode(false),
+    : mi(getHWTopo().first), reserved(0), masterFastmode(false), idleSpin(0),
       running(false) {
+  int spin = 0;
+  if (EnvCheck("GALOIS_IDLE_SPIN_US", spin) && spin > 0)
+    idleSpin = spin;
+
   signals.resize(mi.maxThreads);
   initThread(0);
 
@@ -129,7 +133,7 @@ void ThreadPool::threadLoop(unsigned tid) {
   bool fastmode = false;
   auto& me      = my_box;
   do {
-    me.wait(fastmode);
+    me.wait(fastmode, getIdleSpin());
     cascade(fastmode);
     try {
       work();
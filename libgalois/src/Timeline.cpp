@@ -0,0 +1,428 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file Timeline.cpp
+ *
+ * Ring buffers and output formats for Timeline.h
+ */
+
+#include "galois/runtime/Timeline.h"
+#include "galois/gIO.h"
+#include "galois/substrate/EnvCheck.h"
+#include "galois/substrate/SimpleLock.h"
+#include "galois/substrate/ThreadPool.h"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace galois {
+namespace runtime {
+uint32_t getHostID();
+} // namespace runtime
+} // namespace galois
+
+using namespace galois::runtime::timeline;
+
+namespace {
+
+constexpr const char* const TIMELINE_ENV_VAR        = "GALOIS_TIMELINE";
+constexpr const char* const TIMELINE_EVENTS_ENV_VAR = "GALOIS_TIMELINE_EVENTS";
+constexpr const uint64_t DEFAULT_CAPACITY           = 1 << 16;
+constexpr const char MAGIC[8] = {'G', 'A', 'L', 'T', 'L', 'N', 'E', '1'};
+
+typedef std::chrono::steady_clock clockTy;
+
+//! Events of one thread; a ring that keeps the latest capacity events
+struct Buffer {
+  unsigned tid;
+  uint64_t next = 0;
+  std::vector<Record> records;
+
+  Buffer(unsigned t, uint64_t capacity) : tid(t), records(capacity) {}
+
+  void push(const Record& r) {
+    records[next % records.size()] = r;
+    ++next;
+  }
+};
+
+//! Events of one thread in order, as written to or read from a file
+struct ThreadEvents {
+  unsigned tid;
+  uint64_t dropped;
+  std::vector<Record> records;
+};
+
+struct TimelineState {
+  std::string outfile;
+  uint64_t capacity;
+  clockTy::time_point startTime;
+
+  galois::substrate::SimpleLock lock;
+  std::vector<std::unique_ptr<Buffer>> buffers;
+  std::vector<std::string> names;
+  std::unordered_map<std::string, uint32_t> nameIds;
+};
+
+TimelineState* state = nullptr;
+//! Incremented on every start so stale thread-local buffers are not reused
+uint64_t generation = 0;
+
+thread_local Buffer* localBuffer      = nullptr;
+thread_local uint64_t localGeneration = 0;
+
+Buffer* getLocalBuffer() {
+  if (localBuffer && localGeneration == generation) {
+    return localBuffer;
+  }
+
+  std::unique_ptr<Buffer> b(new Buffer(galois::substrate::ThreadPool::getTID(),
+                                       state->capacity));
+  localBuffer     = b.get();
+  localGeneration = generation;
+
+  std::lock_guard<galois::substrate::SimpleLock> lg(state->lock);
+  state->buffers.emplace_back(std::move(b));
+  return localBuffer;
+}
+
+std::vector<ThreadEvents> collect() {
+  std::vector<ThreadEvents> threads;
+  for (auto& b : state->buffers) {
+    ThreadEvents t;
+    t.tid        = b->tid;
+    uint64_t cap = b->records.size();
+    uint64_t num = std::min(b->next, cap);
+    t.dropped    = b->next - num;
+    for (uint64_t i = b->next - num; i < b->next; ++i) {
+      t.records.push_back(b->records[i % cap]);
+    }
+    threads.emplace_back(std::move(t));
+  }
+  return threads;
+}
+
+template <typename T>
+void writeRaw(std::ostream& os, const T& v) {
+  os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <typename T>
+bool readRaw(std::istream& is, T& v) {
+  return bool(is.read(reinterpret_cast<char*>(&v), sizeof(v)));
+}
+
+void writeBinary(std::ostream& os, const std::vector<std::string>& names,
+                 const std::vector<ThreadEvents>& threads) {
+  os.write(MAGIC, sizeof(MAGIC));
+  writeRaw(os, uint32_t(names.size()));
+  for (auto& n : names) {
+    writeRaw(os, uint32_t(n.size()));
+    os.write(n.data(), n.size());
+  }
+  writeRaw(os, uint32_t(threads.size()));
+  for (auto& t : threads) {
+    writeRaw(os, uint32_t(t.tid));
+    writeRaw(os, t.dropped);
+    writeRaw(os, uint64_t(t.records.size()));
+    for (auto& r : t.records) {
+      writeRaw(os, r.time);
+      writeRaw(os, r.arg);
+      writeRaw(os, r.event);
+    }
+  }
+}
+
+bool readBinary(std::istream& is, std::vector<std::string>& names,
+                std::vector<ThreadEvents>& threads) {
+  char magic[sizeof(MAGIC)];
+  if (!is.read(magic, sizeof(magic)) ||
+      !std::equal(magic, magic + sizeof(magic), MAGIC)) {
+    return false;
+  }
+
+  uint32_t numNames;
+  if (!readRaw(is, numNames)) {
+    return false;
+  }
+  names.resize(numNames);
+  for (auto& n : names) {
+    uint32_t len;
+    if (!readRaw(is, len)) {
+      return false;
+    }
+    n.resize(len);
+    if (!is.read(&n[0], len)) {
+      return false;
+    }
+  }
+
+  uint32_t numThreads;
+  if (!readRaw(is, numThreads)) {
+    return false;
+  }
+  threads.resize(numThreads);
+  for (auto& t : threads) {
+    uint32_t tid;
+    uint64_t num;
+    if (!readRaw(is, tid) || !readRaw(is, t.dropped) || !readRaw(is, num)) {
+      return false;
+    }
+    t.tid = tid;
+    t.records.resize(num);
+    for (auto& r : t.records) {
+      if (!readRaw(is, r.time) || !readRaw(is, r.arg) || !readRaw(is, r.event)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void writeString(std::ostream& os, const std::string& s) {
+  os << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if ((unsigned char)c < 0x20) {
+      os << ' ';
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+void writeJSON(std::ostream& os, const std::vector<std::string>& names,
+               const std::vector<ThreadEvents>& threads) {
+  auto nameOf = [&](uint32_t id) -> const std::string& {
+    static const std::string unknown = "?";
+    return id < names.size() ? names[id] : unknown;
+  };
+
+  os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  bool first = true;
+  auto begin = [&](const char* ph, unsigned tid, uint64_t time) {
+    if (!first) {
+      os << ",\n";
+    }
+    first = false;
+    os << "{\"pid\":0,\"tid\":" << tid << ",\"ph\":\"" << ph
+       << "\",\"ts\":" << time / 1000 << "." << time % 1000 / 100
+       << time % 100 / 10 << time % 10;
+  };
+
+  for (auto& t : threads) {
+    begin("M", t.tid, 0);
+    os << ",\"name\":\"thread_name\",\"args\":{\"name\":\"thread " << t.tid
+       << "\",\"dropped_events\":" << t.dropped << "}}";
+
+    // Once the ring wrapped, the begin of a span may be gone while its end
+    // survived; skip such ends so that slices stay matched
+    uint64_t depth = 0;
+    auto keep      = [&](bool isBegin) {
+      if (isBegin) {
+        ++depth;
+        return true;
+      }
+      if (depth) {
+        --depth;
+        return true;
+      }
+      return t.dropped == 0;
+    };
+
+    for (auto& r : t.records) {
+      switch (r.event) {
+      case Event::LoopBegin:
+      case Event::LoopEnd:
+        if (!keep(r.event == Event::LoopBegin))
+          break;
+        begin(r.event == Event::LoopBegin ? "B" : "E", t.tid, r.time);
+        os << ",\"cat\":\"loop\",\"name\":";
+        writeString(os, nameOf(r.arg));
+        os << "}";
+        break;
+      case Event::SyncBegin:
+      case Event::SyncEnd:
+        if (!keep(r.event == Event::SyncBegin))
+          break;
+        begin(r.event == Event::SyncBegin ? "B" : "E", t.tid, r.time);
+        os << ",\"cat\":\"sync\",\"name\":";
+        writeString(os, nameOf(r.arg));
+        os << "}";
+        break;
+      case Event::BarrierBegin:
+      case Event::BarrierEnd:
+        if (!keep(r.event == Event::BarrierBegin))
+          break;
+        begin(r.event == Event::BarrierBegin ? "B" : "E", t.tid, r.time);
+        os << ",\"cat\":\"barrier\",\"name\":\"barrier\"}";
+        break;
+      case Event::ChunkGrab:
+        begin("i", t.tid, r.time);
+        os << ",\"s\":\"t\",\"cat\":\"work\",\"name\":\"chunk\","
+           << "\"args\":{\"size\":" << r.arg << "}}";
+        break;
+      case Event::Steal:
+        begin("i", t.tid, r.time);
+        os << ",\"s\":\"t\",\"cat\":\"work\",\"name\":\"steal\","
+           << "\"args\":{\"victim\":" << r.arg << "}}";
+        break;
+      case Event::Push:
+        begin("i", t.tid, r.time);
+        os << ",\"s\":\"t\",\"cat\":\"worklist\",\"name\":\"push\","
+           << "\"args\":{\"size\":" << r.arg << "}}";
+        break;
+      case Event::Pop:
+        begin("i", t.tid, r.time);
+        os << ",\"s\":\"t\",\"cat\":\"worklist\",\"name\":\"pop\","
+           << "\"args\":{\"size\":" << r.arg << "}}";
+        break;
+      case Event::CommitRatio:
+        begin("C", t.tid, r.time);
+        os << ",\"cat\":\"conflicts\",\"name\":\"commit ratio\","
+           << "\"args\":{\"per_mille\":" << r.arg << "}}";
+        break;
+      case Event::SpeculativeThreads:
+        begin("C", t.tid, r.time);
+        os << ",\"cat\":\"conflicts\",\"name\":\"speculative threads\","
+           << "\"args\":{\"threads\":" << r.arg << "}}";
+        break;
+      }
+    }
+  }
+  os << "\n]}\n";
+}
+
+bool isJSONFile(const std::string& f) {
+  const std::string ext = ".json";
+  return f.size() >= ext.size() &&
+         f.compare(f.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+/**
+ * In distributed runs every host but the first writes to a file with its
+ * host id inserted before the extension.
+ */
+std::string outputName(const std::string& f) {
+  uint32_t host = galois::runtime::getHostID();
+  if (host == 0) {
+    return f;
+  }
+  size_t dot   = f.rfind('.');
+  size_t slash = f.rfind('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+    return f + "." + std::to_string(host);
+  }
+  return f.substr(0, dot) + "." + std::to_string(host) + f.substr(dot);
+}
+
+} // namespace
+
+bool galois::runtime::timeline::internal::enabled = false;
+
+void galois::runtime::timeline::internal::record(Event event, uint32_t arg) {
+  Buffer* b = getLocalBuffer();
+  uint64_t time =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          clockTy::now() - state->startTime)
+          .count();
+  b->push(Record{time, arg, event});
+}
+
+uint32_t galois::runtime::timeline::internal::intern(const char* name) {
+  std::lock_guard<galois::substrate::SimpleLock> lg(state->lock);
+  auto ii = state->nameIds.find(name);
+  if (ii != state->nameIds.end()) {
+    return ii->second;
+  }
+  uint32_t id = state->names.size();
+  state->names.emplace_back(name);
+  state->nameIds.emplace(name, id);
+  return id;
+}
+
+void galois::runtime::timeline::start() {
+  std::string outfile;
+  if (!substrate::EnvCheck(TIMELINE_ENV_VAR, outfile) || outfile.empty()) {
+    return;
+  }
+
+  int capacity = DEFAULT_CAPACITY;
+  substrate::EnvCheck(TIMELINE_EVENTS_ENV_VAR, capacity);
+  if (capacity <= 0) {
+    capacity = DEFAULT_CAPACITY;
+  }
+
+  delete state;
+  state            = new TimelineState();
+  state->outfile   = outfile;
+  state->capacity  = capacity;
+  state->startTime = clockTy::now();
+  // id 0 is used by spans without a name, e.g., barriers
+  state->names.emplace_back("");
+  state->nameIds.emplace("", 0);
+
+  ++generation;
+  internal::enabled = true;
+}
+
+void galois::runtime::timeline::finish() {
+  if (!internal::enabled) {
+    return;
+  }
+  internal::enabled = false;
+
+  std::vector<ThreadEvents> threads = collect();
+  std::string outfile               = outputName(state->outfile);
+  std::ofstream out(outfile, std::ios_base::out | std::ios_base::binary);
+  if (!out.good()) {
+    gWarn("Could not open timeline file for writing: ", outfile);
+  } else if (isJSONFile(outfile)) {
+    writeJSON(out, state->names, threads);
+  } else {
+    writeBinary(out, state->names, threads);
+  }
+
+  delete state;
+  state = nullptr;
+}
+
+bool galois::runtime::timeline::convertToJSON(const std::string& binaryFile,
+                                              const std::string& jsonFile) {
+  std::ifstream in(binaryFile, std::ios_base::in | std::ios_base::binary);
+  std::vector<std::string> names;
+  std::vector<ThreadEvents> threads;
+  if (!in.good() || !readBinary(in, names, threads)) {
+    return false;
+  }
+
+  std::ofstream out(jsonFile);
+  if (!out.good()) {
+    return false;
+  }
+  writeJSON(out, names, threads);
+  return out.good();
+}
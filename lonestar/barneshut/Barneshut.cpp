@@ -20,6 +20,7 @@
 #include "galois/Galois.h"
 #include "galois/Timer.h"
 #include "galois/Bag.h"
+#include "galois/LargeArray.h"
 #include "galois/Reduction.h"
 #include "Lonestar/BoilerPlate.h"
 #include "galois/runtime/Profile.h"
@@ -53,6 +54,12 @@ static llvm::cl::opt<int>
 static llvm::cl::opt<int> seed("seed",
                                llvm::cl::desc("Random seed (default value 7)"),
                                llvm::cl::init(7));
+static llvm::cl::opt<bool>
+    mortonTree("morton",
+               llvm::cl::desc("Build the octree from Morton-sorted bodies "
+                              "into a contiguous node array and compute "
+                              "forces in Morton order (default false)"),
+               llvm::cl::init(false));
 
 struct Node {
   Point pos;
@@ -338,6 +345,335 @@ struct ComputeForces {
   }
 };
 
+/******************************************************************************/
+/* Morton-ordered octree */
+/******************************************************************************/
+
+//! Bits per coordinate in a Morton key; also the deepest octree level
+constexpr static const unsigned MORTON_BITS = 21;
+//! Bodies whose forces are computed by one task; neighbors in Morton order
+//! traverse nearly the same part of the tree
+constexpr static const unsigned MORTON_CHUNK_SIZE = 64;
+//! Radix sort digit width
+constexpr static const unsigned RADIX_BITS = 8;
+
+/**
+ * Spread the low MORTON_BITS bits of v so that two zero bits separate
+ * consecutive bits.
+ */
+inline uint64_t spreadBits(uint64_t v) {
+  v &= (1u << MORTON_BITS) - 1;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8) & 0x100f00f00f00f00fULL;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2) & 0x1249249249249249ULL;
+  return v;
+}
+
+//! Octant of a key at an octree level (level 0 splits the root cell)
+inline unsigned mortonDigit(uint64_t key, unsigned level) {
+  return (key >> (3 * (MORTON_BITS - 1 - level))) & 7;
+}
+
+struct KeyedBody {
+  uint64_t key;
+  Body* body;
+};
+
+/**
+ * Stable parallel LSD radix sort of bodies by Morton key. Each pass builds
+ * per-thread digit histograms over a block of the input, prefix sums them
+ * serially and scatters each block to its own slots.
+ */
+void radixSortBodies(std::vector<KeyedBody>& data,
+                     std::vector<KeyedBody>& tmp) {
+  constexpr unsigned numBuckets = 1u << RADIX_BITS;
+  const unsigned numThreads     = galois::getActiveThreads();
+  std::vector<std::array<size_t, numBuckets>> offsets(numThreads);
+  tmp.resize(data.size());
+
+  for (unsigned shift = 0; shift < 3 * MORTON_BITS; shift += RADIX_BITS) {
+    galois::on_each([&](unsigned tid, unsigned nthreads) {
+      std::array<size_t, numBuckets>& hist = offsets[tid];
+      hist.fill(0);
+      auto r = galois::block_range(data.begin(), data.end(), tid, nthreads);
+      for (auto ii = r.first; ii != r.second; ++ii) {
+        ++hist[(ii->key >> shift) & (numBuckets - 1)];
+      }
+    });
+
+    size_t sum = 0;
+    for (unsigned d = 0; d < numBuckets; ++d) {
+      for (unsigned t = 0; t < numThreads; ++t) {
+        size_t count  = offsets[t][d];
+        offsets[t][d] = sum;
+        sum += count;
+      }
+    }
+
+    galois::on_each([&](unsigned tid, unsigned nthreads) {
+      std::array<size_t, numBuckets>& pos = offsets[tid];
+      auto r = galois::block_range(data.begin(), data.end(), tid, nthreads);
+      for (auto ii = r.first; ii != r.second; ++ii) {
+        tmp[pos[(ii->key >> shift) & (numBuckets - 1)]++] = *ii;
+      }
+    });
+
+    std::swap(data, tmp);
+  }
+}
+
+/**
+ * Node of the Morton octree. The children of a node are adjacent in the node
+ * array. Chains of single-child cells are collapsed, so a node records the
+ * octree level of its cell for the opening criterion.
+ */
+struct MortonNode {
+  Point pos; // center of mass
+  double mass;
+  uint32_t first;     // first child; index of the body for a leaf
+  uint32_t nChildren; // 0 for a leaf
+  uint32_t level;
+};
+
+/**
+ * Octree built from bodies sorted by Morton key into one contiguous node
+ * array, one tree depth per parallel round. Since all nodes of a depth are
+ * created in the same round, each depth occupies a contiguous range of the
+ * array and centers of mass are summarized bottom-up one depth at a time.
+ */
+struct MortonOctree {
+  //! bodies in Morton order; leaves refer to bodies by index in this array
+  std::vector<KeyedBody> sorted;
+  std::vector<KeyedBody> scratch;
+  galois::LargeArray<MortonNode> nodes;
+  //! start of each depth's node range, plus one past the last node
+  std::vector<uint32_t> depthStart;
+  //! opening threshold (squared) of a cell at each octree level
+  std::array<double, MORTON_BITS + 1> levelDsq;
+
+  struct Task {
+    uint32_t node;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t level;
+  };
+
+  void makeLeaf(uint32_t index, uint32_t bodyIndex) {
+    MortonNode& leaf = nodes[index];
+    leaf.pos         = sorted[bodyIndex].body->pos;
+    leaf.mass        = sorted[bodyIndex].body->mass;
+    leaf.first       = bodyIndex;
+    leaf.nChildren   = 0;
+    leaf.level       = MORTON_BITS;
+  }
+
+  void computeKeys(BodyPtrs& pBodies, const BoundingBox& box) {
+    sorted.clear();
+    for (Body* b : pBodies) {
+      sorted.push_back(KeyedBody{0, b});
+    }
+
+    Point extent = box.max - box.min;
+    double side  = std::max(extent[0], std::max(extent[1], extent[2]));
+    double scale = side > 0.0 ? (1u << MORTON_BITS) / side : 0.0;
+    const uint64_t maxCoord = (1u << MORTON_BITS) - 1;
+
+    galois::do_all(
+        galois::iterate(sorted),
+        [&](KeyedBody& kb) {
+          uint64_t key = 0;
+          for (int i = 0; i < 3; ++i) {
+            uint64_t c = (kb.body->pos[i] - box.min[i]) * scale;
+            key |= spreadBits(std::min(c, maxCoord)) << i;
+          }
+          kb.key = key;
+        },
+        galois::loopname("MortonKeys"));
+
+    for (unsigned l = 0; l <= MORTON_BITS; ++l) {
+      double cell = side / (double)(1u << l);
+      levelDsq[l] = cell * cell * config.itolsq;
+    }
+  }
+
+  void build(BodyPtrs& pBodies, const BoundingBox& box, size_t nbodies) {
+    computeKeys(pBodies, box);
+
+    galois::StatTimer T_sort("MortonSortTime");
+    T_sort.start();
+    radixSortBodies(sorted, scratch);
+    T_sort.stop();
+
+    // every internal node has at least two children
+    size_t maxNodes = std::max<size_t>(2 * nbodies, 1);
+    if (nodes.size() < maxNodes) {
+      nodes.deallocate();
+      nodes.allocateInterleaved(maxNodes);
+    }
+    depthStart.assign(1, 0);
+
+    if (nbodies == 0) {
+      // an empty root, so that the tree has a center of mass
+      nodes[0] = MortonNode{Point(), 0.0, 0, 0, 0};
+      depthStart.push_back(1);
+      return;
+    }
+
+    if (sorted.size() == 1) {
+      makeLeaf(0, 0);
+      depthStart.push_back(1);
+      return;
+    }
+
+    std::atomic<uint32_t> nextFree(1);
+    galois::InsertBag<Task> current;
+    galois::InsertBag<Task> next;
+    next.push(Task{0, 0, (uint32_t)sorted.size(), 0});
+
+    while (!next.empty()) {
+      std::swap(current, next);
+      next.clear();
+      depthStart.push_back(nextFree);
+
+      galois::do_all(
+          galois::iterate(current),
+          [&](const Task& t) {
+            // skip levels on which all bodies fall in the same octant;
+            // sorted keys make checking the extremes sufficient
+            uint32_t level = t.level;
+            while (level < MORTON_BITS &&
+                   mortonDigit(sorted[t.begin].key, level) ==
+                       mortonDigit(sorted[t.end - 1].key, level)) {
+              ++level;
+            }
+
+            std::array<uint32_t, 9> bounds;
+            uint32_t nChildren = 0;
+            if (level == MORTON_BITS) {
+              // identical keys; every body becomes a child leaf
+              nChildren = t.end - t.begin;
+            } else {
+              bounds[0] = t.begin;
+              for (unsigned d = 0; d < 8; ++d) {
+                auto split = std::partition_point(
+                    sorted.begin() + bounds[nChildren],
+                    sorted.begin() + t.end, [&](const KeyedBody& kb) {
+                      return mortonDigit(kb.key, level) <= d;
+                    });
+                uint32_t end = split - sorted.begin();
+                if (end != bounds[nChildren]) {
+                  bounds[++nChildren] = end;
+                }
+              }
+            }
+
+            uint32_t first  = nextFree.fetch_add(nChildren);
+            MortonNode& n   = nodes[t.node];
+            n.first         = first;
+            n.nChildren     = nChildren;
+            n.level         = level;
+
+            for (uint32_t c = 0; c < nChildren; ++c) {
+              uint32_t b = (level == MORTON_BITS) ? t.begin + c : bounds[c];
+              uint32_t e = (level == MORTON_BITS) ? b + 1 : bounds[c + 1];
+              if (e - b == 1) {
+                makeLeaf(first + c, b);
+              } else {
+                next.push(Task{first + c, b, e, level + 1});
+              }
+            }
+          },
+          galois::steal(), galois::loopname("MortonBuild"));
+    }
+    depthStart.push_back(nextFree);
+  }
+
+  //! Compute centers of mass from the deepest depth up to the root
+  void summarize() {
+    for (size_t d = depthStart.size() - 1; d-- > 0;) {
+      galois::do_all(
+          galois::iterate(depthStart[d], depthStart[d + 1]),
+          [&](uint32_t i) {
+            MortonNode& n = nodes[i];
+            if (n.nChildren == 0) {
+              return;
+            }
+            double mass = 0.0;
+            Point accum;
+            for (uint32_t c = n.first; c < n.first + n.nChildren; ++c) {
+              mass += nodes[c].mass;
+              accum += nodes[c].pos * nodes[c].mass;
+            }
+            n.mass = mass;
+            if (mass > 0.0)
+              n.pos = accum / mass;
+          },
+          galois::loopname("MortonSummarize"));
+    }
+  }
+
+  size_t size() const { return depthStart.back(); }
+
+  const Point& centerOfMass() const { return nodes[0].pos; }
+
+  void computeForce(uint32_t self, Body& b) const {
+    // at most 7 pending siblings per level plus the node being expanded
+    std::array<uint32_t, 8 * (MORTON_BITS + 1)> stack;
+    unsigned top = 0;
+    Point acc(0.0, 0.0, 0.0);
+
+    if (nodes[0].nChildren != 0) {
+      stack[top++] = 0;
+    }
+
+    while (top) {
+      const MortonNode& n = nodes[stack[--top]];
+      Point p    = b.pos - n.pos;
+      double psq = p.dist2();
+
+      // Node is far enough away, summarize contribution
+      if (psq >= levelDsq[n.level]) {
+        acc += updateForce(p, psq, n.mass);
+        continue;
+      }
+
+      // siblings are adjacent: fetch the whole block before touching it
+      const MortonNode* children = &nodes[n.first];
+      const char* block = reinterpret_cast<const char*>(children);
+      for (size_t off = 0; off < n.nChildren * sizeof(MortonNode); off += 64) {
+        __builtin_prefetch(block + off);
+      }
+
+      for (uint32_t c = 0; c < n.nChildren; ++c) {
+        const MortonNode& child = children[c];
+        if (child.nChildren == 0) {
+          if (child.first != self) {
+            Point q = b.pos - child.pos;
+            acc += updateForce(q, q.dist2(), child.mass);
+          }
+        } else {
+          assert(top < stack.size());
+          stack[top++] = n.first + c;
+        }
+      }
+    }
+
+    Point prev = b.acc;
+    b.acc      = acc;
+    b.vel += (b.acc - prev) * config.dthf;
+  }
+
+  void computeForces() {
+    galois::do_all(
+        galois::iterate(size_t{0}, sorted.size()),
+        [&](size_t i) { computeForce(i, *sorted[i].body); },
+        galois::steal(), galois::chunk_size<MORTON_CHUNK_SIZE>(),
+        galois::loopname("compute"));
+  }
+};
+
 struct centerXCmp {
   template <typename T>
   bool operator()(const T& lhs, const T& rhs) const {
@@ -478,6 +814,9 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
                        galois::runtime::pagePoolSize());
   galois::reportPageAlloc("MeminfoPre");
 
+  // reused across steps so its arrays are only allocated once
+  MortonOctree mortonOctree;
+
   for (int step = 0; step < ntimesteps; step++) {
 
     auto MB = [](BoundingBox& lhs, const Point& rhs) { lhs.merge(rhs); };
@@ -492,37 +831,62 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
     BoundingBox box = boxes.reduce(
         [](BoundingBox& lhs, BoundingBox& rhs) { lhs.merge(rhs); });
 
-    Tree t;
-    BuildOctree treeBuilder{t};
-    Octree& top = t.emplace(box.center());
+    Point centerOfMass;
 
-    galois::StatTimer T_build("BuildTime");
-    T_build.start();
-    galois::do_all(
-        galois::iterate(pBodies),
-        [&](Body* body) { treeBuilder.insert(body, &top, box.radius()); },
-        galois::loopname("BuildTree"));
-    T_build.stop();
-
-    // update centers of mass in tree
-    galois::timeThis(
-        [&](void) {
-          unsigned size = computeCenterOfMass(&top);
-          // printTree(&top);
-          std::cout << "Tree Size: " << size << "\n";
-        },
-        "summarize-Serial");
+    if (mortonTree) {
+      galois::StatTimer T_build("BuildTime");
+      T_build.start();
+      mortonOctree.build(pBodies, box, nbodies);
+      T_build.stop();
 
-    ComputeForces cf(&top, box.diameter());
+      galois::timeThis(
+          [&](void) {
+            mortonOctree.summarize();
+            std::cout << "Tree Size: " << mortonOctree.size() << "\n";
+          },
+          "summarize-Parallel");
+
+      galois::StatTimer T_compute("ComputeTime");
+      T_compute.start();
+      mortonOctree.computeForces();
+      T_compute.stop();
+
+      centerOfMass = mortonOctree.centerOfMass();
+    } else {
+      Tree t;
+      BuildOctree treeBuilder{t};
+      Octree& top = t.emplace(box.center());
+
+      galois::StatTimer T_build("BuildTime");
+      T_build.start();
+      galois::do_all(
+          galois::iterate(pBodies),
+          [&](Body* body) { treeBuilder.insert(body, &top, box.radius()); },
+          galois::loopname("BuildTree"));
+      T_build.stop();
+
+      // update centers of mass in tree
+      galois::timeThis(
+          [&](void) {
+            unsigned size = computeCenterOfMass(&top);
+            // printTree(&top);
+            std::cout << "Tree Size: " << size << "\n";
+          },
+          "summarize-Serial");
 
-    galois::StatTimer T_compute("ComputeTime");
-    T_compute.start();
-    galois::for_each(galois::iterate(pBodies),
-                     [&](Body* b, auto& cnx) { cf.computeForce(b, cnx); },
-                     galois::loopname("compute"), galois::wl<WLL>(),
-                     galois::no_conflicts(), galois::no_pushes(),
-                     galois::per_iter_alloc());
-    T_compute.stop();
+      ComputeForces cf(&top, box.diameter());
+
+      galois::StatTimer T_compute("ComputeTime");
+      T_compute.start();
+      galois::for_each(galois::iterate(pBodies),
+                       [&](Body* b, auto& cnx) { cf.computeForce(b, cnx); },
+                       galois::loopname("compute"), galois::wl<WLL>(),
+                       galois::no_conflicts(), galois::no_pushes(),
+                       galois::per_iter_alloc());
+      T_compute.stop();
+
+      centerOfMass = top.pos;
+    }
 
     if (!skipVerify) {
       galois::timeThis(
@@ -549,7 +913,7 @@ void run(Bodies& bodies, BodyPtrs& pBodies, size_t nbodies) {
     std::ios::fmtflags flags =
         std::cout.setf(std::ios::showpos | std::ios::right |
                        std::ios::scientific | std::ios::showpoint);
-    std::cout << top.pos;
+    std::cout << centerOfMass;
     std::cout.flags(flags);
     std::cout << "\n";
   }
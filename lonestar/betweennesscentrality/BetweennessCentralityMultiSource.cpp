@@ -0,0 +1,559 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2019, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+constexpr static const char* const REGION_NAME = "BC";
+
+#include <limits>
+#include <fstream>
+#include "galois/gstl.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/DynamicBitset.h"
+#include "galois/LargeArray.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/graphs/B_LC_CSR_Graph.h"
+#include "galois/substrate/PerThreadStorage.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+
+// type of the num shortest paths variable
+using ShortPathType = double;
+
+/******************************************************************************/
+/* Declaration of command line arguments */
+/******************************************************************************/
+namespace cll = llvm::cl;
+static cll::opt<std::string>
+    filename(cll::Positional, cll::desc("<input graph>"), cll::Required);
+static cll::opt<std::string>
+    sourcesToUse("sourcesToUse",
+                 cll::desc("Whitespace separated list of sources in a file to "
+                           "use in BC (default empty)"),
+                 cll::init(""));
+static cll::opt<unsigned long long>
+    startSource("startNode", // not uint64_t due to a bug in llvm cl
+                cll::desc("First source node used for betweeness-centrality "
+                          "when no source file is given (default 0)"),
+                cll::init(0));
+static cll::opt<unsigned int>
+    numberOfSources("numOfSources",
+                    cll::desc("Number of sources to use for "
+                              "betweeness-centraility (default all)"),
+                    cll::init(0));
+static cll::opt<unsigned int>
+    batchSize("batchSize",
+              cll::desc("Number of sources processed together in one sweep; "
+                        "must be a multiple of 64 (default 64)"),
+              cll::init(64));
+static cll::opt<bool> verify("verify",
+                             cll::desc("Flag to verify (default: false)"),
+                             cll::init(false));
+
+/******************************************************************************/
+/* Graph structure declarations */
+/******************************************************************************/
+const uint32_t infinity = std::numeric_limits<uint32_t>::max() / 4;
+
+struct NodeData {
+  float bc;
+};
+
+// reading in list of sources to operate on if provided
+std::ifstream sourceFile;
+std::vector<uint64_t> sourceVector;
+
+// forward phase pulls over in-edges, backward phase over out-edges
+using Graph = galois::graphs::B_LC_CSR_Graph<NodeData, void, false, true>;
+using GNode = Graph::GraphNode;
+using WorklistType = galois::InsertBag<GNode, 4096>;
+
+constexpr static const unsigned CHUNK_SIZE = 256u;
+//! Number of sources tracked by one frontier word
+constexpr static const unsigned BITS_PER_WORD = 64u;
+
+/**
+ * Per-(node, source) state of one batch of sources.
+ *
+ * Every array is laid out node-major: the values of all sources of the batch
+ * for one node are contiguous, so the per-edge work of a sweep is a dense
+ * loop over the batch that the compiler can vectorize. Memory is
+ * O(nodes * batch size) no matter how many sources are processed overall.
+ */
+struct BatchState {
+  //! sources in the batch
+  unsigned numSources;
+  //! 64-bit words per node in the bitmask arrays
+  unsigned numWords;
+
+  //! sources that have reached a node
+  galois::LargeArray<uint64_t> seen;
+  //! sources that reached a node in the current level
+  galois::LargeArray<uint64_t> frontier;
+  //! sources that reach a node in the next level
+  galois::LargeArray<uint64_t> next;
+  //! BFS level of a node for each source
+  galois::LargeArray<uint32_t> distance;
+  //! number of shortest paths to a node for each source
+  galois::LargeArray<ShortPathType> numShortestPaths;
+  //! Brandes dependency of a node for each source
+  galois::LargeArray<float> dependency;
+  //! nodes already added to the next level's worklist
+  galois::DynamicBitSet inNextLevel;
+
+  BatchState(size_t numNodes, unsigned _numSources)
+      : numSources(_numSources), numWords(_numSources / BITS_PER_WORD) {
+    seen.allocateInterleaved(numNodes * numWords);
+    frontier.allocateInterleaved(numNodes * numWords);
+    next.allocateInterleaved(numNodes * numWords);
+    distance.allocateInterleaved(numNodes * numSources);
+    numShortestPaths.allocateInterleaved(numNodes * numSources);
+    dependency.allocateInterleaved(numNodes * numSources);
+    inNextLevel.resize(numNodes);
+  }
+
+  //! @returns bytes used by the batch state
+  size_t memoryFootprint() const {
+    size_t bitmaskBytes = 3 * seen.size() * sizeof(uint64_t);
+    size_t valueBytes   = distance.size() * (sizeof(uint32_t) +
+                          sizeof(ShortPathType) + sizeof(float));
+    return bitmaskBytes + valueBytes + inNextLevel.size() / CHAR_BIT;
+  }
+};
+
+/******************************************************************************/
+/* Functions for running the algorithm */
+/******************************************************************************/
+/**
+ * Initialize node fields all to 0
+ * @param graph Graph to initialize
+ */
+void InitializeGraph(Graph& graph) {
+  galois::do_all(
+    galois::iterate(graph),
+    [&] (GNode n) {
+      graph.getData(n).bc = 0;
+    },
+    galois::no_stats(),
+    galois::loopname("InitializeGraph")
+  );
+}
+
+/**
+ * Resets the batch state and seeds the sources of a new batch.
+ *
+ * @param graph Graph being operated on
+ * @param state Batch state to reset
+ * @param sources Sources of the batch; may be fewer than the batch size
+ * @param firstLevel Worklist that receives the (distinct) source nodes
+ */
+void InitializeBatch(Graph& graph, BatchState& state,
+                     const std::vector<GNode>& sources,
+                     WorklistType& firstLevel) {
+  const unsigned numWords   = state.numWords;
+  const unsigned numSources = state.numSources;
+
+  galois::do_all(
+    galois::iterate(graph),
+    [&] (GNode n) {
+      for (unsigned w = 0; w < numWords; w++) {
+        state.seen[(size_t)n * numWords + w]     = 0;
+        state.frontier[(size_t)n * numWords + w] = 0;
+        state.next[(size_t)n * numWords + w]     = 0;
+      }
+      for (unsigned s = 0; s < numSources; s++) {
+        state.distance[(size_t)n * numSources + s]         = infinity;
+        state.numShortestPaths[(size_t)n * numSources + s] = 0;
+        state.dependency[(size_t)n * numSources + s]       = 0;
+      }
+    },
+    galois::no_stats(),
+    galois::loopname("InitializeBatch")
+  );
+
+  // the same node may be the source of several lanes
+  for (unsigned s = 0; s < sources.size(); s++) {
+    GNode src = sources[s];
+    uint64_t bit = (uint64_t)1 << (s % BITS_PER_WORD);
+
+    if (!state.inNextLevel.set(src)) {
+      firstLevel.push(src);
+    }
+    state.seen[(size_t)src * numWords + s / BITS_PER_WORD]     |= bit;
+    state.frontier[(size_t)src * numWords + s / BITS_PER_WORD] |= bit;
+    state.distance[(size_t)src * numSources + s]               = 0;
+    state.numShortestPaths[(size_t)src * numSources + s]       = 1;
+  }
+
+  for (GNode src : sources) {
+    state.inNextLevel.reset(src);
+  }
+}
+
+/**
+ * Forward phase: multi-source BFS with bitmask frontiers. Each level first
+ * pushes frontier bits along out-edges (an atomic OR per edge and word), then
+ * every newly reached node pulls the shortest path counts of all its sources
+ * at once over its in-edges, so no path count is ever updated atomically.
+ *
+ * @returns stack of per-level worklists, last one empty
+ */
+galois::gstl::Vector<WorklistType> MultiSourceBFS(Graph& graph,
+                                                  BatchState& state,
+                                                  const std::vector<GNode>&
+                                                      sources) {
+  const unsigned numWords   = state.numWords;
+  const unsigned numSources = state.numSources;
+
+  galois::gstl::Vector<WorklistType> stackOfWorklists;
+  uint32_t currentLevel = 0;
+
+  stackOfWorklists.emplace_back();
+  InitializeBatch(graph, state, sources, stackOfWorklists[0]);
+
+  while (!stackOfWorklists[currentLevel].empty()) {
+    stackOfWorklists.emplace_back();
+    uint32_t nextLevel = currentLevel + 1;
+    WorklistType& currentWorklist = stackOfWorklists[currentLevel];
+    WorklistType& nextWorklist    = stackOfWorklists[nextLevel];
+
+    // expand frontier bits to unseen (node, source) pairs
+    galois::do_all(
+      galois::iterate(currentWorklist),
+      [&] (GNode n) {
+        const uint64_t* curFrontier = &state.frontier[(size_t)n * numWords];
+
+        for (auto e : graph.edges(n)) {
+          GNode dest = graph.getEdgeDst(e);
+          bool reached = false;
+
+          for (unsigned w = 0; w < numWords; w++) {
+            uint64_t newBits = curFrontier[w] &
+                               ~state.seen[(size_t)dest * numWords + w];
+            if (newBits) {
+              uint64_t& destNext = state.next[(size_t)dest * numWords + w];
+              if ((destNext & newBits) != newBits) {
+                __sync_fetch_and_or(&destNext, newBits);
+              }
+              reached = true;
+            }
+          }
+
+          // only 1 thread should add to worklist
+          if (reached && !state.inNextLevel.set(dest)) {
+            nextWorklist.push(dest);
+          }
+        }
+      },
+      galois::steal(),
+      galois::chunk_size<CHUNK_SIZE>(),
+      galois::no_stats(),
+      galois::loopname("MSBFSExpand")
+    );
+
+    // newly reached nodes pull path counts from in-neighbors on the frontier
+    galois::do_all(
+      galois::iterate(nextWorklist),
+      [&] (GNode n) {
+        const uint64_t* newBits = &state.next[(size_t)n * numWords];
+        ShortPathType* paths    = &state.numShortestPaths[(size_t)n * numSources];
+
+        for (auto e : graph.in_edges(n)) {
+          GNode src = graph.getInEdgeDst(e);
+          const uint64_t* srcFrontier   = &state.frontier[(size_t)src * numWords];
+          const ShortPathType* srcPaths =
+              &state.numShortestPaths[(size_t)src * numSources];
+
+          for (unsigned w = 0; w < numWords; w++) {
+            uint64_t bits = srcFrontier[w] & newBits[w];
+            if (!bits) {
+              continue;
+            }
+
+            unsigned base = w * BITS_PER_WORD;
+            for (unsigned b = 0; b < BITS_PER_WORD; b++) {
+              paths[base + b] += ((bits >> b) & 1) ? srcPaths[base + b] : 0;
+            }
+          }
+        }
+
+        uint32_t* dists = &state.distance[(size_t)n * numSources];
+        for (unsigned w = 0; w < numWords; w++) {
+          uint64_t bits = newBits[w];
+          unsigned base = w * BITS_PER_WORD;
+          for (unsigned b = 0; b < BITS_PER_WORD; b++) {
+            if ((bits >> b) & 1) {
+              dists[base + b] = nextLevel;
+            }
+          }
+        }
+      },
+      galois::steal(),
+      galois::chunk_size<CHUNK_SIZE>(),
+      galois::no_stats(),
+      galois::loopname("MSBFSPaths")
+    );
+
+    // retire current frontier; next level's bits become the frontier
+    galois::do_all(
+      galois::iterate(currentWorklist),
+      [&] (GNode n) {
+        for (unsigned w = 0; w < numWords; w++) {
+          state.frontier[(size_t)n * numWords + w] = 0;
+        }
+      },
+      galois::no_stats(),
+      galois::loopname("MSBFSRetire")
+    );
+    galois::do_all(
+      galois::iterate(nextWorklist),
+      [&] (GNode n) {
+        state.inNextLevel.reset(n);
+        for (unsigned w = 0; w < numWords; w++) {
+          uint64_t bits = state.next[(size_t)n * numWords + w];
+          state.seen[(size_t)n * numWords + w] |= bits;
+          state.frontier[(size_t)n * numWords + w] = bits;
+          state.next[(size_t)n * numWords + w]     = 0;
+        }
+      },
+      galois::no_stats(),
+      galois::loopname("MSBFSAdvance")
+    );
+
+    currentLevel++;
+  }
+
+  return stackOfWorklists;
+}
+
+/**
+ * Backward phase: walk the level stack from the bottom up; each node pulls
+ * the dependencies of its successors for all sources of the batch that have
+ * it at the level being processed, then adds them to its BC value.
+ *
+ * @param graph Graph to do backward Brandes dependency prop on
+ */
+void MultiSourceBrandes(Graph& graph, BatchState& state,
+                        galois::gstl::Vector<WorklistType>& stackOfWorklists) {
+  const unsigned numSources = state.numSources;
+  galois::substrate::PerThreadStorage<galois::gstl::Vector<float>> scratch;
+
+  // last worklist is empty, and the one before holds leaves of every DAG
+  if (stackOfWorklists.size() < 3) {
+    return;
+  }
+
+  // level 0 is included: a source may be on any level for other sources
+  for (int64_t level = stackOfWorklists.size() - 3; level >= 0; level--) {
+    uint32_t currentLevel = level;
+    uint32_t succLevel    = level + 1;
+
+    galois::do_all(
+      galois::iterate(stackOfWorklists[currentLevel]),
+      [&] (GNode n) {
+        galois::gstl::Vector<float>& accum = *scratch.getLocal();
+        accum.assign(numSources, 0);
+
+        const uint32_t* dists = &state.distance[(size_t)n * numSources];
+
+        for (auto e : graph.edges(n)) {
+          GNode dest = graph.getEdgeDst(e);
+          const uint32_t* destDists = &state.distance[(size_t)dest * numSources];
+          const float* destDeps     = &state.dependency[(size_t)dest * numSources];
+          const ShortPathType* destPaths =
+              &state.numShortestPaths[(size_t)dest * numSources];
+
+          for (unsigned s = 0; s < numSources; s++) {
+            bool onDAG = (dists[s] == currentLevel) &&
+                         (destDists[s] == succLevel);
+            accum[s] += onDAG ? ((float)1 + destDeps[s]) / destPaths[s] : 0;
+          }
+        }
+
+        float* deps = &state.dependency[(size_t)n * numSources];
+        const ShortPathType* paths = &state.numShortestPaths[(size_t)n * numSources];
+        float bcContrib = 0;
+
+        for (unsigned s = 0; s < numSources; s++) {
+          if (dists[s] == currentLevel) {
+            deps[s] = accum[s] * paths[s];
+            // a source gets no BC from its own DAG
+            bcContrib += (currentLevel != 0) ? deps[s] : 0;
+          }
+        }
+
+        graph.getData(n).bc += bcContrib;
+      },
+      galois::steal(),
+      galois::chunk_size<CHUNK_SIZE>(),
+      galois::no_stats(),
+      galois::loopname("MSBrandes")
+    );
+  }
+}
+
+/******************************************************************************/
+/* Sanity check */
+/******************************************************************************/
+
+/**
+ * Get some sanity numbers (max, min, sum of BC)
+ *
+ * @param graph Graph to sanity check
+ */
+void Sanity(Graph& graph) {
+  galois::GReduceMax<float> accumMax;
+  galois::GReduceMin<float> accumMin;
+  galois::GAccumulator<float> accumSum;
+  accumMax.reset();
+  accumMin.reset();
+  accumSum.reset();
+
+  // get max, min, sum of BC values using accumulators and reducers
+  galois::do_all(
+    galois::iterate(graph),
+    [&] (GNode n) {
+      NodeData& nodeData = graph.getData(n);
+      accumMax.update(nodeData.bc);
+      accumMin.update(nodeData.bc);
+      accumSum += nodeData.bc;
+    },
+    galois::no_stats(),
+    galois::loopname("Sanity")
+  );
+
+  galois::gPrint("Max BC is ", accumMax.reduce(), "\n");
+  galois::gPrint("Min BC is ", accumMin.reduce(), "\n");
+  galois::gPrint("BC sum is ", accumSum.reduce(), "\n");
+}
+
+/******************************************************************************/
+/* Main method for running */
+/******************************************************************************/
+constexpr static const char* const name =
+    "Betweeness Centrality Multi-Source";
+constexpr static const char* const desc =
+    "Betweeness Centrality processing batches of sources together, using a "
+    "bit-parallel multi-source BFS and batched Brandes backward dependency "
+    "propagation.";
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, NULL);
+
+  if (batchSize == 0 || batchSize % BITS_PER_WORD != 0) {
+    GALOIS_DIE("Batch size must be a positive multiple of ", BITS_PER_WORD);
+  }
+
+  // some initial stat reporting
+  galois::gInfo("Worklist chunk size of ", CHUNK_SIZE, ": best size may depend"
+                " on input.");
+  galois::runtime::reportStat_Single(REGION_NAME, "ChunkSize", CHUNK_SIZE);
+  galois::runtime::reportStat_Single(REGION_NAME, "BatchSize",
+                                     (unsigned)batchSize);
+  galois::reportPageAlloc("MemAllocPre");
+
+  galois::StatTimer totalTimer("TimerTotal", REGION_NAME);
+  totalTimer.start();
+
+  // Graph construction
+  galois::StatTimer graphConstructTimer("TimerConstructGraph", REGION_NAME);
+  graphConstructTimer.start();
+  Graph graph;
+  galois::graphs::readGraph(graph, filename);
+  graph.constructIncomingEdges();
+  graphConstructTimer.stop();
+  galois::gInfo("Graph construction complete");
+
+  // If particular set of sources was specified, use them
+  if (sourcesToUse != "") {
+    sourceFile.open(sourcesToUse);
+    std::vector<uint64_t> t(std::istream_iterator<uint64_t>{sourceFile},
+                            std::istream_iterator<uint64_t>{});
+    sourceVector = t;
+    sourceFile.close();
+  }
+
+  // determine the sources to use based on command line args
+  std::vector<GNode> sources;
+  if (sourceVector.size() != 0) {
+    uint64_t count = sourceVector.size();
+    if (numberOfSources && numberOfSources < count) {
+      count = numberOfSources;
+    }
+    sources.assign(sourceVector.begin(), sourceVector.begin() + count);
+  } else {
+    uint64_t count = graph.size() - std::min<uint64_t>(startSource,
+                                                       graph.size());
+    if (numberOfSources && numberOfSources < count) {
+      count = numberOfSources;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+      sources.push_back(startSource + i);
+    }
+  }
+
+  // batch state is the only per-source storage and is reused by all batches
+  galois::StatTimer allocTimer("TimerAllocBatch", REGION_NAME);
+  allocTimer.start();
+  BatchState state(graph.size(), batchSize);
+  allocTimer.stop();
+  galois::gInfo("Batch state uses ", state.memoryFootprint(), " bytes");
+  galois::runtime::reportStat_Single(REGION_NAME, "BatchStateBytes",
+                                     state.memoryFootprint());
+  galois::reportPageAlloc("MemAllocMid");
+
+  // graph initialization, then main loop
+  InitializeGraph(graph);
+
+  galois::gInfo("Beginning main computation");
+  galois::StatTimer runtimeTimer;
+  uint64_t numBatches = 0;
+
+  for (size_t i = 0; i < sources.size(); i += batchSize) {
+    size_t end = std::min<size_t>(i + batchSize, sources.size());
+    std::vector<GNode> batch(sources.begin() + i, sources.begin() + end);
+
+    runtimeTimer.start();
+    // worklist; last one will be empty
+    galois::gstl::Vector<WorklistType> worklists =
+        MultiSourceBFS(graph, state, batch);
+    MultiSourceBrandes(graph, state, worklists);
+    runtimeTimer.stop();
+    numBatches++;
+  }
+  totalTimer.stop();
+  galois::runtime::reportStat_Single(REGION_NAME, "Batches", numBatches);
+  galois::reportPageAlloc("MemAllocPost");
+
+  // sanity checking numbers
+  Sanity(graph);
+
+  // Verify, i.e. print out graph data for examination
+  if (verify) {
+    char* v_out = (char*)malloc(40);
+    for (auto ii = graph.begin(); ii != graph.end(); ++ii) {
+      // outputs betweenness centrality
+      sprintf(v_out, "%u %.9f\n", (*ii), graph.getData(*ii).bc);
+      galois::gPrint(v_out);
+    }
+    free(v_out);
+  }
+
+  return 0;
+}
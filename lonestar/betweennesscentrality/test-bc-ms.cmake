@@ -0,0 +1,64 @@
+# Checks that the betweenness centrality computed by bc-ms from all sources
+# matches that of betweennesscentrality-outer. bc-ms accumulates in single
+# precision, so values may differ by 0.01% plus 0.01.
+#
+# cmake -DOUTER=<betweennesscentrality-outer> -DMS=<bc-ms> -DINPUT=<graph>
+#       -DWORKDIR=<dir> -P test-bc-ms.cmake
+
+file(MAKE_DIRECTORY ${WORKDIR})
+
+# outer writes the values of all nodes to outer_certificate_<threads>
+execute_process(
+  COMMAND ${OUTER} ${INPUT} -t 1 -printAll
+  WORKING_DIRECTORY ${WORKDIR}
+  RESULT_VARIABLE result OUTPUT_VARIABLE out ERROR_VARIABLE out)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "betweennesscentrality-outer failed: ${result}\n${out}")
+endif()
+file(STRINGS ${WORKDIR}/outer_certificate_1 expected)
+
+execute_process(
+  COMMAND ${MS} ${INPUT} -t 2 -verify
+  RESULT_VARIABLE result OUTPUT_VARIABLE out ERROR_VARIABLE err)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "bc-ms failed: ${result}\n${err}")
+endif()
+string(REGEX MATCHALL "[0-9]+ [0-9]+\\.[0-9]+\n" actual "${out}")
+
+list(LENGTH expected numExpected)
+list(LENGTH actual numActual)
+if(NOT numExpected EQUAL numActual)
+  message(FATAL_ERROR
+    "bc-ms printed ${numActual} values, expected ${numExpected}")
+endif()
+
+# "<node> <value>" to the value in thousandths
+function(parse line node milli)
+  if(NOT line MATCHES "^([0-9]+) ([0-9]+)\\.([0-9]*)")
+    message(FATAL_ERROR "cannot parse '${line}'")
+  endif()
+  string(SUBSTRING "${CMAKE_MATCH_3}000" 0 3 frac)
+  math(EXPR value "${CMAKE_MATCH_2} * 1000 + ${frac}")
+  set(${node} ${CMAKE_MATCH_1} PARENT_SCOPE)
+  set(${milli} ${value} PARENT_SCOPE)
+endfunction()
+
+math(EXPR last "${numExpected} - 1")
+foreach(i RANGE ${last})
+  list(GET expected ${i} e)
+  list(GET actual ${i} a)
+  string(STRIP "${a}" a)
+  parse("${e}" node want)
+  parse("${a}" actualNode got)
+  if(NOT node EQUAL actualNode)
+    message(FATAL_ERROR "expected node ${node}, got ${actualNode}")
+  endif()
+  math(EXPR diff "${got} - ${want}")
+  if(diff LESS 0)
+    math(EXPR diff "-${diff}")
+  endif()
+  math(EXPR tolerance "${want} / 10000 + 10")
+  if(diff GREATER tolerance)
+    message(FATAL_ERROR "node ${node}: bc-ms gives ${a}, outer gives ${e}")
+  endif()
+endforeach()
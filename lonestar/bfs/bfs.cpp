@@ -81,6 +81,16 @@ static cll::opt<Algo> algo(
                 clEnumVal(Sync2p, "Sync2p"), clEnumValEnd),
     cll::init(SyncTile));
 
+enum WorkList { PerSocketChunk, WorkStealing };
+
+static cll::opt<WorkList> worklist(
+    "wl",
+    cll::desc("Worklist of the Async algorithms (default value "
+              "PerSocketChunk):"),
+    cll::values(clEnumVal(PerSocketChunk, "PerSocketChunk"),
+                clEnumVal(WorkStealing, "WorkStealing"), clEnumValEnd),
+    cll::init(PerSocketChunk));
+
 using Graph =
     galois::graphs::LC_CSR_Graph<unsigned, void>::with_no_lockable<true>::type;
 //::with_numa_alloc<true>::type;
@@ -158,15 +168,12 @@ struct OneTilePushWrap {
   }
 };
 
-template <bool CONCURRENT, typename T, typename P, typename R>
+template <bool CONCURRENT, typename T, typename WL, typename P, typename R>
 void asyncAlgo(Graph& graph, GNode source, const P& pushWrap,
                const R& edgeRange) {
 
   namespace gwl = galois::worklists;
-  // typedef PerSocketChunkFIFO<CHUNK_SIZE> dFIFO;
-  using FIFO = gwl::PerSocketChunkFIFO<CHUNK_SIZE>;
   using BSWL = gwl::BulkSynchronous<gwl::PerSocketChunkLIFO<CHUNK_SIZE>>;
-  using WL   = FIFO;
 
   using Loop =
       typename std::conditional<CONCURRENT, galois::ForEach,
@@ -355,17 +362,36 @@ void sync2phaseAlgo(Graph& graph, GNode source, const P& pushWrap,
   }
 }
 
+template <bool CONCURRENT, typename T, typename P, typename R>
+void runAsyncAlgo(Graph& graph, GNode source, const P& pushWrap,
+                  const R& edgeRange) {
+  namespace gwl = galois::worklists;
+
+  switch (worklist) {
+  case PerSocketChunk:
+    asyncAlgo<CONCURRENT, T, gwl::PerSocketChunkFIFO<CHUNK_SIZE>>(
+        graph, source, pushWrap, edgeRange);
+    break;
+  case WorkStealing:
+    asyncAlgo<CONCURRENT, T, gwl::WorkStealingFIFO<CHUNK_SIZE>>(
+        graph, source, pushWrap, edgeRange);
+    break;
+  default:
+    std::cerr << "ERROR: unknown worklist type" << std::endl;
+  }
+}
+
 template <bool CONCURRENT>
 void runAlgo(Graph& graph, const GNode& source) {
 
   switch (algo) {
   case AsyncTile:
-    asyncAlgo<CONCURRENT, SrcEdgeTile>(
+    runAsyncAlgo<CONCURRENT, SrcEdgeTile>(
         graph, source, SrcEdgeTilePushWrap{graph}, TileRangeFn());
     break;
   case Async:
-    asyncAlgo<CONCURRENT, UpdateRequest>(graph, source, ReqPushWrap(),
-                                         OutEdgeRangeFn{graph});
+    runAsyncAlgo<CONCURRENT, UpdateRequest>(graph, source, ReqPushWrap(),
+                                            OutEdgeRangeFn{graph});
     break;
   case SyncTile:
     syncAlgo<CONCURRENT, EdgeTile>(graph, source, EdgeTilePushWrap{graph},
@@ -441,6 +441,7 @@ void run() {
   T.stop();
 
   galois::reportPageAlloc("MeminfoPost");
+  galois::reportSlabAlloc("MeminfoPost");
 
   auto get_weight = [](const Edge& e) { return *e.weight; };
 
@@ -0,0 +1,237 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/AtomicHelpers.h"
+#include "galois/Reduction.h"
+#include "galois/Bag.h"
+#include "galois/Timer.h"
+#include "galois/LargeArray.h"
+#include "galois/graphs/LCGraph.h"
+#include "llvm/Support/CommandLine.h"
+#include "Lonestar/BoilerPlate.h"
+#include "Lonestar/BatchUpdates.h"
+
+#include <utility>
+#include <vector>
+#include <iostream>
+
+const char* name = "Incremental Connected Components";
+const char* desc = "Maintains the connected components of a graph while "
+                   "batches of edges are inserted and deleted";
+const char* url  = 0;
+
+namespace cll = llvm::cl;
+static cll::opt<std::string>
+    inputFilename(cll::Positional, cll::desc("<input file (symmetric)>"),
+                  cll::Required);
+
+//! Component label in the high half and the parent in the low half
+using Graph = galois::graphs::LC_Dynamic_CSR_Graph<std::atomic<uint64_t>, void>;
+using GNode = Graph::GraphNode;
+
+/**
+ * Labels every node with the smallest node id of its component. Updates are
+ * applied in both directions.
+ *
+ * Each node also records the neighbor its label came from; these parents form
+ * a spanning forest with the smallest node of each component as the root.
+ * Deleting a non-forest edge changes nothing. Deleting a forest edge resets
+ * the subtree below it: its nodes restart from their own ids, pull the label
+ * of neighbors outside the subtree and, with the endpoints of inserted edges,
+ * seed label propagation. Other nodes keep their labels.
+ */
+struct IncrementalCC {
+  Graph& graph;
+  galois::LargeArray<std::atomic<bool>> invalid;
+  size_t numReset = 0;
+
+  explicit IncrementalCC(Graph& g) : graph(g) {
+    invalid.create(graph.size());
+    galois::do_all(galois::iterate(graph), [&](GNode n) { invalid[n] = false; },
+                   galois::no_stats());
+  }
+
+  static uint64_t pack(uint32_t label, GNode parent) {
+    return (uint64_t(label) << 32) | parent;
+  }
+  uint32_t label(GNode n) { return graph.getData(n) >> 32; }
+  GNode parent(GNode n) { return uint32_t(graph.getData(n)); }
+
+  //! Sets the label of n to l with parent p if l is smaller
+  bool lower(GNode n, uint32_t l, GNode p) {
+    std::atomic<uint64_t>& data = graph.getData(n);
+    uint64_t old                = data;
+    while ((old >> 32) > l)
+      if (data.compare_exchange_weak(old, pack(l, p)))
+        return true;
+    return false;
+  }
+
+  template <typename C>
+  void propagate(C& seeds) {
+    galois::for_each(
+        galois::iterate(seeds),
+        [&](GNode src, auto& ctx) {
+          uint32_t l = label(src);
+          for (auto ii : graph.edges(src)) {
+            GNode dst = graph.getEdgeDst(ii);
+            if (lower(dst, l, src))
+              ctx.push(dst);
+          }
+        },
+        galois::wl<galois::worklists::PerSocketChunkFIFO<64>>(),
+        galois::no_conflicts(), galois::loopname("CC-Propagate"));
+  }
+
+  void computeFromScratch() {
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) { graph.getData(n) = pack(n, n); },
+                   galois::no_stats());
+    propagate(graph);
+  }
+
+  template <typename It>
+  void update(It begin, It end) {
+    applyEdgeUpdates(graph, begin, end, UpdateDirection::Symmetric);
+
+    // roots of the subtrees cut off by deleted forest edges
+    galois::InsertBag<GNode> roots;
+    galois::InsertBag<GNode> seeds;
+    galois::do_all(galois::iterate(begin, end),
+                   [&](const EdgeUpdate& u) {
+                     if (u.insert) {
+                       seeds.push(u.src);
+                       seeds.push(u.dst);
+                     } else if (u.src != u.dst) {
+                       if (parent(u.dst) == u.src)
+                         roots.push(u.dst);
+                       if (parent(u.src) == u.dst)
+                         roots.push(u.src);
+                     }
+                   },
+                   galois::no_stats());
+
+    galois::InsertBag<GNode> reset;
+    galois::for_each(
+        galois::iterate(roots),
+        [&](GNode n, auto& ctx) {
+          if (invalid[n].exchange(true))
+            return;
+          reset.push(n);
+          for (auto ii : graph.edges(n)) {
+            GNode dst = graph.getEdgeDst(ii);
+            if (parent(dst) == n && dst != n && !invalid[dst])
+              ctx.push(dst);
+          }
+        },
+        galois::wl<galois::worklists::PerSocketChunkFIFO<64>>(),
+        galois::no_conflicts(), galois::loopname("CC-Invalidate"));
+
+    galois::do_all(galois::iterate(reset),
+                   [&](GNode n) { graph.getData(n) = pack(n, n); },
+                   galois::no_stats());
+    galois::GAccumulator<size_t> count;
+    galois::do_all(galois::iterate(reset),
+                   [&](GNode n) {
+                     for (auto ii : graph.edges(n)) {
+                       GNode dst = graph.getEdgeDst(ii);
+                       if (!invalid[dst])
+                         lower(n, label(dst), dst);
+                     }
+                     seeds.push(n);
+                     count += 1;
+                   },
+                   galois::steal(), galois::no_stats(),
+                   galois::loopname("CC-Pull"));
+    galois::do_all(galois::iterate(reset), [&](GNode n) { invalid[n] = false; },
+                   galois::no_stats());
+    numReset += count.reduce();
+
+    propagate(seeds);
+  }
+
+  //! Checks the labels against a computation from scratch
+  bool verify() {
+    std::vector<uint32_t> incremental(graph.size());
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) { incremental[n] = label(n); },
+                   galois::no_stats());
+    computeFromScratch();
+
+    std::atomic<size_t> mismatches(0);
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) {
+                     if (incremental[n] != label(n))
+                       ++mismatches;
+                   },
+                   galois::no_stats());
+    if (mismatches) {
+      std::cerr << mismatches
+                << " nodes differ from the labels computed from scratch\n";
+      return false;
+    }
+    return true;
+  }
+};
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  Graph graph;
+  galois::graphs::readGraph(graph, inputFilename);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+
+  std::vector<EdgeUpdate> updates = loadEdgeUpdates(graph);
+  IncrementalCC cc(graph);
+
+  galois::StatTimer initialTime("InitialTime");
+  initialTime.start();
+  cc.computeFromScratch();
+  initialTime.stop();
+
+  galois::StatTimer T("TotalTime");
+  T.start();
+  forEachBatch(updates, [&](auto begin, auto end) { cc.update(begin, end); });
+  T.stop();
+
+  galois::runtime::reportStat_Single("CC", "Updates", updates.size());
+  galois::runtime::reportStat_Single("CC", "ResetNodes", cc.numReset);
+
+  galois::GAccumulator<size_t> reps;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   if (cc.label(n) == n)
+                     reps += 1;
+                 },
+                 galois::no_stats());
+  std::cout << "Total components: " << reps.reduce() << "\n";
+
+  if (!skipVerify) {
+    if (cc.verify()) {
+      std::cout << "Verification successful.\n";
+    } else {
+      GALOIS_DIE("verification failed");
+    }
+  }
+
+  return 0;
+}
@@ -26,6 +26,7 @@
 #include "galois/graphs/LCGraph.h"
 #include "galois/graphs/OCGraph.h"
 #include "galois/graphs/TypeTraits.h"
+#include "galois/runtime/SegmentedExecutor.h"
 #include "galois/ParallelSTL.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
@@ -49,12 +50,15 @@ enum Algo {
   edgetiledasync,
   blockedasync,
   labelProp,
+  labelPropSegmented,
   serial,
   synchronous
 };
 
 enum OutputEdgeType { void_, int32_, int64_ };
 
+enum WorkList { PerSocketChunk, WorkStealing };
+
 namespace cll = llvm::cl;
 static cll::opt<std::string>
     inputFilename(cll::Positional, cll::desc("<input file (symmetric)>"),
@@ -88,11 +92,27 @@ static cll::opt<Algo> algo(
                            "Blocked asynchronous"),
                 clEnumValN(Algo::labelProp, "LabelProp",
                            "Using label propagation algorithm"),
+                clEnumValN(Algo::labelPropSegmented, "LabelPropSegmented",
+                           "Pull label propagation over cache-sized "
+                           "segments of the labels"),
                 clEnumValN(Algo::serial, "Serial", "Serial"),
                 clEnumValN(Algo::synchronous, "Sync", "Synchronous"),
 
                 clEnumValEnd),
     cll::init(Algo::edgetiledasync));
+static cll::opt<WorkList> worklist(
+    "wl", cll::desc("Worklist of the BlockedAsync algorithm:"),
+    cll::values(clEnumValN(WorkList::PerSocketChunk, "PerSocketChunk",
+                           "Per-socket chunked FIFO (default)"),
+                clEnumValN(WorkList::WorkStealing, "WorkStealing",
+                           "Per-thread deques with locality-biased stealing"),
+                clEnumValEnd),
+    cll::init(WorkList::PerSocketChunk));
+static cll::opt<unsigned>
+    segmentSize("segmentSize",
+                cll::desc("KB of labels read per segment of the "
+                          "LabelPropSegmented algorithm (default 1024)"),
+                cll::init(1024));
 
 struct Node : public galois::UnionFindNode<Node> {
   using component_type = Node*;
@@ -287,6 +307,37 @@ struct LabelPropAlgo {
   }
 };
 
+/**
+ * Label propagation in pull style: every round, each node takes the smallest
+ * label among itself and its neighbors. The rounds run on a
+ * SegmentedPullExecutor so that the labels read stay in cache.
+ */
+struct SegmentedLabelPropAlgo : public LabelPropAlgo {
+  void operator()(Graph& graph) {
+    galois::runtime::SegmentedPullExecutor<Graph> executor(
+        graph, size_t(segmentSize) * 1024 / sizeof(LNode));
+
+    galois::GReduceLogicalOR changed;
+    do {
+      changed.reset();
+      executor.run(
+          LABEL_INF,
+          [&](GNode dst) {
+            return graph.getData(dst, galois::MethodFlag::UNPROTECTED)
+                .comp_current.load(std::memory_order_relaxed);
+          },
+          [](component_type a, component_type b) { return std::min(a, b); },
+          [&](GNode src, component_type label) {
+            LNode& sdata = graph.getData(src, galois::MethodFlag::UNPROTECTED);
+            if (label < sdata.comp_current) {
+              sdata.comp_current = label;
+              changed.update(true);
+            }
+          });
+    } while (changed.reduce());
+  }
+};
+
 /**
  * Like synchronous algorithm, but if we restrict path compression (as done is
  * @link{UnionFindNode}), we can perform unions and finds concurrently.
@@ -544,6 +595,15 @@ struct BlockedAsyncAlgo {
     }
   }
 
+  template <typename WL>
+  void merge(Graph& graph, galois::InsertBag<WorkItem>& items) {
+    galois::for_each(galois::iterate(items),
+                     [&](const WorkItem& item, auto& ctx) {
+                       process<true, 0>(graph, item.src, item.start, ctx);
+                     },
+                     galois::loopname("Merge"), galois::wl<WL>());
+  }
+
   void operator()(Graph& graph) {
     galois::InsertBag<WorkItem> items;
 
@@ -559,12 +619,17 @@ struct BlockedAsyncAlgo {
                    },
                    galois::loopname("Initialize"));
 
-    galois::for_each(galois::iterate(items),
-                     [&](const WorkItem& item, auto& ctx) {
-                       process<true, 0>(graph, item.src, item.start, ctx);
-                     },
-                     galois::loopname("Merge"),
-                     galois::wl<galois::worklists::PerSocketChunkFIFO<128>>());
+    switch (worklist) {
+    case WorkList::PerSocketChunk:
+      merge<galois::worklists::PerSocketChunkFIFO<128>>(graph, items);
+      break;
+    case WorkList::WorkStealing:
+      merge<galois::worklists::WorkStealingFIFO<128>>(graph, items);
+      break;
+    default:
+      std::cerr << "Unknown worklist\n";
+      abort();
+    }
 
     galois::do_all(
         galois::iterate(graph),
@@ -633,7 +698,7 @@ typename Graph::node_data_type::component_type findLargest(Graph& graph) {
                  [&](const GNode& x) {
                    auto& n = graph.getData(x, galois::MethodFlag::UNPROTECTED);
 
-                   if (std::is_same<Algo, LabelPropAlgo>::value) {
+                   if (std::is_base_of<LabelPropAlgo, Algo>::value) {
                      if (n.isRepComp((unsigned int)x)) {
                        accumReps += 1;
                        return;
@@ -760,6 +825,9 @@ int main(int argc, char** argv) {
   case Algo::labelProp:
     run<LabelPropAlgo>();
     break;
+  case Algo::labelPropSegmented:
+    run<SegmentedLabelPropAlgo>();
+    break;
   case Algo::serial:
     run<SerialAlgo>();
     break;
@@ -41,21 +41,24 @@ class Cavity {
   int dim;
 
   /**
-   * find the node that is opposite the obtuse angle of the element
+   * find the node that is opposite the obtuse angle of the element; the
+   * neighborhood of node must already be acquired
    */
   GNode getOpposite(GNode node) {
-    assert(std::distance(graph->edge_begin(node), graph->edge_end(node)) == 3);
-    Element& element   = graph->getData(node, galois::MethodFlag::WRITE);
+    assert(std::distance(
+               graph->edge_begin(node, galois::MethodFlag::UNPROTECTED),
+               graph->edge_end(node, galois::MethodFlag::UNPROTECTED)) == 3);
+    Element& element   = graph->getData(node, galois::MethodFlag::UNPROTECTED);
     Tuple elementTuple = element.getObtuse();
     Edge ObtuseEdge    = element.getOppositeObtuse();
     for (Graph::edge_iterator
-             ii = graph->edge_begin(node, galois::MethodFlag::WRITE),
-             ee = graph->edge_end(node, galois::MethodFlag::WRITE);
+             ii = graph->edge_begin(node, galois::MethodFlag::UNPROTECTED),
+             ee = graph->edge_end(node, galois::MethodFlag::UNPROTECTED);
          ii != ee; ++ii) {
       GNode neighbor = graph->getEdgeDst(ii);
       // Edge& edgeData = graph->getEdgeData(node, neighbor);
       Edge edgeData = element.getRelatedEdge(
-          graph->getData(neighbor, galois::MethodFlag::WRITE));
+          graph->getData(neighbor, galois::MethodFlag::UNPROTECTED));
       if (elementTuple != edgeData.getPoint(0) &&
           elementTuple != edgeData.getPoint(1)) {
         return neighbor;
@@ -65,16 +68,17 @@ class Cavity {
     return node;
   }
 
-  void expand(GNode node, GNode next) {
-    Element& nextElement = graph->getData(next, galois::MethodFlag::WRITE);
+  //! @returns false on a conflict
+  bool expand(GNode node, GNode next) {
+    Element& nextElement =
+        graph->getData(next, galois::MethodFlag::UNPROTECTED);
     if ((!(dim == 2 && nextElement.dim() == 2 && next != centerNode)) &&
         nextElement.inCircle(center)) {
       // isMember says next is part of the cavity, and we're not the second
       // segment encroaching on this cavity
       if ((nextElement.dim() == 2) && (dim != 2)) {
         // is segment, and we are encroaching
-        initialize(next);
-        build();
+        return initialize(next) && build();
       } else {
         if (!pre.containsNode(next)) {
           pre.addNode(next);
@@ -85,49 +89,66 @@ class Cavity {
       // not a member
       // Edge& edgeData = graph->getEdgeData(node, next);
       Edge edgeData = nextElement.getRelatedEdge(
-          graph->getData(node, galois::MethodFlag::WRITE));
+          graph->getData(node, galois::MethodFlag::UNPROTECTED));
       EdgeTuple edge(node, next, edgeData);
       if (std::find(connections.begin(), connections.end(), edge) ==
           connections.end()) {
         connections.push_back(edge);
       }
     }
+    return true;
   }
 
 public:
   Cavity(Graph* g, galois::PerIterAllocTy& cnx)
       : frontier(cnx), pre(cnx), post(cnx), connections(cnx), graph(g) {}
 
-  void initialize(GNode node) {
+  /**
+   * initialize and build acquire the cavity with status-returning acquires
+   * (see galois::runtime::tryAcquire). They return false on a conflict,
+   * after which the operator must return without further side effects.
+   */
+  bool initialize(GNode node) {
     pre.reset();
     post.reset();
     connections.clear();
     frontier.clear();
-    centerNode    = node;
-    centerElement = &graph->getData(centerNode, galois::MethodFlag::WRITE);
-    while (graph->containsNode(centerNode, galois::MethodFlag::WRITE) &&
+    centerNode = node;
+    if (!graph->tryAcquireNeighborhood(centerNode))
+      return false;
+    centerElement =
+        &graph->getData(centerNode, galois::MethodFlag::UNPROTECTED);
+    while (graph->containsNode(centerNode, galois::MethodFlag::UNPROTECTED) &&
            centerElement->isObtuse()) {
-      centerNode    = getOpposite(centerNode);
-      centerElement = &graph->getData(centerNode, galois::MethodFlag::WRITE);
+      centerNode = getOpposite(centerNode);
+      if (!graph->tryAcquireNeighborhood(centerNode))
+        return false;
+      centerElement =
+          &graph->getData(centerNode, galois::MethodFlag::UNPROTECTED);
     }
     center = centerElement->getCenter();
     dim    = centerElement->dim();
     pre.addNode(centerNode);
     frontier.push_back(centerNode);
+    return true;
   }
 
-  void build() {
+  bool build() {
     while (!frontier.empty()) {
       GNode curr = frontier.back();
       frontier.pop_back();
+      if (!graph->tryAcquireNeighborhood(curr))
+        return false;
       for (Graph::edge_iterator
-               ii = graph->edge_begin(curr, galois::MethodFlag::WRITE),
-               ee = graph->edge_end(curr, galois::MethodFlag::WRITE);
+               ii = graph->edge_begin(curr, galois::MethodFlag::UNPROTECTED),
+               ee = graph->edge_end(curr, galois::MethodFlag::UNPROTECTED);
            ii != ee; ++ii) {
         GNode neighbor = graph->getEdgeDst(ii);
-        expand(curr, neighbor);
+        if (!expand(curr, neighbor))
+          return false;
       }
     }
+    return true;
   }
 
   /**
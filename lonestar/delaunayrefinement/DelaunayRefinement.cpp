@@ -66,7 +66,10 @@ void refine(galois::InsertBag<GNode>& initialBad, Graph& graph) {
   galois::for_each(
       galois::iterate(initialBad),
       [&](GNode item, auto& ctx) {
-        if (!graph.containsNode(item, galois::MethodFlag::WRITE))
+        // Cavities are acquired with status-returning acquires: on a
+        // conflict the operator returns and the executor retries item
+        if (!graph.tryAcquireNode(item) ||
+            !graph.containsNode(item, galois::MethodFlag::UNPROTECTED))
           return;
 
         if (Version == detDisjoint) {
@@ -74,8 +77,8 @@ void refine(galois::InsertBag<GNode>& initialBad, Graph& graph) {
           if (ctx.isFirstPass()) {
             LocalState* localState = ctx.template createLocalState<LocalState>(
                 graph, ctx.getPerIterAlloc());
-            localState->cav.initialize(item);
-            localState->cav.build();
+            if (!localState->cav.initialize(item) || !localState->cav.build())
+              return;
             localState->cav.computePost();
           } else {
             LocalState* localState = ctx.template getLocalState<LocalState>();
@@ -87,8 +90,8 @@ void refine(galois::InsertBag<GNode>& initialBad, Graph& graph) {
           //! [Accessing Per Iteration Allocator in DMR]
           Cavity cav(&graph, ctx.getPerIterAlloc());
           //! [Accessing Per Iteration Allocator in DMR]
-          cav.initialize(item);
-          cav.build();
+          if (!cav.initialize(item) || !cav.build())
+            return;
           cav.computePost();
           if (Version == detPrefix)
             return;
@@ -194,6 +197,7 @@ int main(int argc, char** argv) {
   T.stop();
 
   galois::reportPageAlloc("MeminfoPost");
+  galois::reportSlabAlloc("MeminfoPost");
 
   if (!skipVerify) {
     int size = galois::ParallelSTL::count_if(graph.begin(), graph.end(),
@@ -91,18 +91,19 @@ EdgeDataType runBodyParallel(Graph& graph) {
       galois::iterate(graph),
 
       [&graph, &MSTWeight](const GNode& src, auto& lwl) {
-        if (graph.containsNode(src) == false)
+        // Neighborhoods are acquired with status-returning acquires: on a
+        // conflict the operator returns and the executor retries src
+        if (!graph.tryAcquireNode(src) ||
+            !graph.containsNode(src, galois::MethodFlag::UNPROTECTED))
           return;
-        graph.getData(src, galois::MethodFlag::WRITE);
         GNode minNeighbor = 0;
 #ifdef BORUVKA_DEBUG
         std::cout << "Processing " << graph.getData(src) << std::endl;
 #endif
         EdgeDataType minEdgeWeight = std::numeric_limits<EdgeDataType>::max();
         // Acquire locks on neighborhood.
-        for (auto dit : graph.edges(src, galois::MethodFlag::WRITE)) {
-          graph.getData(graph.getEdgeDst(dit));
-        }
+        if (!graph.tryAcquireNeighborhood(src))
+          return;
         // Find minimum neighbor
         for (auto e_it : graph.edges(src, galois::MethodFlag::UNPROTECTED)) {
           EdgeDataType w =
@@ -128,9 +129,8 @@ EdgeDataType runBodyParallel(Graph& graph) {
         std::cout << " Boruvka edge added: " << tpl << std::endl;
 #endif
         // Acquire locks on neighborhood of min neighbor.
-        for (auto e_it : graph.edges(minNeighbor, galois::MethodFlag::WRITE)) {
-          graph.getData(graph.getEdgeDst(e_it));
-        }
+        if (!graph.tryAcquireNeighborhood(minNeighbor))
+          return;
         assert(minEdgeWeight >= 0);
         // update MST weight.
         MSTWeight += minEdgeWeight;
@@ -265,5 +265,6 @@ int main(int argc, char** argv) {
 	Tcomp.start();
 	FsmSolver(graph, miner);
 	Tcomp.stop();
+	miner.report_cache_stats();
 	return 0;
 }
@@ -38,6 +38,8 @@ static cll::opt<std::string> filetype(cll::Positional, cll::desc("<filetype: txt
 static cll::opt<std::string> filename(cll::Positional, cll::desc("<filename: symmetrized graph>"), cll::Required);
 static cll::opt<unsigned> k("k", cll::desc("max number of vertices in k-clique (default value 3)"), cll::init(3));
 static cll::opt<unsigned> show("s", cll::desc("print out the details"), cll::init(0));
+static cll::opt<bool> dfs("dfs", cll::desc("explore embeddings depth-first with bounded memory"), cll::init(false));
+static cll::opt<unsigned> bfs_levels("bfs-levels", cll::desc("with -dfs, levels expanded breadth-first before switching to depth-first (default value 1)"), cll::init(1));
 typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_numa_alloc<true>::type ::with_no_lockable<true>::type Graph;
 typedef Graph::GraphNode GNode;
 
@@ -128,6 +130,51 @@ void KclSolver(Graph& graph, Miner &miner) {
 	galois::gPrint("\n\ttotal_num_cliques = ", std::distance(queue.begin(), queue.end()), "\n\n");
 }
 
+// Hybrid exploration: the first bfs_levels levels are expanded breadth-first to get
+// enough tasks for load balance, then the cliques extending each embedding of the last
+// expanded level are counted depth-first by one thread without materializing them.
+void KclSolverDFS(Graph& graph, Miner &miner) {
+	if(show) std::cout << "\n=============================== Start ===============================\n";
+	BaseEmbeddingQueue queue, queue2;
+	initialization(graph, queue);
+	unsigned level = 1;
+	for (; level < k-1 && level <= bfs_levels; level ++) {
+		queue2.clear();
+		galois::for_each(
+			galois::iterate(queue),
+			[&](const BaseEmbedding& emb, auto& ctx) {
+				miner.extend_vertex_clique(emb, queue2);
+			},
+			galois::chunk_size<CHUNK_SIZE>(), galois::steal(), galois::no_conflicts(),
+			galois::wl<galois::worklists::PerSocketChunkFIFO<CHUNK_SIZE>>(),
+			galois::loopname("ExtendVertex")
+		);
+		queue.swap(queue2);
+	}
+	queue2.clear();
+
+	galois::GAccumulator<unsigned long> num_cliques;
+	LocalDfsContext dfs_ctx;
+	galois::for_each(
+		galois::iterate(queue),
+		[&](const BaseEmbedding& emb, auto& ctx) {
+			// embeddings of the last level have level + 1 vertices
+			if (level + 1 == k) {
+				num_cliques += 1;
+				return;
+			}
+			BaseEmbedding &buf = dfs_ctx.getLocal()->base_emb;
+			buf = emb;
+			num_cliques += miner.extend_vertex_clique_dfs(k, buf);
+		},
+		galois::chunk_size<1>(), galois::steal(), galois::no_conflicts(),
+		galois::wl<galois::worklists::PerSocketChunkFIFO<1>>(),
+		galois::loopname("DepthFirst")
+	);
+	if(show) std::cout << "\n=============================== Done ================================\n";
+	galois::gPrint("\n\ttotal_num_cliques = ", num_cliques.reduce(), "\n\n");
+}
+
 int main(int argc, char** argv) {
 	galois::SharedMemSys G;
 	LonestarStart(argc, argv, name, desc, url);
@@ -141,7 +188,8 @@ int main(int argc, char** argv) {
 	Miner miner(&graph);
 	galois::StatTimer Tcomp("Compute");
 	Tcomp.start();
-	KclSolver(graph, miner);
+	if (dfs) KclSolverDFS(graph, miner);
+	else KclSolver(graph, miner);
 	Tcomp.stop();
 	return 0;
 }
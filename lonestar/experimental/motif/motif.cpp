@@ -36,6 +36,8 @@ static cll::opt<std::string> filetype(cll::Positional, cll::desc("<filetype: txt
 static cll::opt<std::string> filename(cll::Positional, cll::desc("<filename: symmetrized graph>"), cll::Required);
 static cll::opt<unsigned> k("k", cll::desc("max number of vertices in k-motif(default value 0)"), cll::init(0));
 static cll::opt<unsigned> show("s", cll::desc("print out the details"), cll::init(0));
+static cll::opt<bool> dfs("dfs", cll::desc("explore embeddings depth-first with bounded memory"), cll::init(false));
+static cll::opt<unsigned> bfs_levels("bfs-levels", cll::desc("with -dfs, levels expanded breadth-first before switching to depth-first (default value 1)"), cll::init(1));
 typedef galois::graphs::LC_CSR_Graph<uint32_t, void>::with_numa_alloc<true>::type ::with_no_lockable<true>::type Graph;
 typedef Graph::GraphNode GNode;
 
@@ -68,6 +70,23 @@ void initialization(Graph& graph, EmbeddingQueue &queue) {
 	);
 }
 
+// aggregate quick patterns into canonical patterns and print out the patterns
+void canonical_aggregate(Miner &miner, QpMapFreq &qp_map, CgMapFreq &cg_map) {
+	//miner.canonical_aggregate(qp_map, cg_map);
+	// Parallel canonical pattern aggregation into one shared map
+	ConcurrentCgMapFreq cg_shared_map;
+	galois::do_all(
+		galois::iterate(qp_map),
+		[&](std::pair<QuickPattern, Frequency> qp) {
+			miner.canonical_aggregate_each(qp.first, qp.second, cg_shared_map); // canonical pattern aggregation
+		},
+		galois::chunk_size<CHUNK_SIZE>(), galois::steal(),
+		galois::loopname("CanonicalAggregation")
+	);
+	cg_shared_map.collect(cg_map);
+	miner.printout_agg(cg_map);
+}
+
 void MotifSolver(Graph& graph, Miner &miner) {
 	std::cout << "=============================== Start ===============================\n";
 	EmbeddingQueue queue, queue2; // task queues. double buffering
@@ -125,33 +144,82 @@ void MotifSolver(Graph& graph, Miner &miner) {
 
 		// Sub-step 2: aggregate on canonical patterns: gather quick patterns into different canonical patterns
 		CgMapFreq cg_map; // canonical graph map for couting the frequency
-		//miner.canonical_aggregate(qp_map, cg_map);
-		// Parallel canonical pattern aggregation
-		LocalCgMapFreq cg_localmap; // canonical graph local map for each thread
+		canonical_aggregate(miner, qp_map, cg_map);
+		queue_size = std::distance(queue.begin(), queue.end());
+		if(show) std::cout << "num_patterns: " << cg_map.size() << " num_quick_patterns: " << qp_map.size()
+					<< " num_embeddings: " << queue_size << "\n";
+		level ++;
+	}
+	std::cout << "\n=============================== Done ===============================\n\n";
+}
+
+// Hybrid exploration: the first bfs_levels levels are expanded breadth-first to get
+// enough tasks for load balance, then each embedding of the last expanded level is
+// explored depth-first by one thread. Patterns are aggregated on the fly, so no
+// level is materialized beyond bfs_levels.
+void MotifSolverDFS(Graph& graph, Miner &miner) {
+	std::cout << "=============================== Start ===============================\n";
+	EmbeddingQueue queue, queue2;
+	initialization(graph, queue);
+	unsigned max_num_edges = k * (k - 1) / 2; // maximum number of edges in k-motif (i.e. k-clique)
+	LocalDfsContext dfs_ctx;
+	galois::on_each([&](unsigned, unsigned) {
+		DfsContext &ctx = *dfs_ctx.getLocal();
+		ctx.qp_maps.resize(max_num_edges);
+		ctx.emb.reserve(max_num_edges + 1);
+	});
+
+	unsigned level = 1;
+	for (; level <= bfs_levels && level < max_num_edges; level ++) {
+		galois::for_each(
+			galois::iterate(queue),
+			[&](const Embedding& emb, auto& ctx) {
+				miner.extend_edge(k, emb, queue2);
+			},
+			galois::chunk_size<CHUNK_SIZE>(), galois::steal(), galois::no_conflicts(),
+			galois::wl<galois::worklists::PerSocketChunkFIFO<CHUNK_SIZE>>(),
+			galois::loopname("Expanding")
+		);
+		queue.swap(queue2);
+		queue2.clear();
 		galois::do_all(
-			galois::iterate(qp_map),
-			[&](std::pair<QuickPattern, Frequency> qp) {
-				miner.canonical_aggregate_each(qp.first, qp.second, *(cg_localmap.getLocal())); // canonical pattern aggregation
+			galois::iterate(queue),
+			[&](Embedding& emb) {
+				miner.quick_aggregate_each(emb, dfs_ctx.getLocal()->qp_maps[level]);
 			},
 			galois::chunk_size<CHUNK_SIZE>(), galois::steal(),
-			//galois::no_conflicts(), galois::wl<galois::worklists::PerSocketChunkFIFO<CHUNK_SIZE>>(),
-			galois::loopname("CanonicalAggregation")
+			galois::loopname("QuickAggregation")
 		);
-		// merging results sequentially
-		for (unsigned i = 0; i < cg_localmap.size(); i++) {
-			CgMapFreq cg_lmap = *cg_localmap.getLocal(i);
-			for (auto element : cg_lmap) {
-				if (cg_map.find(element.first) != cg_map.end())
-					cg_map[element.first] += element.second;
+	}
+	if (level < max_num_edges) {
+		galois::for_each(
+			galois::iterate(queue),
+			[&](const Embedding& emb, auto& ctx) {
+				DfsContext &dctx = *dfs_ctx.getLocal();
+				dctx.emb = emb;
+				miner.extend_edge_dfs(k, level, max_num_edges, dctx);
+			},
+			galois::chunk_size<1>(), galois::steal(), galois::no_conflicts(),
+			galois::wl<galois::worklists::PerSocketChunkFIFO<1>>(),
+			galois::loopname("DepthFirst")
+		);
+	}
+	queue.clear();
+
+	for (unsigned l = 1; l < max_num_edges; l ++) {
+		QpMapFreq qp_map;
+		for (unsigned i = 0; i < dfs_ctx.size(); i++) {
+			for (auto element : dfs_ctx.getLocal(i)->qp_maps[l]) {
+				if (qp_map.find(element.first) != qp_map.end())
+					qp_map[element.first] += element.second;
 				else
-					cg_map[element.first] = element.second;
+					qp_map[element.first] = element.second;
 			}
 		}
-		miner.printout_agg(cg_map);
-		queue_size = std::distance(queue.begin(), queue.end());
-		if(show) std::cout << "num_patterns: " << cg_map.size() << " num_quick_patterns: " << qp_map.size()
-					<< " num_embeddings: " << queue_size << "\n";
-		level ++;
+		if (qp_map.empty()) break;
+		std::cout << "\n============================== Level " << l << " ==============================\n";
+		CgMapFreq cg_map;
+		canonical_aggregate(miner, qp_map, cg_map);
 	}
 	std::cout << "\n=============================== Done ===============================\n\n";
 }
@@ -170,7 +238,9 @@ int main(int argc, char** argv) {
 	Miner miner(&graph);
 	galois::StatTimer Tcomp("Compute");
 	Tcomp.start();
-	MotifSolver(graph, miner);
+	if (dfs) MotifSolverDFS(graph, miner);
+	else MotifSolver(graph, miner);
 	Tcomp.stop();
+	miner.report_cache_stats();
 	return 0;
 }
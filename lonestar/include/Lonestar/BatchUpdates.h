@@ -0,0 +1,242 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file BatchUpdates.h
+ *
+ * Edge update streams for the incremental benchmarks: command line options,
+ * reading or generating the updates, and applying a batch of them to a
+ * galois::graphs::LC_Dynamic_CSR_Graph.
+ */
+
+#ifndef LONESTAR_BATCH_UPDATES_H
+#define LONESTAR_BATCH_UPDATES_H
+
+#include "galois/Galois.h"
+#include "galois/gIO.h"
+#include "galois/graphs/LCGraph.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static llvm::cl::opt<std::string> updatesFile(
+    "updates",
+    llvm::cl::desc("File of edge updates, one per line: '+ src dst [weight]' "
+                   "inserts an edge and '- src dst' deletes one (default: "
+                   "random updates)"),
+    llvm::cl::init(""));
+static llvm::cl::opt<unsigned>
+    numBatches("batches",
+               llvm::cl::desc("Number of batches of random updates (default "
+                              "value 10)"),
+               llvm::cl::init(10));
+static llvm::cl::opt<unsigned>
+    batchSize("batchSize",
+              llvm::cl::desc("Updates per batch (default value 1000)"),
+              llvm::cl::init(1000));
+
+struct EdgeUpdate {
+  uint32_t src;
+  uint32_t dst;
+  uint32_t weight;
+  bool insert;
+};
+
+//! Reads an update file; see the -updates option for the format
+inline std::vector<EdgeUpdate> readEdgeUpdates(const std::string& filename,
+                                               size_t numNodes) {
+  std::ifstream in(filename);
+  if (!in)
+    GALOIS_DIE("failed to open update file ", filename);
+
+  std::vector<EdgeUpdate> updates;
+  std::string line;
+  for (size_t lineNo = 1; std::getline(in, line); ++lineNo) {
+    std::istringstream fields(line);
+    std::string op;
+    if (!(fields >> op) || op[0] == '#')
+      continue;
+    EdgeUpdate u{0, 0, 1, op == "+"};
+    if ((op != "+" && op != "-") || !(fields >> u.src >> u.dst))
+      GALOIS_DIE("malformed update on line ", lineNo, " of ", filename);
+    if (u.insert)
+      fields >> u.weight;
+    if (u.src >= numNodes || u.dst >= numNodes)
+      GALOIS_DIE("update on line ", lineNo, " names a node outside the graph");
+    updates.push_back(u);
+  }
+  return updates;
+}
+
+/**
+ * Generates count updates; even ones delete a random existing edge and odd
+ * ones insert a random edge with a weight in [1, 100].
+ */
+template <typename Graph>
+std::vector<EdgeUpdate> randomEdgeUpdates(Graph& graph, size_t count) {
+  std::mt19937 gen(0);
+  std::vector<EdgeUpdate> updates;
+  updates.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    EdgeUpdate u{uint32_t(gen() % graph.size()),
+                 uint32_t(gen() % graph.size()), uint32_t(gen() % 100 + 1),
+                 i % 2 == 1};
+    if (!u.insert) {
+      for (unsigned tries = 0; tries < 8; ++tries) {
+        size_t degree = std::distance(graph.edge_begin(u.src),
+                                      graph.edge_end(u.src));
+        if (degree) {
+          auto e = graph.edge_begin(u.src);
+          std::advance(e, gen() % degree);
+          u.dst = graph.getEdgeDst(e);
+          break;
+        }
+        u.src = gen() % graph.size();
+      }
+    }
+    updates.push_back(u);
+  }
+  return updates;
+}
+
+//! The -updates file if given, random updates for all batches otherwise
+template <typename Graph>
+std::vector<EdgeUpdate> loadEdgeUpdates(Graph& graph) {
+  if (!updatesFile.empty())
+    return readEdgeUpdates(updatesFile, graph.size());
+  return randomEdgeUpdates(graph, size_t(numBatches) * batchSize);
+}
+
+//! Calls fn(begin, end) on consecutive batches of batchSize updates
+template <typename F>
+void forEachBatch(const std::vector<EdgeUpdate>& updates, F fn) {
+  if (batchSize == 0)
+    GALOIS_DIE("batch size must be positive");
+  for (size_t b = 0; b < updates.size(); b += batchSize) {
+    size_t e = std::min(updates.size(), b + batchSize);
+    fn(updates.begin() + b, updates.begin() + e);
+  }
+}
+
+namespace internal {
+template <typename T>
+struct UpdateValue {
+  static T get(const EdgeUpdate& u) { return u.weight; }
+};
+template <>
+struct UpdateValue<void*> {
+  static void* get(const EdgeUpdate&) { return nullptr; }
+};
+} // namespace internal
+
+enum class UpdateDirection {
+  Forward,  //!< src->dst
+  Reverse,  //!< dst->src, for graphs of in-edges
+  Symmetric //!< both, for symmetric graphs
+};
+
+//! Applies the updates [begin, end) to graph and commits them
+template <typename Graph, typename It>
+void applyEdgeUpdates(Graph& graph, It begin, It end,
+                      UpdateDirection dir = UpdateDirection::Forward) {
+  typedef internal::UpdateValue<typename Graph::edge_value_type> Value;
+  galois::do_all(
+      galois::iterate(begin, end),
+      [&](const EdgeUpdate& u) {
+        if (dir != UpdateDirection::Reverse) {
+          if (u.insert)
+            graph.insertEdge(u.src, u.dst, Value::get(u));
+          else
+            graph.deleteEdge(u.src, u.dst);
+        }
+        if (dir != UpdateDirection::Forward) {
+          if (u.insert)
+            graph.insertEdge(u.dst, u.src, Value::get(u));
+          else
+            graph.deleteEdge(u.dst, u.src);
+        }
+      },
+      galois::no_stats(), galois::loopname("ApplyUpdates"));
+  graph.commit();
+}
+
+/**
+ * Builds the in-edges of graph into in, which must be an empty
+ * LC_Dynamic_CSR_Graph with the same edge data.
+ */
+template <typename Graph, typename InGraph>
+void transposeGraph(Graph& graph, InGraph& in) {
+  typedef typename Graph::GraphNode GNode;
+  typedef std::pair<GNode, typename Graph::edge_value_type> InEdge;
+
+  size_t numNodes = graph.size();
+  std::vector<std::atomic<uint64_t>> next(numNodes);
+  galois::do_all(galois::iterate(size_t{0}, numNodes),
+                 [&](size_t n) { next[n] = 0; }, galois::no_stats());
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode src) {
+                   for (auto e : graph.edges(src))
+                     ++next[graph.getEdgeDst(e)];
+                 },
+                 galois::steal(), galois::no_stats(),
+                 galois::loopname("TransposeCount"));
+
+  std::vector<uint64_t> ends(numNodes);
+  uint64_t total = 0;
+  for (size_t n = 0; n < numNodes; ++n) {
+    uint64_t degree = next[n];
+    next[n]         = total;
+    total += degree;
+    ends[n] = total;
+  }
+
+  std::vector<InEdge> edges(total);
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode src) {
+                   for (auto e : graph.edges(src))
+                     edges[next[graph.getEdgeDst(e)]++] =
+                         InEdge(src, graph.getEdgeData(e));
+                 },
+                 galois::steal(), galois::no_stats(),
+                 galois::loopname("TransposeFill"));
+
+  in.allocateFrom(numNodes, total);
+  in.constructNodes();
+  galois::do_all(galois::iterate(size_t{0}, numNodes),
+                 [&](size_t n) {
+                   uint64_t begin = n == 0 ? 0 : ends[n - 1];
+                   std::sort(edges.begin() + begin, edges.begin() + ends[n],
+                             [](const InEdge& a, const InEdge& b) {
+                               return a.first < b.first;
+                             });
+                   for (uint64_t e = begin; e < ends[n]; ++e)
+                     in.constructEdge(e, edges[e].first, edges[e].second);
+                   in.fixEndEdge(n, ends[n]);
+                 },
+                 galois::steal(), galois::no_stats(),
+                 galois::loopname("TransposeConstruct"));
+}
+
+#endif
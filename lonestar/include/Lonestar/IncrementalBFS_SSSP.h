@@ -0,0 +1,232 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef LONESTAR_INCREMENTAL_BFS_SSSP_H
+#define LONESTAR_INCREMENTAL_BFS_SSSP_H
+
+#include "galois/AtomicHelpers.h"
+#include "galois/LargeArray.h"
+#include "Lonestar/BFS_SSSP.h"
+#include "Lonestar/BatchUpdates.h"
+
+/**
+ * Maintains single-source distances on an LC_Dynamic_CSR_Graph across batches
+ * of edge updates. inGraph holds the in-edges of graph and receives the same
+ * updates reversed. Edge weights must be positive.
+ *
+ * After a batch, nodes whose distance lost all shortest-path support from
+ * valid in-neighbors are invalidated, starting from the destinations of the
+ * updated edges and following the shortest-path subtree downwards. They then
+ * pull a new distance from their valid in-neighbors and, with the sources of
+ * the updated edges, seed a label-correcting pass; untouched nodes keep their
+ * distances.
+ */
+template <typename Graph, typename InGraph, typename _DistLabel,
+          bool USE_EDGE_WT>
+struct IncrementalBFS_SSSP {
+
+  using Base          = BFS_SSSP<Graph, _DistLabel, USE_EDGE_WT>;
+  using Dist          = typename Base::Dist;
+  using GNode         = typename Graph::GraphNode;
+  using UpdateRequest = typename Base::UpdateRequest;
+
+  constexpr static const Dist DIST_INFINITY = Base::DIST_INFINITY;
+  constexpr static const unsigned CHUNK_SIZE = 64;
+
+  Graph& graph;
+  InGraph& inGraph;
+  GNode source;
+  unsigned stepShift;
+  galois::LargeArray<std::atomic<bool>> invalid;
+  size_t numInvalidated = 0;
+
+  IncrementalBFS_SSSP(Graph& g, InGraph& in, GNode s, unsigned shift = 0)
+      : graph(g), inGraph(in), source(s), stepShift(shift) {
+    invalid.create(graph.size());
+    galois::do_all(galois::iterate(graph), [&](GNode n) { invalid[n] = false; },
+                   galois::no_stats());
+  }
+
+  template <bool useWt, typename G, typename EI>
+  static Dist weight(G&, EI, typename std::enable_if<!useWt>::type* = nullptr) {
+    return 1;
+  }
+
+  template <bool useWt, typename G, typename EI>
+  static Dist weight(G& g, EI ii,
+                     typename std::enable_if<useWt>::type* = nullptr) {
+    return g.getEdgeData(ii);
+  }
+
+  //! Label-correcting relaxation from the nodes in seeds
+  template <typename C>
+  void relax(C& seeds) {
+    namespace gwl = galois::worklists;
+    using Chunk   = gwl::PerSocketChunkFIFO<CHUNK_SIZE>;
+    using OBIM    = gwl::OrderedByIntegerMetric<
+        typename Base::UpdateRequestIndexer, Chunk>;
+
+    galois::InsertBag<UpdateRequest> initBag;
+    galois::do_all(galois::iterate(seeds),
+                   [&](GNode n) {
+                     Dist d = graph.getData(n);
+                     if (d != DIST_INFINITY)
+                       initBag.push(UpdateRequest(n, d));
+                   },
+                   galois::no_stats());
+
+    galois::for_each(
+        galois::iterate(initBag),
+        [&](const UpdateRequest& req, auto& ctx) {
+          if (graph.getData(req.src) < req.dist)
+            return;
+          for (auto ii : graph.edges(req.src)) {
+            GNode dst   = graph.getEdgeDst(ii);
+            Dist newDist = req.dist + weight<USE_EDGE_WT>(graph, ii);
+            if (newDist < galois::atomicMin(graph.getData(dst), newDist))
+              ctx.push(UpdateRequest(dst, newDist));
+          }
+        },
+        galois::wl<OBIM>(typename Base::UpdateRequestIndexer{stepShift}),
+        galois::no_conflicts(), galois::loopname("Relax"));
+  }
+
+  //! Computes all distances, ignoring the current ones
+  void computeFromScratch() {
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) { graph.getData(n) = DIST_INFINITY; },
+                   galois::no_stats());
+    graph.getData(source) = 0;
+    std::vector<GNode> seeds{source};
+    relax(seeds);
+  }
+
+  /**
+   * Applies the updates [begin, end) to both graphs and repairs the
+   * distances.
+   */
+  template <typename It>
+  void update(It begin, It end) {
+    if (USE_EDGE_WT)
+      for (It u = begin; u != end; ++u)
+        if (u->insert && u->weight == 0)
+          GALOIS_DIE("incremental SSSP needs positive edge weights");
+
+    applyEdgeUpdates(graph, begin, end, UpdateDirection::Forward);
+    applyEdgeUpdates(inGraph, begin, end, UpdateDirection::Reverse);
+
+    // nodes whose distance may no longer be achievable
+    galois::InsertBag<GNode> candidates;
+    galois::do_all(galois::iterate(begin, end),
+                   [&](const EdgeUpdate& u) { candidates.push(u.dst); },
+                   galois::no_stats());
+
+    galois::InsertBag<GNode> invalidated;
+    galois::for_each(
+        galois::iterate(candidates),
+        [&](GNode x, auto& ctx) {
+          Dist dx = graph.getData(x);
+          if (x == source || dx == DIST_INFINITY || invalid[x])
+            return;
+          for (auto ii : inGraph.edges(x)) {
+            GNode u = inGraph.getEdgeDst(ii);
+            Dist du = graph.getData(u);
+            if (!invalid[u] && du != DIST_INFINITY &&
+                du + weight<USE_EDGE_WT>(inGraph, ii) == dx)
+              return;
+          }
+          if (invalid[x].exchange(true))
+            return;
+          invalidated.push(x);
+          // the children in the shortest-path tree lose this support
+          for (auto ii : graph.edges(x)) {
+            GNode y = graph.getEdgeDst(ii);
+            if (!invalid[y] &&
+                graph.getData(y) == dx + weight<USE_EDGE_WT>(graph, ii))
+              ctx.push(y);
+          }
+        },
+        galois::wl<galois::worklists::PerSocketChunkFIFO<CHUNK_SIZE>>(),
+        galois::no_conflicts(), galois::loopname("Invalidate"));
+
+    galois::do_all(galois::iterate(invalidated),
+                   [&](GNode x) { graph.getData(x) = DIST_INFINITY; },
+                   galois::no_stats());
+
+    galois::InsertBag<GNode> seeds;
+    galois::do_all(
+        galois::iterate(invalidated),
+        [&](GNode x) {
+          Dist best = DIST_INFINITY;
+          for (auto ii : inGraph.edges(x)) {
+            GNode u = inGraph.getEdgeDst(ii);
+            Dist du = graph.getData(u);
+            if (!invalid[u] && du != DIST_INFINITY)
+              best = std::min(best, du + weight<USE_EDGE_WT>(inGraph, ii));
+          }
+          if (best != DIST_INFINITY) {
+            graph.getData(x) = best;
+            seeds.push(x);
+          }
+        },
+        galois::steal(), galois::no_stats(), galois::loopname("Pull"));
+
+    galois::GAccumulator<size_t> count;
+    galois::do_all(galois::iterate(invalidated),
+                   [&](GNode x) {
+                     invalid[x] = false;
+                     count += 1;
+                   },
+                   galois::no_stats());
+    numInvalidated += count.reduce();
+
+    galois::do_all(galois::iterate(begin, end),
+                   [&](const EdgeUpdate& u) {
+                     if (u.insert)
+                       seeds.push(u.src);
+                   },
+                   galois::no_stats());
+    relax(seeds);
+  }
+
+  //! Checks the distances against a computation from scratch
+  bool verify() {
+    std::vector<Dist> incremental(graph.size());
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) { incremental[n] = graph.getData(n); },
+                   galois::no_stats());
+    computeFromScratch();
+
+    std::atomic<size_t> mismatches(0);
+    galois::do_all(galois::iterate(graph),
+                   [&](GNode n) {
+                     if (incremental[n] != graph.getData(n))
+                       ++mismatches;
+                   },
+                   galois::no_stats());
+    if (mismatches) {
+      std::cerr << mismatches
+                << " nodes differ from the distances computed from scratch\n";
+      return false;
+    }
+    return Base::verify(graph, source);
+  }
+};
+
+#endif // LONESTAR_INCREMENTAL_BFS_SSSP_H
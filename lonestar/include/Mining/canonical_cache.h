@@ -0,0 +1,156 @@
+#ifndef CANONICAL_CACHE_HPP_
+#define CANONICAL_CACHE_HPP_
+#include "quick_pattern.h"
+#include "canonical_graph.h"
+#include "galois/Reduction.h"
+#include "galois/runtime/Statistics.h"
+#include "galois/substrate/CacheLineStorage.h"
+#include "galois/substrate/SimpleLock.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+typedef std::unordered_map<QuickPattern, const CanonicalGraph*> QpMapCg;
+
+// Memoizes the canonical graphs of quick patterns so that bliss runs once per pattern class.
+// Unlabeled patterns of up to MAX_TABLE_VERTICES vertices are keyed by the smallest adjacency
+// bitmask over all vertex permutations, looked up in tables computed once; isomorphic patterns
+// share one entry. Other patterns are keyed by the quick pattern itself, found through its hash.
+// Entries live until the cache is destroyed and are safe to look up from all threads.
+class CanonicalCache {
+public:
+	static const unsigned MAX_TABLE_VERTICES = 5;
+
+	CanonicalCache() : slots(new std::atomic<const CanonicalGraph*>[num_slots()]()) {}
+	~CanonicalCache() {
+		for (unsigned i = 0; i < num_slots(); ++i)
+			delete slots[i].load(std::memory_order_relaxed);
+		for (auto& stripe : stripes)
+			for (auto& sized : stripe.data.maps)
+				for (auto& element : sized.second) {
+					delete element.second;
+					QuickPattern key = element.first;
+					key.clean();
+				}
+	}
+
+	// canonical graph of qp; compute(qp) returns a new CanonicalGraph on a miss
+	template <typename F>
+	const CanonicalGraph* get(QuickPattern& qp, F compute) {
+		unsigned slot;
+		if (table_slot(qp, slot)) {
+			std::atomic<const CanonicalGraph*>& entry = slots[slot];
+			const CanonicalGraph* cg = entry.load(std::memory_order_acquire);
+			if (cg) {
+				table_hits += 1;
+				return cg;
+			}
+			table_misses += 1;
+			const CanonicalGraph* fresh = compute(qp);
+			if (entry.compare_exchange_strong(cg, fresh, std::memory_order_acq_rel))
+				return fresh;
+			delete fresh;
+			return cg;
+		}
+
+		Stripe& stripe = stripes[qp.get_hash() % NUM_STRIPES].data;
+		std::lock_guard<galois::substrate::SimpleLock> lg(stripe.lock);
+		QpMapCg& map = stripe.maps[qp.get_size()];
+		auto it = map.find(qp);
+		if (it != map.end()) {
+			memo_hits += 1;
+			return it->second;
+		}
+		memo_misses += 1;
+		const CanonicalGraph* cg = compute(qp);
+		map.insert(std::make_pair(copy_pattern(qp), cg));
+		return cg;
+	}
+
+	// reports hits and misses of both lookup paths as statistics
+	void report_stats() {
+		galois::runtime::reportStat_Single("CanonicalCache", "TableHits", table_hits.reduce());
+		galois::runtime::reportStat_Single("CanonicalCache", "TableMisses", table_misses.reduce());
+		galois::runtime::reportStat_Single("CanonicalCache", "MemoHits", memo_hits.reduce());
+		galois::runtime::reportStat_Single("CanonicalCache", "MemoMisses", memo_misses.reduce());
+	}
+
+private:
+	static const unsigned NUM_STRIPES = 64;
+	struct Stripe {
+		galois::substrate::SimpleLock lock;
+		std::unordered_map<unsigned, QpMapCg> maps; // by pattern size; QuickPattern == needs equal sizes
+	};
+
+	std::unique_ptr<std::atomic<const CanonicalGraph*>[]> slots;
+	galois::substrate::CacheLineStorage<Stripe> stripes[NUM_STRIPES];
+	galois::GAccumulator<size_t> table_hits, table_misses, memo_hits, memo_misses;
+
+	static unsigned num_pairs(unsigned n) { return n * (n - 1) / 2; }
+	static unsigned pair_index(unsigned a, unsigned b) {
+		if (a > b) std::swap(a, b);
+		return num_pairs(b) + a;
+	}
+	// first slot of the patterns with n vertices
+	static unsigned slot_offset(unsigned n) {
+		unsigned offset = 0;
+		for (unsigned i = 0; i < n; ++i) offset += 1u << num_pairs(i);
+		return offset;
+	}
+	static unsigned num_slots() { return slot_offset(MAX_TABLE_VERTICES + 1); }
+
+	// tables[n][mask] is the smallest mask of a graph isomorphic to the n-vertex graph mask
+	static const std::vector<std::vector<uint16_t> >& tables() {
+		static const std::vector<std::vector<uint16_t> > t = build_tables();
+		return t;
+	}
+	static std::vector<std::vector<uint16_t> > build_tables() {
+		std::vector<std::vector<uint16_t> > t(MAX_TABLE_VERTICES + 1);
+		for (unsigned n = 0; n <= MAX_TABLE_VERTICES; ++n) {
+			unsigned num_masks = 1u << num_pairs(n);
+			t[n].assign(num_masks, 0xFFFF);
+			std::vector<unsigned> perm(n);
+			for (unsigned i = 0; i < n; ++i) perm[i] = i;
+			do {
+				for (unsigned mask = 0; mask < num_masks; ++mask) {
+					unsigned permuted = 0;
+					for (unsigned b = 1; b < n; ++b)
+						for (unsigned a = 0; a < b; ++a)
+							if (mask & (1u << pair_index(a, b)))
+								permuted |= 1u << pair_index(perm[a], perm[b]);
+					if (permuted < t[n][mask]) t[n][mask] = permuted;
+				}
+			} while (std::next_permutation(perm.begin(), perm.end()));
+		}
+		return t;
+	}
+
+	// slot of qp if it is covered by the tables
+	static bool table_slot(QuickPattern& qp, unsigned& slot) {
+#ifdef ENABLE_LABEL
+		return false;
+#else
+		unsigned n = 0;
+		for (unsigned i = 0; i < qp.get_size(); ++i)
+			n = std::max(n, (unsigned)qp.at(i).vertex_id);
+		if (n > MAX_TABLE_VERTICES) return false;
+		unsigned mask = 0;
+		for (unsigned i = 1; i < qp.get_size(); ++i) {
+			unsigned a = qp.at(qp.at(i).history_info).vertex_id - 1;
+			unsigned b = qp.at(i).vertex_id - 1;
+			if (a != b) mask |= 1u << pair_index(a, b);
+		}
+		slot = slot_offset(n) + tables()[n][mask];
+		return true;
+#endif
+	}
+
+	static QuickPattern copy_pattern(QuickPattern& qp) {
+		QuickPattern key(qp.get_size() * sizeof(ElementType));
+		std::memcpy(key.get_elements(), qp.get_elements(), qp.get_size() * sizeof(ElementType));
+		key.set_hash();
+		return key;
+	}
+};
+
+#endif // CANONICAL_CACHE_HPP_
@@ -2,6 +2,7 @@
 #define MINER_HPP_
 #include "quick_pattern.h"
 #include "canonical_graph.h"
+#include "canonical_cache.h"
 #include "galois/Bag.h"
 #include "galois/Galois.h"
 #include "galois/substrate/PerThreadStorage.h"
@@ -26,6 +27,41 @@ typedef galois::InsertBag<Embedding> EmbeddingQueue;
 typedef galois::InsertBag<BaseEmbedding> BaseEmbeddingQueue;
 typedef galois::InsertBag<VertexInducedEmbedding> VertexInducedEmbeddingQueue;
 
+// Frequencies of canonical patterns updated concurrently by all threads
+class ConcurrentCgMapFreq {
+public:
+	void add(const CanonicalGraph& cg, Frequency freq) {
+		Stripe& stripe = stripes[cg.get_hash() % NUM_STRIPES].data;
+		std::lock_guard<galois::substrate::SimpleLock> lg(stripe.lock);
+		stripe.map[cg] += freq;
+	}
+	// adds all frequencies to cg_map
+	void collect(CgMapFreq& cg_map) {
+		for (auto& stripe : stripes)
+			for (auto& element : stripe.data.map)
+				cg_map[element.first] += element.second;
+	}
+
+private:
+	static const unsigned NUM_STRIPES = 64;
+	struct Stripe {
+		galois::substrate::SimpleLock lock;
+		CgMapFreq map;
+	};
+	galois::substrate::CacheLineStorage<Stripe> stripes[NUM_STRIPES];
+};
+
+
+// Per-thread state of the depth-first engine. An embedding is extended in place,
+// so a thread holds one embedding of at most the maximum size and one quick pattern
+// map per level instead of a materialized queue per level.
+struct DfsContext {
+	Embedding emb; // embedding being explored; reused across tasks
+	BaseEmbedding base_emb; // same for vertex (clique) extension
+	std::vector<QpMapFreq> qp_maps; // quick patterns of the embeddings of each level
+};
+typedef galois::substrate::PerThreadStorage<DfsContext> LocalDfsContext;
+
 class Miner {
 public:
 	Miner(Graph *g) {
@@ -184,6 +220,68 @@ public:
 			}
 		}
 	}
+	// Depth-first version of extend_edge. ctx.emb holds an embedding of the level before
+	// 'level'; each extension is pushed onto it in place, aggregated into ctx.qp_maps[level]
+	// and explored further while level + 1 < max_level. Memory is bounded by the depth.
+	void extend_edge_dfs(unsigned max_size, unsigned level, unsigned max_level, DfsContext &ctx) {
+		Embedding &emb = ctx.emb;
+		unsigned size = emb.size();
+		// the embedding is small, so linear scans replace the hash sets of extend_edge
+		unsigned num_vertices = 0;
+		for(unsigned i = 0; i < size; i ++)
+			if(find_vertex(emb, i, emb[i].vertex_id) == i) num_vertices ++;
+		for(unsigned i = 0; i < size; ++i) {
+			VertexId id = emb[i].vertex_id;
+			assert(id >= 0 && id < graph->size());
+			if(find_vertex(emb, i, id) != i) continue; // each distinct vertex is expanded only once
+			for(auto e : graph->edges(id)) {
+				GNode dst = graph->getEdgeDst(e);
+				auto dst_label = 0, edge_label = 0;
+				#ifdef ENABLE_LABEL
+				dst_label = graph->getData(dst);
+				#endif
+				bool vertex_existed = find_vertex(emb, size, dst) != size;
+				unsigned new_num_vertices = vertex_existed ? num_vertices : num_vertices + 1;
+				if(new_num_vertices <= max_size && !is_automorphism(emb, i, id, dst, vertex_existed)) {
+					emb.push_back(ElementType(dst, (BYTE)new_num_vertices, edge_label, dst_label, (BYTE)i));
+					quick_aggregate_each(emb, ctx.qp_maps[level]);
+					if(level + 1 < max_level) extend_edge_dfs(max_size, level + 1, max_level, ctx);
+					emb.pop_back();
+				}
+			}
+		}
+	}
+	// Depth-first version of extend_vertex_clique. Returns the number of cliques of max_size
+	// vertices that extend emb, which is extended in place and restored before returning.
+	unsigned long extend_vertex_clique_dfs(unsigned max_size, BaseEmbedding &emb) {
+		unsigned n = emb.size();
+		VertexId src = emb[n-1];
+		unsigned long num = 0;
+		for(auto e1 : graph->edges(src)) {
+			GNode dst = graph->getEdgeDst(e1);
+			if(dst > src) {
+				unsigned num_edges = 0;
+				for(auto e2 : graph->edges(dst)) {
+					GNode dst_dst = graph->getEdgeDst(e2);
+					for(unsigned i = 0; i < n; ++i) {
+						if (dst_dst == emb[i]) {
+							num_edges ++;
+							break;
+						}
+					}
+				}
+				if(num_edges == n) {
+					if(n + 1 == max_size) num ++;
+					else {
+						emb.push_back(dst);
+						num += extend_vertex_clique_dfs(max_size, emb);
+						emb.pop_back();
+					}
+				}
+			}
+		}
+		return num;
+	}
 	void aggregate_clique(BaseEmbeddingQueue &in_queue, BaseEmbeddingQueue &out_queue) {
 		SimpleMap simple_agg;
 		for (auto emb : in_queue) {
@@ -269,28 +367,32 @@ public:
 		for (auto it = qp_map.begin(); it != qp_map.end(); ++it) {
 			QuickPattern qp = it->first;
 			unsigned freq = it->second;
-			CanonicalGraph* cg = turn_canonical_graph(qp, false);
+			const CanonicalGraph* cg = canonical_graph(qp);
 			qp.clean();
 			if (cg_map.find(*cg) != cg_map.end()) cg_map[*cg] += freq;
 			else cg_map[*cg] = freq;
-			delete cg;
 		}
 	}
 	// aggregate quick patterns into canonical patterns.
 	inline void canonical_aggregate_each(QuickPattern qp, Frequency freq, CgMapFreq &cg_map) {
 		// turn the quick pattern into its canonical pattern
-		CanonicalGraph* cg = turn_canonical_graph(qp, false);
+		const CanonicalGraph* cg = canonical_graph(qp);
 		qp.clean();
 		// if this pattern already exists, increase its count
 		if (cg_map.find(*cg) != cg_map.end()) cg_map[*cg] += freq;
 		// otherwise add this pattern into the map, and set the count as 'freq'
 		else cg_map[*cg] = freq;
-		delete cg;
+	}
+	// same, but all threads aggregate into one shared map
+	inline void canonical_aggregate_each(QuickPattern qp, Frequency freq, ConcurrentCgMapFreq &cg_map) {
+		const CanonicalGraph* cg = canonical_graph(qp);
+		qp.clean();
+		cg_map.add(*cg, freq);
 	}
 	// aggregate quick patterns into canonical patterns. Construct an id_map from QuickPattern ID (qp_id) to CanonicalGraph ID (cg_id)
 	void canonical_aggregate_each(QuickPattern qp, Frequency freq, CgMapFreq &cg_map, UintMap &id_map) {
 		// turn the quick pattern into its canonical pattern
-		CanonicalGraph* cg = turn_canonical_graph(qp, false);
+		const CanonicalGraph* cg = canonical_graph(qp);
 		assert(cg != NULL);
 		int qp_id = qp.get_id();
 		int cg_id = cg->get_id();
@@ -309,7 +411,6 @@ public:
 			//cg_map.insert(std::make_pair(*cg, freq));
 			//qp.set_cgid((it->first).get_id());
 		}
-		delete cg;
 	}
 	void canonical_aggregate_each(QuickPattern qp, DomainSupport domainSets, CgMapDomain& cg_map, UintMap &id_map) {
 		assert(qp.get_size() == domainSets.size());
@@ -340,11 +441,10 @@ public:
 		for (auto emb : in_queue) {
 			QuickPattern qp(emb);
 			//turn_quick_pattern_pure(emb, qp);
-			CanonicalGraph* cf = turn_canonical_graph(qp, false);
+			const CanonicalGraph* cf = canonical_graph(qp);
 			qp.clean();
 			assert(cg_map.find(*cf) != cg_map.end());
 			if(cg_map[*cf] >= threshold) out_queue.push_back(emb);
-			delete cf;
 		}
 	}
 	// filtering for FSM
@@ -353,18 +453,17 @@ public:
 		// find the quick pattern of this embedding
 		QuickPattern qp(emb);
 		// find the pattern (canonical graph) of this embedding
-		CanonicalGraph* cf = turn_canonical_graph(qp, false);
+		const CanonicalGraph* cf = canonical_graph(qp);
 		qp.clean();
 		//assert(cg_map.find(*cf) != cg_map.end());
 		// compare the count of this pattern with the threshold
 		// if the pattern is frequent, insert this embedding into the task queue
 		if (cg_map[*cf] >= threshold) out_queue.push_back(emb);
-		delete cf;
 	}
 	void filter(EmbeddingQueue &in_queue, CgMapDomain &cg_map, EmbeddingQueue &out_queue) {
 		for (auto emb : in_queue) {
 			QuickPattern qp(emb);
-			CanonicalGraph* cf = turn_canonical_graph(qp, false);
+			const CanonicalGraph* cf = canonical_graph(qp);
 			qp.clean();
 			assert(cg_map.find(*cf) != cg_map.end());
 			bool is_frequent = true;
@@ -376,12 +475,11 @@ public:
 				}
 			}
 			if (is_frequent) out_queue.push_back(emb);
-			delete cf;
 		}
 	}
 	void filter_each(Embedding &emb, CgMapDomain &cg_map, EmbeddingQueue &out_queue) {
 		QuickPattern qp(emb);
-		CanonicalGraph* cf = turn_canonical_graph(qp, false);
+		const CanonicalGraph* cf = canonical_graph(qp);
 		qp.clean();
 		//assert(cg_map.find(*cf) != cg_map.end());
 		bool is_frequent = true;
@@ -393,7 +491,6 @@ public:
 			}
 		}
 		if (is_frequent) out_queue.push_back(emb);
-		delete cf;
 	}
 	inline void filter(EmbeddingQueue &in_queue, const UintMap id_map, const UintMap support_map, EmbeddingQueue &out_queue) {
 		for (auto emb : in_queue) {
@@ -487,12 +584,16 @@ public:
 		}
 	}
 
+	// reports the hit rates of the canonical graph cache
+	void report_cache_stats() { cg_cache.report_stats(); }
+
 private:
 	unsigned embedding_size;
 	unsigned threshold;
 	Graph *graph;
 	unsigned num_cliques;
 	galois::substrate::SimpleLock slock;
+	CanonicalCache cg_cache;
 	inline bool is_automorphism(Embedding & emb, BYTE history, VertexId src, VertexId dst, const bool vertex_existed) {
 		//check with the first element
 		if(dst < emb.front().vertex_id) return true;
@@ -509,6 +610,12 @@ private:
 		}
 		return false;
 	}
+	// index of the first element among the first n elements of emb with vertex id, or n
+	inline unsigned find_vertex(const Embedding & emb, unsigned n, VertexId id) {
+		for(unsigned i = 0; i < n; ++i)
+			if(emb[i].vertex_id == id) return i;
+		return n;
+	}
 	inline bool edge_existed(Embedding & emb, BYTE history, VertexId src, VertexId dst) {
 		std::pair<VertexId, VertexId> added_edge(src, dst);
 		for(unsigned i = 1; i < emb.size(); ++i) {
@@ -553,6 +660,10 @@ private:
 		delete cf;
 		return cg;
 	}
+	// canonical graph of qp, computed once per pattern class; owned by the cache
+	const CanonicalGraph* canonical_graph(QuickPattern & qp) {
+		return cg_cache.get(qp, [this](QuickPattern & p) { return turn_canonical_graph(p, false); });
+	}
 	bliss::AbstractGraph* readGraph(QuickPattern & qp, bool opt_directed) {
 		bliss::AbstractGraph* g = 0;
 		//get the number of vertices
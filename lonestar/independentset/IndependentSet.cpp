@@ -153,9 +153,17 @@ struct DefaultAlgo {
 
   template <typename C>
   void processNode(Graph& graph, const GNode& src, C& ctx) {
+    // Acquire the neighborhood up front and return on a conflict; the
+    // executor then retries src without unwinding the operator
+    if (!graph.tryAcquireNode(src))
+      return;
+    if (graph.getData(src, galois::MethodFlag::UNPROTECTED).flag != UNMATCHED)
+      return;
+    if (!graph.tryAcquireNeighborhood(src))
+      return;
+
     bool mod;
-    mod = build<galois::MethodFlag::WRITE>(graph, src);
-    graph.getData(src, galois::MethodFlag::WRITE);
+    mod = build<galois::MethodFlag::UNPROTECTED>(graph, src);
     ctx.cautiousPoint(); // Failsafe point
 
     if (mod) {
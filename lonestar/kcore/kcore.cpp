@@ -21,10 +21,15 @@
 #include "galois/gstl.h"
 #include "galois/Reduction.h"
 #include "galois/AtomicHelpers.h"
+#include "galois/DynamicBitset.h"
+#include "galois/LargeArray.h"
 #include "galois/graphs/LCGraph.h"
 #include "Lonestar/BoilerPlate.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <array>
+#include <fstream>
+
 constexpr static const char* const REGION_NAME = "k-core";
 
 /******************************************************************************/
@@ -32,7 +37,7 @@ constexpr static const char* const REGION_NAME = "k-core";
 /******************************************************************************/
 namespace cll = llvm::cl;
 
-enum Algo { Async = 0, Sync };
+enum Algo { Async = 0, Sync, Bucket };
 
 //! Input file: should be symmetric graph
 static cll::opt<std::string> inputFilename(cll::Positional,
@@ -43,12 +48,25 @@ static cll::opt<std::string> inputFilename(cll::Positional,
 static cll::opt<Algo> algo("algo",
     cll::desc("Choose an algorithm (default Sync):"),
     cll::values(clEnumVal(Async, "Asynchronous"), clEnumVal(Sync, "Synchronous"),
+                clEnumVal(Bucket, "Bucketed coreness decomposition"),
                 clEnumValEnd),
     cll::init(Sync));
 
-//! Required k specification for k-core
-static cll::opt<unsigned int> k_core_num("kcore", cll::desc("k-core value"),
-                                         cll::Required);
+//! k specification for k-core; required unless doing full decomposition
+static cll::opt<unsigned int> k_core_num("kcore",
+    cll::desc("k-core value (required for Async/Sync; with Bucket it only "
+              "selects the core reported by the sanity check)"),
+    cll::init(0));
+
+//! File to write per-node coreness to (Bucket only)
+static cll::opt<std::string> corenessFile("corenessFile",
+    cll::desc("Output file for per-node coreness (Bucket only)"),
+    cll::init(""));
+
+//! Print statistics for every peeling round (Bucket only)
+static cll::opt<bool> roundStats("roundStats",
+    cll::desc("Print per-round statistics of the decomposition (Bucket only)"),
+    cll::init(false));
 
 //! Flag that forces user to be aware that they should be passing in a
 //! symmetric graph
@@ -75,6 +93,13 @@ using GNode = Graph::GraphNode;
 //! Chunksize for for_each worklist: best chunksize will depend on input
 constexpr static const unsigned CHUNK_SIZE = 64u;
 
+//! Number of degree buckets the decomposition keeps materialized at a time;
+//! nodes with larger degree wait in an overflow bucket
+constexpr static const uint32_t NUM_OPEN_BUCKETS = 128u;
+
+//! Coreness value of a node that has not been peeled yet
+constexpr static const uint32_t UNPEELED = std::numeric_limits<uint32_t>::max();
+
 /******************************************************************************/
 /* Functions for running the algorithm */
 /******************************************************************************/
@@ -195,6 +220,305 @@ void asyncCascadeKCore(Graph& graph, galois::InsertBag<GNode>& initialWorklist)
   );
 }
 
+/******************************************************************************/
+/* Bucketed coreness decomposition */
+/******************************************************************************/
+/**
+ * Lazily updated bucket structure keyed by current degree (Julienne style).
+ *
+ * Only the buckets in [base, base + NUM_OPEN_BUCKETS) are materialized; nodes
+ * of higher degree sit in an overflow bag until the window reaches them.
+ * Buckets are never searched or cleaned up on a degree change: a node whose
+ * degree drops is simply inserted again into its new bucket, and the stale
+ * entries it leaves behind are filtered out when a bucket is extracted.
+ */
+class CoreBuckets {
+  using Bag = galois::InsertBag<GNode>;
+
+  Graph& graph;
+  galois::LargeArray<uint32_t>& coreness;
+  uint32_t base;
+  std::array<Bag, NUM_OPEN_BUCKETS> open;
+  Bag* overflow;
+  Bag* nextOverflow;
+
+  //! Places a node in the bucket of its current degree, or in the overflow
+  //! bag if that degree is past the open window
+  void place(GNode node, Bag& over) {
+    uint32_t degree = graph.getData(node).currentDegree;
+    assert(degree >= base);
+    if (degree - base < NUM_OPEN_BUCKETS) {
+      open[degree - base].push(node);
+    } else {
+      over.push(node);
+    }
+  }
+
+public:
+  CoreBuckets(Graph& _graph, galois::LargeArray<uint32_t>& _coreness)
+      : graph(_graph), coreness(_coreness), base(0), overflow(new Bag),
+        nextOverflow(new Bag) {
+    galois::do_all(
+      galois::iterate(graph.begin(), graph.end()),
+      [&] (GNode curNode) { place(curNode, *overflow); },
+      galois::loopname("BucketInit"),
+      galois::no_stats()
+    );
+  }
+
+  ~CoreBuckets() {
+    delete overflow;
+    delete nextOverflow;
+  }
+
+  //! @returns first degree covered by the open window
+  uint32_t windowBase() const { return base; }
+
+  /**
+   * Re-bucket a node whose degree was decremented during a peeling round.
+   * Nodes still outside the window already have an overflow entry.
+   */
+  void update(GNode node) {
+    uint32_t degree = graph.getData(node).currentDegree;
+    if (degree - base < NUM_OPEN_BUCKETS) {
+      open[degree - base].push(node);
+    }
+  }
+
+  /**
+   * Move the window so that it starts at the smallest degree of any
+   * unpeeled node in the overflow bag and redistribute the overflow bag.
+   *
+   * @returns false if the overflow bag holds no unpeeled nodes
+   */
+  bool advanceWindow() {
+    galois::GReduceMin<uint32_t> minDegree;
+    galois::do_all(
+      galois::iterate(*overflow),
+      [&] (GNode curNode) {
+        if (coreness[curNode] == UNPEELED) {
+          minDegree.update(graph.getData(curNode).currentDegree.load());
+        }
+      },
+      galois::loopname("BucketWindowMin"),
+      galois::no_stats()
+    );
+
+    uint32_t newBase = minDegree.reduce();
+    if (newBase == UNPEELED) {
+      overflow->clear();
+      return false;
+    }
+
+    base = newBase;
+    galois::do_all(
+      galois::iterate(*overflow),
+      [&] (GNode curNode) {
+        if (coreness[curNode] == UNPEELED) {
+          place(curNode, *nextOverflow);
+        }
+      },
+      galois::loopname("BucketRedistribute"),
+      galois::no_stats()
+    );
+    std::swap(overflow, nextOverflow);
+    nextOverflow->clear();
+    return true;
+  }
+
+  /**
+   * Extract bucket k (which must be in the open window) into the frontier,
+   * dropping stale entries and assigning coreness k to every real member.
+   *
+   * @returns number of nodes added to the frontier
+   */
+  size_t extract(uint32_t k, galois::InsertBag<GNode>& frontier) {
+    assert(k >= base && k - base < NUM_OPEN_BUCKETS);
+    Bag& bucket = open[k - base];
+    galois::GAccumulator<size_t> extracted;
+
+    galois::do_all(
+      galois::iterate(bucket),
+      [&] (GNode curNode) {
+        // an entry is current if the node is unpeeled and its degree has not
+        // moved below k; each node has at most one entry per bucket
+        if (coreness[curNode] == UNPEELED &&
+            graph.getData(curNode).currentDegree <= k) {
+          coreness[curNode] = k;
+          frontier.push(curNode);
+          extracted += 1;
+        }
+      },
+      galois::loopname("BucketExtract"),
+      galois::no_stats()
+    );
+
+    bucket.clear();
+    return extracted.reduce();
+  }
+};
+
+//! Statistics of a single peeling round of the decomposition
+struct RoundStat {
+  uint32_t k;
+  size_t peeled;
+  size_t rebucketed;
+};
+
+/**
+ * Full coreness decomposition by parallel bucketed peeling.
+ *
+ * Levels are processed in increasing k. At level k the current bucket is
+ * extracted and peeled in rounds: every frontier node decrements the degree
+ * of its unpeeled neighbors with atomics, and a neighbor whose degree falls
+ * to k joins the next frontier of the same level. Neighbors whose degree
+ * stays above k are collected once per round (deduplicated with a bitset)
+ * and re-bucketed in a single batch after the round.
+ *
+ * @param graph Graph to operate on; degrees must have been initialized
+ * @param coreness Array (one entry per node) that receives the coreness
+ * @param rounds Per-round statistics are appended here
+ */
+void bucketKCore(Graph& graph, galois::LargeArray<uint32_t>& coreness,
+                 std::vector<RoundStat>& rounds) {
+  galois::do_all(
+    galois::iterate(graph.begin(), graph.end()),
+    [&] (GNode curNode) { coreness[curNode] = UNPEELED; },
+    galois::loopname("CorenessInit"),
+    galois::no_stats()
+  );
+
+  galois::DynamicBitSet moved;
+  moved.resize(graph.size());
+
+  CoreBuckets buckets(graph, coreness);
+  galois::InsertBag<GNode>* current = new galois::InsertBag<GNode>;
+  galois::InsertBag<GNode>* next = new galois::InsertBag<GNode>;
+  galois::InsertBag<GNode> movedNodes;
+
+  size_t remaining = graph.size();
+  uint32_t k = buckets.windowBase();
+
+  while (remaining > 0) {
+    if (k - buckets.windowBase() >= NUM_OPEN_BUCKETS) {
+      if (!buckets.advanceWindow()) {
+        break;
+      }
+      k = buckets.windowBase();
+    }
+
+    size_t frontierSize = buckets.extract(k, *next);
+
+    while (frontierSize > 0) {
+      std::swap(current, next);
+      next->clear();
+      remaining -= frontierSize;
+
+      galois::GAccumulator<size_t> nextSize;
+      galois::do_all(
+        galois::iterate(*current),
+        [&] (GNode deadNode) {
+          for (auto e : graph.edges(deadNode)) {
+            GNode dest = graph.getEdgeDst(e);
+            NodeData& destData = graph.getData(dest);
+
+            // peeled nodes never have degree above the current level, so
+            // this skips them without touching the coreness array
+            if (destData.currentDegree.load(std::memory_order_relaxed) <= k) {
+              continue;
+            }
+
+            uint32_t oldDegree = galois::atomicSubtract(destData.currentDegree,
+                                                        1u);
+            if (oldDegree == k + 1) {
+              // this thread moved dest down to the current level
+              coreness[dest] = k;
+              next->push(dest);
+              nextSize += 1;
+            } else if (oldDegree > k + 1 && !moved.set(dest)) {
+              movedNodes.push(dest);
+            }
+          }
+        },
+        galois::steal(),
+        galois::chunk_size<CHUNK_SIZE>(),
+        galois::loopname("BucketPeel")
+      );
+
+      galois::GAccumulator<size_t> rebucketed;
+      galois::do_all(
+        galois::iterate(movedNodes),
+        [&] (GNode movedNode) {
+          moved.reset(movedNode);
+          if (coreness[movedNode] == UNPEELED) {
+            buckets.update(movedNode);
+            rebucketed += 1;
+          }
+        },
+        galois::loopname("BucketUpdate"),
+        galois::no_stats()
+      );
+      movedNodes.clear();
+
+      rounds.push_back(RoundStat{k, frontierSize, rebucketed.reduce()});
+      frontierSize = nextSize.reduce();
+    }
+
+    ++k;
+  }
+
+  delete current;
+  delete next;
+}
+
+/**
+ * Write "node coreness" pairs to a file.
+ *
+ * @param coreness Coreness array computed by bucketKCore
+ */
+void writeCoreness(const galois::LargeArray<uint32_t>& coreness) {
+  std::ofstream of(corenessFile);
+  if (!of.is_open()) {
+    std::cerr << "Cannot open " << corenessFile << " for output." << std::endl;
+    return;
+  }
+
+  for (size_t i = 0; i < coreness.size(); ++i) {
+    of << i << " " << coreness[i] << "\n";
+  }
+}
+
+/**
+ * Report aggregate statistics of the decomposition and, if requested, the
+ * statistics of every round.
+ *
+ * @param rounds Per-round statistics collected by bucketKCore
+ */
+void reportRounds(const std::vector<RoundStat>& rounds) {
+  uint32_t levels = 0;
+  uint32_t lastK = UNPEELED;
+  size_t totalRebucketed = 0;
+
+  for (size_t i = 0; i < rounds.size(); ++i) {
+    const RoundStat& r = rounds[i];
+    if (r.k != lastK) {
+      ++levels;
+      lastK = r.k;
+    }
+    totalRebucketed += r.rebucketed;
+
+    if (roundStats) {
+      galois::gPrint("Round ", i, ": k ", r.k, ", peeled ", r.peeled,
+                     ", rebucketed ", r.rebucketed, "\n");
+    }
+  }
+
+  galois::runtime::reportStat_Single(REGION_NAME, "Rounds", rounds.size());
+  galois::runtime::reportStat_Single(REGION_NAME, "Levels", levels);
+  galois::runtime::reportStat_Single(REGION_NAME, "Rebucketed",
+                                     totalRebucketed);
+}
+
 /******************************************************************************/
 /* Sanity check operators */
 /******************************************************************************/
@@ -223,6 +547,54 @@ void kCoreSanity(Graph& graph) {
                  aliveNodes.reduce(), "\n");
 }
 
+/**
+ * Check that every node has at least coreness-many neighbors of equal or
+ * greater coreness, print the maximum coreness and, if k was given, the size
+ * of the k-core.
+ *
+ * @param graph Graph that was decomposed
+ * @param coreness Coreness array computed by bucketKCore
+ */
+void corenessSanity(Graph& graph, const galois::LargeArray<uint32_t>& coreness) {
+  galois::GReduceMax<uint32_t> maxCoreness;
+  galois::GAccumulator<uint32_t> aliveNodes;
+  galois::GAccumulator<uint32_t> badNodes;
+
+  galois::do_all(
+    galois::iterate(graph.begin(), graph.end()),
+    [&] (GNode curNode) {
+      uint32_t core = coreness[curNode];
+      uint32_t support = 0;
+      for (auto e : graph.edges(curNode)) {
+        if (coreness[graph.getEdgeDst(e)] >= core) {
+          ++support;
+        }
+      }
+
+      if (core == UNPEELED || support < core) {
+        badNodes += 1;
+      }
+      if (core >= k_core_num) {
+        aliveNodes += 1;
+      }
+      maxCoreness.update(core);
+    },
+    galois::loopname("CorenessSanityCheck"),
+    galois::no_stats()
+  );
+
+  galois::gPrint("Maximum coreness is ", maxCoreness.reduce(), "\n");
+  if (k_core_num.getNumOccurrences()) {
+    galois::gPrint("Number of nodes in the ", k_core_num, "-core is ",
+                   aliveNodes.reduce(), "\n");
+  }
+
+  if (badNodes.reduce() != 0) {
+    GALOIS_DIE("Coreness of ", badNodes.reduce(), " nodes is not supported "
+               "by their neighbors");
+  }
+}
+
 /******************************************************************************/
 /* Main method for running */
 /******************************************************************************/
@@ -230,7 +602,8 @@ void kCoreSanity(Graph& graph) {
 constexpr static const char* const name = "k-core";
 constexpr static const char* const desc = "Finds the k-core of a graph, defined "
                                           "as the subgraph where all vertices "
-                                          "have degree at least k.";
+                                          "have degree at least k, or the "
+                                          "coreness of every vertex.";
 constexpr static const char* const url  = 0;
 
 int main(int argc, char** argv) {
@@ -242,6 +615,10 @@ int main(int argc, char** argv) {
                "aware this program needs to be passed a symmetric graph.");
   }
 
+  if (algo != Bucket && !k_core_num.getNumOccurrences()) {
+    GALOIS_DIE("A k-core value (-kcore) is required for Async and Sync.");
+  }
+
   // some initial stat reporting
   galois::gInfo("Worklist chunk size of ", CHUNK_SIZE, ": best size may depend"
                 " on input.");
@@ -271,6 +648,10 @@ int main(int argc, char** argv) {
   // intialization of degrees
   degreeCounting(graph);
 
+  // only allocated by the full decomposition
+  galois::LargeArray<uint32_t> coreness;
+  std::vector<RoundStat> rounds;
+
   // here begins main computation
   galois::StatTimer runtimeTimer;
 
@@ -290,6 +671,10 @@ int main(int argc, char** argv) {
                   k_core_num);
     // synchronous k-core
     syncCascadeKCore(graph);
+  } else if (algo == Bucket) {
+    galois::gInfo("Running bucketed coreness decomposition");
+    coreness.allocateBlocked(graph.size());
+    bucketKCore(graph, coreness, rounds);
   } else {
     GALOIS_DIE("Invalid specification of k-core algorithm");
   }
@@ -299,9 +684,20 @@ int main(int argc, char** argv) {
   totalTimer.stop();
   galois::reportPageAlloc("MemAllocPost");
 
+  if (algo == Bucket) {
+    reportRounds(rounds);
+    if (!corenessFile.empty()) {
+      writeCoreness(coreness);
+    }
+  }
+
   // sanity check
   if (!skipVerify) {
-    kCoreSanity(graph);
+    if (algo == Bucket) {
+      corenessSanity(graph, coreness);
+    } else {
+      kCoreSanity(graph);
+    }
   }
 
   return 0;
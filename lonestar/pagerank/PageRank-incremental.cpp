@@ -0,0 +1,210 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "Lonestar/BoilerPlate.h"
+#include "Lonestar/BatchUpdates.h"
+#include "PageRank-constants.h"
+#include "galois/Bag.h"
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LCGraph.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Push-based PageRank (as in PageRank-push.cpp) kept up to date across
+// batches of edge updates. The push algorithm maintains, for every node x,
+//
+//   residual[x] = (1 - ALPHA) + ALPHA * sum_{u->x} value[u] / outdeg(u)
+//                 - value[x]
+//
+// When the out-edges of u change, the residuals of its old neighbors lose
+// ALPHA * value[u] / oldOutdeg and those of its new neighbors gain
+// ALPHA * value[u] / newOutdeg; pushing from the nodes whose residual
+// exceeds the tolerance then restores convergence. Residuals may become
+// negative, so the magnitude is compared against the tolerance.
+
+const char* desc = "Maintains page ranks a la Page and Brin while batches of "
+                   "edges are inserted and deleted. This is a push-style "
+                   "algorithm.";
+
+constexpr static const unsigned CHUNK_SIZE = 16;
+
+struct LNode {
+  PRTy value;
+  std::atomic<PRTy> residual;
+
+  void init() {
+    value    = 0.0;
+    residual = INIT_RESIDUAL;
+  }
+};
+
+typedef galois::graphs::LC_Dynamic_CSR_Graph<LNode, void> Graph;
+typedef typename Graph::GraphNode GNode;
+
+template <typename C>
+void asyncPageRank(Graph& graph, C& seeds) {
+  typedef galois::worklists::PerSocketChunkFIFO<CHUNK_SIZE> WL;
+  galois::for_each(
+      galois::iterate(seeds),
+      [&](GNode src, auto& ctx) {
+        LNode& sdata = graph.getData(src);
+
+        if (std::fabs(sdata.residual) > tolerance) {
+          PRTy oldResidual = sdata.residual.exchange(0.0);
+          sdata.value += oldResidual;
+          int src_nout =
+              std::distance(graph.edge_begin(src), graph.edge_end(src));
+          if (src_nout > 0) {
+            PRTy delta = oldResidual * ALPHA / src_nout;
+            // for each out-going neighbors
+            for (auto jj : graph.edges(src)) {
+              GNode dst    = graph.getEdgeDst(jj);
+              LNode& ddata = graph.getData(dst);
+              auto old     = atomicAdd(ddata.residual, delta);
+              if ((std::fabs(old) < tolerance) &&
+                  (std::fabs(old + delta) >= tolerance)) {
+                ctx.push(dst);
+              }
+            }
+          }
+        }
+      },
+      galois::loopname("PushResidualAsync"), galois::no_conflicts(),
+      galois::wl<WL>());
+}
+
+template <typename It>
+void updatePageRank(Graph& graph, It begin, It end) {
+  std::vector<GNode> sources;
+  for (It u = begin; u != end; ++u)
+    sources.push_back(u->src);
+  std::sort(sources.begin(), sources.end());
+  sources.erase(std::unique(sources.begin(), sources.end()), sources.end());
+
+  std::vector<std::vector<GNode>> oldNeighbors(sources.size());
+  galois::do_all(galois::iterate(size_t{0}, sources.size()),
+                 [&](size_t i) {
+                   for (auto jj : graph.edges(sources[i]))
+                     oldNeighbors[i].push_back(graph.getEdgeDst(jj));
+                 },
+                 galois::steal(), galois::no_stats());
+
+  applyEdgeUpdates(graph, begin, end);
+
+  galois::InsertBag<GNode> seeds;
+  galois::do_all(
+      galois::iterate(size_t{0}, sources.size()),
+      [&](size_t i) {
+        GNode src         = sources[i];
+        PRTy value        = graph.getData(src).value;
+        const auto& old   = oldNeighbors[i];
+        if (!old.empty()) {
+          PRTy delta = value * ALPHA / old.size();
+          for (GNode dst : old) {
+            atomicAdd(graph.getData(dst).residual, -delta);
+            seeds.push(dst);
+          }
+        }
+        int src_nout =
+            std::distance(graph.edge_begin(src), graph.edge_end(src));
+        if (src_nout > 0) {
+          PRTy delta = value * ALPHA / src_nout;
+          for (auto jj : graph.edges(src)) {
+            GNode dst = graph.getEdgeDst(jj);
+            atomicAdd(graph.getData(dst).residual, delta);
+            seeds.push(dst);
+          }
+        }
+      },
+      galois::steal(), galois::loopname("CorrectResidual"));
+
+  asyncPageRank(graph, seeds);
+}
+
+//! Checks that all residuals are small and consistent with the values
+bool verify(Graph& graph) {
+  std::vector<double> expected(graph.size(), INIT_RESIDUAL);
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) { expected[n] -= graph.getData(n).value; },
+                 galois::no_stats());
+  for (GNode src : graph) {
+    int src_nout = std::distance(graph.edge_begin(src), graph.edge_end(src));
+    for (auto jj : graph.edges(src))
+      expected[graph.getEdgeDst(jj)] +=
+          double(ALPHA) * graph.getData(src).value / src_nout;
+  }
+
+  galois::GReduceMax<double> maxResidual;
+  galois::GReduceMax<double> maxError;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   double r = graph.getData(n).residual;
+                   maxResidual.update(std::fabs(r));
+                   maxError.update(std::fabs(r - expected[n]));
+                 },
+                 galois::no_stats());
+
+  std::cout << "max residual: " << maxResidual.reduce()
+            << ", max residual error: " << maxError.reduce() << "\n";
+  return maxResidual.reduce() <= tolerance && maxError.reduce() <= tolerance;
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  Graph graph;
+  galois::graphs::readGraph(graph, filename);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+  std::cout << "tolerance:" << tolerance << "\n";
+
+  std::vector<EdgeUpdate> updates = loadEdgeUpdates(graph);
+
+  galois::do_all(galois::iterate(graph),
+                 [&graph](GNode n) { graph.getData(n).init(); },
+                 galois::no_stats(), galois::loopname("Initialize"));
+
+  galois::StatTimer initialTime("InitialTime");
+  initialTime.start();
+  asyncPageRank(graph, graph);
+  initialTime.stop();
+
+  galois::StatTimer Tmain;
+  Tmain.start();
+  forEachBatch(updates,
+               [&](auto begin, auto end) { updatePageRank(graph, begin, end); });
+  Tmain.stop();
+
+  galois::runtime::reportStat_Single("PageRank", "Updates", updates.size());
+
+  if (!skipVerify) {
+    printTop(graph);
+    if (verify(graph)) {
+      std::cout << "Verification successful.\n";
+    } else {
+      GALOIS_DIE("Verification failed");
+    }
+  }
+
+  return 0;
+}
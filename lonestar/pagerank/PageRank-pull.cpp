@@ -24,19 +24,34 @@
 #include "galois/Timer.h"
 #include "galois/graphs/LCGraph.h"
 #include "galois/graphs/TypeTraits.h"
+#include "galois/runtime/SegmentedExecutor.h"
 #include "galois/gstl.h"
 
 const char* desc =
     "Computes page ranks a la Page and Brin. This is a pull-style algorithm.";
 
-enum Algo { Topo = 0, Residual };
+enum Algo { Topo = 0, Residual, Segmented };
 
 static cll::opt<Algo> algo("algo", cll::desc("Choose an algorithm:"),
                            cll::values(clEnumVal(Topo, "Topological"),
                                        clEnumVal(Residual, "Residual"),
+                                       clEnumVal(Segmented,
+                                                 "Topological, cache-blocked"),
                                        clEnumValEnd),
                            cll::init(Residual));
 
+static cll::opt<unsigned>
+    prefetchDistance("prefetchDistance",
+                     cll::desc("Edges to prefetch ahead in the pull loops "
+                               "(0 to disable)"),
+                     cll::init(galois::graphs::DEFAULT_PREFETCH_DISTANCE));
+
+static cll::opt<unsigned>
+    segmentSize("segmentSize",
+                cll::desc("KB of ranks read per segment of the Segmented "
+                          "algorithm (default 1024)"),
+                cll::init(1024));
+
 constexpr static const unsigned CHUNK_SIZE = 32;
 
 struct LNode {
@@ -50,6 +65,7 @@ typedef typename Graph::GraphNode GNode;
 
 using DeltaArray    = galois::LargeArray<PRTy>;
 using ResidualArray = galois::LargeArray<PRTy>;
+using ContribArray  = galois::LargeArray<PRTy>;
 
 //! [example of no_stats]
 void initNodeDataTopological(Graph& g) {
@@ -136,13 +152,9 @@ void computePRResidual(Graph& graph, DeltaArray& delta,
 
     galois::do_all(galois::iterate(graph),
                    [&](const GNode& src) {
-                     float sum = 0;
-                     for (auto nbr : graph.edges(src)) {
-                       GNode dst = graph.getEdgeDst(nbr);
-                       if (delta[dst] > 0) {
-                         sum += delta[dst];
-                       }
-                     }
+                     // deltas are never negative
+                     float sum = graph.gather_sum(src, delta.data(),
+                                                  prefetchDistance);
                      if (sum > 0) {
                        residual[src] = sum;
                      }
@@ -168,11 +180,27 @@ void computePRResidual(Graph& graph, DeltaArray& delta,
 }
 //! [scalarreduction]
 
+//! Computes value / nout of every node, dense so that pull loops can gather it
+void initContributions(Graph& graph, ContribArray& contrib) {
+  contrib.allocateInterleaved(graph.size());
+  galois::do_all(galois::iterate(graph),
+                 [&](const GNode& src) {
+                   LNode& sdata =
+                       graph.getData(src, galois::MethodFlag::UNPROTECTED);
+                   contrib[src] = sdata.nout ? sdata.value / sdata.nout : 0;
+                 },
+                 galois::no_stats(), galois::loopname("Contributions"));
+}
+
 // PageRank pull topological
 void computePRTopological(Graph& graph) {
   unsigned int iteration = 0;
   galois::GReduceMax<float> max_delta;
 
+  // kept current as values change, like the node data it mirrors
+  ContribArray contrib;
+  initContributions(graph, contrib);
+
   while (true) {
 
     galois::do_all(galois::iterate(graph),
@@ -181,16 +209,8 @@ void computePRTopological(Graph& graph) {
                          galois::MethodFlag::UNPROTECTED;
 
                      LNode& sdata = graph.getData(src, flag);
-                     float sum    = 0.0;
-
-                     for (auto jj = graph.edge_begin(src, flag),
-                               ej = graph.edge_end(src, flag);
-                          jj != ej; ++jj) {
-                       GNode dst = graph.getEdgeDst(jj);
-
-                       LNode& ddata = graph.getData(dst, flag);
-                       sum += ddata.value / ddata.nout;
-                     }
+                     float sum    = graph.gather_sum(src, contrib.data(),
+                                                  prefetchDistance, flag);
 
                      // New value of pagerank after computing contributions from
                      // incoming edges in the original graph
@@ -201,6 +221,8 @@ void computePRTopological(Graph& graph) {
                      // Do not update pagerank before the diff is computed since
                      // there is a data dependence on the pagerank value
                      sdata.value = value;
+                     if (sdata.nout)
+                       contrib[src] = value / sdata.nout;
                      max_delta.update(diff);
                    },
                    galois::no_stats(), galois::steal(),
@@ -227,6 +249,55 @@ void computePRTopological(Graph& graph) {
   }
 }
 
+// PageRank pull topological over cache-sized segments of the contributions;
+// unlike Topo, every round reads the contributions of the previous round
+void computePRSegmented(Graph& graph) {
+  galois::StatTimer segmentTimer("Segment", "PAGERANK_MAIN");
+  segmentTimer.start();
+  galois::runtime::SegmentedPullExecutor<Graph> executor(
+      graph, size_t(segmentSize) * 1024 / sizeof(PRTy));
+  segmentTimer.stop();
+  galois::runtime::reportStat_Single("PAGERANK_MAIN", "Segments",
+                                     executor.size());
+  galois::runtime::reportStat_Single("PAGERANK_MAIN", "PartialResults",
+                                     executor.sizePartials());
+
+  unsigned int iteration = 0;
+  galois::GReduceMax<float> max_delta;
+  ContribArray contrib;
+  initContributions(graph, contrib);
+
+  while (true) {
+    executor.run(PRTy(0), [&](GNode dst) { return contrib[dst]; },
+                 std::plus<PRTy>(), [&](GNode src, PRTy sum) {
+                   LNode& sdata =
+                       graph.getData(src, galois::MethodFlag::UNPROTECTED);
+                   float value = sum * ALPHA + (1.0 - ALPHA);
+                   max_delta.update(std::fabs(value - sdata.value));
+                   sdata.value = value;
+                   if (sdata.nout)
+                     contrib[src] = value / sdata.nout;
+                 });
+
+    float delta = max_delta.reduce();
+
+#if DEBUG
+    std::cout << "iteration: " << iteration << " max delta: " << delta << "\n";
+#endif
+
+    iteration += 1;
+    if (delta <= tolerance || iteration >= maxIterations) {
+      break;
+    }
+    max_delta.reset();
+  }
+
+  if (iteration >= maxIterations) {
+    std::cerr << "ERROR: failed to converge in " << iteration << " iterations"
+              << std::endl;
+  }
+}
+
 void prTopological(Graph& graph) {
   galois::StatTimer prTimer("Time", "PAGERANK_MAIN");
   prTimer.start();
@@ -236,6 +307,15 @@ void prTopological(Graph& graph) {
   prTimer.stop();
 }
 
+void prSegmented(Graph& graph) {
+  galois::StatTimer prTimer("Time", "PAGERANK_MAIN");
+  prTimer.start();
+  initNodeDataTopological(graph);
+  computeOutDeg(graph);
+  computePRSegmented(graph);
+  prTimer.stop();
+}
+
 void prResidual(Graph& graph) {
   galois::StatTimer prTimer("Time", "PAGERANK_MAIN");
   prTimer.start();
@@ -284,6 +364,13 @@ int main(int argc, char** argv) {
     prTopological(transposeGraph);
     break;
   }
+  case Segmented: {
+    std::cout << "Running Pull Segmented version, tolerance:" << tolerance
+              << ", maxIterations:" << maxIterations
+              << ", segmentSize:" << segmentSize << "KB\n";
+    prSegmented(transposeGraph);
+    break;
+  }
   case Residual: {
     std::cout << "Running Pull Residual version, tolerance:" << tolerance
               << ", maxIterations:" << maxIterations << "\n";
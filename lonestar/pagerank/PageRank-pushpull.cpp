@@ -0,0 +1,365 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "Lonestar/BoilerPlate.h"
+#include "PageRank-constants.h"
+#include "galois/DynamicBitset.h"
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/B_LC_CSR_Graph.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/runtime/SegmentedExecutor.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+// Residual (delta-based) PageRank in which every round is either a sparse
+// push over the out-edges of the active vertices or a dense pull over the
+// in-edges of all vertices, whichever is cheaper for the current frontier.
+// Pull rounds run on a SegmentedPullExecutor over the in-edges, so that the
+// deltas being read stay in cache.
+
+const char* desc =
+    "Computes page ranks a la Page and Brin. This engine switches between "
+    "sparse push rounds and dense, cache-partitioned pull rounds depending "
+    "on the size of the frontier.";
+
+enum Mode { Auto = 0, Push, Pull };
+
+static cll::opt<Mode> mode(
+    "mode", cll::desc("Choose how rounds are executed (default Auto):"),
+    cll::values(clEnumVal(Auto, "Switch on the size of the frontier"),
+                clEnumVal(Push, "Always push"), clEnumVal(Pull, "Always pull"),
+                clEnumValEnd),
+    cll::init(Auto));
+
+static cll::opt<unsigned> pullThreshold(
+    "pullThreshold",
+    cll::desc("Pull when the active vertices and their out-edges exceed "
+              "|E| / pullThreshold (default 20)"),
+    cll::init(20));
+
+static cll::opt<unsigned> partitionSize(
+    "partitionSize",
+    cll::desc("Vertices per pull partition; the deltas of one partition "
+              "should fit in cache (default 65536)"),
+    cll::init(1 << 16));
+
+static cll::opt<bool> roundStats("roundStats",
+                                 cll::desc("Print per-round mode, active "
+                                           "count and applied residual"),
+                                 cll::init(false));
+
+constexpr static const char* const REGION_NAME  = "PAGERANK_MAIN";
+
+struct LNode {
+  PRTy value;
+  uint32_t nout;
+};
+
+typedef galois::graphs::B_LC_CSR_Graph<LNode, void, false, true, true> Graph;
+typedef typename Graph::GraphNode GNode;
+
+using DeltaArray    = galois::LargeArray<PRTy>;
+using ResidualArray = galois::LargeArray<std::atomic<PRTy>>;
+
+/**
+ * In-edges of the graph presented as its edges, which is how
+ * SegmentedPullExecutor reads the neighbors of a node.
+ */
+struct InEdges {
+  typedef GNode GraphNode;
+
+  Graph& graph;
+
+  size_t size() const { return graph.size(); }
+
+  auto edges(GNode n, galois::MethodFlag flag)
+      -> decltype(graph.in_edges(n, flag)) {
+    return graph.in_edges(n, flag);
+  }
+
+  GNode getEdgeDst(Graph::edge_iterator e) const {
+    return graph.getInEdgeDst(e);
+  }
+};
+
+typedef galois::runtime::SegmentedPullExecutor<InEdges> PullExecutor;
+
+/**
+ * Statistics of one round of the engine.
+ */
+struct RoundStat {
+  bool pull;
+  size_t active;
+  size_t activeEdges;
+  double applied; // residual folded into page ranks this round
+};
+
+/**
+ * Calls f(n) for every vertex set in the frontier; only the cache lines of
+ * the bitset that hold set bits are visited.
+ */
+template <typename F>
+void forEachActive(const galois::DynamicBitSet& frontier, F f,
+                   const char* name) {
+  frontier.do_all_set([&](size_t n) { f(GNode(n)); }, galois::steal(),
+                      galois::chunk_size<1>(), galois::no_stats(),
+                      galois::loopname(name));
+}
+
+void initNodeData(Graph& graph, DeltaArray& delta, ResidualArray& residual,
+                  galois::DynamicBitSet& frontier) {
+  galois::do_all(galois::iterate(graph),
+                 [&](const GNode& n) {
+                   auto& sdata = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+                   sdata.value = 0;
+                   sdata.nout  = std::distance(graph.edge_begin(n),
+                                              graph.edge_end(n));
+                   delta[n]    = 0;
+                   residual.constructAt(n, INIT_RESIDUAL);
+                   frontier.set(n);
+                 },
+                 galois::no_stats(), galois::loopname("initNodeData"));
+}
+
+/**
+ * Sparse round: active vertices push their deltas along out-edges; vertices
+ * whose residual crosses the tolerance join the next frontier.
+ */
+void pushRound(Graph& graph, galois::DynamicBitSet& frontier,
+               galois::DynamicBitSet& next, DeltaArray& delta,
+               ResidualArray& residual) {
+  forEachActive(
+      frontier,
+      [&](GNode src) {
+        PRTy d = delta[src];
+        if (d == 0) {
+          return;
+        }
+        for (auto e : graph.edges(src, galois::MethodFlag::UNPROTECTED)) {
+          GNode dst = graph.getEdgeDst(e);
+          PRTy old  = atomicAdd(residual[dst], d);
+          if (old <= tolerance && old + d > tolerance) {
+            next.set(dst);
+          }
+        }
+      },
+      "PageRankPush");
+}
+
+/**
+ * Dense round: every vertex pulls deltas over its in-edges, one source
+ * partition at a time; the sums are added to the residuals, which also
+ * rebuilds the frontier.
+ */
+void pullRound(PullExecutor& executor, galois::DynamicBitSet& next,
+               DeltaArray& delta, ResidualArray& residual) {
+  executor.run(PRTy(0), [&](GNode src) { return delta[src]; },
+               std::plus<PRTy>(), [&](GNode dst, PRTy sum) {
+                 auto& r = residual[dst];
+                 if (sum > 0) {
+                   r.store(r.load(std::memory_order_relaxed) + sum,
+                           std::memory_order_relaxed);
+                 }
+                 if (r.load(std::memory_order_relaxed) > tolerance) {
+                   next.set(dst);
+                 }
+               });
+}
+
+void computePageRank(Graph& graph, std::vector<RoundStat>& rounds) {
+  DeltaArray delta;
+  delta.allocateInterleaved(graph.size());
+  ResidualArray residual;
+  residual.allocateInterleaved(graph.size());
+  galois::DynamicBitSet frontier;
+  frontier.resize(graph.size());
+  galois::DynamicBitSet next;
+  next.resize(graph.size());
+
+  initNodeData(graph, delta, residual, frontier);
+
+  InEdges inEdges{graph};
+  std::unique_ptr<PullExecutor> executor;
+  if (mode != Push) {
+    galois::StatTimer buildTimer("BuildPartitions", REGION_NAME);
+    buildTimer.start();
+    executor.reset(new PullExecutor(inEdges, partitionSize));
+    buildTimer.stop();
+    galois::runtime::reportStat_Single(REGION_NAME, "PullPartitions",
+                                       executor->size());
+    galois::runtime::reportStat_Single(REGION_NAME, "PullEntries",
+                                       executor->sizePartials());
+  }
+
+  galois::GAccumulator<size_t> activeCount;
+  galois::GAccumulator<size_t> activeEdges;
+  galois::GAccumulator<double> applied;
+  uint64_t pullLimit = graph.sizeEdges() / std::max(1u, (unsigned)pullThreshold);
+
+  unsigned iteration = 0;
+  while (true) {
+    activeCount.reset();
+    activeEdges.reset();
+    applied.reset();
+
+    // fold residuals of the frontier into page ranks and compute the deltas
+    // to propagate
+    forEachActive(
+        frontier,
+        [&](GNode n) {
+          auto& sdata = graph.getData(n, galois::MethodFlag::UNPROTECTED);
+          PRTy oldResidual = residual[n].exchange(0, std::memory_order_relaxed);
+          sdata.value += oldResidual;
+          delta[n] = sdata.nout > 0 ? oldResidual * ALPHA / sdata.nout : 0;
+          activeCount += 1;
+          activeEdges += sdata.nout;
+          applied += oldResidual;
+        },
+        "PageRankApply");
+
+    size_t active = activeCount.reduce();
+    if (active == 0) {
+      break;
+    }
+
+    size_t work = active + activeEdges.reduce();
+    bool pull   = (mode == Pull) || (mode == Auto && work > pullLimit);
+    rounds.push_back(RoundStat{pull, active, activeEdges.reduce(),
+                               applied.reduce()});
+
+    if (pull) {
+      pullRound(*executor, next, delta, residual);
+    } else {
+      pushRound(graph, frontier, next, delta, residual);
+    }
+
+    // deltas of this frontier are consumed; pull rounds read every delta
+    forEachActive(frontier, [&](GNode n) { delta[n] = 0; }, "ClearDeltas");
+
+    std::swap(frontier, next);
+    next.reset();
+
+    iteration += 1;
+    if (iteration >= maxIterations) {
+      break;
+    }
+  }
+
+  if (iteration >= maxIterations) {
+    std::cerr << "ERROR: failed to converge in " << iteration << " iterations"
+              << std::endl;
+  }
+}
+
+/**
+ * Reports per-round statistics gathered by computePageRank.
+ */
+void reportRounds(const std::vector<RoundStat>& rounds) {
+  size_t pullRounds = 0;
+
+  for (size_t i = 0; i < rounds.size(); ++i) {
+    const RoundStat& r = rounds[i];
+    pullRounds += r.pull;
+
+    if (roundStats) {
+      galois::gPrint("Round ", i, ": ", r.pull ? "pull" : "push", ", active ",
+                     r.active, ", active edges ", r.activeEdges,
+                     ", applied residual ", r.applied, "\n");
+    }
+  }
+
+  galois::runtime::reportStat_Single(REGION_NAME, "Rounds", rounds.size());
+  galois::runtime::reportStat_Single(REGION_NAME, "PullRounds", pullRounds);
+  galois::runtime::reportStat_Single(REGION_NAME, "PushRounds",
+                                     rounds.size() - pullRounds);
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  if (partitionSize == 0) {
+    GALOIS_DIE("partitionSize must be positive");
+  }
+
+  galois::StatTimer overheadTime("Time", "TotalTime");
+  overheadTime.start();
+
+  Graph graph;
+  std::cout << "Reading graph: " << filename << std::endl;
+  galois::StatTimer readTime("Time", "ReadGraph");
+  readTime.start();
+  galois::graphs::readGraph(graph, filename);
+  graph.constructIncomingEdges();
+  readTime.stop();
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges\n";
+
+  galois::preAlloc(5 * numThreads +
+                   (5 * graph.size() * sizeof(typename Graph::node_data_type)) /
+                       galois::runtime::pagePoolSize());
+  galois::reportPageAlloc("MeminfoPre");
+
+  std::cout << "Running push-pull version, tolerance:" << tolerance
+            << ", maxIterations:" << maxIterations << "\n";
+
+  std::vector<RoundStat> rounds;
+  galois::StatTimer prTimer("Time", REGION_NAME);
+  prTimer.start();
+  computePageRank(graph, rounds);
+  prTimer.stop();
+
+  galois::reportPageAlloc("MeminfoPost");
+  reportRounds(rounds);
+
+  // Sanity checking code
+  galois::GReduceMax<PRTy> maxRank;
+  galois::GReduceMin<PRTy> minRank;
+  galois::GAccumulator<PRTy> distanceSum;
+
+  galois::do_all(galois::iterate(graph),
+                 [&](uint64_t i) {
+                   PRTy rank = graph.getData(i).value;
+
+                   maxRank.update(rank);
+                   minRank.update(rank);
+                   distanceSum += rank;
+                 },
+                 galois::loopname("Sanity check"), galois::no_stats());
+
+  galois::gInfo("Max rank is ", maxRank.reduce());
+  galois::gInfo("Min rank is ", minRank.reduce());
+  galois::gInfo("Sum is ", distanceSum.reduce());
+
+  if (!skipVerify) {
+    printTop(graph);
+  }
+
+#if DEBUG
+  printPageRank(graph);
+#endif
+
+  overheadTime.stop();
+  return 0;
+}
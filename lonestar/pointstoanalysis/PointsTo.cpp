@@ -22,8 +22,10 @@
 #include "Lonestar/BoilerPlate.h"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include <deque>
 #include "SparseBitVector.h"
+#include "RoaringPointsToSet.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Command line parameters
@@ -67,6 +69,18 @@ static cll::opt<unsigned>
                            "(default 500000)"),
                  cll::init(500000));
 
+enum PointsToSetKind { SBV = 0, Roaring, HashConsed };
+
+static cll::opt<PointsToSetKind> pointsToSetKind(
+    "pointsToSet",
+    cll::desc("Representation of points-to sets (default SBV):"),
+    cll::values(clEnumVal(SBV, "Linked list sparse bit vector"),
+                clEnumVal(Roaring, "Roaring-style array/bitmap/run containers"),
+                clEnumVal(HashConsed,
+                          "Hash-consed roaring sets with memoized unions"),
+                clEnumValEnd),
+    cll::init(SBV));
+
 ////////////////////////////////////////////////////////////////////////////////
 // Declaration of strutures, types, and variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -125,23 +139,40 @@ public:
   }
 };
 
+/**
+ * Adds values to a points-to set. Mutable sets take them one at a time.
+ */
+template <typename PointsToSet>
+void addAll(PointsToSet& set, const std::vector<unsigned>& values) {
+  for (unsigned v : values) {
+    set.set(v);
+  }
+}
+
+/**
+ * Hash-consed sets intern a new set on every change, so add all values in
+ * one step.
+ */
+template <bool IsConcurrent>
+void addAll(galois::HashConsedSet<IsConcurrent>& set,
+            const std::vector<unsigned>& values) {
+  set.setAll(values.begin(), values.end());
+}
+
 /**
  * Points to analysis runner base class. Does not have a run method itself.
  *
  * @tparam IsConcurrent if set to true, the data structures used for points
  * to results and outgoing edges will be thread safe
+ * @tparam PointsToSet set type holding points-to results (SparseBitVector,
+ * RoaringSet or HashConsedSet)
+ * @tparam EdgeSet set type holding outgoing edges
  */
-template <bool IsConcurrent>
+template <bool IsConcurrent, typename PointsToSet, typename EdgeSet>
 class PTABase {
-  // sparse bit vector is concurrent or serial based on template parameter
-  using SparseBitVector = galois::SparseBitVector<IsConcurrent>;
-
   using PointsToConstraints = std::vector<PtsToCons>;
-  using PointsToInfo        = std::vector<SparseBitVector>;
-  using EdgeVector          = std::vector<SparseBitVector>;
-
-  using NodeAllocator =
-      galois::FixedSizeAllocator<typename SparseBitVector::Node>;
+  using PointsToInfo        = std::vector<PointsToSet>;
+  using EdgeVector          = std::vector<EdgeSet>;
 
 protected:
   PointsToInfo pointsToResult; // pointsTo results for nodes
@@ -158,7 +189,7 @@ protected:
    */
   struct OnlineCycleDetection {
   private:
-    PTABase<IsConcurrent>&
+    PTABase&
         outerPTA; // reference to outer PTA instance to get runtime info
 
     galois::gstl::Vector<unsigned> ancestors; // TODO find better representation
@@ -286,7 +317,7 @@ protected:
     }
 
   public:
-    OnlineCycleDetection(PTABase<IsConcurrent>& o) : outerPTA(o) {}
+    OnlineCycleDetection(PTABase& o) : outerPTA(o) {}
 
     /**
      * Init fields (outerPTA needs to have numNodes set).
@@ -448,15 +479,45 @@ protected:
   VecType processAddressOfCopy(const PointsToConstraints& constraints) {
     VecType updates;
 
+    // group addressof constraints by destination so that each points-to set
+    // gets all of its initial values in one addAll
+    std::vector<std::pair<unsigned, unsigned>> addressOf;
+    for (const PtsToCons& c : constraints) {
+      if (c.getType() == PtsToCons::AddressOf) {
+        unsigned src;
+        unsigned dst;
+        std::tie(src, dst) = c.getSrcDst();
+        addressOf.emplace_back(dst, src);
+      }
+    }
+    std::sort(addressOf.begin(), addressOf.end());
+
+    std::vector<size_t> groupBegin;
+    for (size_t i = 0; i < addressOf.size(); i++) {
+      if (i == 0 || addressOf[i].first != addressOf[i - 1].first) {
+        groupBegin.push_back(i);
+      }
+    }
+    groupBegin.push_back(addressOf.size());
+
+    LoopInvoker()(galois::iterate(size_t{0}, groupBegin.size() - 1),
+                  [&](size_t g) {
+                    std::vector<unsigned> srcs;
+                    for (size_t i = groupBegin[g]; i < groupBegin[g + 1]; i++) {
+                      srcs.push_back(addressOf[i].second);
+                    }
+                    addAll(pointsToResult[addressOf[groupBegin[g]].first],
+                           srcs);
+                  });
+
     LoopInvoker()(galois::iterate(constraints), [&](auto ii) {
       unsigned src;
       unsigned dst;
 
       std::tie(src, dst) = ii.getSrcDst();
 
-      if (ii.getType() == PtsToCons::AddressOf) { // addressof; save point info
-        pointsToResult[dst].set(src);
-      } else if (src != dst) { // copy constraint; add an edge
+      if (ii.getType() != PtsToCons::AddressOf &&
+          src != dst) { // copy constraint; add an edge
         outgoingEdges[src].set(dst);
         updates.push_back(src);
       }
@@ -501,10 +562,12 @@ public:
    * structures needed for the points-to algorithm.
    *
    * @param n Number of nodes in the constraint graph
-   * @param nodeAllocator galois allocator object to allocate nodes in the
-   * sparse bit vector
+   * @param pointsToContext shared state for points-to sets (e.g. the node
+   * allocator of a sparse bit vector)
+   * @param edgeContext shared state for edge sets
    */
-  void initialize(size_t n, NodeAllocator& nodeAllocator) {
+  void initialize(size_t n, typename PointsToSet::Context& pointsToContext,
+                  typename EdgeSet::Context& edgeContext) {
     numNodes = n;
 
     // initialize different constructs based on which version is being run
@@ -513,8 +576,8 @@ public:
 
     // initialize vectors
     for (unsigned i = 0; i < numNodes; i++) {
-      pointsToResult[i].init(&nodeAllocator);
-      outgoingEdges[i].init(&nodeAllocator);
+      pointsToResult[i].init(&pointsToContext);
+      outgoingEdges[i].init(&edgeContext);
     }
 
     ocd.init();
@@ -643,6 +706,29 @@ public:
     return count;
   }
 
+  /**
+   * @returns bytes held by points-to sets (shared state such as an intern
+   * table is not included)
+   */
+  size_t pointsToBytes() const {
+    size_t bytes = 0;
+    for (auto& set : pointsToResult) {
+      bytes += set.memoryBytes();
+    }
+    return bytes;
+  }
+
+  /**
+   * @returns bytes held by edge sets
+   */
+  size_t edgeBytes() const {
+    size_t bytes = 0;
+    for (auto& set : outgoingEdges) {
+      bytes += set.memoryBytes();
+    }
+    return bytes;
+  }
+
   /**
    * Prints out points to info for all verticies in the constraint graph.
    */
@@ -660,7 +746,16 @@ public:
 /**
  * Serial points to executor.
  */
-class PTASerial : public PTABase<false> {
+template <typename PointsToSet, typename EdgeSet>
+class PTASerial : public PTABase<false, PointsToSet, EdgeSet> {
+  using Base = PTABase<false, PointsToSet, EdgeSet>;
+  using Base::addressCopyConstraints;
+  using Base::loadStoreConstraints;
+  using Base::numNodes;
+  using Base::ocd;
+  using Base::outgoingEdges;
+  using Base::propagate;
+
 public:
   /**
    * Run points-to-analysis on a single thread.
@@ -672,9 +767,11 @@ public:
     galois::gDebug("no of nodes = ", numNodes);
 
     std::deque<unsigned> updates;
-    updates = processAddressOfCopy<galois::StdForEach, std::deque<unsigned>>(
+    updates = this->template processAddressOfCopy<galois::StdForEach,
+                                                  std::deque<unsigned>>(
         addressCopyConstraints);
-    processLoadStore<galois::StdForEach>(loadStoreConstraints, updates);
+    this->template processLoadStore<galois::StdForEach>(loadStoreConstraints,
+                                                        updates);
 
     unsigned numUps = 0;
 
@@ -696,12 +793,13 @@ public:
 
       if (updates.empty() || numUps >= THRESHOLD_LS) {
         galois::gDebug("No of points-to facts computed = ",
-                       countPointsToFacts());
+                       this->countPointsToFacts());
         numUps = 0;
 
         // After propagating all constraints, see if load/store
         // constraints need to be added in since graph was potentially updated
-        processLoadStore<galois::StdForEach>(loadStoreConstraints, updates);
+        this->template processLoadStore<galois::StdForEach>(
+            loadStoreConstraints, updates);
 
         // do cycle squashing
         ocd.process(updates);
@@ -713,7 +811,13 @@ public:
 /**
  * Concurrent points to executor.
  */
-class PTAConcurrent : public PTABase<true> {
+template <typename PointsToSet, typename EdgeSet>
+class PTAConcurrent : public PTABase<true, PointsToSet, EdgeSet> {
+  using Base = PTABase<true, PointsToSet, EdgeSet>;
+  using Base::addressCopyConstraints;
+  using Base::loadStoreConstraints;
+  using Base::numNodes;
+
 public:
   /**
    * Run points-to-analysis using galois::for_each as the main loop.
@@ -725,9 +829,11 @@ public:
     galois::gDebug("no of nodes = ", numNodes);
 
     galois::InsertBag<unsigned> updates;
-    updates = processAddressOfCopy<galois::DoAll, galois::InsertBag<unsigned>>(
+    updates = this->template processAddressOfCopy<galois::DoAll,
+                                                  galois::InsertBag<unsigned>>(
         addressCopyConstraints);
-    processLoadStore<galois::DoAll>(loadStoreConstraints, updates);
+    this->template processLoadStore<galois::DoAll>(loadStoreConstraints,
+                                                   updates);
 
     while (!updates.empty()) {
       galois::for_each(
@@ -746,13 +852,15 @@ public:
                                                                  // with this
       );
 
-      galois::gDebug("No of points-to facts computed = ", countPointsToFacts());
+      galois::gDebug("No of points-to facts computed = ",
+                     this->countPointsToFacts());
 
       updates.clear();
 
       // After propagating all constraints, see if load/store constraints need
       // to be added in since graph was potentially updated
-      processLoadStore<galois::DoAll>(loadStoreConstraints, updates);
+      this->template processLoadStore<galois::DoAll>(loadStoreConstraints,
+                                                     updates);
 
       // do cycle squashing
       // ocd.process(updates); // TODO have parallel OCD, if possible
@@ -760,13 +868,31 @@ public:
   }
 };
 
+/**
+ * @returns bytes of shared set state; only the hash-consing intern table
+ * holds any
+ */
+template <typename Context>
+size_t contextBytes(const Context&) {
+  return 0;
+}
+
+size_t contextBytes(const galois::HashConsedSet<false>::Context& c) {
+  return c.memoryBytes();
+}
+
+size_t contextBytes(const galois::HashConsedSet<true>::Context& c) {
+  return c.memoryBytes();
+}
+
 /**
  * Method from running PTA.
  */
-template <typename PTAClass, typename Alloc>
-void runPTA(PTAClass& pta, Alloc nodeAllocator) {
+template <typename PTAClass, typename PointsToContext, typename EdgeContext>
+void runPTA(PTAClass& pta, PointsToContext& pointsToContext,
+            EdgeContext& edgeContext) {
   size_t numNodes = pta.readConstraints(input.c_str());
-  pta.initialize(numNodes, nodeAllocator);
+  pta.initialize(numNodes, pointsToContext, edgeContext);
 
   galois::StatTimer T; // main timer
 
@@ -776,6 +902,12 @@ void runPTA(PTAClass& pta, Alloc nodeAllocator) {
 
   galois::gInfo("No of points-to facts computed = ", pta.countPointsToFacts());
 
+  galois::runtime::reportStat_Single("PointsTo", "PointsToSetBytes",
+                                     pta.pointsToBytes() +
+                                         contextBytes(pointsToContext));
+  galois::runtime::reportStat_Single("PointsTo", "EdgeSetBytes",
+                                     pta.edgeBytes());
+
   if (!skipVerify) {
     galois::gInfo("Doing verification step");
     pta.checkReprPointsTo();
@@ -787,6 +919,53 @@ void runPTA(PTAClass& pta, Alloc nodeAllocator) {
   }
 }
 
+/**
+ * Instantiates the executor with the set representation chosen on the
+ * command line and runs it.
+ *
+ * @tparam PTAClass PTASerial or PTAConcurrent
+ * @tparam IsConcurrent must match PTAClass
+ */
+template <template <typename, typename> class PTAClass, bool IsConcurrent>
+void runWithSets() {
+  switch (pointsToSetKind) {
+  case SBV: {
+    using Set = galois::SparseBitVector<IsConcurrent>;
+    PTAClass<Set, Set> p;
+    typename Set::Context nodeAllocator;
+    runPTA(p, nodeAllocator, nodeAllocator);
+    break;
+  }
+  case Roaring: {
+    using Set = galois::RoaringSet<IsConcurrent>;
+    PTAClass<Set, Set> p;
+    typename Set::Context context;
+    runPTA(p, context, context);
+    break;
+  }
+  case HashConsed: {
+    // edges gain little from sharing and are built one at a time, so they
+    // stay mutable roaring sets
+    using PtsSet  = galois::HashConsedSet<IsConcurrent>;
+    using EdgeSet = galois::RoaringSet<IsConcurrent>;
+    PTAClass<PtsSet, EdgeSet> p;
+    typename PtsSet::Context internTable;
+    typename EdgeSet::Context edgeContext;
+    runPTA(p, internTable, edgeContext);
+
+    galois::runtime::reportStat_Single("PointsTo", "InternedSets",
+                                       internTable.size());
+    galois::runtime::reportStat_Single("PointsTo", "UnionCacheHits",
+                                       internTable.unionHits());
+    galois::runtime::reportStat_Single("PointsTo", "UnionCacheMisses",
+                                       internTable.unionMisses());
+    break;
+  }
+  default:
+    GALOIS_DIE("unknown points-to set representation");
+  }
+}
+
 int main(int argc, char** argv) {
   galois::SharedMemSys G;
   LonestarStart(argc, argv, name, desc, url);
@@ -799,20 +978,14 @@ int main(int argc, char** argv) {
     galois::gInfo("Note correctness of this version is relative to the serial "
                   "version.");
 
-    PTAConcurrent p;
-    galois::FixedSizeAllocator<typename galois::SparseBitVector<true>::Node>
-        nodeAllocator;
-    runPTA(p, nodeAllocator);
+    runWithSets<PTAConcurrent, true>();
   } else {
     galois::gInfo("-------- Sequential version.");
     galois::gInfo(
         "The load store threshold (-lsThreshold) may need tweaking for "
         "best performance; its current setting may not be the best for "
         "your input and may actually degrade performance.");
-    PTASerial p;
-    galois::FixedSizeAllocator<typename galois::SparseBitVector<false>::Node>
-        nodeAllocator;
-    runPTA(p, nodeAllocator);
+    runWithSets<PTASerial, false>();
   }
 
   return 0;
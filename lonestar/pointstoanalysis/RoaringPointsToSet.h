@@ -0,0 +1,1153 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#ifndef _GALOIS_ROARINGPOINTSTOSET_
+#define _GALOIS_ROARINGPOINTSTOSET_
+
+#include <galois/substrate/SimpleLock.h>
+#include <boost/iterator/iterator_facade.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace galois {
+
+/**
+ * Roaring-style set of unsigned integers. The universe is split into chunks
+ * of 2^16 values keyed by the high 16 bits; each non-empty chunk is stored in
+ * whichever of a sorted array, a 2^16-bit bitmap, or a list of runs is
+ * smallest for its contents. Unions and subset checks work a chunk at a time
+ * instead of a word at a time, so large points-to sets avoid the pointer
+ * chasing of SparseBitVector.
+ *
+ * If concurrent, every operation besides iteration holds a per-set spin lock
+ * (two locks, taken in address order, for binary operations). Like
+ * SparseBitVector, BEHAVIOR IF THE SET IS ALTERED DURING ITERATION IS
+ * UNDEFINED.
+ */
+template <bool IsConcurrent>
+class RoaringSet {
+public:
+  //! Roaring sets need no shared state; kept for interface parity with
+  //! SparseBitVector's node allocator
+  struct Context {};
+
+private:
+  //! Largest cardinality stored as a sorted array (4096 * 2 bytes = bitmap)
+  static const uint32_t maxArraySize = 4096;
+  static const uint32_t bitmapWords  = (1u << 16) / 64;
+
+  struct Container {
+    enum Kind : uint8_t { Array, Bitmap, Run };
+
+    uint16_t key;
+    Kind kind;
+    uint32_t card;
+    //! Array: sorted values. Run: (start, length - 1) pairs sorted by start
+    std::vector<uint16_t> vals;
+    //! Bitmap: bitmapWords words
+    std::vector<uint64_t> bits;
+
+    Container(uint16_t k) : key(k), kind(Array), card(0) {}
+
+    bool operator==(const Container& o) const {
+      return key == o.key && kind == o.kind && card == o.card &&
+             vals == o.vals && bits == o.bits;
+    }
+
+    bool contains(uint16_t v) const {
+      switch (kind) {
+      case Array:
+        return std::binary_search(vals.begin(), vals.end(), v);
+      case Bitmap:
+        return (bits[v >> 6] >> (v & 63)) & 1;
+      default: {
+        size_t i = runIndex(v);
+        return i < numRuns() && v - vals[2 * i] <= vals[2 * i + 1];
+      }
+      }
+    }
+
+    /**
+     * @param cursor search hint; ranges must be queried in increasing order
+     * starting from a cursor of 0
+     * @returns true if every value in [first, last] is in the container
+     */
+    bool containsRange(uint32_t first, uint32_t last, size_t& cursor) const {
+      switch (kind) {
+      case Array: {
+        auto pos = std::lower_bound(vals.begin() + cursor, vals.end(), first);
+        size_t i = pos - vals.begin();
+        cursor   = i;
+        // sorted and unique, so the range is present iff it is contiguous
+        return i + (last - first) < vals.size() && *pos == first &&
+               vals[i + (last - first)] == last;
+      }
+      case Bitmap:
+        for (uint32_t v = first; v <= last;) {
+          uint64_t mask = ~0ull << (v & 63);
+          if (last - (v & ~63u) < 64) {
+            mask &= ~0ull >> (63 - (last & 63));
+          }
+          if ((bits[v >> 6] & mask) != mask) {
+            return false;
+          }
+          v = (v & ~63u) + 64;
+        }
+        return true;
+      default:
+        while (cursor < numRuns() &&
+               uint32_t(vals[2 * cursor]) + vals[2 * cursor + 1] < first) {
+          cursor++;
+        }
+        return cursor < numRuns() && vals[2 * cursor] <= first &&
+               last - vals[2 * cursor] <= vals[2 * cursor + 1];
+      }
+    }
+
+    size_t numRuns() const { return vals.size() / 2; }
+
+    //! @returns index of the last run starting at or before v (numRuns() if
+    //! no such run exists)
+    size_t runIndex(uint16_t v) const {
+      size_t lo = 0, hi = numRuns();
+      while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (vals[2 * mid] <= v) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return lo == 0 ? numRuns() : lo - 1;
+    }
+
+    /**
+     * Calls f(first, last) on every maximal run of values (inclusive) in
+     * order; stops early if f returns false.
+     *
+     * @returns false if f stopped the walk
+     */
+    template <typename F>
+    bool forEachRun(F f) const {
+      switch (kind) {
+      case Array:
+        for (size_t i = 0; i < vals.size();) {
+          size_t j = i;
+          while (j + 1 < vals.size() && vals[j + 1] == vals[j] + 1) {
+            j++;
+          }
+          if (!f(vals[i], vals[j])) {
+            return false;
+          }
+          i = j + 1;
+        }
+        return true;
+      case Bitmap: {
+        uint32_t v = 0;
+        while (v < (1u << 16)) {
+          uint32_t w     = v >> 6;
+          uint64_t word  = bits[w] & (~0ull << (v & 63));
+          while (!word && ++w < bitmapWords) {
+            word = bits[w];
+          }
+          if (!word) {
+            return true;
+          }
+          uint32_t first = w * 64 + __builtin_ctzll(word);
+          // find the first unset bit after first
+          uint64_t inv = ~bits[w] & (~0ull << (first & 63));
+          while (!inv && ++w < bitmapWords) {
+            inv = ~bits[w];
+          }
+          uint32_t end = inv ? w * 64 + __builtin_ctzll(inv) : (1u << 16);
+          if (!f(first, end - 1)) {
+            return false;
+          }
+          v = end;
+        }
+        return true;
+      }
+      default:
+        for (size_t i = 0; i < numRuns(); i++) {
+          if (!f(vals[2 * i], vals[2 * i] + vals[2 * i + 1])) {
+            return false;
+          }
+        }
+        return true;
+      }
+    }
+
+    /**
+     * Calls f(v) on every value in order; stops early if f returns false.
+     *
+     * @returns false if f stopped the walk
+     */
+    template <typename F>
+    bool allOf(F f) const {
+      switch (kind) {
+      case Array:
+        for (uint16_t v : vals) {
+          if (!f(v)) {
+            return false;
+          }
+        }
+        return true;
+      case Bitmap:
+        for (uint32_t w = 0; w < bitmapWords; w++) {
+          for (uint64_t word = bits[w]; word; word &= word - 1) {
+            if (!f(w * 64 + __builtin_ctzll(word))) {
+              return false;
+            }
+          }
+        }
+        return true;
+      default:
+        for (size_t i = 0; i < numRuns(); i++) {
+          for (uint32_t v = vals[2 * i]; v <= vals[2 * i] + vals[2 * i + 1];
+               v++) {
+            if (!f(v)) {
+              return false;
+            }
+          }
+        }
+        return true;
+      }
+    }
+
+    void toBitmap() {
+      if (kind == Bitmap) {
+        return;
+      }
+      std::vector<uint64_t> words(bitmapWords, 0);
+      forEachRun([&](uint32_t first, uint32_t last) {
+        for (uint32_t v = first; v <= last; v++) {
+          words[v >> 6] |= 1ull << (v & 63);
+        }
+        return true;
+      });
+      bits.swap(words);
+      std::vector<uint16_t>().swap(vals);
+      kind = Bitmap;
+    }
+
+    void toArray() {
+      if (kind == Array) {
+        return;
+      }
+      std::vector<uint16_t> values;
+      values.reserve(card);
+      allOf([&](uint32_t v) {
+        values.push_back(v);
+        return true;
+      });
+      vals.swap(values);
+      std::vector<uint64_t>().swap(bits);
+      kind = Array;
+    }
+
+    void toRuns() {
+      if (kind == Run) {
+        return;
+      }
+      std::vector<uint16_t> runs;
+      forEachRun([&](uint32_t first, uint32_t last) {
+        runs.push_back(first);
+        runs.push_back(last - first);
+        return true;
+      });
+      vals.swap(runs);
+      std::vector<uint64_t>().swap(bits);
+      kind = Run;
+    }
+
+    /**
+     * Switch to the smallest representation for the current contents. The
+     * choice depends only on the contents, so two canonical containers with
+     * the same values compare equal.
+     */
+    void canonicalize() {
+      size_t runs = 0;
+      if (kind == Run) {
+        runs = numRuns();
+      } else {
+        forEachRun([&](uint32_t, uint32_t) {
+          runs++;
+          return true;
+        });
+      }
+
+      size_t runBytes   = 4 * runs;
+      size_t arrayBytes = 2 * card;
+      if (runBytes < std::min<size_t>(arrayBytes, 2 * maxArraySize)) {
+        toRuns();
+      } else if (card <= maxArraySize) {
+        toArray();
+      } else {
+        toBitmap();
+      }
+      vals.shrink_to_fit();
+    }
+
+    /**
+     * @returns true if v was not in the container before
+     */
+    bool set(uint16_t v) {
+      switch (kind) {
+      case Array: {
+        auto pos = std::lower_bound(vals.begin(), vals.end(), v);
+        if (pos != vals.end() && *pos == v) {
+          return false;
+        }
+        vals.insert(pos, v);
+        card++;
+        if (card > maxArraySize) {
+          toBitmap();
+        }
+        return true;
+      }
+      case Bitmap: {
+        uint64_t mask = 1ull << (v & 63);
+        if (bits[v >> 6] & mask) {
+          return false;
+        }
+        bits[v >> 6] |= mask;
+        card++;
+        return true;
+      }
+      default:
+        return setRun(v);
+      }
+    }
+
+    bool setRun(uint16_t v) {
+      size_t i = runIndex(v);
+      size_t n = numRuns();
+      if (i < n && v - vals[2 * i] <= vals[2 * i + 1]) {
+        return false;
+      }
+      size_t next = (i == n) ? 0 : i + 1;
+      card++;
+
+      // extend the preceding run, merging with the next one if they touch
+      if (i < n && v == vals[2 * i] + vals[2 * i + 1] + 1) {
+        vals[2 * i + 1]++;
+        if (next < n && vals[2 * next] == v + 1) {
+          vals[2 * i + 1] += vals[2 * next + 1] + 1;
+          vals.erase(vals.begin() + 2 * next, vals.begin() + 2 * next + 2);
+        }
+        return true;
+      }
+      // extend the following run downwards
+      if (next < n && vals[2 * next] == v + 1) {
+        vals[2 * next]--;
+        vals[2 * next + 1]++;
+        return true;
+      }
+      uint16_t run[2] = {v, 0};
+      vals.insert(vals.begin() + 2 * next, run, run + 2);
+      return true;
+    }
+
+    /**
+     * Union o into this container.
+     *
+     * @returns number of values added
+     */
+    uint32_t unify(const Container& o) {
+      uint32_t oldCard = card;
+
+      if (kind == Run && o.kind == Run) {
+        // merge the two interval lists
+        std::vector<uint16_t> merged;
+        merged.reserve(vals.size() + o.vals.size());
+        uint32_t c = 0;
+        size_t i = 0, j = 0;
+        while (i < numRuns() || j < o.numRuns()) {
+          const std::vector<uint16_t>& src =
+              (j == o.numRuns() ||
+               (i < numRuns() && vals[2 * i] <= o.vals[2 * j]))
+                  ? vals
+                  : o.vals;
+          size_t& k      = (&src == &vals) ? i : j;
+          uint32_t first = src[2 * k];
+          uint32_t last  = first + src[2 * k + 1];
+          k++;
+
+          size_t n = merged.size();
+          if (n && first <= uint32_t(merged[n - 2]) + merged[n - 1] + 1) {
+            uint32_t prevLast = uint32_t(merged[n - 2]) + merged[n - 1];
+            if (last > prevLast) {
+              merged[n - 1] = last - merged[n - 2];
+              c += last - prevLast;
+            }
+          } else {
+            merged.push_back(first);
+            merged.push_back(last - first);
+            c += last - first + 1;
+          }
+        }
+        vals.swap(merged);
+        card = c;
+      } else if (kind != Bitmap && o.kind != Bitmap &&
+          card + o.card <= maxArraySize) {
+        // small: sorted merge
+        toArray();
+        std::vector<uint16_t> other;
+        const std::vector<uint16_t>* src = &o.vals;
+        if (o.kind != Array) {
+          other.reserve(o.card);
+          o.allOf([&](uint32_t v) {
+            other.push_back(v);
+            return true;
+          });
+          src = &other;
+        }
+        std::vector<uint16_t> merged;
+        merged.reserve(card + o.card);
+        std::set_union(vals.begin(), vals.end(), src->begin(), src->end(),
+                       std::back_inserter(merged));
+        vals.swap(merged);
+        card = vals.size();
+      } else {
+        toBitmap();
+        if (o.kind == Bitmap) {
+          uint32_t c = 0;
+          for (uint32_t w = 0; w < bitmapWords; w++) {
+            bits[w] |= o.bits[w];
+            c += __builtin_popcountll(bits[w]);
+          }
+          card = c;
+        } else {
+          o.forEachRun([&](uint32_t first, uint32_t last) {
+            for (uint32_t v = first; v <= last; v++) {
+              uint64_t mask = 1ull << (v & 63);
+              card += !(bits[v >> 6] & mask);
+              bits[v >> 6] |= mask;
+            }
+            return true;
+          });
+        }
+      }
+
+      if (card != oldCard) {
+        canonicalize();
+      }
+      return card - oldCard;
+    }
+
+    //! @returns true if this container is a subset of o
+    bool isSubsetEq(const Container& o) const {
+      if (card > o.card) {
+        return false;
+      }
+      if (kind == Bitmap && o.kind == Bitmap) {
+        for (uint32_t w = 0; w < bitmapWords; w++) {
+          if (bits[w] & ~o.bits[w]) {
+            return false;
+          }
+        }
+        return true;
+      }
+      if (kind == Array && o.kind == Array) {
+        return std::includes(o.vals.begin(), o.vals.end(), vals.begin(),
+                             vals.end());
+      }
+      size_t cursor = 0;
+      return forEachRun([&](uint32_t first, uint32_t last) {
+        return o.containsRange(first, last, cursor);
+      });
+    }
+
+    size_t memoryBytes() const {
+      return sizeof(Container) + vals.capacity() * sizeof(uint16_t) +
+             bits.capacity() * sizeof(uint64_t);
+    }
+  };
+
+  using Lock = galois::substrate::CondLock<IsConcurrent>;
+
+  std::vector<Container> containers; // sorted by key
+  mutable Lock lock;
+
+  //! @returns index of the container with key k or containers.size()
+  size_t find(uint16_t k) const {
+    auto pos = std::lower_bound(
+        containers.begin(), containers.end(), k,
+        [](const Container& c, uint16_t key) { return c.key < key; });
+    return (pos != containers.end() && pos->key == k)
+               ? pos - containers.begin()
+               : containers.size();
+  }
+
+  /**
+   * Locks this and other in address order so that two threads unifying
+   * a pair of sets in opposite directions cannot deadlock.
+   */
+  void lockPair(const RoaringSet& other) const {
+    if (this < &other) {
+      lock.lock();
+      other.lock.lock();
+    } else {
+      other.lock.lock();
+      lock.lock();
+    }
+  }
+
+  void unlockPair(const RoaringSet& other) const {
+    lock.unlock();
+    other.lock.unlock();
+  }
+
+public:
+  /**
+   * Iterator for RoaringSet; values are returned in increasing order.
+   */
+  class RoaringIterator
+      : public boost::iterator_facade<RoaringIterator, const unsigned,
+                                      boost::forward_traversal_tag> {
+    const Container* cur;
+    const Container* last;
+    uint32_t pos; // array index, bitmap bit, or run index
+    uint32_t sub; // offset into the current run
+    unsigned currentValue;
+
+    //! Finds the first value at or after (pos, sub), moving to the next
+    //! container if needed
+    void settle() {
+      for (; cur != last; ++cur, pos = 0, sub = 0) {
+        switch (cur->kind) {
+        case Container::Array:
+          if (pos < cur->vals.size()) {
+            currentValue = (unsigned(cur->key) << 16) | cur->vals[pos];
+            return;
+          }
+          break;
+        case Container::Bitmap:
+          while (pos < (1u << 16)) {
+            uint64_t word = cur->bits[pos >> 6] & (~0ull << (pos & 63));
+            if (word) {
+              pos          = (pos & ~63u) + __builtin_ctzll(word);
+              currentValue = (unsigned(cur->key) << 16) | pos;
+              return;
+            }
+            pos = (pos & ~63u) + 64;
+          }
+          break;
+        default:
+          if (pos < cur->numRuns()) {
+            currentValue =
+                (unsigned(cur->key) << 16) | (cur->vals[2 * pos] + sub);
+            return;
+          }
+        }
+      }
+      currentValue = -1;
+    }
+
+  public:
+    /**
+     * This is the end for an iterator.
+     */
+    RoaringIterator()
+        : cur(nullptr), last(nullptr), pos(0), sub(0), currentValue(-1) {}
+
+    RoaringIterator(const Container* first, const Container* end)
+        : cur(first), last(end), pos(0), sub(0), currentValue(-1) {
+      settle();
+    }
+
+  private:
+    friend class boost::iterator_core_access;
+
+    void increment() {
+      if (cur == last) {
+        return;
+      }
+      if (cur->kind == Container::Run && sub < cur->vals[2 * pos + 1]) {
+        sub++;
+      } else {
+        pos++;
+        sub = 0;
+      }
+      settle();
+    }
+
+    bool equal(const RoaringIterator& other) const {
+      bool atEnd      = (cur == last);
+      bool otherAtEnd = (other.cur == other.last);
+      if (atEnd || otherAtEnd) {
+        return atEnd == otherAtEnd;
+      }
+      return cur == other.cur && pos == other.pos && sub == other.sub;
+    }
+
+    const unsigned& dereference() const { return currentValue; }
+  };
+
+  RoaringSet() = default;
+
+  RoaringSet(const RoaringSet& other) : containers(other.containers) {}
+
+  RoaringSet(RoaringSet&& other) : containers(std::move(other.containers)) {}
+
+  RoaringSet& operator=(const RoaringSet& other) {
+    containers = other.containers;
+    return *this;
+  }
+
+  RoaringSet& operator=(RoaringSet&& other) {
+    containers = std::move(other.containers);
+    return *this;
+  }
+
+  /**
+   * No shared state to set up; the context only mirrors SparseBitVector.
+   */
+  void init(Context*) { containers.clear(); }
+
+  RoaringIterator begin() const {
+    return RoaringIterator(containers.data(),
+                           containers.data() + containers.size());
+  }
+
+  RoaringIterator end() const { return RoaringIterator(); }
+
+  /**
+   * @param num The value to add
+   * @returns true if num wasn't in the set previously
+   */
+  bool set(unsigned num) {
+    std::lock_guard<Lock> lg(lock);
+    uint16_t k = num >> 16;
+    size_t i   = find(k);
+    if (i == containers.size()) {
+      auto pos = std::lower_bound(
+          containers.begin(), containers.end(), k,
+          [](const Container& c, uint16_t key) { return c.key < key; });
+      pos = containers.insert(pos, Container(k));
+      i   = pos - containers.begin();
+    }
+    return containers[i].set(num & 0xFFFF);
+  }
+
+  /**
+   * @param num The value to check
+   * @returns true if num is in the set
+   */
+  bool test(unsigned num) const {
+    std::lock_guard<Lock> lg(lock);
+    size_t i = find(num >> 16);
+    return i != containers.size() && containers[i].contains(num & 0xFFFF);
+  }
+
+  /**
+   * @returns true if this set is a subset of (or equal to) other
+   */
+  bool isSubsetEq(const RoaringSet& other) const {
+    if (this == &other) {
+      return true;
+    }
+    lockPair(other);
+    bool subset = true;
+    size_t j    = 0;
+    for (const Container& c : containers) {
+      while (j < other.containers.size() && other.containers[j].key < c.key) {
+        j++;
+      }
+      if (j == other.containers.size() || other.containers[j].key != c.key ||
+          !c.isSubsetEq(other.containers[j])) {
+        subset = false;
+        break;
+      }
+    }
+    unlockPair(other);
+    return subset;
+  }
+
+  /**
+   * Takes the union of this set and other and saves it in this set.
+   *
+   * @param other Set to union with
+   * @returns number of values added to this set (0 if nothing changed)
+   */
+  unsigned unify(const RoaringSet& other) {
+    if (this == &other) {
+      return 0;
+    }
+    lockPair(other);
+
+    unsigned changed = 0;
+
+    // common case: every chunk of other already exists here, so the union
+    // happens in place without rebuilding the container vector
+    size_t i = 0;
+    for (const Container& o : other.containers) {
+      while (i < containers.size() && containers[i].key < o.key) {
+        i++;
+      }
+      if (i == containers.size() || containers[i].key != o.key) {
+        break;
+      }
+      i++;
+    }
+    if (other.containers.empty() ||
+        (i > 0 && containers[i - 1].key == other.containers.back().key)) {
+      i = 0;
+      for (const Container& o : other.containers) {
+        while (containers[i].key < o.key) {
+          i++;
+        }
+        changed += containers[i].unify(o);
+      }
+      unlockPair(other);
+      return changed;
+    }
+
+    std::vector<Container> merged;
+    merged.reserve(containers.size() + other.containers.size());
+
+    i = 0;
+    for (const Container& o : other.containers) {
+      while (i < containers.size() && containers[i].key < o.key) {
+        merged.push_back(std::move(containers[i++]));
+      }
+      if (i < containers.size() && containers[i].key == o.key) {
+        changed += containers[i].unify(o);
+        merged.push_back(std::move(containers[i++]));
+      } else {
+        merged.push_back(o);
+        changed += o.card;
+      }
+    }
+    while (i < containers.size()) {
+      merged.push_back(std::move(containers[i++]));
+    }
+    containers.swap(merged);
+
+    unlockPair(other);
+    return changed;
+  }
+
+  /**
+   * Move every container to its smallest representation. Needed before
+   * comparing or hashing sets built with set(), which does not re-encode
+   * containers.
+   */
+  void optimize() {
+    for (Container& c : containers) {
+      c.canonicalize();
+    }
+    containers.shrink_to_fit();
+  }
+
+  /**
+   * @returns number of values in the set
+   */
+  unsigned count() const {
+    unsigned n = 0;
+    for (const Container& c : containers) {
+      n += c.card;
+    }
+    return n;
+  }
+
+  /**
+   * @returns bytes used by this set, including the set object itself
+   */
+  size_t memoryBytes() const {
+    size_t bytes = sizeof(*this) +
+                   (containers.capacity() - containers.size()) *
+                       sizeof(Container);
+    for (const Container& c : containers) {
+      bytes += c.memoryBytes();
+    }
+    return bytes;
+  }
+
+  /**
+   * Hash of the contents; only meaningful on optimize()d sets.
+   */
+  size_t hash() const {
+    uint64_t h = 14695981039346656037ull;
+    auto mix   = [&h](uint64_t v) {
+      h ^= v;
+      h *= 1099511628211ull;
+    };
+    for (const Container& c : containers) {
+      mix((uint64_t(c.key) << 40) | (uint64_t(c.kind) << 32) | c.card);
+      for (uint16_t v : c.vals) {
+        mix(v);
+      }
+      for (uint64_t w : c.bits) {
+        mix(w);
+      }
+    }
+    return h;
+  }
+
+  //! Equality of optimize()d sets
+  bool operator==(const RoaringSet& other) const {
+    return containers == other.containers;
+  }
+
+  /**
+   * Gets the values in this set and returns them in a vector.
+   */
+  std::vector<unsigned> getAllSetBits() const {
+    std::vector<unsigned> setBits;
+    setBits.reserve(count());
+    for (const Container& c : containers) {
+      unsigned base = unsigned(c.key) << 16;
+      c.allOf([&](uint32_t v) {
+        setBits.push_back(base | v);
+        return true;
+      });
+    }
+    return setBits;
+  }
+
+  /**
+   * Output the values in this set.
+   *
+   * @param out Stream to output to
+   * @param prefix A string to append to the values
+   */
+  void print(std::ostream& out, std::string prefix = std::string("")) const {
+    std::vector<unsigned> setBits = getAllSetBits();
+    out << "Elements(" << setBits.size() << "): ";
+
+    for (auto setBitNum : setBits) {
+      out << prefix << setBitNum << ", ";
+    }
+
+    out << "\n";
+  }
+};
+
+/**
+ * Hash-consed points-to set. Each set is a handle to an immutable, interned
+ * RoaringSet; sets with equal contents share one copy. Subset checks between
+ * equal sets are a pointer compare, and unions are memoized on the pair of
+ * interned operands, so propagating the same set along many edges computes
+ * the union once.
+ *
+ * Updates build a new body, intern it, and swing the handle with a
+ * compare-and-swap, so iteration sees a consistent snapshot even while other
+ * threads add to the set. Interned bodies are never freed before the table
+ * is destroyed, so add many values at once with setAll rather than one set
+ * call each: every call copies the body and interns one more set.
+ */
+template <bool IsConcurrent>
+class HashConsedSet {
+public:
+  using Body = RoaringSet<false>;
+
+  /**
+   * Intern table shared by all hash-consed sets of an analysis. Striped by
+   * hash so concurrent interning mostly touches different locks.
+   */
+  class Context {
+    static const unsigned numStripes = IsConcurrent ? 256 : 1;
+    using Lock = galois::substrate::CondLock<IsConcurrent>;
+
+    struct PairHash {
+      size_t operator()(const std::pair<const Body*, const Body*>& p) const {
+        return std::hash<const Body*>()(p.first) * 31 +
+               std::hash<const Body*>()(p.second);
+      }
+    };
+
+    struct Stripe {
+      Lock lock;
+      std::unordered_multimap<size_t, const Body*> bodies;
+      //! (a, b) -> (a U b, |a U b| - |a|)
+      std::unordered_map<std::pair<const Body*, const Body*>,
+                         std::pair<const Body*, unsigned>, PairHash>
+          unions;
+      std::vector<std::unique_ptr<Body>> owned;
+      size_t bodyBytes   = 0;
+      size_t unionHits   = 0;
+      size_t unionMisses = 0;
+    };
+
+    std::unique_ptr<Stripe[]> stripes;
+
+    Stripe& stripeFor(size_t h) { return stripes[h % numStripes]; }
+
+    //! Bytes of an unordered container: its buckets, and per element a node
+    //! holding the value, the next pointer and the cached hash
+    template <typename Table>
+    static size_t tableBytes(const Table& t) {
+      return t.bucket_count() * sizeof(void*) +
+             t.size() * (sizeof(typename Table::value_type) + sizeof(void*) +
+                         sizeof(size_t));
+    }
+
+  public:
+    Context() : stripes(new Stripe[numStripes]) {}
+
+    /**
+     * @returns the interned copy of body (nullptr for the empty set)
+     */
+    const Body* intern(Body&& body) {
+      if (body.count() == 0) {
+        return nullptr;
+      }
+      body.optimize();
+      size_t h  = body.hash();
+      Stripe& s = stripeFor(h);
+      std::lock_guard<Lock> lg(s.lock);
+
+      auto range = s.bodies.equal_range(h);
+      for (auto ii = range.first; ii != range.second; ++ii) {
+        if (*ii->second == body) {
+          return ii->second;
+        }
+      }
+      s.owned.emplace_back(new Body(std::move(body)));
+      const Body* interned = s.owned.back().get();
+      s.bodies.emplace(h, interned);
+      s.bodyBytes += interned->memoryBytes();
+      return interned;
+    }
+
+    /**
+     * @param added OUTPUT: number of values in b but not in a
+     * @returns the interned union of a and b
+     */
+    const Body* unionOf(const Body* a, const Body* b, unsigned& added) {
+      added = 0;
+      if (!b || a == b) {
+        return a;
+      }
+      if (!a) {
+        added = b->count();
+        return b;
+      }
+
+      auto key  = std::make_pair(a, b);
+      Stripe& s = stripeFor(PairHash()(key));
+      {
+        std::lock_guard<Lock> lg(s.lock);
+        auto ii = s.unions.find(key);
+        if (ii != s.unions.end()) {
+          s.unionHits++;
+          added = ii->second.second;
+          return ii->second.first;
+        }
+        s.unionMisses++;
+      }
+
+      Body result(*a);
+      added              = result.unify(*b);
+      const Body* merged = added ? intern(std::move(result)) : a;
+
+      std::lock_guard<Lock> lg(s.lock);
+      s.unions.emplace(key, std::make_pair(merged, added));
+      return merged;
+    }
+
+    //! @returns number of distinct interned sets
+    size_t size() const {
+      size_t n = 0;
+      for (unsigned i = 0; i < numStripes; i++) {
+        n += stripes[i].owned.size();
+      }
+      return n;
+    }
+
+    //! @returns bytes held by interned sets, the intern table and the union
+    //! memo table
+    size_t memoryBytes() const {
+      size_t n = 0;
+      for (unsigned i = 0; i < numStripes; i++) {
+        const Stripe& s = stripes[i];
+        n += s.bodyBytes + tableBytes(s.bodies) + tableBytes(s.unions) +
+             s.owned.capacity() * sizeof(std::unique_ptr<Body>);
+      }
+      return n;
+    }
+
+    //! @returns number of unions answered from the memo table
+    size_t unionHits() const {
+      size_t n = 0;
+      for (unsigned i = 0; i < numStripes; i++) {
+        n += stripes[i].unionHits;
+      }
+      return n;
+    }
+
+    //! @returns number of unions that had to be computed
+    size_t unionMisses() const {
+      size_t n = 0;
+      for (unsigned i = 0; i < numStripes; i++) {
+        n += stripes[i].unionMisses;
+      }
+      return n;
+    }
+  };
+
+private:
+  Context* table;
+  std::atomic<const Body*> body;
+
+public:
+  using iterator = typename Body::RoaringIterator;
+
+  HashConsedSet() : table(nullptr), body(nullptr) {}
+
+  HashConsedSet(const HashConsedSet& other)
+      : table(other.table), body(other.body.load()) {}
+
+  HashConsedSet& operator=(const HashConsedSet& other) {
+    table = other.table;
+    body  = other.body.load();
+    return *this;
+  }
+
+  /**
+   * @param _table intern table shared by all sets of the analysis
+   */
+  void init(Context* _table) {
+    table = _table;
+    body  = nullptr;
+  }
+
+  iterator begin() const {
+    const Body* b = body.load();
+    return b ? b->begin() : iterator();
+  }
+
+  iterator end() const { return iterator(); }
+
+  /**
+   * @param num The value to add
+   * @returns true if num wasn't in the set previously
+   */
+  bool set(unsigned num) {
+    const Body* cur = body.load();
+    while (true) {
+      if (cur && cur->test(num)) {
+        return false;
+      }
+      Body next = cur ? *cur : Body();
+      next.set(num);
+      const Body* interned = table->intern(std::move(next));
+      if (body.compare_exchange_weak(cur, interned)) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * Adds every value of [first, last), building the new body in place and
+   * interning it once.
+   *
+   * @returns number of values that weren't in the set previously
+   */
+  template <typename Iterator>
+  unsigned setAll(Iterator first, Iterator last) {
+    const Body* cur = body.load();
+    while (true) {
+      Body next      = cur ? *cur : Body();
+      unsigned added = 0;
+      for (Iterator ii = first; ii != last; ++ii) {
+        added += next.set(*ii);
+      }
+      if (!added) {
+        return 0;
+      }
+      const Body* interned = table->intern(std::move(next));
+      if (body.compare_exchange_weak(cur, interned)) {
+        return added;
+      }
+    }
+  }
+
+  bool test(unsigned num) const {
+    const Body* b = body.load();
+    return b && b->test(num);
+  }
+
+  bool isSubsetEq(const HashConsedSet& other) const {
+    const Body* a = body.load();
+    const Body* b = other.body.load();
+    if (a == b || !a) {
+      return true;
+    }
+    return b && a->isSubsetEq(*b);
+  }
+
+  /**
+   * Takes the union of this set and other and saves it in this set.
+   *
+   * @returns number of values added to this set (0 if nothing changed)
+   */
+  unsigned unify(const HashConsedSet& other) {
+    const Body* src = other.body.load();
+    const Body* cur = body.load();
+    while (true) {
+      unsigned added;
+      const Body* merged = table->unionOf(cur, src, added);
+      if (merged == cur) {
+        return 0;
+      }
+      if (body.compare_exchange_weak(cur, merged)) {
+        return added;
+      }
+    }
+  }
+
+  unsigned count() const {
+    const Body* b = body.load();
+    return b ? b->count() : 0;
+  }
+
+  /**
+   * @returns bytes of the handle only; interned bodies are accounted for
+   * by the Context
+   */
+  size_t memoryBytes() const { return sizeof(*this); }
+
+  std::vector<unsigned> getAllSetBits() const {
+    const Body* b = body.load();
+    return b ? b->getAllSetBits() : std::vector<unsigned>();
+  }
+
+  void print(std::ostream& out, std::string prefix = std::string("")) const {
+    const Body* b = body.load();
+    if (b) {
+      b->print(out, prefix);
+    } else {
+      Body().print(out, prefix);
+    }
+  }
+};
+
+} // namespace galois
+
+#endif
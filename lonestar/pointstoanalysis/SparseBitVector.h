@@ -254,6 +254,9 @@ struct SparseBitVector {
     }
   };
 
+  //! Shared state needed by init: the allocator for linked list nodes
+  using Context = galois::FixedSizeAllocator<Node>;
+
   //////////////////////////////////////////////////////////////////////////////
 
   /**
@@ -800,6 +803,20 @@ struct SparseBitVector {
     return nbits;
   }
 
+  /**
+   * @returns bytes used by this bitvector, including the bitvector object
+   * itself
+   */
+  size_t memoryBytes() const {
+    size_t bytes = sizeof(*this);
+
+    for (Node* ptr = head; ptr; ptr = (ptr->_next)) {
+      bytes += sizeof(Node);
+    }
+
+    return bytes;
+  }
+
   /**
    * Gets the set bits in this bitvector and returns them in a vector type.
    *
@@ -198,12 +198,11 @@ struct PreflowPush {
     return ret.ei;
   }
 
-  void acquire(const GNode& src) {
+  //! Acquires src and its neighbors; returns false on a conflict, after
+  //! which the operator must return (see galois::runtime::tryAcquire)
+  bool acquire(const GNode& src) {
     // LC Graphs have a different idea of locking
-    for (auto ii : graph.edges(src, galois::MethodFlag::WRITE)) {
-      GNode dst = graph.getEdgeDst(ii);
-      graph.getData(dst, galois::MethodFlag::WRITE);
-    }
+    return graph.tryAcquireNeighborhood(src);
   }
 
   void relabel(const GNode& src) {
@@ -328,13 +327,14 @@ struct PreflowPush {
         galois::iterate(initial),
         [&, this](GNode& src, auto& ctx) {
           if (version != nondet) {
-            if (ctx.isFirstPass()) {
-              this->acquire(src);
+            if (ctx.isFirstPass() && !this->acquire(src)) {
+              return;
             }
             if (version == detDisjoint && ctx.isFirstPass()) {
               return;
             } else {
-              this->graph.getData(src, galois::MethodFlag::WRITE);
+              if (!this->graph.tryAcquireNode(src))
+                return;
               ctx.cautiousPoint();
             }
           }
@@ -363,7 +363,8 @@ struct PreflowPush {
         galois::iterate(initial),
         [&counter, relabel_interval, this](GNode& src, auto& ctx) {
           int increment = 1;
-          this->acquire(src);
+          if (!this->acquire(src))
+            return;
           if (this->discharge(src, ctx)) {
             increment += BETA;
           }
@@ -0,0 +1,125 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/Reduction.h"
+#include "galois/Timer.h"
+#include "galois/graphs/LCGraph.h"
+#include "llvm/Support/CommandLine.h"
+
+#include "Lonestar/BoilerPlate.h"
+#include "Lonestar/IncrementalBFS_SSSP.h"
+
+#include <iostream>
+
+namespace cll = llvm::cl;
+
+static const char* name = "Incremental Single Source Shortest Path";
+
+static const char* desc =
+    "Maintains the shortest path from a source node to all nodes in a "
+    "directed graph with positive edge weights while batches of edges are "
+    "inserted and deleted";
+
+static const char* url = "single_source_shortest_path";
+
+static cll::opt<std::string>
+    filename(cll::Positional, cll::desc("<input graph>"), cll::Required);
+
+static cll::opt<unsigned int>
+    startNode("startNode",
+              cll::desc("Node to start search from (default value 0)"),
+              cll::init(0));
+static cll::opt<unsigned int>
+    reportNode("reportNode",
+               cll::desc("Node to report distance to (default value 1)"),
+               cll::init(1));
+static cll::opt<unsigned int>
+    stepShift("delta",
+              cll::desc("Shift value for the deltastep (default value 13)"),
+              cll::init(13));
+
+using Graph =
+    galois::graphs::LC_Dynamic_CSR_Graph<std::atomic<uint32_t>, uint32_t>;
+using InGraph = galois::graphs::LC_Dynamic_CSR_Graph<void, uint32_t>;
+using GNode   = Graph::GraphNode;
+using SSSP    = IncrementalBFS_SSSP<Graph, InGraph, uint32_t, true>;
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys G;
+  LonestarStart(argc, argv, name, desc, url);
+
+  Graph graph;
+  InGraph inGraph;
+
+  std::cout << "Reading from file: " << filename << std::endl;
+  galois::graphs::readGraph(graph, filename);
+  std::cout << "Read " << graph.size() << " nodes, " << graph.sizeEdges()
+            << " edges" << std::endl;
+
+  if (startNode >= graph.size() || reportNode >= graph.size()) {
+    std::cerr << "failed to set report: " << reportNode
+              << " or failed to set source: " << startNode << "\n";
+    assert(0);
+    abort();
+  }
+
+  galois::GAccumulator<size_t> zeroWeights;
+  galois::do_all(galois::iterate(graph),
+                 [&](GNode n) {
+                   for (auto e : graph.edges(n))
+                     if (graph.getEdgeData(e) == 0)
+                       zeroWeights += 1;
+                 },
+                 galois::steal(), galois::no_stats());
+  if (zeroWeights.reduce())
+    GALOIS_DIE("incremental SSSP needs positive edge weights; the input has ",
+               zeroWeights.reduce(), " zero-weight edges");
+
+  transposeGraph(graph, inGraph);
+  std::vector<EdgeUpdate> updates = loadEdgeUpdates(graph);
+
+  SSSP sssp(graph, inGraph, startNode, stepShift);
+
+  galois::StatTimer initialTime("InitialTime");
+  initialTime.start();
+  sssp.computeFromScratch();
+  initialTime.stop();
+
+  galois::StatTimer Tmain;
+  Tmain.start();
+  forEachBatch(updates, [&](auto begin, auto end) { sssp.update(begin, end); });
+  Tmain.stop();
+
+  galois::runtime::reportStat_Single("SSSP", "Updates", updates.size());
+  galois::runtime::reportStat_Single("SSSP", "Invalidated", sssp.numInvalidated);
+
+  std::cout << "Node " << reportNode << " has distance "
+            << graph.getData(reportNode) << "\n";
+
+  if (!skipVerify) {
+    if (sssp.verify()) {
+      std::cout << "Verification successful.\n";
+    } else {
+      GALOIS_DIE("Verification failed");
+    }
+  }
+
+  return 0;
+}
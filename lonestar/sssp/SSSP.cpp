@@ -82,6 +82,16 @@ static cll::opt<Algo>
                      clEnumVal(topoTile, "topoTile"), clEnumValEnd),
          cll::init(deltaTile));
 
+enum WorkList { PerSocketChunk, WorkStealing };
+
+static cll::opt<WorkList> worklist(
+    "wl",
+    cll::desc("Worklist of each priority level of the delta algorithms "
+              "(default value PerSocketChunk):"),
+    cll::values(clEnumVal(PerSocketChunk, "PerSocketChunk"),
+                clEnumVal(WorkStealing, "WorkStealing"), clEnumValEnd),
+    cll::init(PerSocketChunk));
+
 // typedef galois::graphs::LC_InlineEdge_Graph<std::atomic<unsigned int>,
 // uint32_t>::with_no_lockable<true>::type::with_numa_alloc<true>::type Graph;
 //! [withnumaalloc]
@@ -105,7 +115,7 @@ using ReqPushWrap          = SSSP::ReqPushWrap;
 using OutEdgeRangeFn       = SSSP::OutEdgeRangeFn;
 using TileRangeFn          = SSSP::TileRangeFn;
 
-template <typename T, typename P, typename R>
+template <typename T, typename Chunk, typename P, typename R>
 void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
                    const R& edgeRange) {
 
@@ -116,8 +126,7 @@ void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
 
   namespace gwl = galois::worklists;
 
-  using PSchunk = gwl::PerSocketChunkFIFO<CHUNK_SIZE>;
-  using OBIM    = gwl::OrderedByIntegerMetric<UpdateRequestIndexer, PSchunk>;
+  using OBIM = gwl::OrderedByIntegerMetric<UpdateRequestIndexer, Chunk>;
 
   graph.getData(source) = 0;
 
@@ -179,6 +188,25 @@ void deltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
   }
 }
 
+template <typename T, typename P, typename R>
+void runDeltaStepAlgo(Graph& graph, GNode source, const P& pushWrap,
+                      const R& edgeRange) {
+  namespace gwl = galois::worklists;
+
+  switch (worklist) {
+  case PerSocketChunk:
+    deltaStepAlgo<T, gwl::PerSocketChunkFIFO<CHUNK_SIZE>>(graph, source,
+                                                          pushWrap, edgeRange);
+    break;
+  case WorkStealing:
+    deltaStepAlgo<T, gwl::WorkStealingFIFO<CHUNK_SIZE>>(graph, source,
+                                                        pushWrap, edgeRange);
+    break;
+  default:
+    std::abort();
+  }
+}
+
 template <typename T, typename P, typename R>
 void serDeltaAlgo(Graph& graph, const GNode& source, const P& pushWrap,
                   const R& edgeRange) {
@@ -410,12 +438,12 @@ int main(int argc, char** argv) {
 
   switch (algo) {
   case deltaTile:
-    deltaStepAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
-                               TileRangeFn());
+    runDeltaStepAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
+                                  TileRangeFn());
     break;
   case deltaStep:
-    deltaStepAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
-                                 OutEdgeRangeFn{graph});
+    runDeltaStepAlgo<UpdateRequest>(graph, source, ReqPushWrap(),
+                                    OutEdgeRangeFn{graph});
     break;
   case serDeltaTile:
     serDeltaAlgo<SrcEdgeTile>(graph, source, SrcEdgeTilePushWrap{graph},
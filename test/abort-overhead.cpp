@@ -0,0 +1,114 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Timer.h"
+#include "galois/runtime/Context.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace galois::runtime;
+
+// Compares the cost of aborting an iteration through the status-returning
+// tryAcquire with the configured signalling path (longjmp or throw) and with
+// plain C++ unwinding. Every acquire conflicts with a lock held by another
+// context.
+
+static void report(const char* name, galois::Timer& t, int numAborts) {
+  std::cout << name << " aborts: " << t.get() << " ms, "
+            << t.get_usec() * 1000.0 / numAborts << " ns/abort\n";
+}
+
+GALOIS_ATTRIBUTE_NOINLINE static void throwConflict() { throw CONFLICT; }
+
+int main(int argc, char** argv) {
+  int numAborts = 1 << 18;
+  if (argc > 1)
+    numAborts = atoi(argv[1]);
+  if (numAborts <= 0)
+    numAborts = 1;
+
+  Lockable L;
+  SimpleRuntimeContext owner;
+  SimpleRuntimeContext ctx;
+  setThreadContext(&owner);
+  acquire(&L, galois::MethodFlag::WRITE);
+  setThreadContext(&ctx);
+
+  galois::Timer t;
+  int aborted = 0;
+  t.start();
+  for (int x = 0; x < numAborts; ++x) {
+    ctx.startIteration();
+    if (!tryAcquire(&L, galois::MethodFlag::WRITE)) {
+      ctx.cancelIteration();
+      ++aborted;
+    }
+  }
+  t.stop();
+  GALOIS_ASSERT(aborted == numAborts);
+  report("status", t, numAborts);
+
+  volatile int signalled = 0;
+  t.start();
+  for (int x = 0; x < numAborts; ++x) {
+    ctx.startIteration();
+#ifdef GALOIS_USE_LONGJMP_ABORT
+    if (setjmp(execFrame) == 0) {
+      acquire(&L, galois::MethodFlag::WRITE);
+    } else {
+#else
+    try {
+      acquire(&L, galois::MethodFlag::WRITE);
+    } catch (ConflictFlag const&) {
+#endif
+      clearConflictLock();
+      ctx.cancelIteration();
+      signalled = signalled + 1;
+    }
+  }
+  t.stop();
+  GALOIS_ASSERT(signalled == numAborts);
+#ifdef GALOIS_USE_LONGJMP_ABORT
+  report("longjmp", t, numAborts);
+#else
+  report("exception", t, numAborts);
+#endif
+
+  int thrown = 0;
+  t.start();
+  for (int x = 0; x < numAborts; ++x) {
+    ctx.startIteration();
+    try {
+      throwConflict();
+    } catch (ConflictFlag const&) {
+      ctx.cancelIteration();
+      ++thrown;
+    }
+  }
+  t.stop();
+  GALOIS_ASSERT(thrown == numAborts);
+  report("throw", t, numAborts);
+
+  setThreadContext(&owner);
+  owner.commitIteration();
+  setThreadContext(nullptr);
+
+  return 0;
+}
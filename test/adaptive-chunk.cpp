@@ -0,0 +1,79 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+
+#include <cstdlib>
+
+// Iteration costs follow a heavy tail so that adaptive chunk sizes have
+// something to adapt to; every item must still be processed exactly once.
+static unsigned cost(unsigned i) { return (i % 1024 == 0) ? 20000 : 10; }
+
+static void spin(unsigned n) {
+  volatile unsigned x = 0;
+  for (unsigned i = 0; i < n; ++i)
+    x += i;
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  int numThreads = 2;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+  galois::setActiveThreads(numThreads);
+
+  const unsigned size = 200000;
+  galois::LargeArray<std::atomic<unsigned>> counts;
+  counts.create(size);
+  for (unsigned i = 0; i < size; ++i)
+    counts[i] = 0;
+
+  galois::do_all(galois::iterate(0u, size),
+                 [&](unsigned i) {
+                   spin(cost(i));
+                   counts[i] += 1;
+                 },
+                 galois::adaptive_chunk_size(1, 1024),
+                 galois::loopname("adaptive do_all"));
+
+  for (unsigned i = 0; i < size; ++i)
+    GALOIS_ASSERT(counts[i] == 1, "do_all visited ", i, " ",
+                  counts[i].load(), " times");
+
+  // initial items i stand for item 2i, which pushes size + 2i + 1 for its
+  // odd successor
+  galois::for_each(galois::iterate(0u, size / 2),
+                   [&](unsigned i, auto& ctx) {
+                     unsigned item = i < size ? 2 * i : i - size;
+                     spin(cost(item));
+                     counts[item] += 1;
+                     if (i < size)
+                       ctx.push(size + item + 1);
+                   },
+                   galois::wl<galois::worklists::AdaptiveChunkFIFO<256>>(),
+                   galois::no_conflicts(),
+                   galois::loopname("adaptive for_each"));
+
+  for (unsigned i = 0; i < size; ++i)
+    GALOIS_ASSERT(counts[i] == 2, "for_each visited ", i, " ",
+                  counts[i].load() - 1, " times");
+
+  return 0;
+}
@@ -17,72 +17,77 @@
  * Documentation, or loss or inaccuracy of data of any kind.
  */
 
-#include "galois/Timer.h"
 #include "galois/Galois.h"
 #include "galois/substrate/Barrier.h"
 
+#include <atomic>
 #include <iostream>
 #include <cstdlib>
+#include <vector>
 #include <unistd.h>
 
-unsigned iter       = 1;
-unsigned numThreads = 2;
+// Checks that every barrier separates phases, then reports the time per wait
+// of every barrier for each thread count as CSV, along with the barrier
+// getBarrier() selects for that count.
+//
+// usage: barriers [waits [maxThreads]]
 
-char bname[100];
+using galois::substrate::Barrier;
 
-struct emp {
-  galois::substrate::Barrier& b;
+//! Fails if a thread passes a wait of barrier before all numT threads arrived
+static void checkPhases(Barrier& barrier, unsigned numT) {
+  const unsigned phases = 64;
+  std::vector<std::atomic<unsigned>> arrived(phases);
+  for (auto& a : arrived)
+    a = 0;
+  std::atomic<bool> early(false);
 
-  void go() {
-    for (unsigned i = 0; i < iter; ++i) {
-      b.wait();
+  barrier.reinit(numT);
+  galois::substrate::getThreadPool().run(numT, [&]() {
+    for (unsigned k = 0; k < phases; ++k) {
+      ++arrived[k];
+      barrier.wait();
+      if (arrived[k] != numT)
+        early = true;
     }
-  }
-
-  template <typename T>
-  void operator()(const T& t) {
-    go();
-  }
-
-  template <typename T, typename C>
-  void operator()(const T& t, const C& c) {
-    go();
-  }
-};
-
-void test(std::unique_ptr<galois::substrate::Barrier> b) {
-  unsigned M = numThreads;
-  if (M > 16)
-    M /= 2;
-  while (M) {
-    galois::setActiveThreads(M); // galois::runtime::LL::getMaxThreads());
-    b->reinit(M);
-    galois::Timer t;
-    t.start();
-    emp e{*b.get()};
-    galois::on_each(e);
-    t.stop();
-    std::cout << bname << "," << b->name() << "," << M << "," << t.get()
-              << "\n";
-    M -= 1;
-  }
+  });
+  GALOIS_ASSERT(!early, "barrier ", barrier.name(), " on ", numT,
+                " threads let a thread through early");
 }
 
 int main(int argc, char** argv) {
   galois::SharedMemSys Galois_runtime;
+  using namespace galois::substrate;
+
+  unsigned iter = 1024;
   if (argc > 1)
     iter = atoi(argv[1]);
   if (!iter)
     iter = 16 * 1024;
+  unsigned maxThreads = 2;
   if (argc > 2)
-    numThreads = galois::substrate::getThreadPool().getMaxThreads();
+    maxThreads = atoi(argv[2]);
+  maxThreads = std::min(maxThreads, getThreadPool().getMaxUsableThreads());
+  maxThreads = std::max(maxThreads, 1U);
 
+  char bname[100];
   gethostname(bname, sizeof(bname));
-  using namespace galois::substrate;
-  test(createPthreadBarrier(1));
-  test(createCountingBarrier(1));
-  test(createMCSBarrier(1));
-  test(createTopoBarrier(1));
-  test(createDisseminationBarrier(1));
+
+  std::cout << "host,barrier,threads,ns_per_wait\n";
+  for (unsigned M = 1; M <= maxThreads; ++M) {
+    for (auto& name : getBarrierNames()) {
+      std::unique_ptr<Barrier> b = createBarrier(name, M);
+      if (!b)
+        continue;
+      checkPhases(*b, M);
+      std::cout << bname << "," << b->name() << "," << M << ","
+                << timeBarrier(*b, M, iter) << "\n";
+    }
+    galois::setActiveThreads(M);
+    Barrier& selected = getBarrier(M);
+    checkPhases(selected, M);
+    std::cout << bname << ",selected:" << selected.name() << "," << M << ","
+              << timeBarrier(selected, M, iter) << "\n";
+  }
   return 0;
 }
@@ -0,0 +1,143 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/DynamicBitset.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using Reference = std::vector<bool>;
+
+static void check(const galois::DynamicBitSet& bitset, const Reference& ref) {
+  std::vector<uint32_t> expected;
+  for (size_t i = 0; i < ref.size(); ++i) {
+    GALOIS_ASSERT(bitset.test(i) == ref[i], "bit ", i, " differs");
+    if (ref[i])
+      expected.push_back(i);
+  }
+  GALOIS_ASSERT(bitset.count() == expected.size());
+  GALOIS_ASSERT(bitset.getOffsets() == expected);
+
+  std::vector<uint32_t> visited;
+  bitset.for_each_set([&](size_t i) { visited.push_back(i); });
+  GALOIS_ASSERT(visited == expected);
+
+  galois::GAccumulator<size_t> sum;
+  bitset.do_all_set([&](size_t i) { sum += i + 1; });
+  size_t expectedSum = 0;
+  for (uint32_t i : expected)
+    expectedSum += i + 1;
+  GALOIS_ASSERT(sum.reduce() == expectedSum);
+}
+
+static void randomFill(galois::DynamicBitSet& bitset, Reference& ref,
+                       size_t num, std::mt19937& gen) {
+  std::uniform_int_distribution<size_t> dist(0, ref.size() - 1);
+  for (size_t i = 0; i < num; ++i) {
+    size_t bit = dist(gen);
+    bitset.set(bit);
+    ref[bit] = true;
+  }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  int numThreads = 2;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+  galois::setActiveThreads(numThreads);
+
+  const size_t size = 100003;
+  std::mt19937 gen(7);
+  galois::DynamicBitSet a, b, c;
+  Reference ra(size), rb(size), rc(size);
+  a.resize(size);
+  b.resize(size);
+  c.resize(size);
+  check(a, ra);
+
+  // sparse bits, a dense range and single resets
+  randomFill(a, ra, 50, gen);
+  a.set_range(70000, 75000);
+  std::fill(ra.begin() + 70000, ra.begin() + 75001, true);
+  a.set_range(3, 5);
+  std::fill(ra.begin() + 3, ra.begin() + 6, true);
+  a.set_range(size - 1, size - 1);
+  ra[size - 1] = true;
+  a.reset(70001);
+  ra[70001] = false;
+  check(a, ra);
+
+  randomFill(b, rb, 2000, gen);
+  c.bitwise_and(a, b);
+  for (size_t i = 0; i < size; ++i)
+    rc[i] = ra[i] && rb[i];
+  check(c, rc);
+
+  c.bitwise_xor(a, b);
+  for (size_t i = 0; i < size; ++i)
+    rc[i] = ra[i] != rb[i];
+  check(c, rc);
+
+  c.bitwise_or(a);
+  for (size_t i = 0; i < size; ++i)
+    rc[i] = rc[i] || ra[i];
+  check(c, rc);
+
+  c.bitwise_andnot(b);
+  for (size_t i = 0; i < size; ++i)
+    rc[i] = rc[i] && !rb[i];
+  check(c, rc);
+
+  c.bitwise_and(b);
+  check(c, Reference(size));
+
+  a.bitwise_xor(b);
+  for (size_t i = 0; i < size; ++i)
+    ra[i] = ra[i] != rb[i];
+  check(a, ra);
+
+  // writes through get_vec() bypass the summary
+  auto& words = b.get_vec();
+  words[1000] |= 1;
+  rb[64000]   = true;
+  check(b, rb);
+
+  // parallel sets from all threads
+  galois::DynamicBitSet d;
+  Reference rd(size);
+  d.resize(size);
+  galois::do_all(galois::iterate(size_t{0}, size), [&](size_t i) {
+    if (i % 7 == 0)
+      d.set(i);
+  });
+  for (size_t i = 0; i < size; i += 7)
+    rd[i] = true;
+  check(d, rd);
+
+  d.reset();
+  a.reset();
+  check(d, Reference(size));
+  check(a, Reference(size));
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/runtime/Context.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+// Every iteration takes a few of a handful of hot locks, so most iterations
+// abort and the conflict manager throttles the loop; every item must still
+// commit exactly once, whether conflicts unwind the operator or are reported
+// through tryAcquire, and whichever worklist holds the work. Yielding while
+// holding a lock makes threads overlap even when they share a core.
+
+namespace wl = galois::worklists;
+
+struct Bucket {
+  unsigned operator()(unsigned i) const { return i % 8; }
+};
+
+using OBIM        = wl::OrderedByIntegerMetric<Bucket, wl::PerSocketChunkFIFO<>>;
+using SharedLocal = wl::LocalQueue<wl::PerSocketChunkFIFO<>>;
+
+// Throttled threads can only stop if the worklist can hand their private
+// work to others; loops on the rest are never throttled
+static_assert(wl::HasRelease<wl::PerSocketChunkLIFO<>>::value, "");
+static_assert(wl::HasRelease<wl::WorkStealingLIFO<>>::value, "");
+static_assert(wl::HasRelease<OBIM>::value, "");
+static_assert(wl::HasRelease<SharedLocal>::value, "");
+static_assert(wl::HasRelease<wl::GFIFO<>>::value, "");
+static_assert(!wl::HasRelease<wl::LocalQueue<>>::value, "");
+static_assert(!wl::HasRelease<wl::PerThreadChunkLIFO<>>::value, "");
+static_assert(!wl::HasRelease<OBIM::with_barrier<true>::type>::value, "");
+
+template <typename WL>
+void runOn(galois::runtime::Lockable* locks, unsigned numLocks,
+           galois::LargeArray<std::atomic<unsigned>>& counts, unsigned round,
+           const char* name) {
+  galois::for_each(galois::iterate(0u, unsigned(counts.size())),
+                   [&](unsigned i, auto&) {
+                     for (unsigned j = 0; j < 2; ++j) {
+                       galois::runtime::acquire(&locks[(i + j) % numLocks],
+                                                galois::MethodFlag::WRITE);
+                       std::this_thread::yield();
+                     }
+                     counts[i] += 1;
+                   },
+                   galois::wl<WL>(), galois::no_pushes(),
+                   galois::loopname(name));
+
+  for (unsigned i = 0; i < counts.size(); ++i)
+    GALOIS_ASSERT(counts[i] == round, name, ": item ", i, " committed ",
+                  counts[i].load() + 1 - round, " times");
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  int numThreads = 4;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+  galois::setActiveThreads(numThreads);
+
+  const unsigned size     = 100000;
+  const unsigned numLocks = 4;
+  galois::runtime::Lockable locks[numLocks];
+  galois::LargeArray<std::atomic<unsigned>> counts;
+  counts.create(size);
+  for (unsigned i = 0; i < size; ++i)
+    counts[i] = 0;
+
+  galois::for_each(galois::iterate(0u, size),
+                   [&](unsigned i, auto&) {
+                     for (unsigned j = 0; j < 2; ++j) {
+                       galois::runtime::acquire(&locks[(i + j) % numLocks],
+                                                galois::MethodFlag::WRITE);
+                       std::this_thread::yield();
+                     }
+                     counts[i] += 1;
+                   },
+                   galois::no_pushes(), galois::loopname("conflicts"));
+
+  for (unsigned i = 0; i < size; ++i)
+    GALOIS_ASSERT(counts[i] == 1, "item ", i, " committed ", counts[i].load(),
+                  " times");
+
+  // Same loop through the status-returning acquire and early exit
+  galois::for_each(galois::iterate(0u, size),
+                   [&](unsigned i, auto&) {
+                     for (unsigned j = 0; j < 2; ++j) {
+                       if (!galois::runtime::tryAcquire(
+                               &locks[(i + j) % numLocks],
+                               galois::MethodFlag::WRITE))
+                         return;
+                       std::this_thread::yield();
+                     }
+                     counts[i] += 1;
+                   },
+                   galois::no_pushes(), galois::loopname("conflicts-status"));
+
+  for (unsigned i = 0; i < size; ++i)
+    GALOIS_ASSERT(counts[i] == 2, "item ", i, " committed ",
+                  counts[i].load() - 1, " times");
+
+  runOn<wl::WorkStealingLIFO<>>(locks, numLocks, counts, 3,
+                                "conflicts-stealing");
+  runOn<OBIM>(locks, numLocks, counts, 4, "conflicts-obim");
+  runOn<SharedLocal>(locks, numLocks, counts, 5, "conflicts-localqueue");
+  runOn<wl::PerThreadChunkLIFO<>>(locks, numLocks, counts, 6,
+                                  "conflicts-perthread");
+
+  std::cout << "ok\n";
+  return 0;
+}
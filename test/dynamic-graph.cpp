@@ -0,0 +1,186 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/graphs/LCGraph.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+
+#include <unistd.h>
+
+typedef galois::graphs::LC_Dynamic_CSR_Graph<unsigned, int> Graph;
+typedef std::map<std::pair<unsigned, unsigned>, int> Edges;
+
+struct Update {
+  unsigned src;
+  unsigned dst;
+  bool insert;
+  int data;
+};
+
+static const unsigned numNodes = 512;
+
+static void check(Graph& g, const Edges& expected) {
+  Edges actual;
+  size_t count = 0;
+  for (auto n : g) {
+    for (auto e : g.edges(n)) {
+      bool fresh = actual.emplace(std::make_pair(n, g.getEdgeDst(e)),
+                                  g.getEdgeData(e))
+                       .second;
+      GALOIS_ASSERT(fresh, "edge ", n, "->", g.getEdgeDst(e), " repeated");
+      ++count;
+    }
+  }
+  GALOIS_ASSERT(count == g.sizeEdges(), "sizeEdges ", g.sizeEdges(),
+                " but visited ", count);
+  GALOIS_ASSERT(actual == expected, "graph differs from the expected edges");
+}
+
+// Random batches, applied from a parallel loop, against a sequential model
+static void testUpdates(double threshold, unsigned rounds) {
+  std::mt19937 gen(threshold * 1000 + rounds);
+  Edges expected;
+  for (unsigned n = 0; n < numNodes; ++n)
+    for (unsigned i = 0; i < 8; ++i)
+      expected[std::make_pair(n, (unsigned)gen() % numNodes)] = n;
+
+  Graph g;
+  g.allocateFrom(numNodes, expected.size());
+  g.constructNodes();
+  uint64_t e = 0;
+  for (unsigned n = 0; n < numNodes; ++n) {
+    for (auto it = expected.lower_bound(std::make_pair(n, 0u));
+         it != expected.end() && it->first.first == n; ++it)
+      g.constructEdge(e++, it->first.second, it->second);
+    g.fixEndEdge(n, e);
+  }
+  g.setCompactThreshold(threshold);
+  check(g, expected);
+
+  for (unsigned r = 0; r < rounds; ++r) {
+    std::vector<Update> batch;
+    std::set<std::pair<unsigned, unsigned>> inserted;
+    for (unsigned i = 0; i < 1000; ++i) {
+      Update u{(unsigned)gen() % numNodes, (unsigned)gen() % numNodes,
+               gen() % 2 == 0, (int)(r * 1000 + i)};
+      auto edge = std::make_pair(u.src, u.dst);
+      // at most one insert per edge and batch; its data is then defined
+      if (u.insert && !inserted.insert(edge).second)
+        continue;
+      batch.push_back(u);
+    }
+    for (const Update& u : batch)
+      if (!u.insert && !inserted.count(std::make_pair(u.src, u.dst)))
+        expected.erase(std::make_pair(u.src, u.dst));
+    for (const Update& u : batch)
+      if (u.insert)
+        expected[std::make_pair(u.src, u.dst)] = u.data;
+
+    galois::do_all(galois::iterate(batch), [&](const Update& u) {
+      if (u.insert)
+        g.insertEdge(u.src, u.dst, u.data);
+      else
+        g.deleteEdge(u.src, u.dst);
+    });
+    GALOIS_ASSERT(g.pendingUpdates() == batch.size());
+    g.commit();
+    GALOIS_ASSERT(g.pendingUpdates() == 0);
+    check(g, expected);
+  }
+
+  g.compact();
+  check(g, expected);
+}
+
+// Loads a .gr file whose neighbor lists are unsorted; each thread sorts the
+// edges of its own nodes while the others are still filling theirs
+static void testReadGraph() {
+  std::mt19937 gen(7);
+  std::vector<std::vector<unsigned>> adj(numNodes);
+  Edges expected;
+  size_t numEdges = 0;
+  for (unsigned n = 0; n < numNodes; ++n) {
+    std::set<unsigned> dsts;
+    for (unsigned i = 0, d = gen() % 64; i < d; ++i)
+      dsts.insert(gen() % numNodes);
+    adj[n].assign(dsts.begin(), dsts.end());
+    std::shuffle(adj[n].begin(), adj[n].end(), gen);
+    for (unsigned dst : adj[n])
+      expected[std::make_pair(n, dst)] = n * numNodes + dst;
+    numEdges += adj[n].size();
+  }
+
+  galois::graphs::FileGraphWriter w;
+  w.setNumNodes(numNodes);
+  w.setNumEdges(numEdges);
+  w.setSizeofEdgeData(sizeof(int));
+  w.phase1();
+  for (unsigned n = 0; n < numNodes; ++n)
+    w.incrementDegree(n, adj[n].size());
+  w.phase2();
+  std::vector<std::pair<size_t, int>> data;
+  for (unsigned n = 0; n < numNodes; ++n)
+    for (unsigned dst : adj[n])
+      data.emplace_back(w.addNeighbor(n, dst), n * numNodes + dst);
+  int* edgeData = w.finish<int>();
+  for (auto& d : data)
+    edgeData[d.first] = d.second;
+
+  char filename[] = "/tmp/dynamic-graph-XXXXXX";
+  int fd          = mkstemp(filename);
+  GALOIS_ASSERT(fd >= 0, "unable to create temporary file");
+  close(fd);
+  w.toFile(filename);
+
+  Graph g;
+  galois::graphs::readGraph(g, filename);
+  std::remove(filename);
+
+  check(g, expected);
+  for (auto n : g) {
+    std::vector<unsigned> dsts;
+    for (auto e : g.edges(n))
+      dsts.push_back(g.getEdgeDst(e));
+    GALOIS_ASSERT(std::is_sorted(dsts.begin(), dsts.end()), "neighbors of ",
+                  n, " are not sorted");
+  }
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  int numThreads = 2;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+  galois::setActiveThreads(numThreads);
+
+  testUpdates(1e9, 20); // delta and tombstones only
+  testUpdates(0.1, 20); // compacts every few batches
+  testUpdates(0, 5);    // compacts every batch
+
+  galois::setActiveThreads(std::max(numThreads, 4));
+  testReadGraph();
+
+  return 0;
+}
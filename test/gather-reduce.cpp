@@ -0,0 +1,106 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/graphs/LCGraph.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+static const unsigned numNodes = 1000;
+
+template <typename T>
+static void checkClose(T actual, T expected, unsigned n) {
+  T tolerance = 1e-4 * (1 + std::fabs(expected));
+  GALOIS_ASSERT(std::fabs(actual - expected) <= tolerance, "node ", n,
+                ": got ", actual, ", expected ", expected);
+}
+
+// Node n has a degree that covers empty, partial and several full vectors
+template <typename Graph>
+static void construct(Graph& g, std::mt19937& gen) {
+  std::vector<unsigned> degree(numNodes);
+  uint64_t numEdges = 0;
+  for (unsigned n = 0; n < numNodes; ++n)
+    numEdges += degree[n] = n % 7 == 0 ? 0 : gen() % 100;
+
+  g.allocateFrom(numNodes, numEdges);
+  g.constructNodes();
+  uint64_t e = 0;
+  for (unsigned n = 0; n < numNodes; ++n) {
+    for (unsigned i = 0; i < degree[n]; ++i)
+      g.constructEdge(e++, gen() % numNodes,
+                      typename Graph::edge_data_type(gen() % 1000) / 100);
+    g.fixEndEdge(n, e);
+  }
+}
+
+template <typename T>
+static void testReductions(size_t prefetchDistance) {
+  typedef typename galois::graphs::LC_CSR_Graph<unsigned, T>::
+      template with_no_lockable<true>::type Graph;
+  std::mt19937 gen(prefetchDistance);
+  Graph g;
+  construct(g, gen);
+
+  std::vector<T> values(numNodes);
+  for (auto& v : values)
+    v = T(gen() % 10000) / 1000;
+
+  for (auto n : g) {
+    std::vector<uint32_t> dsts;
+    g.template edge_map<16>(
+        n,
+        [&](const uint32_t* batch, size_t count) {
+          GALOIS_ASSERT(count > 0 && count <= 16, "batch of ", count);
+          dsts.insert(dsts.end(), batch, batch + count);
+        },
+        prefetchDistance);
+
+    T sum = 0;
+    T dot = 0;
+    size_t i = 0;
+    for (auto e : g.edges(n)) {
+      GALOIS_ASSERT(i < dsts.size() && dsts[i] == g.getEdgeDst(e), "node ", n,
+                    ": edge_map differs from edges at ", i);
+      sum += values[g.getEdgeDst(e)];
+      dot += g.getEdgeData(e) * values[g.getEdgeDst(e)];
+      ++i;
+    }
+    GALOIS_ASSERT(i == dsts.size(), "node ", n, ": edge_map has ",
+                  dsts.size(), " edges instead of ", i);
+
+    checkClose(g.gather_sum(n, values.data(), prefetchDistance), sum, n);
+    checkClose(g.gather_dot(n, values.data(), prefetchDistance), dot, n);
+    checkClose(galois::graphs::gather_sum(values.data(), dsts.data(),
+                                          dsts.size()),
+               sum, n);
+  }
+}
+
+int main() {
+  galois::SharedMemSys G;
+  for (size_t distance : {size_t{0}, size_t{1}, size_t{64}, size_t{1000}}) {
+    testReductions<float>(distance);
+    testReductions<double>(distance);
+    testReductions<int>(distance);
+  }
+  return 0;
+}
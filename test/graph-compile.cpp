@@ -49,6 +49,8 @@ void check() {
   g.addMultiEdge(n5, n2, galois::MethodFlag::WRITE, v);
   g.addMultiEdge(n2, n3, galois::MethodFlag::WRITE, v);
   g.addMultiEdge(n2, n4, galois::MethodFlag::WRITE, v);
+  // Outside of a parallel loop there is nothing to conflict with
+  GALOIS_ASSERT(g.tryAcquireNode(n2) && g.tryAcquireNeighborhood(n2));
   for (auto ii : g.edges(n2))
     std::cout << "o " << g.getData(g.getEdgeDst(ii)).x << "\n";
   for (auto ii : g.in_edges(n2))
@@ -31,7 +31,8 @@ int main(int argc, char** argv) {
               << " socket: " << c.socket << " numaNode: " << c.numaNode
               << " cumulativeMaxSocket: " << c.cumulativeMaxSocket
               << " osContext: " << c.osContext
-              << " osNumaNode: " << c.osNumaNode << "\n";
+              << " osNumaNode: " << c.osNumaNode << " core: " << c.core
+              << "\n";
   }
   return 0;
 }
@@ -21,6 +21,10 @@
 #include "galois/gIO.h"
 #include "galois/runtime/Mem.h"
 
+#include <cstdlib>
+#include <set>
+#include <vector>
+
 using namespace galois::runtime;
 using namespace galois::substrate;
 
@@ -30,9 +34,105 @@ struct element {
   element(int i) : val(i), next(0) {}
 };
 
+// Objects freed by another thread go back to the thread that allocated them
+static void testRemoteFree() {
+  const unsigned num       = galois::getActiveThreads();
+  const unsigned perThread = 10000;
+  SlabHeap<SystemHeap> heap(sizeof(element));
+  std::vector<std::vector<void*>> ptrs(num);
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    for (unsigned i = 0; i < perThread; ++i)
+      ptrs[tid].push_back(heap.allocate(sizeof(element)));
+  });
+  galois::on_each([&](unsigned tid, unsigned) {
+    for (void* p : ptrs[(tid + 1) % num])
+      heap.deallocate(p);
+  });
+  galois::on_each([&](unsigned tid, unsigned) {
+    std::set<void*> mine(ptrs[tid].begin(), ptrs[tid].end());
+    for (unsigned i = 0; i < perThread; ++i)
+      GALOIS_ASSERT(mine.count(heap.allocate(sizeof(element))),
+                    "thread ", tid, " got an object of another thread");
+  });
+
+  SlabStats s;
+  for (unsigned tid = 0; tid < num; ++tid)
+    s += heap.stats(tid);
+  GALOIS_ASSERT(s.remoteFrees == (num > 1 ? num * perThread : 0));
+  GALOIS_ASSERT(s.localFrees == (num > 1 ? 0 : perThread));
+  GALOIS_ASSERT(s.liveBytes >= num * perThread * sizeof(element));
+  GALOIS_ASSERT(s.slabBytes >= s.liveBytes);
+}
+
+// Objects larger than a slab still get distinct, whole and reusable memory
+static void testLargeObjects() {
+  const size_t size = 3 * SystemHeap::AllocSize / 4;
+  SlabHeap<SystemHeap> heap(size);
+
+  std::vector<char*> ptrs;
+  for (unsigned i = 0; i < 4; ++i) {
+    char* p = static_cast<char*>(heap.allocate(size));
+    p[0] = p[size - 1] = i;
+    ptrs.push_back(p);
+  }
+  for (unsigned i = 0; i < 4; ++i)
+    GALOIS_ASSERT(ptrs[i][0] == char(i) && ptrs[i][size - 1] == char(i),
+                  "large objects overlap");
+
+  heap.deallocate(ptrs[2]);
+  GALOIS_ASSERT(heap.allocate(size) == ptrs[2], "large object not reused");
+}
+
+// Pages freed by any thread can be reused, and whole free batches are
+// returned to the OS by pagePoolRelease
+static void testPagePool() {
+  const unsigned num       = galois::getActiveThreads();
+  const unsigned perThread = 20;
+  std::vector<std::vector<unsigned*>> pages(num);
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    for (unsigned i = 0; i < perThread; ++i) {
+      unsigned* p = static_cast<unsigned*>(pagePoolAlloc());
+      p[0]        = tid;
+      p[pagePoolSize() / sizeof(unsigned) - 1] = i;
+      pages[tid].push_back(p);
+    }
+  });
+
+  std::set<unsigned*> distinct;
+  for (auto& v : pages)
+    distinct.insert(v.begin(), v.end());
+  GALOIS_ASSERT(distinct.size() == num * perThread, "page handed out twice");
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    unsigned victim = (tid + 1) % num;
+    for (unsigned i = 0; i < perThread; ++i) {
+      unsigned* p = pages[victim][i];
+      GALOIS_ASSERT(p[0] == victim);
+      GALOIS_ASSERT(p[pagePoolSize() / sizeof(unsigned) - 1] == i);
+      pagePoolFree(p);
+    }
+  });
+
+  pagePoolPreAlloc(3);
+  int before      = numPagePoolAllocTotal();
+  size_t released = pagePoolRelease();
+  GALOIS_ASSERT(released > 0, "no free batch released");
+  GALOIS_ASSERT(numPagePoolAllocTotal() + released == size_t(before));
+
+  void* p = pagePoolAlloc();
+  GALOIS_ASSERT(p);
+  pagePoolFree(p);
+}
+
 int main(int argc, char** argv) {
   galois::SharedMemSys Galois_runtime;
   unsigned baseAllocSize = SystemHeap::AllocSize;
+  int numThreads         = 2;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+  galois::setActiveThreads(numThreads);
 
   FixedSizeAllocator<element> falloc;
   element* last = nullptr;
@@ -52,6 +152,10 @@ int main(int argc, char** argv) {
   }
   GALOIS_ASSERT(!last);
 
+  testRemoteFree();
+  testLargeObjects();
+  testPagePool();
+
   VariableSizeHeap valloc;
   size_t allocated;
   GALOIS_ASSERT(1 < baseAllocSize);
@@ -0,0 +1,66 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/PropagationBlocking.h"
+
+#include <atomic>
+#include <vector>
+
+static const unsigned numNodes   = 10000;
+static const unsigned numUpdates = 200000;
+
+// Pushes from a parallel loop; apply must see every update once, each range
+// from a single thread, so plain adds give the exact sums
+static void testBins(size_t rangeSize) {
+  galois::PropagationBlocking<uint64_t> bins(numNodes, rangeSize);
+  std::vector<uint64_t> expected(numNodes);
+  for (unsigned i = 0; i < numUpdates; ++i)
+    expected[(i * 7919u) % numNodes] += i;
+
+  for (unsigned round = 0; round < 2; ++round) {
+    galois::do_all(galois::iterate(0u, numUpdates), [&](unsigned i) {
+      bins.push((i * 7919u) % numNodes, i);
+    });
+
+    std::vector<uint64_t> sums(numNodes);
+    std::vector<std::atomic<int>> owner(numNodes);
+    for (auto& o : owner)
+      o = -1;
+    bins.apply([&](uint32_t dst, uint64_t value) {
+      int tid  = galois::substrate::ThreadPool::getTID();
+      int prev = -1;
+      owner[dst / rangeSize].compare_exchange_strong(prev, tid);
+      GALOIS_ASSERT(prev == -1 || prev == tid, "range ", dst / rangeSize,
+                    " applied by threads ", prev, " and ", tid);
+      sums[dst] += value;
+    });
+    GALOIS_ASSERT(sums == expected, "range size ", rangeSize, ", round ",
+                  round, ": wrong sums");
+  }
+}
+
+int main() {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(4);
+  for (size_t rangeSize :
+       {size_t{1}, size_t{100}, size_t{4096}, size_t{1} << 20})
+    testBins(rangeSize);
+  return 0;
+}
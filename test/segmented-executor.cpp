@@ -0,0 +1,92 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/graphs/LCGraph.h"
+#include "galois/runtime/SegmentedExecutor.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+typedef galois::graphs::LC_CSR_Graph<unsigned, void>::with_no_lockable<
+    true>::type Graph;
+
+static const unsigned numNodes = 3000;
+
+int main() {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(4);
+
+  // skewed degrees, some nodes without edges, repeated neighbors
+  std::mt19937 gen(7);
+  std::vector<std::vector<unsigned>> adj(numNodes);
+  uint64_t numEdges = 0;
+  for (unsigned n = 0; n < numNodes; ++n) {
+    unsigned degree = n % 5 == 0 ? 0 : gen() % (n % 97 == 0 ? 2000 : 20);
+    for (unsigned i = 0; i < degree; ++i)
+      adj[n].push_back(gen() % numNodes);
+    numEdges += degree;
+  }
+
+  Graph g;
+  g.allocateFrom(numNodes, numEdges);
+  g.constructNodes();
+  uint64_t e = 0;
+  for (unsigned n = 0; n < numNodes; ++n) {
+    for (unsigned dst : adj[n])
+      g.constructEdge(e++, dst);
+    g.fixEndEdge(n, e);
+  }
+
+  std::vector<uint64_t> values(numNodes);
+  for (auto& v : values)
+    v = gen() % 100000;
+
+  for (size_t segmentSize : {size_t{1}, size_t{7}, size_t{500}, size_t{5000}}) {
+    galois::runtime::SegmentedPullExecutor<Graph> executor(g, segmentSize);
+    GALOIS_ASSERT(executor.size() ==
+                      (numNodes + segmentSize - 1) / segmentSize,
+                  "wrong number of segments");
+
+    std::vector<uint64_t> sums(numNodes, ~uint64_t{0});
+    std::vector<uint64_t> mins(numNodes, 0);
+    executor.run(uint64_t{0}, [&](unsigned m) { return values[m]; },
+                 [](uint64_t a, uint64_t b) { return a + b; },
+                 [&](unsigned n, uint64_t r) { sums[n] = r; });
+    executor.run(~uint64_t{0}, [&](unsigned m) { return values[m]; },
+                 [](uint64_t a, uint64_t b) { return std::min(a, b); },
+                 [&](unsigned n, uint64_t r) { mins[n] = r; });
+
+    for (unsigned n = 0; n < numNodes; ++n) {
+      uint64_t sum = 0;
+      uint64_t min = ~uint64_t{0};
+      for (unsigned m : adj[n]) {
+        sum += values[m];
+        min = std::min(min, values[m]);
+      }
+      GALOIS_ASSERT(sums[n] == sum, "segment size ", segmentSize, ", node ", n,
+                    ": sum ", sums[n], " instead of ", sum);
+      GALOIS_ASSERT(mins[n] == min, "segment size ", segmentSize, ", node ", n,
+                    ": min ", mins[n], " instead of ", min);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/runtime/Timeline.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+static std::string readFile(const std::string& name) {
+  std::ifstream in(name);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+static void runLoops(int numThreads) {
+  galois::SharedMemSys Galois_runtime;
+  galois::setActiveThreads(numThreads);
+
+  galois::GAccumulator<size_t> sum;
+  galois::do_all(galois::iterate(0, 100000), [&](int i) { sum += i; },
+                 galois::steal(), galois::chunk_size<64>(),
+                 galois::loopname("stealing loop"));
+  galois::do_all(galois::iterate(0, 100000), [&](int i) { sum += i; },
+                 galois::loopname("static loop"));
+  galois::on_each([&](unsigned, unsigned) { sum += 1; },
+                  galois::loopname("on_each loop"));
+  GALOIS_ASSERT(galois::runtime::timeline::isEnabled());
+}
+
+int main(int argc, char** argv) {
+  int numThreads = 2;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+
+  setenv("GALOIS_TIMELINE", "timeline-test.json", 1);
+  runLoops(numThreads);
+  GALOIS_ASSERT(!galois::runtime::timeline::isEnabled());
+
+  std::string json = readFile("timeline-test.json");
+  GALOIS_ASSERT(json.find("\"traceEvents\"") != std::string::npos);
+  for (const char* name : {"stealing loop", "static loop", "on_each loop",
+                           "\"chunk\"", "\"barrier\""}) {
+    GALOIS_ASSERT(json.find(name) != std::string::npos, "missing ", name);
+  }
+
+  // binary output converts to the same events
+  setenv("GALOIS_TIMELINE", "timeline-test.bin", 1);
+  runLoops(numThreads);
+  GALOIS_ASSERT(galois::runtime::timeline::convertToJSON(
+      "timeline-test.bin", "timeline-test-converted.json"));
+  std::string converted = readFile("timeline-test-converted.json");
+  for (const char* name : {"stealing loop", "static loop", "on_each loop"}) {
+    GALOIS_ASSERT(converted.find(name) != std::string::npos, "missing ", name);
+  }
+  GALOIS_ASSERT(!galois::runtime::timeline::convertToJSON(
+      "timeline-test.json", "timeline-test-bad.json"));
+
+  // with a ring too small for a whole loop, the oldest begin events are
+  // dropped, but every end event must still have its begin
+  setenv("GALOIS_TIMELINE", "timeline-test.json", 1);
+  setenv("GALOIS_TIMELINE_EVENTS", "5", 1);
+  runLoops(numThreads);
+  unsetenv("GALOIS_TIMELINE_EVENTS");
+  std::string wrapped = readFile("timeline-test.json");
+  GALOIS_ASSERT(wrapped.find("thread 0\",\"dropped_events\":0}") ==
+                std::string::npos);
+  std::istringstream lines(wrapped);
+  std::map<std::string, int> depth;
+  for (std::string line; std::getline(lines, line);) {
+    size_t tid = line.find("\"tid\":");
+    if (tid == std::string::npos)
+      continue;
+    std::string thread = line.substr(tid, line.find(',', tid) - tid);
+    if (line.find("\"ph\":\"B\"") != std::string::npos)
+      ++depth[thread];
+    if (line.find("\"ph\":\"E\"") != std::string::npos)
+      GALOIS_ASSERT(--depth[thread] >= 0, "unmatched end event: ", line);
+  }
+
+  std::remove("timeline-test.json");
+  std::remove("timeline-test.bin");
+  std::remove("timeline-test-converted.json");
+  return 0;
+}
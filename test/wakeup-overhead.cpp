@@ -25,8 +25,10 @@
 
 #include <boost/iterator/counting_iterator.hpp>
 
+#include <chrono>
 #include <cmath>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 typedef galois::GAccumulator<double> AccumDouble;
@@ -39,6 +41,11 @@ static cll::opt<int> rounds("rounds", cll::desc("number of rounds"),
                             cll::init(10000));
 static cll::opt<int> trials("trials", cll::desc("number of trials"),
                             cll::init(1));
+static cll::opt<unsigned>
+    idleSpin("idleSpin",
+             cll::desc("microseconds idle workers spin before parking in "
+                       "elastic mode"),
+             cll::init(100));
 
 void runDoAllBurn(int num) {
   galois::substrate::getThreadPool().burnPower(galois::getActiveThreads());
@@ -77,6 +84,57 @@ void runExplicitThread(int num) {
   });
 }
 
+/**
+ * Measures the time from the master starting a parallel region until each
+ * worker starts executing it and reports the average and worst latency over
+ * the rounds.
+ */
+void runWakeupLatency(std::string name, unsigned gapUsec) {
+  using clockTy = std::chrono::steady_clock;
+  unsigned numThreads = galois::getActiveThreads();
+  std::vector<clockTy::time_point> starts(numThreads);
+  int numRounds = std::min(rounds.getValue(), 1000);
+  double sum    = 0;
+  double worst  = 0;
+
+  for (int r = 0; r < numRounds; ++r) {
+    if (gapUsec)
+      std::this_thread::sleep_for(std::chrono::microseconds(gapUsec));
+    auto begin = clockTy::now();
+    galois::on_each(
+        [&](unsigned tid, unsigned) { starts[tid] = clockTy::now(); });
+    for (unsigned i = 1; i < numThreads; ++i) {
+      double us =
+          std::chrono::duration<double, std::micro>(starts[i] - begin).count();
+      sum += us;
+      worst = std::max(worst, us);
+    }
+  }
+
+  double avg = numThreads > 1 ? sum / (numRounds * (numThreads - 1)) : 0;
+  std::cout << name << " wakeup latency: avg " << avg << " us, max " << worst
+            << " us\n";
+}
+
+void runWakeupLatencies() {
+  auto& pool         = galois::substrate::getThreadPool();
+  unsigned origSpin  = pool.getIdleSpin();
+  unsigned parkedGap = 2 * idleSpin + 1000;
+
+  pool.setIdleSpin(0);
+  runWakeupLatency("Parked", parkedGap);
+
+  pool.setIdleSpin(idleSpin);
+  runWakeupLatency("Elastic", 0);
+  runWakeupLatency("ElasticParked", parkedGap);
+
+  pool.burnPower(galois::getActiveThreads());
+  runWakeupLatency("Burn", 0);
+  pool.beKind();
+
+  pool.setIdleSpin(origSpin);
+}
+
 void run(std::function<void(int)> fn, std::string name) {
   galois::Timer t;
   t.start();
@@ -86,7 +144,6 @@ void run(std::function<void(int)> fn, std::string name) {
 }
 
 std::atomic<int> EXIT;
-#include <chrono>
 
 int main(int argc, char* argv[]) {
   galois::SharedMemSys Galois_runtime;
@@ -109,6 +166,7 @@ int main(int argc, char* argv[]) {
     run(runDoAll, "DoAll");
     run(runDoAllBurn, "DoAllBurn");
     run(runExplicitThread, "ExplicitThread");
+    runWakeupLatencies();
   }
   EXIT = 1;
   return 0;
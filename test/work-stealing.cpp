@@ -0,0 +1,103 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+
+#include <cstdlib>
+
+// Thread 0 pushes and takes while all other threads steal; every element
+// must come out exactly once.
+static void testDeque(unsigned size) {
+  galois::worklists::internal::ChaseLevDeque<unsigned> deque(2);
+  galois::LargeArray<unsigned> values;
+  galois::LargeArray<std::atomic<unsigned>> counts;
+  values.create(size);
+  counts.create(size);
+  for (unsigned i = 0; i < size; ++i) {
+    values[i] = i;
+    counts[i] = 0;
+  }
+  std::atomic<bool> done(false);
+
+  galois::on_each([&](unsigned tid, unsigned) {
+    if (tid == 0) {
+      for (unsigned i = 0; i < size; ++i) {
+        deque.push(&values[i]);
+        if (i % 3 == 0)
+          if (unsigned* v = deque.take())
+            counts[*v] += 1;
+      }
+      while (unsigned* v = deque.take())
+        counts[*v] += 1;
+      done = true;
+    } else {
+      galois::worklists::internal::ChaseLevDeque<unsigned> mine;
+      while (!done || !deque.empty()) {
+        if (unsigned* v = mine.stealHalfAndTake(deque)) {
+          counts[*v] += 1;
+          while (unsigned* w = mine.take())
+            counts[*w] += 1;
+        }
+      }
+    }
+  });
+
+  for (unsigned i = 0; i < size; ++i)
+    GALOIS_ASSERT(counts[i] == 1, "deque returned ", i, " ", counts[i].load(),
+                  " times");
+}
+
+// Items form a binary tree rooted at 1; loop iterations push the children.
+template <typename WL>
+static void testForEach(unsigned size) {
+  galois::LargeArray<std::atomic<unsigned>> counts;
+  counts.create(size);
+  for (unsigned i = 0; i < size; ++i)
+    counts[i] = 0;
+
+  galois::for_each(galois::iterate({1u}),
+                   [&](unsigned i, auto& ctx) {
+                     counts[i] += 1;
+                     if (2 * i < size)
+                       ctx.push(2 * i);
+                     if (2 * i + 1 < size)
+                       ctx.push(2 * i + 1);
+                   },
+                   galois::wl<WL>(), galois::no_conflicts(),
+                   galois::loopname("work-stealing"));
+
+  for (unsigned i = 1; i < size; ++i)
+    GALOIS_ASSERT(counts[i] == 1, "for_each visited ", i, " ",
+                  counts[i].load(), " times");
+}
+
+int main(int argc, char** argv) {
+  galois::SharedMemSys Galois_runtime;
+  int numThreads = 2;
+  if (argc > 1)
+    numThreads = atoi(argv[1]);
+  galois::setActiveThreads(numThreads);
+
+  testDeque(1 << 20);
+  testForEach<galois::worklists::WorkStealingLIFO<16>>(1 << 20);
+  testForEach<galois::worklists::WorkStealingFIFO<16>>(1 << 20);
+
+  return 0;
+}
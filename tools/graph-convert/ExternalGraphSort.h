@@ -0,0 +1,789 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file ExternalGraphSort.h
+ *
+ * Transforms gr files that do not fit in memory by sorting their edges on
+ * disk.
+ *
+ * The input is streamed once in file order. Each edge, after relabeling,
+ * transposing or symmetrizing, goes into a buffer of bounded size; a full
+ * buffer is sorted by (source, destination) in parallel and written to a
+ * temporary file as one run. While there are more than maxFanIn runs, groups
+ * of maxFanIn runs are merged into one. The remaining runs are then merged in
+ * parallel: the source nodes are split into one range per thread with about
+ * the same number of edges, and each thread merges its range of every run
+ * into its slice of the output. All file access goes through block readers
+ * and writers that overlap the next read or the previous write with the
+ * computation, using a fixed pool of I/O threads.
+ *
+ * Memory use is bounded by the buffer size plus a few arrays with one entry
+ * per node.
+ */
+
+#ifndef GRAPH_CONVERT_EXTERNAL_GRAPH_SORT_H
+#define GRAPH_CONVERT_EXTERNAL_GRAPH_SORT_H
+
+#include "galois/Galois.h"
+#include "galois/Endian.h"
+#include "galois/LargeArray.h"
+#include "galois/gIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace external_sort {
+
+inline void preadFully(int fd, void* buf, size_t bytes, uint64_t offset) {
+  char* p = static_cast<char*>(buf);
+  while (bytes) {
+    ssize_t r = pread(fd, p, bytes, offset);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r < 0)
+      GALOIS_SYS_DIE("failed reading");
+    if (r == 0)
+      GALOIS_DIE("unexpected end of file");
+    p += r;
+    bytes -= r;
+    offset += r;
+  }
+}
+
+inline void pwriteFully(int fd, const void* buf, size_t bytes,
+                        uint64_t offset) {
+  const char* p = static_cast<const char*>(buf);
+  while (bytes) {
+    ssize_t r = pwrite(fd, p, bytes, offset);
+    if (r < 0 && errno == EINTR)
+      continue;
+    if (r < 0)
+      GALOIS_SYS_DIE("failed writing");
+    p += r;
+    bytes -= r;
+    offset += r;
+  }
+}
+
+//! Creates an anonymous file in dir that is removed when closed
+inline int tempFile(const std::string& dir) {
+  std::string name = dir + "/graph-convert-huge-XXXXXX";
+  std::vector<char> path(name.begin(), name.end());
+  path.push_back('\0');
+  int fd = mkstemp(path.data());
+  if (fd == -1)
+    GALOIS_SYS_DIE("failed creating temporary file in ", dir);
+  unlink(path.data());
+  return fd;
+}
+
+/**
+ * Fixed set of threads that run the background reads and writes of the block
+ * readers and writers. They are separate from the Galois threads, which keep
+ * computing while I/O is pending.
+ */
+class IOPool {
+  std::vector<std::thread> threads;
+  std::mutex lock;
+  std::condition_variable ready;
+  std::deque<std::function<void()>> tasks;
+  bool done = false;
+
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lg(lock);
+        ready.wait(lg, [this] { return done || !tasks.empty(); });
+        if (tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+public:
+  explicit IOPool(unsigned numThreads) {
+    for (unsigned i = 0; i < std::max(numThreads, 1u); ++i)
+      threads.emplace_back([this] { work(); });
+  }
+
+  IOPool(const IOPool&) = delete;
+  IOPool& operator=(const IOPool&) = delete;
+
+  ~IOPool() {
+    {
+      std::lock_guard<std::mutex> lg(lock);
+      done = true;
+    }
+    ready.notify_all();
+    for (std::thread& t : threads)
+      t.join();
+  }
+
+  //! Runs fn on an I/O thread; fn must not wait for other tasks
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> submit(F fn) {
+    typedef typename std::result_of<F()>::type R;
+    auto task   = std::make_shared<std::packaged_task<R()>>(std::move(fn));
+    auto result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lg(lock);
+      tasks.emplace_back([task] { (*task)(); });
+    }
+    ready.notify_one();
+    return result;
+  }
+};
+
+/**
+ * Reads the bytes [begin, end) of a file in order. While one block is
+ * consumed, the next one is read in the background.
+ */
+class BlockReader {
+  IOPool& io;
+  int fd;
+  uint64_t next;
+  uint64_t end;
+  std::vector<char> current;
+  std::vector<char> prefetched;
+  size_t pos = 0;
+  size_t len = 0;
+  std::future<size_t> pending;
+
+  std::future<size_t> fetch() {
+    size_t bytes    = std::min<uint64_t>(prefetched.size(), end - next);
+    uint64_t offset = next;
+    char* buf       = prefetched.data();
+    int file        = fd;
+    next += bytes;
+    if (!bytes) {
+      std::promise<size_t> none;
+      none.set_value(0);
+      return none.get_future();
+    }
+    return io.submit([=] {
+      preadFully(file, buf, bytes, offset);
+      return bytes;
+    });
+  }
+
+public:
+  BlockReader(IOPool& io, int fd, uint64_t begin, uint64_t end,
+              size_t blockSize)
+      : io(io), fd(fd), next(begin), end(end), current(blockSize),
+        prefetched(blockSize) {
+    pending = fetch();
+  }
+
+  BlockReader(const BlockReader&) = delete;
+  BlockReader& operator=(const BlockReader&) = delete;
+
+  ~BlockReader() {
+    if (pending.valid())
+      pending.wait();
+  }
+
+  //! Copies the next bytes to out; returns false at the end of the range
+  bool read(void* out, size_t bytes) {
+    char* o = static_cast<char*>(out);
+    while (bytes) {
+      if (pos == len) {
+        len = pending.get();
+        if (!len)
+          return false;
+        std::swap(current, prefetched);
+        pos     = 0;
+        pending = fetch();
+      }
+      size_t n = std::min(bytes, len - pos);
+      std::memcpy(o, current.data() + pos, n);
+      pos += n;
+      o += n;
+      bytes -= n;
+    }
+    return true;
+  }
+};
+
+/**
+ * Writes bytes in order starting at an offset of a file. A full block is
+ * written in the background while the next one is filled.
+ */
+class BlockWriter {
+  IOPool& io;
+  int fd;
+  uint64_t offset;
+  std::vector<char> current;
+  std::vector<char> flushing;
+  size_t len = 0;
+  std::future<void> pending;
+
+  void flush() {
+    if (pending.valid())
+      pending.get();
+    std::swap(current, flushing);
+    const char* buf = flushing.data();
+    size_t bytes    = len;
+    uint64_t at     = offset;
+    int file        = fd;
+    offset += len;
+    len     = 0;
+    pending = io.submit([=] { pwriteFully(file, buf, bytes, at); });
+  }
+
+public:
+  BlockWriter(IOPool& io, int fd, uint64_t offset, size_t blockSize)
+      : io(io), fd(fd), offset(offset), current(blockSize),
+        flushing(blockSize) {}
+
+  BlockWriter(const BlockWriter&) = delete;
+  BlockWriter& operator=(const BlockWriter&) = delete;
+
+  ~BlockWriter() { finish(); }
+
+  void write(const void* in, size_t bytes) {
+    const char* p = static_cast<const char*>(in);
+    while (bytes) {
+      size_t n = std::min(bytes, current.size() - len);
+      std::memcpy(current.data() + len, p, n);
+      len += n;
+      p += n;
+      bytes -= n;
+      if (len == current.size())
+        flush();
+    }
+  }
+
+  void finish() {
+    if (len)
+      flush();
+    if (pending.valid())
+      pending.get();
+  }
+};
+
+//! Edge values are kept as raw bytes of at most 8 bytes
+struct EdgeRecord {
+  uint64_t src;
+  uint64_t dst;
+  uint64_t data;
+
+  bool operator<(const EdgeRecord& o) const {
+    return std::tie(src, dst) < std::tie(o.src, o.dst);
+  }
+  bool sameEdge(const EdgeRecord& o) const {
+    return src == o.src && dst == o.dst;
+  }
+};
+
+//! A sorted sequence of edges in a temporary file
+struct Run {
+  int fd            = -1;
+  uint64_t numEdges = 0;
+};
+
+//! The edges [begin, end) of a run
+struct RunRange {
+  int fd;
+  uint64_t begin;
+  uint64_t end;
+};
+
+} // namespace external_sort
+
+/**
+ * Sorts the edges of a gr file on disk, optionally relabeling the nodes
+ * randomly, transposing, symmetrizing and removing repeated edges. The output
+ * has sorted neighbor lists.
+ */
+class ExternalGraphSort {
+  typedef external_sort::EdgeRecord EdgeRecord;
+  typedef external_sort::Run Run;
+  typedef external_sort::RunRange RunRange;
+
+public:
+  bool transpose  = false;
+  bool symmetrize = false;
+  bool dedup      = false;
+  bool relabel    = false;
+  //! Where to write the relabeling as "old,new" lines, if anywhere
+  std::string permutationFilename;
+  std::string tmpDir  = ".";
+  size_t memoryLimit  = size_t{1} << 30;
+  //! Most runs read at once by one merge; more runs take several passes
+  size_t maxFanIn = 64;
+
+private:
+  uint64_t numNodes  = 0;
+  uint64_t numEdges  = 0;
+  size_t sizeofData  = 0;
+  size_t blockSize   = 0;
+  std::vector<EdgeRecord> buffer;
+  size_t capacity = 0;
+  std::vector<Run> runs;
+  std::unique_ptr<external_sort::IOPool> io;
+  galois::LargeArray<uint64_t> perm;
+  //! Out-degrees of the edges sorted so far, before duplicates are removed
+  galois::LargeArray<uint64_t> degrees;
+  uint64_t numSorted = 0;
+
+  void add(uint64_t src, uint64_t dst, uint64_t data) {
+    buffer.push_back(EdgeRecord{src, dst, data});
+    ++degrees[src];
+    if (buffer.size() == capacity)
+      spill();
+  }
+
+  //! Sorts the buffer into one run
+  void spill() {
+    unsigned numThreads = galois::getActiveThreads();
+    std::vector<size_t> pieces(numThreads + 1, buffer.size());
+    for (unsigned t = 0; t < numThreads; ++t)
+      pieces[t] =
+          galois::block_range(size_t{0}, buffer.size(), t, numThreads).first;
+    auto at = [&](unsigned piece) { return buffer.begin() + pieces[piece]; };
+
+    // stable sorts and merges of neighboring pieces, which are in file
+    // order, so that dedup keeps the first value read
+    galois::on_each([&](unsigned tid, unsigned) {
+      std::stable_sort(at(tid), at(tid + 1));
+    });
+    for (unsigned width = 1; width < numThreads; width *= 2) {
+      unsigned pairs = (numThreads + 2 * width - 1) / (2 * width);
+      galois::do_all(
+          galois::iterate(0u, pairs),
+          [&](unsigned i) {
+            unsigned lo = 2 * width * i;
+            std::inplace_merge(at(lo), at(std::min(lo + width, numThreads)),
+                               at(std::min(lo + 2 * width, numThreads)));
+          },
+          galois::no_stats());
+    }
+
+    auto end = buffer.end();
+    if (dedup)
+      end = std::unique(buffer.begin(), buffer.end(),
+                        [](const EdgeRecord& a, const EdgeRecord& b) {
+                          return a.sameEdge(b);
+                        });
+    Run run;
+    run.numEdges = end - buffer.begin();
+    if (run.numEdges) {
+      run.fd = external_sort::tempFile(tmpDir);
+      galois::on_each([&](unsigned tid, unsigned total) {
+        auto r = galois::block_range(uint64_t{0}, run.numEdges, tid, total);
+        if (r.first != r.second)
+          external_sort::pwriteFully(run.fd, &buffer[r.first],
+                                     sizeof(EdgeRecord) * (r.second - r.first),
+                                     sizeof(EdgeRecord) * r.first);
+      });
+      runs.push_back(run);
+    }
+    numSorted += buffer.size();
+    buffer.clear();
+  }
+
+  //! Streams the input graph through the buffer
+  void generateRuns(int fd) {
+    using namespace external_sort;
+    uint64_t header[4];
+    preadFully(fd, header, sizeof(header), 0);
+    uint64_t version = galois::convert_le64toh(header[0]);
+    sizeofData       = galois::convert_le64toh(header[1]);
+    numNodes         = galois::convert_le64toh(header[2]);
+    numEdges         = galois::convert_le64toh(header[3]);
+    if (version != 1 && version != 2)
+      GALOIS_DIE("unknown file version: ", version);
+    if (sizeofData > sizeof(uint64_t))
+      GALOIS_DIE("edge data of ", sizeofData, " bytes is not supported");
+
+    size_t dstWidth  = version == 1 ? sizeof(uint32_t) : sizeof(uint64_t);
+    uint64_t idxOff  = sizeof(header);
+    uint64_t dstOff  = idxOff + sizeof(uint64_t) * numNodes;
+    uint64_t dataOff = dstOff + dstWidth * numEdges;
+    if (version == 1 && numEdges % 2)
+      dataOff += sizeof(uint32_t);
+
+    degrees.create(numNodes);
+    std::fill(degrees.begin(), degrees.end(), 0);
+    if (relabel) {
+      perm.create(numNodes);
+      for (uint64_t n = 0; n < numNodes; ++n)
+        perm[n] = n;
+      std::random_device rng;
+      std::mt19937 urng(rng());
+      std::shuffle(perm.begin(), perm.end(), urng);
+    }
+
+    BlockReader index(*io, fd, idxOff, dstOff, blockSize);
+    BlockReader dsts(*io, fd, dstOff, dstOff + dstWidth * numEdges,
+                     blockSize);
+    BlockReader data(*io, fd, dataOff, dataOff + sizeofData * numEdges,
+                     blockSize);
+    uint64_t edge = 0;
+    for (uint64_t src = 0; src < numNodes; ++src) {
+      uint64_t end;
+      if (!index.read(&end, sizeof(end)))
+        GALOIS_DIE("unexpected end of file");
+      end = galois::convert_le64toh(end);
+      for (; edge < end; ++edge) {
+        uint64_t dst = 0;
+        uint64_t d   = 0;
+        if (!dsts.read(&dst, dstWidth) || !data.read(&d, sizeofData))
+          GALOIS_DIE("unexpected end of file");
+        dst = dstWidth == sizeof(uint32_t)
+                  ? galois::convert_le32toh(static_cast<uint32_t>(dst))
+                  : galois::convert_le64toh(dst);
+        if (dst >= numNodes)
+          GALOIS_DIE("edge destination out of range: ", dst);
+
+        uint64_t s = relabel ? perm[src] : src;
+        uint64_t t = relabel ? perm[dst] : dst;
+        if (symmetrize) {
+          add(s, t, d);
+          if (s != t)
+            add(t, s, d);
+        } else if (transpose) {
+          add(t, s, d);
+        } else {
+          add(s, t, d);
+        }
+      }
+    }
+    if (!buffer.empty())
+      spill();
+  }
+
+  //! First node of each thread's range, balanced by out-degree
+  std::vector<uint64_t> splitNodes(unsigned parts) {
+    std::vector<uint64_t> bounds(parts + 1, numNodes);
+    bounds[0]     = 0;
+    uint64_t sum  = 0;
+    unsigned part = 1;
+    for (uint64_t n = 0; n < numNodes && part < parts; ++n) {
+      while (part < parts && sum >= numSorted * part / parts)
+        bounds[part++] = n;
+      sum += degrees[n];
+    }
+    return bounds;
+  }
+
+  //! Index of the first edge of run with source at least node
+  uint64_t lowerBound(const Run& run, uint64_t node) {
+    uint64_t lo = 0, hi = run.numEdges;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      EdgeRecord r;
+      external_sort::preadFully(run.fd, &r, sizeof(r), sizeof(r) * mid);
+      if (r.src < node)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  struct Sink {
+    int dstFd;
+    uint64_t dstAt;
+    int dataFd;
+    uint64_t dataAt;
+  };
+
+  /**
+   * Calls emit on the edges of ranges in sorted order. Equal edges come in
+   * the order of their ranges; with dedup, only the first is emitted.
+   */
+  template <typename F>
+  void mergeRanges(const std::vector<RunRange>& ranges, F emit) {
+    using namespace external_sort;
+    typedef std::pair<EdgeRecord, size_t> Head;
+    auto later = [](const Head& a, const Head& b) {
+      return std::tie(a.first.src, a.first.dst, a.second) >
+             std::tie(b.first.src, b.first.dst, b.second);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    std::vector<std::unique_ptr<BlockReader>> readers(ranges.size());
+    for (size_t r = 0; r < ranges.size(); ++r) {
+      if (ranges[r].begin == ranges[r].end)
+        continue;
+      readers[r].reset(new BlockReader(*io, ranges[r].fd,
+                                       sizeof(EdgeRecord) * ranges[r].begin,
+                                       sizeof(EdgeRecord) * ranges[r].end,
+                                       blockSize));
+      EdgeRecord first;
+      readers[r]->read(&first, sizeof(first));
+      heads.emplace(first, r);
+    }
+
+    bool any = false;
+    EdgeRecord last{};
+    while (!heads.empty()) {
+      Head h = heads.top();
+      heads.pop();
+      EdgeRecord next;
+      if (readers[h.second]->read(&next, sizeof(next)))
+        heads.emplace(next, h.second);
+
+      const EdgeRecord& e = h.first;
+      if (dedup && any && e.sameEdge(last))
+        continue;
+      emit(e);
+      last = e;
+      any  = true;
+    }
+  }
+
+  //! Merges consecutive groups of maxFanIn runs until at most maxFanIn remain
+  void reduceRuns() {
+    using namespace external_sort;
+    size_t fanIn = std::max<size_t>(maxFanIn, 2);
+    while (runs.size() > fanIn) {
+      size_t groups = (runs.size() + fanIn - 1) / fanIn;
+      std::vector<Run> merged(groups);
+      galois::do_all(
+          galois::iterate(size_t{0}, groups),
+          [&](size_t g) {
+            size_t b = g * fanIn, e = std::min(b + fanIn, runs.size());
+            if (e - b == 1) {
+              merged[g] = runs[b];
+              return;
+            }
+            std::vector<RunRange> ranges;
+            for (size_t r = b; r < e; ++r)
+              ranges.push_back(RunRange{runs[r].fd, 0, runs[r].numEdges});
+            Run& out = merged[g];
+            out.fd   = tempFile(tmpDir);
+            {
+              BlockWriter writer(*io, out.fd, 0, blockSize);
+              mergeRanges(ranges, [&](const EdgeRecord& rec) {
+                writer.write(&rec, sizeof(rec));
+                ++out.numEdges;
+              });
+            }
+            for (size_t r = b; r < e; ++r)
+              close(runs[r].fd);
+          },
+          galois::no_stats());
+      runs.swap(merged);
+      std::cout << "Merged into " << runs.size() << " runs\n";
+    }
+  }
+
+  //! Merges edges with sources in [bounds[p], bounds[p+1]) of every run
+  void merge(unsigned p, const std::vector<std::vector<uint64_t>>& offsets,
+             const Sink& sink, size_t dstWidth,
+             galois::LargeArray<uint64_t>& outDegrees) {
+    using namespace external_sort;
+    std::vector<RunRange> ranges;
+    for (size_t r = 0; r < runs.size(); ++r)
+      ranges.push_back(RunRange{runs[r].fd, offsets[r][p], offsets[r][p + 1]});
+
+    BlockWriter dsts(*io, sink.dstFd, sink.dstAt, blockSize);
+    BlockWriter data(*io, sink.dataFd, sink.dataAt,
+                     sizeofData ? blockSize : 0);
+    mergeRanges(ranges, [&](const EdgeRecord& e) {
+      if (dstWidth == sizeof(uint32_t)) {
+        uint32_t d = galois::convert_htole32(static_cast<uint32_t>(e.dst));
+        dsts.write(&d, sizeof(d));
+      } else {
+        uint64_t d = galois::convert_htole64(e.dst);
+        dsts.write(&d, sizeof(d));
+      }
+      data.write(&e.data, sizeofData);
+      ++outDegrees[e.src];
+    });
+  }
+
+  void copy(int from, uint64_t bytes, int to, uint64_t at) {
+    external_sort::BlockReader in(*io, from, 0, bytes, blockSize);
+    std::vector<char> buf(blockSize);
+    for (uint64_t done = 0; done < bytes;) {
+      size_t n = std::min<uint64_t>(blockSize, bytes - done);
+      in.read(buf.data(), n);
+      external_sort::pwriteFully(to, buf.data(), n, at + done);
+      done += n;
+    }
+  }
+
+  void writePermutation() {
+    std::ofstream out(permutationFilename);
+    for (uint64_t n = 0; n < numNodes; ++n)
+      out << n << "," << perm[n] << "\n";
+  }
+
+public:
+  /**
+   * Returns the number of nodes and edges of the input and the number of
+   * edges written.
+   */
+  std::tuple<uint64_t, uint64_t, uint64_t>
+  operator()(const std::string& infilename, const std::string& outfilename) {
+    using namespace external_sort;
+    unsigned numThreads = galois::getActiveThreads();
+    // buffer, sort scratch and I/O blocks each get about a third
+    capacity  = std::max<size_t>(memoryLimit / 3 / sizeof(EdgeRecord), 1024);
+    blockSize = std::max<size_t>(memoryLimit / 3 / (8 * numThreads), 4096);
+    blockSize = std::min<size_t>(blockSize, 4 << 20);
+    buffer.reserve(capacity);
+    io.reset(new IOPool(numThreads));
+
+    int in = open(infilename.c_str(), O_RDONLY);
+    if (in == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", infilename, "'");
+    generateRuns(in);
+    close(in);
+    std::vector<EdgeRecord>().swap(buffer);
+    std::cout << "Sorted " << numSorted << " edges into " << runs.size()
+              << " runs\n";
+
+    // every thread may read up to maxFanIn runs at once
+    size_t fanIn      = std::min(std::max<size_t>(maxFanIn, 2), runs.size());
+    size_t numReaders = std::max<size_t>(fanIn, 1) * numThreads;
+    blockSize = std::min(blockSize, std::max<size_t>(memoryLimit / 3 /
+                                                         (2 * numReaders),
+                                                     4096));
+    reduceRuns();
+
+    std::vector<uint64_t> bounds = splitNodes(numThreads);
+    std::vector<std::vector<uint64_t>> offsets(runs.size());
+    galois::do_all(galois::iterate(size_t{0}, runs.size()),
+                   [&](size_t r) {
+                     for (uint64_t b : bounds)
+                       offsets[r].push_back(lowerBound(runs[r], b));
+                   },
+                   galois::no_stats());
+
+    size_t dstWidth = numNodes <= std::numeric_limits<uint32_t>::max()
+                          ? sizeof(uint32_t)
+                          : sizeof(uint64_t);
+    auto dstOffset = [&](uint64_t edges) {
+      return sizeof(uint64_t) * (4 + numNodes) + dstWidth * edges;
+    };
+    auto dataOffset = [&](uint64_t edges, uint64_t totalEdges) {
+      uint64_t padding =
+          dstWidth == sizeof(uint32_t) && totalEdges % 2 ? sizeof(uint32_t) : 0;
+      return dstOffset(totalEdges) + padding + sizeofData * edges;
+    };
+    // first edge of each range
+    auto rangeStarts = [&](galois::LargeArray<uint64_t>& counts) {
+      std::vector<uint64_t> starts(bounds.size(), 0);
+      for (unsigned p = 0; p < numThreads; ++p) {
+        starts[p + 1] = starts[p];
+        for (uint64_t n = bounds[p]; n < bounds[p + 1]; ++n)
+          starts[p + 1] += counts[n];
+      }
+      return starts;
+    };
+
+    mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+    int out     = open(outfilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, mode);
+    if (out == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", outfilename, "'");
+    auto resize = [&](uint64_t totalEdges) {
+      if (ftruncate(out, dataOffset(totalEdges, totalEdges)) == -1)
+        GALOIS_SYS_DIE("failed resizing ", "'", outfilename, "'");
+    };
+
+    galois::LargeArray<uint64_t> outDegrees;
+    outDegrees.create(numNodes);
+    std::fill(outDegrees.begin(), outDegrees.end(), 0);
+    std::vector<Sink> sinks(numThreads);
+    if (dedup) {
+      // sizes are known only after merging, so merge into temporary files
+      for (Sink& s : sinks)
+        s = Sink{tempFile(tmpDir), 0, tempFile(tmpDir), 0};
+    } else {
+      std::vector<uint64_t> starts = rangeStarts(degrees);
+      resize(numSorted);
+      for (unsigned p = 0; p < numThreads; ++p)
+        sinks[p] = Sink{out, dstOffset(starts[p]), out,
+                        dataOffset(starts[p], numSorted)};
+    }
+
+    galois::on_each([&](unsigned tid, unsigned) {
+      merge(tid, offsets, sinks[tid], dstWidth, outDegrees);
+    });
+    for (Run& r : runs)
+      close(r.fd);
+    runs.clear();
+
+    std::vector<uint64_t> starts = rangeStarts(outDegrees);
+    uint64_t outEdges            = starts.back();
+    if (dedup) {
+      resize(outEdges);
+      galois::on_each([&](unsigned tid, unsigned) {
+        uint64_t n = starts[tid + 1] - starts[tid];
+        copy(sinks[tid].dstFd, dstWidth * n, out, dstOffset(starts[tid]));
+        copy(sinks[tid].dataFd, sizeofData * n, out,
+             dataOffset(starts[tid], outEdges));
+        close(sinks[tid].dstFd);
+        close(sinks[tid].dataFd);
+      });
+    }
+
+    {
+      uint64_t header[4] = {
+          galois::convert_htole64(dstWidth == sizeof(uint32_t) ? 1 : 2),
+          galois::convert_htole64(sizeofData),
+          galois::convert_htole64(numNodes), galois::convert_htole64(outEdges)};
+      BlockWriter index(*io, out, 0, blockSize);
+      index.write(header, sizeof(header));
+      uint64_t end = 0;
+      for (uint64_t n = 0; n < numNodes; ++n) {
+        end += outDegrees[n];
+        uint64_t e = galois::convert_htole64(end);
+        index.write(&e, sizeof(e));
+      }
+    }
+    close(out);
+    io.reset();
+
+    if (relabel && !permutationFilename.empty())
+      writePermutation();
+    return std::make_tuple(numNodes, numEdges, outEdges);
+  }
+};
+
+#endif
@@ -0,0 +1,790 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file TextGraphIngest.h
+ *
+ * Parallel conversion of text graph formats to binary gr.
+ *
+ * The input is memory-mapped and cut at line boundaries into one piece per
+ * thread. A first pass parses every piece and counts out-degrees into a
+ * per-thread histogram; the histograms are merged into per-thread write
+ * cursors with a parallel prefix sum. A second pass parses the pieces again
+ * and scatters each edge to its slot, so neighbors keep their order in the
+ * file and the result matches the sequential conversions. Reverse edges
+ * (symmetrize) are added in both passes, and duplicate removal sorts the
+ * neighbors of each node before the graph is written through a mapping of
+ * the output file.
+ *
+ * A histogram covers the range of ids its thread has counted, so inputs not
+ * grouped by source, and symmetrized inputs, make every histogram span most
+ * nodes. Once a range would pass a limit, degrees are counted again into one
+ * shared array, edges are scattered through shared atomic cursors along with
+ * their position in the file, and each node's neighbors are sorted back into
+ * file order.
+ */
+
+#ifndef GRAPH_CONVERT_TEXT_GRAPH_INGEST_H
+#define GRAPH_CONVERT_TEXT_GRAPH_INGEST_H
+
+#include "galois/Galois.h"
+#include "galois/Endian.h"
+#include "galois/LargeArray.h"
+#include "galois/gIO.h"
+#include "galois/substrate/PerThreadStorage.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//! Read-only mapping of a whole file
+class MappedTextFile {
+  int fd;
+  const char* base;
+  size_t length;
+
+public:
+  explicit MappedTextFile(const std::string& filename) : base(nullptr) {
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+      GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+    struct stat buf;
+    if (fstat(fd, &buf) == -1)
+      GALOIS_SYS_DIE("failed reading ", "'", filename, "'");
+    length = buf.st_size;
+    if (length) {
+      void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m == MAP_FAILED)
+        GALOIS_SYS_DIE("failed mapping ", "'", filename, "'");
+      madvise(m, length, MADV_SEQUENTIAL);
+      base = static_cast<const char*>(m);
+    }
+  }
+
+  ~MappedTextFile() {
+    if (base)
+      munmap(const_cast<char*>(base), length);
+    close(fd);
+  }
+
+  MappedTextFile(const MappedTextFile&) = delete;
+  MappedTextFile& operator=(const MappedTextFile&) = delete;
+
+  const char* begin() const { return base; }
+  const char* end() const { return base + length; }
+  size_t size() const { return length; }
+};
+
+namespace text_ingest {
+
+inline bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+inline void skipBlanks(const char*& p, const char* end) {
+  while (p != end && isBlank(*p))
+    ++p;
+}
+
+/**
+ * Parses an unsigned decimal number at p, after optional blanks, and moves p
+ * past it. limit is the end of the mapping: runs of digits are read eight
+ * bytes at a time while at least eight bytes remain before limit, even past
+ * end, since a number never spans lines.
+ */
+inline bool parseUnsigned(const char*& p, const char* end, const char* limit,
+                          uint64_t& value) {
+  skipBlanks(p, end);
+  const char* start = p;
+  uint64_t v        = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  while (limit - p >= 8) {
+    uint64_t chunk;
+    std::memcpy(&chunk, p, 8);
+    // a byte is a digit iff its high nibble is 3 before and after adding 6
+    uint64_t nonDigit =
+        ((chunk & UINT64_C(0xF0F0F0F0F0F0F0F0)) ^ UINT64_C(0x3030303030303030)) |
+        (((chunk + UINT64_C(0x0606060606060606)) & UINT64_C(0xF0F0F0F0F0F0F0F0)) ^
+         UINT64_C(0x3030303030303030));
+    unsigned digits = nonDigit ? __builtin_ctzll(nonDigit) / 8 : 8;
+    if (p + digits > end)
+      digits = end - p;
+    if (digits == 0)
+      break;
+    // shift the digits to the top so that the rest become leading zeros
+    chunk <<= 8 * (8 - digits);
+    chunk = ((chunk & UINT64_C(0x0F0F0F0F0F0F0F0F)) * 2561) >> 8;
+    chunk = ((chunk & UINT64_C(0x00FF00FF00FF00FF)) * 6553601) >> 16;
+    chunk = ((chunk & UINT64_C(0x0000FFFF0000FFFF)) * UINT64_C(42949672960001)) >>
+            32;
+    static const uint64_t scale[9] = {1,      10,      100,      1000,     10000,
+                                      100000, 1000000, 10000000, 100000000};
+    v = v * scale[digits] + chunk;
+    p += digits;
+    if (digits < 8)
+      break;
+  }
+#endif
+  for (; p != end && *p >= '0' && *p <= '9'; ++p)
+    v = v * 10 + (*p - '0');
+  value = v;
+  return p != start;
+}
+
+template <typename T>
+bool parseValue(const char*& p, const char* end, const char* limit, T& value,
+                typename std::enable_if<std::is_integral<T>::value>::type* = 0) {
+  skipBlanks(p, end);
+  bool negative = p != end && *p == '-';
+  if (negative || (p != end && *p == '+'))
+    ++p;
+  uint64_t v;
+  if (!parseUnsigned(p, end, limit, v))
+    return false;
+  value = negative ? static_cast<T>(-static_cast<int64_t>(v))
+                   : static_cast<T>(v);
+  return true;
+}
+
+template <typename T>
+bool parseValue(
+    const char*& p, const char* end, const char*, T& value,
+    typename std::enable_if<std::is_floating_point<T>::value>::type* = 0) {
+  skipBlanks(p, end);
+  // the mapping is not NUL-terminated, so copy the token
+  char token[64];
+  size_t len = 0;
+  while (p + len != end && !isBlank(p[len]) && len < sizeof(token) - 1) {
+    token[len] = p[len];
+    ++len;
+  }
+  token[len] = '\0';
+  char* stop;
+  double v = strtod(token, &stop);
+  if (stop == token)
+    return false;
+  p += stop - token;
+  value = static_cast<T>(v);
+  return true;
+}
+
+//! No edge values
+inline bool parseValue(const char*&, const char*, const char*, void*&) {
+  return true;
+}
+
+[[noreturn]] inline void badLine(const char* p, const char* end) {
+  GALOIS_DIE("cannot parse line: ",
+             std::string(p, std::min<size_t>(end - p, 80)));
+}
+
+/**
+ * Out-degrees of the nodes one thread has seen, over the range of node ids it
+ * has seen so far. Inputs grouped by source keep each range small.
+ */
+struct DegreeHistogram {
+  uint64_t lo = 0;
+  std::vector<uint64_t> counts;
+
+  bool covers(uint64_t n) const { return n - lo < counts.size(); }
+  uint64_t& operator[](uint64_t n) { return counts[n - lo]; }
+
+  //! Number of ids the range would cover after counting n
+  uint64_t spanWith(uint64_t n) const {
+    if (counts.empty())
+      return 1;
+    return std::max(n, lo + counts.size() - 1) - std::min(n, lo) + 1;
+  }
+
+  void release() { std::vector<uint64_t>().swap(counts); }
+
+  void add(uint64_t n) {
+    if (counts.empty()) {
+      lo = n;
+      counts.resize(1);
+    } else if (n < lo) {
+      uint64_t grow = std::max<uint64_t>(lo - n, counts.size());
+      grow          = std::min(grow, lo);
+      counts.insert(counts.begin(), grow, 0);
+      lo -= grow;
+    } else if (n - lo >= counts.size()) {
+      counts.resize(std::max<uint64_t>(n - lo + 1, 2 * counts.size()));
+    }
+    ++counts[n - lo];
+  }
+};
+
+//! Inclusive prefix sum of a[0, n)
+inline void prefixSum(galois::LargeArray<uint64_t>& a, size_t n) {
+  std::vector<uint64_t> sums(galois::getActiveThreads() + 1, 0);
+  galois::on_each([&](unsigned tid, unsigned total) {
+    auto r     = galois::block_range(size_t{0}, n, tid, total);
+    uint64_t s = 0;
+    for (size_t i = r.first; i != r.second; ++i)
+      s += a[i];
+    sums[tid + 1] = s;
+  });
+  for (size_t i = 1; i < sums.size(); ++i)
+    sums[i] += sums[i - 1];
+  galois::on_each([&](unsigned tid, unsigned total) {
+    auto r     = galois::block_range(size_t{0}, n, tid, total);
+    uint64_t s = sums[tid];
+    for (size_t i = r.first; i != r.second; ++i) {
+      s += a[i];
+      a[i] = s;
+    }
+  });
+}
+
+/**
+ * Writes a gr file from neighbors stored at [srcIdx[n-1], srcIdx[n]), of
+ * which the first dstIdx[n] - dstIdx[n-1] are kept.
+ */
+template <typename DstTy, typename EdgeData>
+void writeGr(const std::string& filename, size_t numNodes,
+             galois::LargeArray<uint64_t>& srcIdx,
+             galois::LargeArray<uint64_t>& dstIdx,
+             galois::LargeArray<DstTy>& dsts, EdgeData& edgeData) {
+  typedef typename EdgeData::value_type edge_value_type;
+  const size_t sizeofEdgeData = EdgeData::size_of::value;
+  const uint64_t version      = sizeof(DstTy) == sizeof(uint32_t) ? 1 : 2;
+  uint64_t numEdges           = numNodes ? dstIdx[numNodes - 1] : 0;
+
+  size_t dstBytes = sizeof(DstTy) * numEdges;
+  if (version == 1 && numEdges % 2)
+    dstBytes += sizeof(uint32_t); // padding
+  size_t headerBytes = sizeof(uint64_t) * (4 + numNodes);
+  size_t bytes = headerBytes + dstBytes + sizeofEdgeData * numEdges;
+
+  mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+  int fd      = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, mode);
+  if (fd == -1)
+    GALOIS_SYS_DIE("failed opening ", "'", filename, "'");
+  if (ftruncate(fd, bytes) == -1)
+    GALOIS_SYS_DIE("failed resizing ", "'", filename, "'");
+  char* base = static_cast<char*>(
+      mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  if (base == MAP_FAILED)
+    GALOIS_SYS_DIE("failed mapping ", "'", filename, "'");
+
+  uint64_t* header = reinterpret_cast<uint64_t*>(base);
+  header[0]        = galois::convert_htole64(version);
+  header[1]        = galois::convert_htole64(sizeofEdgeData);
+  header[2]        = galois::convert_htole64(numNodes);
+  header[3]        = galois::convert_htole64(numEdges);
+  uint64_t* outIdx = header + 4;
+  DstTy* outs      = reinterpret_cast<DstTy*>(base + headerBytes);
+  char* outData    = base + headerBytes + dstBytes;
+
+  galois::do_all(
+      galois::iterate(size_t{0}, numNodes),
+      [&](size_t n) {
+        outIdx[n]     = galois::convert_htole64(dstIdx[n]);
+        uint64_t from = n ? srcIdx[n - 1] : 0;
+        uint64_t to   = n ? dstIdx[n - 1] : 0;
+        for (; to != dstIdx[n]; ++from, ++to) {
+          outs[to] = sizeof(DstTy) == sizeof(uint32_t)
+                         ? galois::convert_htole32(dsts[from])
+                         : galois::convert_htole64(dsts[from]);
+          if (EdgeData::has_value) {
+            edge_value_type v = edgeData[from];
+            std::memcpy(outData + to * sizeofEdgeData, &v, sizeofEdgeData);
+          }
+        }
+      },
+      galois::steal(), galois::no_stats(), galois::loopname("WriteGr"));
+
+  if (munmap(base, bytes) == -1)
+    GALOIS_SYS_DIE("failed writing ", "'", filename, "'");
+  close(fd);
+}
+
+} // namespace text_ingest
+
+/**
+ * Converts a text graph to gr in parallel. Format supplies
+ *
+ *   const char* header(const MappedTextFile&): consumes any header and
+ *     returns where the edges start
+ *   uint64_t numNodes(): node count from the header, or 0 to use the largest
+ *     node id plus one
+ *   void parseLine(p, end, limit, emit, node): calls emit(src, dst, value)
+ *     for the edges on the line [p, end), and node(id) for any node the line
+ *     names without an edge, so that it still counts towards the node count
+ *   void check(numEdges): validates the number of parsed edges
+ *
+ * histogramLimit is the most node ids a per-thread degree histogram may
+ * span before degrees are counted in a shared array; 0 picks twice the
+ * thread's share of the nodes, so that the histograms never take more than
+ * twice the memory of the shared array.
+ *
+ * Returns the number of nodes and edges written.
+ */
+template <typename EdgeTy, typename Format>
+std::pair<size_t, size_t>
+ingestText(Format& format, const std::string& infilename,
+           const std::string& outfilename, bool symmetrize, bool dedup,
+           uint64_t histogramLimit = 0) {
+  typedef galois::LargeArray<EdgeTy> EdgeData;
+  typedef typename EdgeData::value_type edge_value_type;
+  using text_ingest::DegreeHistogram;
+
+  MappedTextFile in(infilename);
+  const char* limit = in.end();
+  const char* start = format.header(in);
+
+  // one piece per thread, starting at line boundaries
+  unsigned numThreads = galois::getActiveThreads();
+  std::vector<const char*> pieces(numThreads + 1, limit);
+  pieces[0] = start;
+  for (unsigned t = 1; t < numThreads; ++t) {
+    const char* p = std::max(pieces[t - 1], start + (limit - start) * t /
+                                                        numThreads);
+    if (p != start && p != limit && p[-1] != '\n') {
+      const void* nl = std::memchr(p, '\n', limit - p);
+      p = nl ? static_cast<const char*>(nl) + 1 : limit;
+    }
+    pieces[t] = p;
+  }
+
+  auto forEachEdge = [&](unsigned tid, auto emit, auto node) {
+    for (const char *p = pieces[tid], *e = pieces[tid + 1]; p < e;) {
+      const void* nl = std::memchr(p, '\n', e - p);
+      const char* lineEnd = nl ? static_cast<const char*>(nl) : e;
+      format.parseLine(p, lineEnd, limit, emit, node);
+      p = lineEnd + 1;
+    }
+  };
+  auto ignoreNode = [](uint64_t) {};
+
+  galois::StatTimer countTime("IngestCount");
+  countTime.start();
+  std::vector<DegreeHistogram> histograms(numThreads);
+  std::vector<uint64_t> maxIds(numThreads, 0);
+  std::atomic<bool> shared(false);
+  galois::on_each([&](unsigned tid, unsigned) {
+    DegreeHistogram& h = histograms[tid];
+    uint64_t maxId     = 0;
+    auto count         = [&](uint64_t n) {
+      if (shared.load(std::memory_order_relaxed))
+        return;
+      uint64_t maxSpan = histogramLimit;
+      if (!maxSpan)
+        maxSpan = std::max<uint64_t>(
+            1 << 16, 2 * std::max(format.numNodes(), maxId + 1) / numThreads);
+      if (h.spanWith(n) > maxSpan) {
+        shared = true;
+        return;
+      }
+      h.add(n);
+    };
+    forEachEdge(
+        tid,
+        [&](uint64_t src, uint64_t dst, const edge_value_type&) {
+          maxId = std::max(maxId, std::max(src, dst));
+          count(src);
+          if (symmetrize && src != dst)
+            count(dst);
+        },
+        [&](uint64_t n) { maxId = std::max(maxId, n); });
+    maxIds[tid] = maxId;
+  });
+
+  uint64_t numNodes = format.numNodes();
+  if (!numNodes)
+    numNodes = *std::max_element(maxIds.begin(), maxIds.end()) + 1;
+
+  galois::LargeArray<uint64_t> srcIdx;
+  srcIdx.create(numNodes);
+  // shared degrees, then write cursors within each node
+  galois::LargeArray<std::atomic<uint64_t>> cursors;
+  // edges each thread places, then the index of its first placed edge
+  std::vector<uint64_t> placed(numThreads + 1, 0);
+  if (shared) {
+    for (DegreeHistogram& h : histograms)
+      h.release();
+    cursors.create(numNodes);
+    galois::do_all(galois::iterate(uint64_t{0}, numNodes),
+                   [&](uint64_t n) { cursors[n] = 0; }, galois::no_stats());
+    galois::on_each([&](unsigned tid, unsigned) {
+      uint64_t num = 0;
+      auto count   = [&](uint64_t n) {
+        cursors[n].fetch_add(1, std::memory_order_relaxed);
+        ++num;
+      };
+      forEachEdge(
+          tid,
+          [&](uint64_t src, uint64_t dst, const edge_value_type&) {
+            count(src);
+            if (symmetrize && src != dst)
+              count(dst);
+          },
+          ignoreNode);
+      placed[tid + 1] = num;
+    });
+    for (unsigned t = 1; t <= numThreads; ++t)
+      placed[t] += placed[t - 1];
+    galois::do_all(galois::iterate(uint64_t{0}, numNodes),
+                   [&](uint64_t n) {
+                     srcIdx[n]  = cursors[n];
+                     cursors[n] = 0;
+                   },
+                   galois::no_stats(), galois::loopname("IngestMerge"));
+  } else {
+    // per-thread histograms become each thread's offset within a node
+    galois::do_all(galois::iterate(uint64_t{0}, numNodes),
+                   [&](uint64_t n) {
+                     uint64_t degree = 0;
+                     for (DegreeHistogram& h : histograms) {
+                       if (h.covers(n)) {
+                         uint64_t c = h[n];
+                         h[n]       = degree;
+                         degree += c;
+                       }
+                     }
+                     srcIdx[n] = degree;
+                   },
+                   galois::no_stats(), galois::loopname("IngestMerge"));
+  }
+  text_ingest::prefixSum(srcIdx, numNodes);
+  uint64_t numEdges = numNodes ? srcIdx[numNodes - 1] : 0;
+  countTime.stop();
+
+  uint64_t numParsed = symmetrize ? 0 : numEdges;
+  if (symmetrize) {
+    std::vector<uint64_t> counts(numThreads, 0);
+    galois::on_each([&](unsigned tid, unsigned) {
+      forEachEdge(
+          tid,
+          [&](uint64_t, uint64_t, const edge_value_type&) { ++counts[tid]; },
+          ignoreNode);
+    });
+    for (uint64_t c : counts)
+      numParsed += c;
+  }
+  format.check(numParsed);
+
+  auto run = [&](auto* dstTag) {
+    typedef typename std::remove_pointer<decltype(dstTag)>::type DstTy;
+    galois::LargeArray<DstTy> dsts;
+    EdgeData edgeData;
+    dsts.create(numEdges);
+    edgeData.create(numEdges);
+
+    // with shared cursors, the index of each edge in file order
+    galois::LargeArray<uint64_t> order;
+    if (shared)
+      order.create(numEdges);
+
+    galois::StatTimer scatterTime("IngestScatter");
+    scatterTime.start();
+    galois::on_each([&](unsigned tid, unsigned) {
+      DegreeHistogram& h = histograms[tid];
+      uint64_t next      = placed[tid];
+      auto place = [&](uint64_t src, uint64_t dst, const edge_value_type& v) {
+        uint64_t pos = src ? srcIdx[src - 1] : 0;
+        if (shared) {
+          pos += cursors[src].fetch_add(1, std::memory_order_relaxed);
+          order[pos] = next++;
+        } else {
+          pos += h[src]++;
+        }
+        dsts[pos] = dst;
+        edgeData.set(pos, v);
+      };
+      forEachEdge(
+          tid,
+          [&](uint64_t src, uint64_t dst, const edge_value_type& v) {
+            place(src, dst, v);
+            if (symmetrize && src != dst)
+              place(dst, src, v);
+          },
+          ignoreNode);
+    });
+
+    if (shared) {
+      // put the neighbors of each node back in file order
+      typedef std::pair<uint64_t, uint64_t> Entry;
+      galois::substrate::PerThreadStorage<std::vector<Entry>> entries;
+      galois::substrate::PerThreadStorage<std::vector<DstTy>> neighbors;
+      galois::substrate::PerThreadStorage<std::vector<edge_value_type>> values;
+      galois::do_all(
+          galois::iterate(uint64_t{0}, numNodes),
+          [&](uint64_t n) {
+            uint64_t b = n ? srcIdx[n - 1] : 0, e = srcIdx[n];
+            std::vector<Entry>& es           = *entries.getLocal();
+            std::vector<DstTy>& ds           = *neighbors.getLocal();
+            std::vector<edge_value_type>& vs = *values.getLocal();
+            es.clear();
+            ds.clear();
+            vs.clear();
+            for (uint64_t i = b; i != e; ++i)
+              es.emplace_back(order[i], i);
+            std::sort(es.begin(), es.end());
+            for (const Entry& entry : es) {
+              ds.push_back(dsts[entry.second]);
+              vs.push_back(edgeData[entry.second]);
+            }
+            for (size_t i = 0; i < es.size(); ++i) {
+              dsts[b + i] = ds[i];
+              edgeData.set(b + i, vs[i]);
+            }
+          },
+          galois::steal(), galois::no_stats(),
+          galois::loopname("IngestOrder"));
+    }
+    scatterTime.stop();
+
+    galois::LargeArray<uint64_t> dedupIdx;
+    galois::LargeArray<uint64_t>* dstIdx = &srcIdx;
+    if (dedup) {
+      galois::StatTimer dedupTime("IngestDedup");
+      dedupTime.start();
+      dedupIdx.create(numNodes);
+      typedef std::pair<DstTy, uint64_t> Entry;
+      galois::substrate::PerThreadStorage<std::vector<Entry>> entries;
+      galois::substrate::PerThreadStorage<std::vector<edge_value_type>> values;
+      galois::do_all(
+          galois::iterate(uint64_t{0}, numNodes),
+          [&](uint64_t n) {
+            uint64_t b = n ? srcIdx[n - 1] : 0, e = srcIdx[n];
+            std::vector<Entry>& es = *entries.getLocal();
+            std::vector<edge_value_type>& vs = *values.getLocal();
+            es.clear();
+            vs.clear();
+            for (uint64_t i = b; i != e; ++i)
+              es.emplace_back(dsts[i], i);
+            // keeps the value of the first occurrence in the file
+            std::sort(es.begin(), es.end());
+            uint64_t kept = b;
+            for (size_t i = 0; i < es.size(); ++i) {
+              if (i && es[i].first == es[i - 1].first)
+                continue;
+              vs.push_back(edgeData[es[i].second]);
+              dsts[kept++] = es[i].first;
+            }
+            for (size_t i = 0; i < vs.size(); ++i)
+              edgeData.set(b + i, vs[i]);
+            dedupIdx[n] = kept - b;
+          },
+          galois::steal(), galois::no_stats(), galois::loopname("IngestDedup"));
+      text_ingest::prefixSum(dedupIdx, numNodes);
+      dstIdx = &dedupIdx;
+      dedupTime.stop();
+    }
+
+    galois::StatTimer writeTime("IngestWrite");
+    writeTime.start();
+    text_ingest::writeGr(outfilename, numNodes, srcIdx, *dstIdx, dsts,
+                         edgeData);
+    writeTime.stop();
+    return numNodes ? (*dstIdx)[numNodes - 1] : 0;
+  };
+
+  uint64_t written = numNodes <= std::numeric_limits<uint32_t>::max()
+                         ? run(static_cast<uint32_t*>(nullptr))
+                         : run(static_cast<uint64_t*>(nullptr));
+  return std::make_pair(numNodes, written);
+}
+
+//! src dst [value] per line; lines starting with # or % are comments
+template <typename EdgeTy>
+struct EdgelistFormat {
+  typedef typename galois::LargeArray<EdgeTy>::value_type edge_value_type;
+
+  const char* header(const MappedTextFile& in) { return in.begin(); }
+  uint64_t numNodes() const { return 0; }
+  void check(uint64_t) const {}
+
+  template <typename F, typename N>
+  void parseLine(const char* p, const char* end, const char* limit, F& emit,
+                 N&) {
+    using namespace text_ingest;
+    const char* line = p;
+    skipBlanks(p, end);
+    if (p == end || *p == '#' || *p == '%')
+      return;
+    uint64_t src, dst;
+    edge_value_type v{};
+    if (!parseUnsigned(p, end, limit, src) ||
+        !parseUnsigned(p, end, limit, dst) || !parseValue(p, end, limit, v))
+      badLine(line, end);
+    emit(src, dst, v);
+  }
+};
+
+/**
+ * Matrix market: % comments, a "rows cols entries" line, then 1-indexed
+ * "row col [value]" lines; a missing value is 1.
+ */
+template <typename EdgeTy>
+struct MtxFormat {
+  typedef typename galois::LargeArray<EdgeTy>::value_type edge_value_type;
+  uint64_t nnodes = 0;
+  uint64_t nedges = 0;
+
+  const char* header(const MappedTextFile& in) {
+    using namespace text_ingest;
+    const char* p = in.begin();
+    while (p != in.end()) {
+      const void* nl      = std::memchr(p, '\n', in.end() - p);
+      const char* lineEnd = nl ? static_cast<const char*>(nl) : in.end();
+      const char* q       = p;
+      skipBlanks(q, lineEnd);
+      if (q != lineEnd && *q != '%') {
+        uint64_t cols;
+        if (!parseUnsigned(q, lineEnd, lineEnd, nnodes) ||
+            !parseUnsigned(q, lineEnd, lineEnd, cols) ||
+            !parseUnsigned(q, lineEnd, lineEnd, nedges))
+          GALOIS_DIE("Unknown problem specification line: ",
+                     std::string(p, lineEnd));
+        return nl ? lineEnd + 1 : lineEnd;
+      }
+      p = nl ? lineEnd + 1 : lineEnd;
+    }
+    GALOIS_DIE("missing problem specification line");
+  }
+  uint64_t numNodes() const { return nnodes; }
+  void check(uint64_t numEdges) const {
+    if (numEdges != nedges)
+      GALOIS_DIE("Error: expected ", nedges, " edges but found ", numEdges);
+  }
+
+  template <typename F, typename N>
+  void parseLine(const char* p, const char* end, const char* limit, F& emit,
+                 N&) {
+    using namespace text_ingest;
+    const char* line = p;
+    skipBlanks(p, end);
+    if (p == end || *p == '%')
+      return;
+    uint64_t src, dst;
+    if (!parseUnsigned(p, end, limit, src) ||
+        !parseUnsigned(p, end, limit, dst))
+      badLine(line, end);
+    if (src == 0 || src > nnodes)
+      GALOIS_DIE("Error: node id out of range: ", src);
+    if (dst == 0 || dst > nnodes)
+      GALOIS_DIE("Error: neighbor id out of range: ", dst);
+    double weight = 1;
+    parseValue(p, end, limit, weight);
+    emit(src - 1, dst - 1, static_cast<edge_value_type>(weight));
+  }
+};
+
+//! DIMACS: c comments, "p sp nodes arcs", then 1-indexed "a src dst weight"
+template <typename EdgeTy>
+struct DimacsFormat {
+  typedef typename galois::LargeArray<EdgeTy>::value_type edge_value_type;
+  uint64_t nnodes = 0;
+  uint64_t nedges = 0;
+
+  const char* header(const MappedTextFile& in) {
+    using namespace text_ingest;
+    const char* p = in.begin();
+    while (p != in.end()) {
+      const void* nl      = std::memchr(p, '\n', in.end() - p);
+      const char* lineEnd = nl ? static_cast<const char*>(nl) : in.end();
+      if (*p == 'p') {
+        // the last two fields are the counts
+        std::vector<uint64_t> fields;
+        for (const char* q = p + 1; q != lineEnd;) {
+          uint64_t v;
+          if (parseUnsigned(q, lineEnd, lineEnd, v))
+            fields.push_back(v);
+          else
+            while (q != lineEnd && !isBlank(*q))
+              ++q;
+        }
+        if (fields.size() < 2)
+          GALOIS_DIE("Unknown problem specification line: ",
+                     std::string(p, lineEnd));
+        nnodes = fields[fields.size() - 2];
+        nedges = fields[fields.size() - 1];
+        return nl ? lineEnd + 1 : lineEnd;
+      }
+      p = nl ? lineEnd + 1 : lineEnd;
+    }
+    GALOIS_DIE("missing problem specification line");
+  }
+  uint64_t numNodes() const { return nnodes; }
+  void check(uint64_t numEdges) const {
+    if (numEdges != nedges)
+      GALOIS_DIE("Error: expected ", nedges, " arcs but found ", numEdges);
+  }
+
+  template <typename F, typename N>
+  void parseLine(const char* p, const char* end, const char* limit, F& emit,
+                 N&) {
+    using namespace text_ingest;
+    const char* line = p;
+    if (p == end || *p != 'a')
+      return;
+    ++p;
+    uint64_t src, dst;
+    int32_t weight;
+    if (!parseUnsigned(p, end, limit, src) ||
+        !parseUnsigned(p, end, limit, dst) ||
+        !parseValue(p, end, limit, weight))
+      badLine(line, end);
+    if (src == 0 || src > nnodes)
+      GALOIS_DIE("Error: node id out of range: ", src);
+    if (dst == 0 || dst > nnodes)
+      GALOIS_DIE("Error: neighbor id out of range: ", dst);
+    emit(src - 1, dst - 1, static_cast<edge_value_type>(weight));
+  }
+};
+
+//! "src numNeighbors neighbor*" per line, no edge values
+struct NodelistFormat {
+  const char* header(const MappedTextFile& in) { return in.begin(); }
+  uint64_t numNodes() const { return 0; }
+  void check(uint64_t) const {}
+
+  template <typename F, typename N>
+  void parseLine(const char* p, const char* end, const char* limit, F& emit,
+                 N& node) {
+    using namespace text_ingest;
+    const char* line = p;
+    uint64_t src, numNeighbors;
+    if (!parseUnsigned(p, end, limit, src))
+      return;
+    if (!parseUnsigned(p, end, limit, numNeighbors))
+      badLine(line, end);
+    node(src);
+    for (; numNeighbors; --numNeighbors) {
+      uint64_t dst;
+      if (!parseUnsigned(p, end, limit, dst))
+        badLine(line, end);
+      emit(src, dst, nullptr);
+    }
+  }
+};
+
+#endif
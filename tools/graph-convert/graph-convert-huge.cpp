@@ -17,12 +17,15 @@
  * Documentation, or loss or inaccuracy of data of any kind.
  */
 
+#include "galois/Galois.h"
 #include "galois/LargeArray.h"
 #include "galois/graphs/FileGraph.h"
 #include "galois/graphs/OfflineGraph.h"
 
 #include "llvm/Support/CommandLine.h"
 
+#include "ExternalGraphSort.h"
+
 #include <boost/iostreams/filtering_streambuf.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/mpl/if.hpp>
@@ -54,6 +57,39 @@ static cll::opt<bool>
 static cll::opt<unsigned long long>
     numNodes("numNodes", cll::desc("Total number of nodes given."),
              cll::init(0));
+static cll::opt<bool> transpose("transpose",
+                                cll::desc("Transpose a gr input on disk"),
+                                cll::init(false));
+static cll::opt<bool>
+    symmetrize("symmetrize",
+               cll::desc("Add the reverse of every edge of a gr input"),
+               cll::init(false));
+static cll::opt<bool> dedup("dedup",
+                            cll::desc("Drop repeated edges of a gr input, "
+                                      "keeping the first value"),
+                            cll::init(false));
+static cll::opt<bool> relabel("relabel",
+                              cll::desc("Randomly relabel the nodes of a gr "
+                                        "input"),
+                              cll::init(false));
+static cll::opt<std::string>
+    outputPermutationFilename("outputNodePermutation",
+                              cll::desc("output node permutation file"),
+                              cll::init(""));
+static cll::opt<unsigned>
+    memoryLimit("memoryLimit",
+                cll::desc("Memory in MB used for sorting gr inputs"),
+                cll::init(1024));
+static cll::opt<std::string>
+    tmpDir("tmpDir", cll::desc("Directory for temporary sorted runs"),
+           cll::init("."));
+static cll::opt<unsigned>
+    maxFanIn("maxFanIn",
+             cll::desc("Most sorted runs merged at once; more runs are "
+                       "merged in several passes"),
+             cll::init(64));
+static cll::opt<unsigned> numThreads("t", cll::desc("Number of threads"),
+                                     cll::init(1));
 
 union dataTy {
   int64_t ival;
@@ -230,8 +266,36 @@ void go_edgesSorted(std::istream& input, uint64_t numNodes) {
   }
 }
 
+/**
+ * Sorts the edges of a gr input on disk; neighbors in the output are sorted
+ * by destination.
+ */
+void goExternal() {
+  galois::SharedMemSys G;
+  galois::setActiveThreads(numThreads);
+
+  ExternalGraphSort sorter;
+  sorter.transpose           = transpose;
+  sorter.symmetrize          = symmetrize;
+  sorter.dedup               = dedup;
+  sorter.relabel             = relabel;
+  sorter.permutationFilename = outputPermutationFilename;
+  sorter.tmpDir              = tmpDir;
+  sorter.memoryLimit         = size_t{memoryLimit} << 20;
+  sorter.maxFanIn            = maxFanIn;
+
+  uint64_t nodes, inEdges, outEdges;
+  std::tie(nodes, inEdges, outEdges) = sorter(inputFilename, outputFilename);
+  std::cout << "InGraph : |V| = " << nodes << ", |E| = " << inEdges << "\n";
+  std::cout << "OutGraph: |V| = " << nodes << ", |E| = " << outEdges << "\n";
+}
+
 int main(int argc, char** argv) {
   llvm::cl::ParseCommandLineOptions(argc, argv);
+  if (transpose || symmetrize || dedup || relabel) {
+    goExternal();
+    return 0;
+  }
   //  std::ios_base::sync_with_stdio(false);
   std::cout << "Data will be " << (useSmallData ? 4 : 8) << " Bytes\n";
 
@@ -20,6 +20,7 @@
 #include "galois/Galois.h"
 #include "galois/LargeArray.h"
 #include "galois/graphs/FileGraph.h"
+#include "TextGraphIngest.h"
 
 #include "llvm/Support/CommandLine.h"
 
@@ -198,6 +199,29 @@ static cll::opt<int>
              cll::init(1));
 static cll::opt<int> maxDegree("maxDegree", cll::desc("maximum degree to keep"),
                                cll::init(2 * 1024));
+static cll::opt<unsigned> numThreads("t", cll::desc("Number of threads"),
+                                     cll::init(1));
+static cll::opt<bool>
+    parallelParse("parallelParse",
+                  cll::desc("parse edgelist, mtx, dimacs and nodelist inputs "
+                            "in parallel from a memory-mapped file"),
+                  cll::init(false));
+static cll::opt<bool>
+    symmetrizeInput("symmetrize",
+                    cll::desc("also add the reverse of every parsed edge "
+                              "(requires -parallelParse)"),
+                    cll::init(false));
+static cll::opt<bool>
+    dedupInput("dedup",
+               cll::desc("sort neighbors and drop repeated edges, keeping the "
+                         "first value (requires -parallelParse)"),
+               cll::init(false));
+static cll::opt<unsigned long long> ingestHistogramLimit(
+    "ingestHistogramLimit",
+    cll::desc("most node ids a thread counts degrees for privately before "
+              "-parallelParse counts them in a shared array (0: twice the "
+              "thread's share of the nodes)"),
+    cll::init(0));
 
 struct Conversion {};
 struct HasOnlyVoidSpecialization {};
@@ -338,6 +362,15 @@ void outputPermutation(const T& perm) {
 struct Edgelist2Gr : public Conversion {
   template <typename EdgeTy>
   void convert(const std::string& infilename, const std::string& outfilename) {
+    if (parallelParse) {
+      EdgelistFormat<EdgeTy> format;
+      auto sizes = ingestText<EdgeTy>(format, infilename, outfilename,
+                                      symmetrizeInput, dedupInput,
+                                      ingestHistogramLimit);
+      printStatus(sizes.first, sizes.second);
+      return;
+    }
+
     typedef galois::graphs::FileGraphWriter Writer;
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
@@ -487,6 +520,15 @@ struct Edgelist2Binary : public Conversion {
 struct Mtx2Gr : public HasNoVoidSpecialization {
   template <typename EdgeTy>
   void convert(const std::string& infilename, const std::string& outfilename) {
+    if (parallelParse) {
+      MtxFormat<EdgeTy> format;
+      auto sizes = ingestText<EdgeTy>(format, infilename, outfilename,
+                                      symmetrizeInput, dedupInput,
+                                      ingestHistogramLimit);
+      printStatus(sizes.first, sizes.second);
+      return;
+    }
+
     typedef galois::graphs::FileGraphWriter Writer;
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
@@ -626,6 +668,16 @@ struct Nodelist2Gr : public HasOnlyVoidSpecialization {
   void convert(const std::string& infilename, const std::string& outfilename) {
     static_assert(std::is_same<EdgeTy, void>::value,
                   "conversion undefined for non-void graphs");
+
+    if (parallelParse) {
+      NodelistFormat format;
+      auto sizes = ingestText<EdgeTy>(format, infilename, outfilename,
+                                      symmetrizeInput, dedupInput,
+                                      ingestHistogramLimit);
+      printStatus(sizes.first, sizes.second);
+      return;
+    }
+
     typedef galois::graphs::FileGraphWriter Writer;
 
     Writer p;
@@ -2061,6 +2113,15 @@ struct MakeUnsymmetric : public Conversion {
 struct Dimacs2Gr : public HasNoVoidSpecialization {
   template <typename EdgeTy>
   void convert(const std::string& infilename, const std::string& outfilename) {
+    if (parallelParse) {
+      DimacsFormat<EdgeTy> format;
+      auto sizes = ingestText<EdgeTy>(format, infilename, outfilename,
+                                      symmetrizeInput, dedupInput,
+                                      ingestHistogramLimit);
+      printStatus(sizes.first, sizes.second);
+      return;
+    }
+
     typedef galois::graphs::FileGraphWriter Writer;
     typedef galois::LargeArray<EdgeTy> EdgeData;
     typedef typename EdgeData::value_type edge_value_type;
@@ -2856,6 +2917,9 @@ int main(int argc, char** argv) {
   galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
   std::ios_base::sync_with_stdio(false);
+  galois::setActiveThreads(numThreads);
+  if ((symmetrizeInput || dedupInput) && !parallelParse)
+    GALOIS_DIE("-symmetrize and -dedup require -parallelParse");
   switch (convertMode) {
   case bipartitegr2bigpetsc:
     convert<Bipartitegr2Petsc<double, false>>();
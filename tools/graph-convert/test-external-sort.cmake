@@ -0,0 +1,104 @@
+# Checks that the on-disk transforms of graph-convert-huge write the same gr
+# file as the in-memory conversions of graph-convert. The memory budget is at
+# its minimum (runs of 1024 edges) and at most 2 runs are merged at once, so
+# the input is split into several runs that take more than one merge pass.
+#
+# cmake -DCONVERT=<graph-convert> -DHUGE=<graph-convert-huge> -DWORKDIR=<dir>
+#       -P test-external-sort.cmake
+
+file(MAKE_DIRECTORY ${WORKDIR})
+
+# 3000 edges over nodes [0, 200) -> [0, 211) in file order that is not sorted
+# by source, plus a repeat of every tenth edge. There are no self edges, and
+# the value of an edge depends only on the pair of its endpoints, so the
+# outputs do not depend on the order of edges with the same destination.
+set(el "")
+foreach(i RANGE 2999)
+  math(EXPR src "(${i} * 7) % 200")
+  math(EXPR dst "(${i} * 13 + 5) % 211")
+  if(src EQUAL dst)
+    math(EXPR dst "${dst} + 1")
+  endif()
+  math(EXPR w "(${src} + ${dst}) % 17")
+  string(APPEND el "${src} ${dst} ${w}\n")
+  math(EXPR rem "${i} % 10")
+  if(rem EQUAL 0)
+    string(APPEND el "${src} ${dst} ${w}\n")
+  endif()
+endforeach()
+file(WRITE ${WORKDIR}/sort.el "${el}")
+
+function(run)
+  execute_process(COMMAND ${ARGN} RESULT_VARIABLE result
+                  OUTPUT_VARIABLE out ERROR_VARIABLE out)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${ARGN} failed: ${result}\n${out}")
+  endif()
+  set(output "${out}" PARENT_SCOPE)
+endfunction()
+
+function(runHuge option file)
+  run(${HUGE} -${option} -memoryLimit=0 -maxFanIn=2 -t=2
+      -tmpDir=${WORKDIR} ${ARGN} ${WORKDIR}/sort.gr ${WORKDIR}/${file})
+  # the first count printed is the number of runs before merging
+  string(REGEX MATCH "into ([0-9]+) runs" match "${output}")
+  if(NOT CMAKE_MATCH_1 GREATER 2)
+    message(FATAL_ERROR "-${option} did not take several merge passes")
+  endif()
+endfunction()
+
+function(compare expected actual)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+            ${WORKDIR}/${expected} ${WORKDIR}/${actual}
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${actual} differs from ${expected}")
+  endif()
+endfunction()
+
+run(${CONVERT} -edgelist2gr -edgeType=int32 ${WORKDIR}/sort.el
+    ${WORKDIR}/sort.gr)
+
+# graph-convert does not sort neighbors, so its outputs are sorted by
+# destination before comparing
+foreach(pair "transpose;gr2tgr" "symmetrize;gr2sgr" "dedup;gr2cgr")
+  list(GET pair 0 option)
+  list(GET pair 1 mode)
+  run(${CONVERT} -${mode} -edgeType=int32 ${WORKDIR}/sort.gr
+      ${WORKDIR}/${mode}.unsorted.gr)
+  run(${CONVERT} -gr2sorteddstgr -edgeType=int32
+      ${WORKDIR}/${mode}.unsorted.gr ${WORKDIR}/${mode}.gr)
+  runHuge(${option} ${option}.gr)
+  compare(${mode}.gr ${option}.gr)
+endforeach()
+
+# The permutation is random: map the input edges through the permutation
+# that -relabel wrote and compare the sorted edge lists
+runHuge(relabel relabel.gr -outputNodePermutation=${WORKDIR}/relabel.perm)
+file(STRINGS ${WORKDIR}/relabel.perm perm)
+foreach(line IN LISTS perm)
+  string(REPLACE "," ";" line "${line}")
+  list(GET line 0 old)
+  list(GET line 1 new)
+  set(new${old} ${new})
+endforeach()
+run(${CONVERT} -gr2edgelist -edgeType=int32 ${WORKDIR}/sort.gr
+    ${WORKDIR}/sort.out.el)
+run(${CONVERT} -gr2edgelist -edgeType=int32 ${WORKDIR}/relabel.gr
+    ${WORKDIR}/relabel.out.el)
+file(STRINGS ${WORKDIR}/sort.out.el edges)
+set(expected "")
+foreach(edge IN LISTS edges)
+  string(REPLACE " " ";" edge "${edge}")
+  list(GET edge 0 src)
+  list(GET edge 1 dst)
+  list(GET edge 2 w)
+  list(APPEND expected "${new${src}} ${new${dst}} ${w}")
+endforeach()
+file(STRINGS ${WORKDIR}/relabel.out.el actual)
+list(SORT expected)
+list(SORT actual)
+if(NOT expected STREQUAL actual)
+  message(FATAL_ERROR "-relabel output is not the permuted input")
+endif()
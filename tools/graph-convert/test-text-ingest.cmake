@@ -0,0 +1,97 @@
+# Checks that -parallelParse writes the same gr file as the sequential
+# conversion for each text format it handles.
+#
+# cmake -DCONVERT=<graph-convert> -DWORKDIR=<dir> -P test-text-ingest.cmake
+
+file(MAKE_DIRECTORY ${WORKDIR})
+
+# 600 edges over nodes [0, 50) -> [0, 53) in file order that is not sorted
+# by source. The headers declare 60 nodes, and the nodelist ends with node 59
+# without neighbors, so the last nodes only exist through the node counts.
+set(el "")
+set(mtx "%%MatrixMarket matrix coordinate real general\n% comment\n60 60 600\n")
+set(dimacs "c comment\np sp 60 600\n")
+foreach(i RANGE 599)
+  math(EXPR src "(${i} * 7) % 50")
+  math(EXPR dst "(${i} * 13 + 5) % 53")
+  math(EXPR w "(${i} * 31) % 17 - 3")
+  math(EXPR src1 "${src} + 1")
+  math(EXPR dst1 "${dst} + 1")
+  string(APPEND el "${src} ${dst} ${w}\n")
+  string(APPEND mtx "${src1} ${dst1} ${w}.5\n")
+  string(APPEND dimacs "a ${src1} ${dst1} ${w}\n")
+  list(APPEND neighbors${src} ${dst})
+endforeach()
+set(nl "")
+foreach(src RANGE 49)
+  list(LENGTH neighbors${src} degree)
+  string(REPLACE ";" " " list "${neighbors${src}}")
+  string(APPEND nl "${src} ${degree} ${list}\n")
+endforeach()
+string(APPEND nl "59 0\n")
+
+file(WRITE ${WORKDIR}/ingest.el "${el}")
+file(WRITE ${WORKDIR}/ingest.mtx "${mtx}")
+file(WRITE ${WORKDIR}/ingest.dimacs "${dimacs}")
+file(WRITE ${WORKDIR}/ingest.nl "${nl}")
+
+function(check mode input edgeType)
+  foreach(parallel OFF ON)
+    if(parallel)
+      set(args -parallelParse -t=4)
+      set(out ${input}.par.gr)
+    else()
+      set(args)
+      set(out ${input}.seq.gr)
+    endif()
+    execute_process(
+      COMMAND ${CONVERT} -${mode} -edgeType=${edgeType} ${args}
+              ${WORKDIR}/${input} ${WORKDIR}/${out}
+      RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "${mode} ${args} failed: ${result}")
+    endif()
+  endforeach()
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+            ${WORKDIR}/${input}.seq.gr ${WORKDIR}/${input}.par.gr
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${mode}: -parallelParse output differs")
+  endif()
+endfunction()
+
+check(edgelist2gr ingest.el int32)
+check(mtx2gr ingest.mtx float32)
+check(dimacs2gr ingest.dimacs int32)
+check(nodelist2gr ingest.nl void)
+
+# A histogram limit of 8 node ids makes -parallelParse count degrees in the
+# shared array and sort neighbors back into file order; the output must not
+# change.
+function(checkShared mode input edgeType)
+  foreach(limit 0 8)
+    execute_process(
+      COMMAND ${CONVERT} -${mode} -edgeType=${edgeType} -parallelParse -t=4
+              -ingestHistogramLimit=${limit} ${ARGN}
+              ${WORKDIR}/${input} ${WORKDIR}/${input}.limit${limit}.gr
+      RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "${mode} ${ARGN} -ingestHistogramLimit=${limit} "
+                          "failed: ${result}")
+    endif()
+  endforeach()
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files
+            ${WORKDIR}/${input}.limit0.gr ${WORKDIR}/${input}.limit8.gr
+    RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${mode} ${ARGN}: shared degree counts change the "
+                        "output")
+  endif()
+endfunction()
+
+checkShared(edgelist2gr ingest.el int32)
+checkShared(edgelist2gr ingest.el int32 -symmetrize)
+checkShared(mtx2gr ingest.mtx float32 -symmetrize -dedup)
+checkShared(nodelist2gr ingest.nl void -symmetrize)
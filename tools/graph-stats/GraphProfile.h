@@ -0,0 +1,539 @@
+/*
+ * This file belongs to the Galois project, a C++ library for exploiting parallelism.
+ * The code is being released under the terms of the 3-Clause BSD License (a
+ * copy is located in LICENSE.txt at the top-level directory).
+ *
+ * Copyright (C) 2018, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+
+/**
+ * @file GraphProfile.h
+ *
+ * Estimates structural properties of a graph that guide the choice of
+ * partitioning policy and node order:
+ *
+ * - degree extremes, self loops and whether neighbor lists are sorted, from
+ *   one pass over the edges that also counts in-degrees;
+ * - transitivity and average local clustering coefficient from wedges
+ *   sampled over out-neighbors;
+ * - degree assortativity from uniformly sampled edges;
+ * - the edges each CuSP policy would cut and its replication factor, from a
+ *   second pass over the edges;
+ * - the neighborhood function, effective diameter and an approximate
+ *   diameter from HyperLogLog counters (HyperANF), one pass over the edges
+ *   per hop.
+ *
+ * Samples draw from counter-based random streams, so the results do not
+ * depend on the number of threads.
+ */
+
+#ifndef GRAPH_STATS_GRAPH_PROFILE_H
+#define GRAPH_STATS_GRAPH_PROFILE_H
+
+#include "galois/Galois.h"
+#include "galois/LargeArray.h"
+#include "galois/Reduction.h"
+#include "galois/graphs/FileGraph.h"
+#include "galois/graphs/GraphHelpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ProfileOptions {
+  uint64_t samples       = 100000;
+  unsigned registers     = 64;
+  unsigned maxHops       = 64;
+  unsigned hosts         = 4;
+  uint64_t seed          = 0;
+  //! degree above which hybrid vertex cuts assign edges by the other end
+  uint64_t hvcThreshold  = 1000;
+};
+
+namespace graph_profile {
+
+inline uint64_t mix(uint64_t x) {
+  x += UINT64_C(0x9E3779B97F4A7C15);
+  x = (x ^ (x >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+  x = (x ^ (x >> 27)) * UINT64_C(0x94D049BB133111EB);
+  return x ^ (x >> 31);
+}
+
+//! Random stream number i of a seed
+class SampleRng {
+  uint64_t state;
+
+public:
+  SampleRng(uint64_t seed, uint64_t i) : state(mix(seed) ^ mix(i)) {}
+  uint64_t next() { return mix(state++); }
+  //! Uniform in [0, n)
+  uint64_t below(uint64_t n) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >>
+                                 64);
+  }
+  double uniform() { return std::ldexp(double(next() >> 11), -53); }
+};
+
+//! Writes doubles as JSON numbers, with null for non-finite values
+inline std::string number(double x) {
+  if (!std::isfinite(x))
+    return "null";
+  std::ostringstream s;
+  s.precision(6);
+  s << x;
+  return s.str();
+}
+
+} // namespace graph_profile
+
+class GraphProfile {
+  typedef galois::graphs::FileGraph Graph;
+
+  Graph& graph;
+  const ProfileOptions& opts;
+  uint64_t numNodes;
+  uint64_t numEdges;
+  //! Inclusive prefix sums of out- and in-degrees
+  galois::LargeArray<uint64_t> outPrefix;
+  galois::LargeArray<uint64_t> inPrefix;
+  bool sorted = true;
+  uint64_t selfLoops = 0;
+  uint64_t maxOut = 0, maxOutNode = 0, maxIn = 0, maxInNode = 0;
+
+  uint64_t outDegree(uint64_t n) const {
+    return outPrefix[n] - (n ? outPrefix[n - 1] : 0);
+  }
+  uint64_t inDegree(uint64_t n) const {
+    return inPrefix[n] - (n ? inPrefix[n - 1] : 0);
+  }
+  uint64_t edgeBegin(uint64_t n) const { return n ? outPrefix[n - 1] : 0; }
+
+  //! Source node of an edge index
+  uint64_t edgeSource(uint64_t e) const {
+    return std::upper_bound(outPrefix.begin(), outPrefix.begin() + numNodes,
+                            e) -
+           outPrefix.begin();
+  }
+
+  bool hasEdge(uint64_t src, uint64_t dst) {
+    auto b = graph.edge_begin(src), e = graph.edge_end(src);
+    if (sorted) {
+      while (b != e) {
+        auto mid = b + std::distance(b, e) / 2;
+        uint64_t d = graph.getEdgeDst(mid);
+        if (d == dst)
+          return true;
+        if (d < dst)
+          b = mid + 1;
+        else
+          e = mid;
+      }
+      return false;
+    }
+    for (; b != e; ++b)
+      if (graph.getEdgeDst(b) == dst)
+        return true;
+    return false;
+  }
+
+  void countDegrees() {
+    galois::LargeArray<std::atomic<uint64_t>> in;
+    in.create(numNodes);
+    outPrefix.create(numNodes);
+    inPrefix.create(numNodes);
+    galois::do_all(galois::iterate(uint64_t{0}, numNodes),
+                   [&](uint64_t n) {
+                     in[n]        = 0;
+                     outPrefix[n] = *graph.edge_end(n);
+                   },
+                   galois::no_stats());
+
+    galois::GAccumulator<uint64_t> loops;
+    galois::GReduceLogicalAND allSorted;
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) {
+          uint64_t last = 0;
+          bool first    = true;
+          for (auto ii : graph.edges(n)) {
+            uint64_t dst = graph.getEdgeDst(ii);
+            in[dst].fetch_add(1, std::memory_order_relaxed);
+            if (dst == n)
+              loops += 1;
+            if (!first && dst < last)
+              allSorted.update(false);
+            last  = dst;
+            first = false;
+          }
+        },
+        galois::steal(), galois::no_stats(), galois::loopname("CountDegrees"));
+    selfLoops = loops.reduce();
+    sorted    = allSorted.reduce();
+
+    uint64_t sum = 0;
+    for (uint64_t n = 0; n < numNodes; ++n) {
+      uint64_t d = in[n];
+      sum += d;
+      inPrefix[n] = sum;
+      if (d > maxIn) {
+        maxIn     = d;
+        maxInNode = n;
+      }
+      if (outDegree(n) > maxOut) {
+        maxOut     = outDegree(n);
+        maxOutNode = n;
+      }
+    }
+  }
+
+  struct Clustering {
+    double transitivity;
+    double averageLocal;
+  };
+
+  //! Checks whether a random wedge centered at n is closed
+  bool closedWedge(uint64_t n, graph_profile::SampleRng& rng) {
+    uint64_t d = outDegree(n);
+    uint64_t i = rng.below(d);
+    uint64_t j = rng.below(d - 1);
+    if (j >= i)
+      ++j;
+    uint64_t u = graph.getEdgeDst(graph.edge_begin(n) + i);
+    uint64_t w = graph.getEdgeDst(graph.edge_begin(n) + j);
+    if (u == w || u == n || w == n)
+      return false;
+    return hasEdge(u, w) || hasEdge(w, u);
+  }
+
+  Clustering clustering() {
+    // prefix sums of wedges per center
+    std::vector<double> wedges(numNodes);
+    double total = 0;
+    uint64_t centers = 0;
+    for (uint64_t n = 0; n < numNodes; ++n) {
+      double d = outDegree(n);
+      total += d * (d - 1) / 2;
+      wedges[n] = total;
+      if (d >= 2)
+        ++centers;
+    }
+    if (!centers)
+      return Clustering{NAN, NAN};
+
+    galois::GAccumulator<uint64_t> closed;
+    galois::GAccumulator<uint64_t> closedLocal;
+    galois::GAccumulator<uint64_t> sampledLocal;
+    galois::do_all(
+        galois::iterate(uint64_t{0}, opts.samples),
+        [&](uint64_t s) {
+          graph_profile::SampleRng rng(opts.seed, s);
+          // wedges chosen uniformly estimate transitivity
+          uint64_t n = std::upper_bound(wedges.begin(), wedges.end(),
+                                        rng.uniform() * total) -
+                       wedges.begin();
+          n = std::min(n, numNodes - 1);
+          if (outDegree(n) >= 2 && closedWedge(n, rng))
+            closed += 1;
+          // centers chosen uniformly estimate the average local coefficient
+          for (unsigned tries = 0; tries < 64; ++tries) {
+            uint64_t c = rng.below(numNodes);
+            if (outDegree(c) >= 2) {
+              sampledLocal += 1;
+              if (closedWedge(c, rng))
+                closedLocal += 1;
+              break;
+            }
+          }
+        },
+        galois::steal(), galois::no_stats(), galois::loopname("SampleWedges"));
+    return Clustering{double(closed.reduce()) / opts.samples,
+                      double(closedLocal.reduce()) / sampledLocal.reduce()};
+  }
+
+  //! Master ranges of a CuSP edge cut: the first node of each host
+  std::vector<uint64_t> masterBounds(galois::LargeArray<uint64_t>& prefix) {
+    std::vector<uint64_t> bounds;
+    size_t nodeWeight = numNodes ? numEdges / numNodes : 0;
+    for (unsigned h = 0; h < opts.hosts; ++h) {
+      auto r = galois::graphs::divideNodesBinarySearch(
+          numNodes, numEdges, nodeWeight, 1, h, opts.hosts, prefix);
+      bounds.push_back(*r.first.first);
+    }
+    return bounds;
+  }
+
+  static unsigned master(const std::vector<uint64_t>& bounds, uint64_t n) {
+    return std::upper_bound(bounds.begin(), bounds.end(), n) - bounds.begin() -
+           1;
+  }
+
+  //! Pearson correlation of endpoint degrees over sampled edges
+  double assortativity() {
+    if (!numEdges)
+      return NAN;
+    galois::GAccumulator<double> sx, sxx, sxy;
+    galois::do_all(
+        galois::iterate(uint64_t{0}, opts.samples),
+        [&](uint64_t s) {
+          graph_profile::SampleRng rng(opts.seed + 1, s);
+          uint64_t e   = rng.below(numEdges);
+          uint64_t src = edgeSource(e);
+          uint64_t dst = graph.getEdgeDst(graph.edge_begin(src) +
+                                          (e - edgeBegin(src)));
+          double x = outDegree(src) + inDegree(src);
+          double y = outDegree(dst) + inDegree(dst);
+          // both orientations, as for an undirected graph
+          sx += x + y;
+          sxx += x * x + y * y;
+          sxy += 2 * x * y;
+        },
+        galois::no_stats(), galois::loopname("SampleEdges"));
+
+    double m    = 2.0 * opts.samples;
+    double mean = sx.reduce() / m;
+    double var  = sxx.reduce() / m - mean * mean;
+    return (sxy.reduce() / m - mean * mean) / var;
+  }
+
+  struct PartitionCost {
+    const char* policy;
+    uint64_t cutEdges;
+    double replicationFactor;
+  };
+
+  /**
+   * Assigns masters and edges as the CuSP policies do and records on which
+   * hosts every node gets a proxy. An edge is cut if its owner is not the
+   * master of both endpoints.
+   */
+  std::vector<PartitionCost> partitions() {
+    if (opts.hosts > 64)
+      GALOIS_DIE("partitioning estimates support at most 64 hosts");
+    std::vector<uint64_t> outMasters = masterBounds(outPrefix);
+    std::vector<uint64_t> inMasters  = masterBounds(inPrefix);
+    unsigned columns                 = std::sqrt(opts.hosts);
+    while (opts.hosts % columns)
+      --columns;
+
+    enum { OEC, IEC, HOVC, HIVC, CVC, NUM_POLICIES };
+    const char* names[] = {"oec", "iec", "hovc", "hivc", "cvc"};
+    galois::LargeArray<std::atomic<uint64_t>> proxies[NUM_POLICIES];
+    galois::GAccumulator<uint64_t> cuts[NUM_POLICIES];
+    for (auto& p : proxies)
+      p.create(numNodes);
+
+    auto mark = [](std::atomic<uint64_t>& hosts, unsigned h) {
+      uint64_t bit = uint64_t{1} << h;
+      if (!(hosts.load(std::memory_order_relaxed) & bit))
+        hosts.fetch_or(bit, std::memory_order_relaxed);
+    };
+    galois::do_all(galois::iterate(uint64_t{0}, numNodes),
+                   [&](uint64_t n) {
+                     unsigned o = master(outMasters, n);
+                     unsigned i = master(inMasters, n);
+                     for (int p = 0; p < NUM_POLICIES; ++p)
+                       proxies[p][n] = uint64_t{1}
+                                       << (p == IEC || p == HIVC ? i : o);
+                   },
+                   galois::no_stats());
+
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t src) {
+          unsigned os = master(outMasters, src);
+          unsigned is = master(inMasters, src);
+          for (auto ii : graph.edges(src)) {
+            uint64_t dst = graph.getEdgeDst(ii);
+            unsigned od  = master(outMasters, dst);
+            unsigned id  = master(inMasters, dst);
+            unsigned owners[NUM_POLICIES] = {
+                os, id, outDegree(src) > opts.hvcThreshold ? od : os,
+                inDegree(dst) > opts.hvcThreshold ? is : id,
+                (os / columns) * columns + od % columns};
+            for (int p = 0; p < NUM_POLICIES; ++p) {
+              mark(proxies[p][src], owners[p]);
+              mark(proxies[p][dst], owners[p]);
+              bool in = p == IEC || p == HIVC;
+              if (owners[p] != (in ? is : os) || owners[p] != (in ? id : od))
+                cuts[p] += 1;
+            }
+          }
+        },
+        galois::steal(), galois::no_stats(), galois::loopname("Partitions"));
+
+    std::vector<PartitionCost> result;
+    for (int p = 0; p < NUM_POLICIES; ++p) {
+      galois::GAccumulator<uint64_t> replicas;
+      galois::do_all(galois::iterate(uint64_t{0}, numNodes),
+                     [&](uint64_t n) {
+                       replicas += __builtin_popcountll(proxies[p][n]);
+                     },
+                     galois::no_stats());
+      result.push_back(PartitionCost{names[p], cuts[p].reduce(),
+                                     double(replicas.reduce()) / numNodes});
+    }
+    return result;
+  }
+
+  struct Neighborhood {
+    std::vector<double> reachable;
+    double effectiveDiameter;
+    unsigned hops;
+    bool converged;
+  };
+
+  //! HyperLogLog estimate of the size of a set of m registers
+  double estimate(const uint8_t* r) const {
+    unsigned m  = opts.registers;
+    double sum  = 0;
+    unsigned zeros = 0;
+    for (unsigned j = 0; j < m; ++j) {
+      sum += std::ldexp(1.0, -r[j]);
+      zeros += r[j] == 0;
+    }
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double e     = alpha * m * m / sum;
+    if (e <= 2.5 * m && zeros)
+      e = m * std::log(double(m) / zeros);
+    return e;
+  }
+
+  Neighborhood neighborhood() {
+    unsigned m     = opts.registers;
+    unsigned logM  = __builtin_ctz(m);
+    galois::LargeArray<uint8_t> current, next;
+    current.create(numNodes * m);
+    next.create(numNodes * m);
+
+    galois::GAccumulator<double> reachable;
+    galois::do_all(
+        galois::iterate(uint64_t{0}, numNodes),
+        [&](uint64_t n) {
+          uint8_t* r = &current[n * m];
+          std::fill(r, r + m, 0);
+          uint64_t h = graph_profile::mix(n ^ opts.seed);
+          uint64_t w = h >> logM;
+          r[h & (m - 1)] = w ? __builtin_ctzll(w) + 1 : 65 - logM;
+          reachable += estimate(r);
+        },
+        galois::no_stats());
+
+    Neighborhood result;
+    result.reachable.push_back(reachable.reduce());
+    result.converged = false;
+    for (unsigned hop = 1; hop <= opts.maxHops; ++hop) {
+      galois::GReduceLogicalOR changed;
+      reachable.reset();
+      galois::do_all(
+          galois::iterate(uint64_t{0}, numNodes),
+          [&](uint64_t n) {
+            uint8_t* r = &next[n * m];
+            std::copy(&current[n * m], &current[n * m] + m, r);
+            bool grew = false;
+            for (auto ii : graph.edges(n)) {
+              const uint8_t* o = &current[graph.getEdgeDst(ii) * m];
+              for (unsigned j = 0; j < m; ++j) {
+                grew |= o[j] > r[j];
+                r[j] = std::max(r[j], o[j]);
+              }
+            }
+            if (grew)
+              changed.update(true);
+            reachable += estimate(r);
+          },
+          galois::steal(), galois::no_stats(),
+          galois::loopname("NeighborhoodFunction"));
+      std::swap(current, next);
+      if (!changed.reduce()) {
+        result.converged = true;
+        break;
+      }
+      result.reachable.push_back(reachable.reduce());
+    }
+
+    result.hops = result.reachable.size() - 1;
+    // interpolated hops within which 90% of reachable pairs are reached
+    double target = 0.9 * result.reachable.back();
+    result.effectiveDiameter = 0;
+    for (unsigned t = 1; t < result.reachable.size(); ++t) {
+      double lo = result.reachable[t - 1], hi = result.reachable[t];
+      if (hi >= target) {
+        result.effectiveDiameter = t - 1 + (target - lo) / (hi - lo);
+        break;
+      }
+    }
+    return result;
+  }
+
+public:
+  GraphProfile(Graph& g, const ProfileOptions& o)
+      : graph(g), opts(o), numNodes(g.size()), numEdges(g.sizeEdges()) {
+    if (opts.registers < 16 || opts.registers > 4096 ||
+        (opts.registers & (opts.registers - 1)))
+      GALOIS_DIE("number of registers must be a power of 2 in [16, 4096]");
+    if (!opts.hosts)
+      GALOIS_DIE("number of hosts must be positive");
+  }
+
+  //! Computes the profile and writes it as a JSON object
+  void write(std::ostream& out) {
+    using graph_profile::number;
+    countDegrees();
+    Clustering c{NAN, NAN};
+    double r = NAN;
+    std::vector<PartitionCost> costs;
+    Neighborhood nf{{}, NAN, 0, true};
+    if (numNodes) {
+      c     = clustering();
+      r     = assortativity();
+      costs = partitions();
+      nf    = neighborhood();
+    }
+
+    out << "{\n";
+    out << "  \"nodes\": " << numNodes << ",\n";
+    out << "  \"edges\": " << numEdges << ",\n";
+    out << "  \"selfLoops\": " << selfLoops << ",\n";
+    out << "  \"sortedNeighbors\": " << (sorted ? "true" : "false") << ",\n";
+    out << "  \"degree\": {\"average\": "
+        << number(numNodes ? double(numEdges) / numNodes : NAN)
+        << ", \"maxOut\": " << maxOut << ", \"maxOutNode\": " << maxOutNode
+        << ", \"maxIn\": " << maxIn << ", \"maxInNode\": " << maxInNode
+        << "},\n";
+    out << "  \"samples\": " << opts.samples << ",\n";
+    out << "  \"clustering\": {\"transitivity\": " << number(c.transitivity)
+        << ", \"averageLocal\": " << number(c.averageLocal) << "},\n";
+    out << "  \"degreeAssortativity\": " << number(r) << ",\n";
+    out << "  \"neighborhood\": {\"registers\": " << opts.registers
+        << ", \"reachablePairs\": [";
+    for (size_t t = 0; t < nf.reachable.size(); ++t)
+      out << (t ? ", " : "") << number(nf.reachable[t]);
+    out << "], \"effectiveDiameter\": " << number(nf.effectiveDiameter)
+        << ", \"approximateDiameter\": " << nf.hops
+        << ", \"converged\": " << (nf.converged ? "true" : "false") << "},\n";
+    out << "  \"partitions\": {\"hosts\": " << opts.hosts;
+    for (const PartitionCost& p : costs)
+      out << ",\n    \"" << p.policy << "\": {\"cutEdges\": " << p.cutEdges
+          << ", \"replicationFactor\": " << number(p.replicationFactor)
+          << "}";
+    out << "}\n";
+    out << "}\n";
+  }
+};
+
+#endif
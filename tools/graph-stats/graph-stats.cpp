@@ -19,11 +19,14 @@
 
 #include "galois/Galois.h"
 #include "galois/graphs/LCGraph.h"
-#include "galois/graphs/OfflineGraph.h"
+#include "galois/graphs/FileGraph.h"
+#include "GraphProfile.h"
 
 #include "llvm/Support/CommandLine.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <vector>
 
@@ -37,7 +40,8 @@ enum StatMode {
   indegreehist,
   sortedlogoffsethist,
   sparsityPattern,
-  summary
+  summary,
+  profile
 };
 
 static cll::opt<std::string>
@@ -53,13 +57,46 @@ static cll::list<StatMode> statModeList(
                           "Histogram of neighbor offsets with sorted edges"),
                 clEnumVal(sparsityPattern, "Pattern of non-zeros when graph is "
                                            "interpreted as a sparse matrix"),
-                clEnumVal(summary, "Graph summary"), clEnumValEnd));
+                clEnumVal(summary, "Graph summary"),
+                clEnumVal(profile, "Sampled structural profile as JSON"),
+                clEnumValEnd));
 static cll::opt<int> numBins("numBins", cll::desc("Number of bins"),
                              cll::init(-1));
 static cll::opt<int> columns("columns", cll::desc("Columns for sparsity"),
                              cll::init(80));
+static cll::opt<unsigned> numThreads("t", cll::desc("Number of threads"),
+                                     cll::init(1));
+static cll::opt<unsigned>
+    numSamples("samples", cll::desc("Wedges and edges sampled for profile"),
+               cll::init(100000));
+static cll::opt<unsigned>
+    hllRegisters("registers",
+                 cll::desc("HyperLogLog registers per node for the profile "
+                           "neighborhood function (a power of 2)"),
+                 cll::init(64));
+static cll::opt<unsigned>
+    maxHops("maxHops",
+            cll::desc("Maximum hops of the profile neighborhood function"),
+            cll::init(64));
+static cll::opt<unsigned>
+    numHosts("hosts",
+             cll::desc("Hosts for the profile partitioning estimates"),
+             cll::init(4));
+static cll::opt<unsigned> seed("seed", cll::desc("Seed for profile sampling"),
+                               cll::init(0));
+static cll::opt<std::string>
+    profileFilename("profileFile",
+                    cll::desc("Write the profile to this file instead of "
+                              "standard output"),
+                    cll::init(""));
+static cll::opt<std::string>
+    statFile("statFile",
+             cll::desc("Write the statistics printed on exit to this file; "
+                       "they go to standard error when the profile goes to "
+                       "standard output"),
+             cll::init(""));
 
-typedef galois::graphs::OfflineGraph Graph;
+typedef galois::graphs::FileGraph Graph;
 typedef Graph::GraphNode GNode;
 
 void doSummary(Graph& graph) {
@@ -229,6 +266,21 @@ void doSortedLogOffsetHistogram(Graph& graph) {
   // printHistogram("LogOffset", hists);
 }
 
+void doProfile(Graph& graph) {
+  ProfileOptions opts;
+  opts.samples   = numSamples;
+  opts.registers = hllRegisters;
+  opts.maxHops   = maxHops;
+  opts.hosts     = numHosts;
+  opts.seed      = seed;
+  if (profileFilename.empty()) {
+    GraphProfile(graph, opts).write(std::cout);
+  } else {
+    std::ofstream out(profileFilename);
+    GraphProfile(graph, opts).write(out);
+  }
+}
+
 void doDestinationHistogram(Graph& graph) {
   std::map<uint64_t, uint64_t> hist;
   for (auto ii : graph) {
@@ -240,9 +292,23 @@ void doDestinationHistogram(Graph& graph) {
 }
 
 int main(int argc, char** argv) {
+  galois::SharedMemSys G;
   llvm::cl::ParseCommandLineOptions(argc, argv);
+  galois::setActiveThreads(numThreads);
+
+  bool profileToStdout =
+      profileFilename.empty() &&
+      std::find(statModeList.begin(), statModeList.end(), profile) !=
+          statModeList.end();
+  if (!statFile.empty())
+    galois::runtime::setStatFile(statFile);
+  else if (profileToStdout)
+    // keep standard output valid JSON
+    galois::runtime::setStatFile("/dev/stderr");
+
   try {
-    Graph graph(inputfilename);
+    Graph graph;
+    graph.fromFile(inputfilename);
     for (unsigned i = 0; i != statModeList.size(); ++i) {
       switch (statModeList[i]) {
       case degreehist:
@@ -278,6 +344,9 @@ int main(int argc, char** argv) {
       case summary:
         doSummary(graph);
         break;
+      case profile:
+        doProfile(graph);
+        break;
       default:
         std::cerr << "Unknown stat requested\n";
         break;
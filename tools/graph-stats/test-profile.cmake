@@ -0,0 +1,75 @@
+# Checks the -profile output of graph-stats on a graph whose properties are
+# known: a triangle 0-1-2 with a path 2-3-4-5 hanging off it, with every edge
+# in both directions. The output must parse as JSON.
+#
+# cmake -DCONVERT=<graph-convert> -DSTATS=<graph-stats> -DWORKDIR=<dir>
+#       -P test-profile.cmake
+
+file(MAKE_DIRECTORY ${WORKDIR})
+
+set(el "")
+foreach(edge "0 1" "1 2" "2 0" "2 3" "3 4" "4 5")
+  string(REPLACE " " ";" edge "${edge}")
+  list(GET edge 0 u)
+  list(GET edge 1 v)
+  string(APPEND el "${u} ${v}\n${v} ${u}\n")
+endforeach()
+file(WRITE ${WORKDIR}/profile.el "${el}")
+
+execute_process(
+  COMMAND ${CONVERT} -edgelist2gr -edgeType=void ${WORKDIR}/profile.el
+          ${WORKDIR}/profile.gr
+  RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "edgelist2gr failed: ${result}")
+endif()
+
+execute_process(
+  COMMAND ${STATS} -profile -hosts=2 -t=2 ${WORKDIR}/profile.gr
+  RESULT_VARIABLE result OUTPUT_VARIABLE json ERROR_VARIABLE err)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "graph-stats -profile failed: ${result}\n${err}")
+endif()
+
+# string(JSON) fails on invalid JSON
+function(expect value)
+  string(JSON actual GET "${json}" ${ARGN})
+  if(NOT actual STREQUAL value)
+    message(FATAL_ERROR "${ARGN}: expected ${value}, got ${actual}")
+  endif()
+endfunction()
+
+# sampled values within 0.02 of the exact value, given in thousandths
+function(expectNear value)
+  string(JSON actual GET "${json}" ${ARGN})
+  if(NOT actual MATCHES "^0\\.([0-9]+)$")
+    message(FATAL_ERROR "${ARGN}: expected 0.${value}, got ${actual}")
+  endif()
+  string(SUBSTRING "${CMAKE_MATCH_1}00" 0 3 thousandths)
+  math(EXPR error "${thousandths} - ${value}")
+  if(error LESS -20 OR error GREATER 20)
+    message(FATAL_ERROR "${ARGN}: expected 0.${value}, got ${actual}")
+  endif()
+endfunction()
+
+expect(6 nodes)
+expect(12 edges)
+expect(0 selfLoops)
+# neighbors are in file order, so node 2 lists 0 after 1
+expect(OFF sortedNeighbors)
+expect(3 degree maxOut)
+expect(2 degree maxOutNode)
+
+# 3 of the 7 wedges are closed; the local coefficients of the 5 centers are
+# 1, 1, 1/3, 0 and 0
+expectNear(429 clustering transitivity)
+expectNear(467 clustering averageLocal)
+
+# the longest shortest path is 0-2-3-4-5
+expect(4 neighborhood approximateDiameter)
+expect(ON neighborhood converged)
+
+# the 2 hosts get the triangle and the path 3-4-5, so only 2-3 and 3-2 are
+# cut
+expect(2 partitions oec cutEdges)
+expect(2 partitions iec cutEdges)